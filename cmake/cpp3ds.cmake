@@ -216,6 +216,69 @@ macro(compile_resources name directory output)
 endmacro()
 
 
+# Convert images to preprocessed textures for Texture::loadFromPreprocessedFile.
+# Usage: convert_textures(output "etc1" 0 image1.png image2.jpg ...)
+# with the texture format and number of mipmap levels (0 for a full chain).
+# Each image.png produces image.png.tex next to it.
+function(convert_textures output format levels)
+	if(NOT TEXCONV)
+		find_program(TEXCONV cpp3ds-texconv ${CPP3DS}/bin)
+	endif()
+	if(NOT TEXCONV)
+		message(FATAL_ERROR "Called convert_textures() but cpp3ds-texconv was not found (build cpp3ds with BUILD_TOOLS).")
+	endif()
+	foreach(image ${ARGN})
+		get_filename_component(filename ${image} NAME)
+		list(APPEND ${output} "${image}.tex")
+		add_custom_command(
+			OUTPUT ${image}.tex
+			COMMAND ${TEXCONV} -f ${format} -m ${levels} -o ${image}.tex ${image}
+			DEPENDS ${image}
+			COMMENT "Converting texture ${filename}"
+		)
+	endforeach(image)
+	set(${output} ${${output}} PARENT_SCOPE)
+endfunction()
+
+
+# Bake font glyphs for Font::loadFromBakedAtlas.
+# Usage: bake_fonts(output SIZES 12 16 RANGES 32-126 0x3040-0x30ff [BOLD] FONTS font1.ttf font2.otf ...)
+# Each font.ttf produces font.ttf.fnt next to it, to pass to compile_resources().
+include(CMakeParseArguments)
+function(bake_fonts output)
+	cmake_parse_arguments(BAKE "BOLD" "PAGE_SIZE" "SIZES;RANGES;FONTS" ${ARGN})
+	if(NOT FONTBAKE)
+		find_program(FONTBAKE cpp3ds-fontbake ${CPP3DS}/bin)
+	endif()
+	if(NOT FONTBAKE)
+		message(FATAL_ERROR "Called bake_fonts() but cpp3ds-fontbake was not found (build cpp3ds with BUILD_TOOLS).")
+	endif()
+	if(NOT BAKE_SIZES OR NOT BAKE_RANGES)
+		message(FATAL_ERROR "bake_fonts() needs SIZES and RANGES.")
+	endif()
+	string(REPLACE ";" "," sizes "${BAKE_SIZES}")
+	string(REPLACE ";" "," ranges "${BAKE_RANGES}")
+	set(options -s ${sizes} -r ${ranges})
+	if(BAKE_BOLD)
+		list(APPEND options -b)
+	endif()
+	if(BAKE_PAGE_SIZE)
+		list(APPEND options -p ${BAKE_PAGE_SIZE})
+	endif()
+	foreach(font ${BAKE_FONTS})
+		get_filename_component(filename ${font} NAME)
+		list(APPEND ${output} "${font}.fnt")
+		add_custom_command(
+			OUTPUT ${font}.fnt
+			COMMAND ${FONTBAKE} ${options} -o ${font}.fnt ${font}
+			DEPENDS ${font}
+			COMMENT "Baking font ${filename}"
+		)
+	endforeach(font)
+	set(${output} ${${output}} PARENT_SCOPE)
+endfunction()
+
+
 function(__add_smdh target APP_TITLE APP_DESCRIPTION APP_AUTHOR APP_ICON)
     if(BANNERTOOL AND NOT FORCE_SMDHTOOL)
         set(__SMDH_COMMAND ${BANNERTOOL} makesmdh -s ${APP_TITLE} -l ${APP_DESCRIPTION}  -p ${APP_AUTHOR} -i ${APP_ICON} -o ${CMAKE_RUNTIME_OUTPUT_DIRECTORY}/${target} ${ICON_FLAGS})
@@ -215,6 +215,16 @@ public:
     ////////////////////////////////////////////////////////////
     Time getDuration() const;
 
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the amount of memory used by the samples
+    ///
+    /// \return Size of the samples, in bytes
+    ///
+    /// \see getSampleCount
+    ///
+    ////////////////////////////////////////////////////////////
+    std::size_t getMemoryUsage() const;
+
     ////////////////////////////////////////////////////////////
     /// \brief Overload of assignment operator
     ///
@@ -4,10 +4,14 @@
 #include <cpp3ds/Window.hpp>
 #include <cpp3ds/Graphics/BlendMode.hpp>
 #include <cpp3ds/Graphics/Color.hpp>
+#include <cpp3ds/Graphics/CompactVertex.hpp>
+#include <cpp3ds/Graphics/CompactVertexArray.hpp>
 #include <cpp3ds/Graphics/Console.hpp>
 #include <cpp3ds/Graphics/Font.hpp>
+#include <cpp3ds/Graphics/FrameProfiler.hpp>
 #include <cpp3ds/Graphics/Glyph.hpp>
 #include <cpp3ds/Graphics/Image.hpp>
+#include <cpp3ds/Graphics/IndexedVertexArray.hpp>
 #include <cpp3ds/Graphics/RenderStates.hpp>
 #include <cpp3ds/Graphics/RenderTexture.hpp>
 //#include <cpp3ds/Graphics/RenderWindow.hpp>
@@ -18,7 +22,9 @@
 #include <cpp3ds/Graphics/ConvexShape.hpp>
 #include <cpp3ds/Graphics/Sprite.hpp>
 #include <cpp3ds/Graphics/Text.hpp>
+#include <cpp3ds/Graphics/TextLayout.hpp>
 #include <cpp3ds/Graphics/Texture.hpp>
+#include <cpp3ds/Graphics/TextureLoader.hpp>
 #include <cpp3ds/Graphics/Transform.hpp>
 #include <cpp3ds/Graphics/Vertex.hpp>
 #include <cpp3ds/Graphics/VertexArray.hpp>
@@ -0,0 +1,127 @@
+#ifndef CPP3DS_COMPACTVERTEX_HPP
+#define CPP3DS_COMPACTVERTEX_HPP
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cpp3ds/Config.hpp>
+#include <cpp3ds/Graphics/Color.hpp>
+#include <cpp3ds/System/Vector2.hpp>
+#include <new>
+
+
+namespace cpp3ds
+{
+////////////////////////////////////////////////////////////
+/// \brief Vertex with 16-bit integer position and texture coordinates
+///
+////////////////////////////////////////////////////////////
+class CompactVertex
+{
+public :
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Default constructor
+    ///
+    ////////////////////////////////////////////////////////////
+    CompactVertex();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Construct the vertex from its position
+    ///
+    /// The vertex color is white and texture coordinates are (0, 0).
+    ///
+    /// \param thePosition Vertex position
+    ///
+    ////////////////////////////////////////////////////////////
+    CompactVertex(const Vector2<Int16>& thePosition);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Construct the vertex from its position and color
+    ///
+    /// The texture coordinates are (0, 0).
+    ///
+    /// \param thePosition Vertex position
+    /// \param theColor    Vertex color
+    ///
+    ////////////////////////////////////////////////////////////
+    CompactVertex(const Vector2<Int16>& thePosition, const Color& theColor);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Construct the vertex from its position and texture coordinates
+    ///
+    /// The vertex color is white.
+    ///
+    /// \param thePosition  Vertex position
+    /// \param theTexCoords Vertex texture coordinates
+    ///
+    ////////////////////////////////////////////////////////////
+    CompactVertex(const Vector2<Int16>& thePosition, const Vector2<Int16>& theTexCoords);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Construct the vertex from its position, color and texture coordinates
+    ///
+    /// \param thePosition  Vertex position
+    /// \param theColor     Vertex color
+    /// \param theTexCoords Vertex texture coordinates
+    ///
+    ////////////////////////////////////////////////////////////
+    CompactVertex(const Vector2<Int16>& thePosition, const Color& theColor, const Vector2<Int16>& theTexCoords);
+
+	#ifndef EMULATION
+	static void* operator new (std::size_t size);
+	static void* operator new[] (std::size_t size);
+	static void operator delete (void *p);
+	static void operator delete[] (void *p);
+	#endif
+
+    ////////////////////////////////////////////////////////////
+    // Member data
+    ////////////////////////////////////////////////////////////
+    Vector2<Int16> position;  ///< 2D position of the vertex, in whole units
+    Color          color;     ///< Color of the vertex
+    Vector2<Int16> texCoords; ///< Coordinates of the texture's pixel to map to the vertex
+};
+
+} // namespace cpp3ds
+
+
+#endif // CPP3DS_COMPACTVERTEX_HPP
+
+
+////////////////////////////////////////////////////////////
+/// \class cpp3ds::CompactVertex
+/// \ingroup graphics
+///
+/// cpp3ds::CompactVertex holds the same attributes as
+/// cpp3ds::Vertex, but stores the position and the texture
+/// coordinates as 16-bit integers. It takes 12 bytes instead
+/// of 20, so the GPU reads 40% less data per vertex.
+///
+/// It suits geometry that lies on whole units, like tile maps
+/// and pixel-aligned user interfaces. The transform of the
+/// render states and the view still apply, so the vertices
+/// can be moved, scaled or rotated as a whole.
+///
+/// Render targets have draw overloads taking compact vertices,
+/// so both formats can be mixed freely from one draw to the
+/// next.
+///
+/// Example:
+/// \code
+/// // a 16x16 tile at (32, 48), using the tile at (16, 0) in the tileset
+/// cpp3ds::CompactVertex vertices[] =
+/// {
+///     cpp3ds::CompactVertex(cpp3ds::Vector2<cpp3ds::Int16>(32, 48), cpp3ds::Vector2<cpp3ds::Int16>(16,  0)),
+///     cpp3ds::CompactVertex(cpp3ds::Vector2<cpp3ds::Int16>(32, 64), cpp3ds::Vector2<cpp3ds::Int16>(16, 16)),
+///     cpp3ds::CompactVertex(cpp3ds::Vector2<cpp3ds::Int16>(48, 64), cpp3ds::Vector2<cpp3ds::Int16>(32, 16)),
+///     cpp3ds::CompactVertex(cpp3ds::Vector2<cpp3ds::Int16>(48, 48), cpp3ds::Vector2<cpp3ds::Int16>(32,  0))
+/// };
+///
+/// cpp3ds::RenderStates states(&tileset);
+/// window.draw(vertices, 4, cpp3ds::Quads, states);
+/// \endcode
+///
+/// \see cpp3ds::Vertex, cpp3ds::CompactVertexArray
+///
+////////////////////////////////////////////////////////////
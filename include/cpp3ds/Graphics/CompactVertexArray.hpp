@@ -0,0 +1,204 @@
+#ifndef CPP3DS_COMPACTVERTEXARRAY_HPP
+#define CPP3DS_COMPACTVERTEXARRAY_HPP
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cpp3ds/Config.hpp>
+#include <cpp3ds/Graphics/CompactVertex.hpp>
+#include <cpp3ds/Graphics/PrimitiveType.hpp>
+#include <cpp3ds/Graphics/Rect.hpp>
+#include <cpp3ds/Graphics/Drawable.hpp>
+#ifndef EMULATION
+#include <cpp3ds/System/LinearAllocator.hpp>
+#endif
+#include <vector>
+
+
+namespace cpp3ds
+{
+////////////////////////////////////////////////////////////
+/// \brief Define a set of one or more 2D primitives made
+///        of compact vertices
+///
+////////////////////////////////////////////////////////////
+class CompactVertexArray : public Drawable
+{
+public :
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Default constructor
+    ///
+    /// Creates an empty vertex array.
+    ///
+    ////////////////////////////////////////////////////////////
+    CompactVertexArray();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Construct the vertex array with a type and an initial number of vertices
+    ///
+    /// \param type        Type of primitives
+    /// \param vertexCount Initial number of vertices in the array
+    ///
+    ////////////////////////////////////////////////////////////
+    explicit CompactVertexArray(PrimitiveType type, unsigned int vertexCount = 0);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Return the vertex count
+    ///
+    /// \return Number of vertices in the array
+    ///
+    ////////////////////////////////////////////////////////////
+    unsigned int getVertexCount() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get a read-write access to a vertex by its index
+    ///
+    /// This function doesn't check \a index, it must be in range
+    /// [0, getVertexCount() - 1]. The behaviour is undefined
+    /// otherwise.
+    ///
+    /// \param index Index of the vertex to get
+    ///
+    /// \return Reference to the index-th vertex
+    ///
+    /// \see getVertexCount
+    ///
+    ////////////////////////////////////////////////////////////
+    CompactVertex& operator [](unsigned int index);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get a read-only access to a vertex by its index
+    ///
+    /// This function doesn't check \a index, it must be in range
+    /// [0, getVertexCount() - 1]. The behaviour is undefined
+    /// otherwise.
+    ///
+    /// \param index Index of the vertex to get
+    ///
+    /// \return Const reference to the index-th vertex
+    ///
+    /// \see getVertexCount
+    ///
+    ////////////////////////////////////////////////////////////
+    const CompactVertex& operator [](unsigned int index) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Clear the vertex array
+    ///
+    /// This function removes all the vertices from the array.
+    /// It doesn't deallocate the corresponding memory, so that
+    /// adding new vertices after clearing doesn't involve
+    /// reallocating all the memory.
+    ///
+    ////////////////////////////////////////////////////////////
+    void clear();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Resize the vertex array
+    ///
+    /// Existing vertices are kept, new ones are
+    /// default-constructed.
+    ///
+    /// \param vertexCount New size of the array (number of vertices)
+    ///
+    ////////////////////////////////////////////////////////////
+    void resize(unsigned int vertexCount);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Add a vertex to the array
+    ///
+    /// \param vertex Vertex to add
+    ///
+    ////////////////////////////////////////////////////////////
+    void append(const CompactVertex& vertex);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Set the type of primitives to draw
+    ///
+    /// The default primitive type is cpp3ds::Triangles.
+    ///
+    /// \param type Type of primitive
+    ///
+    ////////////////////////////////////////////////////////////
+    void setPrimitiveType(PrimitiveType type);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the type of primitives drawn by the vertex array
+    ///
+    /// \return Primitive type
+    ///
+    ////////////////////////////////////////////////////////////
+    PrimitiveType getPrimitiveType() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Compute the bounding rectangle of the vertex array
+    ///
+    /// This function returns the axis-aligned rectangle that
+    /// contains all the vertices of the array.
+    ///
+    /// \return Bounding rectangle of the vertex array
+    ///
+    ////////////////////////////////////////////////////////////
+    FloatRect getBounds() const;
+
+private :
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Draw the vertex array to a render target
+    ///
+    /// \param target Render target to draw to
+    /// \param states Current render states
+    ///
+    ////////////////////////////////////////////////////////////
+    virtual void draw(RenderTarget& target, RenderStates states) const;
+
+private:
+
+    ////////////////////////////////////////////////////////////
+    // Member data
+    ////////////////////////////////////////////////////////////
+	#ifdef EMULATION
+    std::vector<CompactVertex> m_vertices;      ///< Vertices contained in the array
+    #else
+    std::vector<CompactVertex, LinearAllocator<CompactVertex>> m_vertices;
+    #endif
+    PrimitiveType              m_primitiveType; ///< Type of primitives to draw
+};
+
+} // namespace cpp3ds
+
+
+#endif // CPP3DS_COMPACTVERTEXARRAY_HPP
+
+
+////////////////////////////////////////////////////////////
+/// \class cpp3ds::CompactVertexArray
+/// \ingroup graphics
+///
+/// cpp3ds::CompactVertexArray works like cpp3ds::VertexArray,
+/// but holds cpp3ds::CompactVertex instances. Since its
+/// vertices are stored in linear memory, big arrays such as
+/// tile maps are handed to the GPU without being copied, and
+/// the GPU reads 12 bytes per vertex instead of 20.
+///
+/// Example:
+/// \code
+/// cpp3ds::CompactVertexArray tiles(cpp3ds::Quads);
+/// for (int y = 0; y < 15; ++y)
+///     for (int x = 0; x < 25; ++x)
+///     {
+///         cpp3ds::Int16 left = x * 16, top = y * 16;
+///         cpp3ds::Int16 u = map[y][x] * 16;
+///         tiles.append(cpp3ds::CompactVertex(cpp3ds::Vector2<cpp3ds::Int16>(left, top), cpp3ds::Vector2<cpp3ds::Int16>(u, 0)));
+///         tiles.append(cpp3ds::CompactVertex(cpp3ds::Vector2<cpp3ds::Int16>(left, top + 16), cpp3ds::Vector2<cpp3ds::Int16>(u, 16)));
+///         tiles.append(cpp3ds::CompactVertex(cpp3ds::Vector2<cpp3ds::Int16>(left + 16, top + 16), cpp3ds::Vector2<cpp3ds::Int16>(u + 16, 16)));
+///         tiles.append(cpp3ds::CompactVertex(cpp3ds::Vector2<cpp3ds::Int16>(left + 16, top), cpp3ds::Vector2<cpp3ds::Int16>(u + 16, 0)));
+///     }
+///
+/// window.draw(tiles, &tileset);
+/// \endcode
+///
+/// \see cpp3ds::CompactVertex, cpp3ds::VertexArray
+///
+////////////////////////////////////////////////////////////
@@ -8,7 +8,11 @@
 #include <cpp3ds/Graphics/Drawable.hpp>
 #include <cpp3ds/Graphics/Font.hpp>
 #include <cpp3ds/Graphics/Text.hpp>
+#include <cpp3ds/Graphics/Vertex.hpp>
 #include <cpp3ds/Window/ContextSettings.hpp>
+#include <cpp3ds/Window/Event.hpp>
+#include <deque>
+#include <vector>
 
 namespace cpp3ds
 {
@@ -31,8 +35,27 @@ public:
 	////////////////////////////////////////////////////////////
 	~Console();
 
+	////////////////////////////////////////////////////////////
+	/// \brief Take the new output and lay out what became visible
+	///
+	/// Only the lines written since the last update are laid
+	/// out, and only those that fit on the screen.
+	///
+	/// \param delta Time since the last update, in seconds
+	///
+	////////////////////////////////////////////////////////////
 	void update(float delta);
 
+	////////////////////////////////////////////////////////////
+	/// \brief Write text at the end of the console
+	///
+	/// Like in a terminal, lines end at '\n': text written
+	/// without it continues the last line. The console keeps
+	/// the last 1000 lines.
+	///
+	/// \param text Text to write
+	///
+	////////////////////////////////////////////////////////////
 	void write(String text);
 
 	bool processEvent(Event& event);
@@ -71,12 +94,83 @@ private:
 	////////////////////////////////////////////////////////////
 	virtual void draw(RenderTarget& target, RenderStates states) const;
 
+	////////////////////////////////////////////////////////////
+	/// \brief Get a stored line
+	///
+	/// \param index Index of the line, 0 being the oldest one
+	///
+	/// \return The line
+	///
+	////////////////////////////////////////////////////////////
+	String& getLine(std::size_t index);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Get the number of lines that fit on the screen
+	///
+	/// \return Number of lines, the top one may be partly hidden
+	///
+	////////////////////////////////////////////////////////////
+	std::size_t getVisibleLineCount() const;
+
+	////////////////////////////////////////////////////////////
+	/// \brief Lay out the lines written since the last update
+	///
+	////////////////////////////////////////////////////////////
+	void updateGeometry();
+
+	////////////////////////////////////////////////////////////
+	/// \brief Add the quads of a line below the visible ones
+	///
+	/// \param line Line to lay out
+	///
+	////////////////////////////////////////////////////////////
+	void addLine(const String& line);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Drop the quads of the top visible line
+	///
+	////////////////////////////////////////////////////////////
+	void removeTopLine();
+
+	////////////////////////////////////////////////////////////
+	/// \brief Drop the quads of the bottom visible line
+	///
+	////////////////////////////////////////////////////////////
+	void removeBottomLine();
+
+	////////////////////////////////////////////////////////////
+	/// \brief Drop the quads of all the visible lines
+	///
+	////////////////////////////////////////////////////////////
+	void clearGeometry();
+
+	////////////////////////////////////////////////////////////
+	/// \brief Vertices using the same font page
+	///
+	////////////////////////////////////////////////////////////
+	struct PageRun
+	{
+		unsigned int page;  ///< Index of the font texture
+		std::size_t  count; ///< Number of vertices
+	};
+
 	////////////////////////////////////////////////////////////
 	// Member data
 	////////////////////////////////////////////////////////////
 	Font  m_font;
 	Color m_color;
-	std::vector<Text> m_lines;
+	std::vector<String> m_lines;              ///< Ring buffer of the last m_limit lines
+	std::size_t m_firstLine;                  ///< Index of the oldest line in m_lines
+	std::size_t m_lineCount;                  ///< Number of lines stored
+	std::size_t m_newLines;                   ///< Number of lines written since the last update
+	bool m_lineOpen;                          ///< Does the last line continue at the next write?
+	bool m_lastLineChanged;                   ///< Was the last laid out line continued since?
+	std::vector<Vertex> m_vertices;           ///< Quads of the visible lines, from m_firstVertex on
+	std::size_t m_firstVertex;                ///< Index of the first vertex of the top visible line
+	std::deque<std::size_t> m_visibleLines;   ///< Number of vertices of each visible line, top first
+	std::deque<PageRun> m_pageRuns;           ///< Font page of the vertices, in order
+	std::size_t m_topRow;                     ///< Row of the top visible line
+	std::size_t m_nextRow;                    ///< Row of the next line laid out
 	Text m_memoryText;
 	unsigned int m_limit;
 	static bool m_enabled;
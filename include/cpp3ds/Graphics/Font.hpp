@@ -29,10 +29,13 @@
 // Headers
 ////////////////////////////////////////////////////////////
 #include <cpp3ds/Graphics/Glyph.hpp>
+#include <cpp3ds/Graphics/Image.hpp>
 #include <cpp3ds/Graphics/Texture.hpp>
 #include <cpp3ds/Graphics/Rect.hpp>
+#include <cpp3ds/System/HashTable.hpp>
 #include <cpp3ds/System/Vector2.hpp>
 #include <cpp3ds/System/String.hpp>
+#include <deque>
 #include <map>
 #include <string>
 #include <vector>
@@ -98,6 +101,10 @@ namespace cpp3ds
         /// function, so the file has to remain accessible until
         /// the cpp3ds::Font object loads a new font or is destroyed.
         ///
+        /// If another font was already loaded from the same file,
+        /// its face and glyph pages are shared instead of being
+        /// loaded again.
+        ///
         /// \param filename Path of the font file to load
         ///
         /// \return True if loading succeeded, false if it failed
@@ -118,6 +125,10 @@ namespace cpp3ds
         /// valid until the cpp3ds::Font object loads a new font or
         /// is destroyed.
         ///
+        /// If another font was already loaded from the same buffer
+        /// (same address and size), its face and glyph pages are
+        /// shared instead of being loaded again.
+        ///
         /// \param data        Pointer to the file data in memory
         /// \param sizeInBytes Size of the data to load, in bytes
         ///
@@ -141,6 +152,9 @@ namespace cpp3ds
         /// function, so the stream has to remain accessible until
         /// the cpp3ds::Font object loads a new font or is destroyed.
         ///
+        /// Unlike files and buffers, streams can't be told apart:
+        /// each font loaded from a stream gets its own face.
+        ///
         /// \param stream Source stream to read from
         ///
         /// \return True if loading succeeded, false if it failed
@@ -150,6 +164,47 @@ namespace cpp3ds
         ////////////////////////////////////////////////////////////
         bool loadFromStream(InputStream& stream);
 
+        ////////////////////////////////////////////////////////////
+        /// \brief Add glyphs baked by cpp3ds-fontbake from a file in memory
+        ///
+        /// The baked character sizes get their glyph pages, metrics
+        /// and kerning straight from the file: using them doesn't
+        /// involve FreeType at all. Glyphs missing from the file
+        /// (other code points, outlined or non-baked bold glyphs)
+        /// are still rasterized by the font face, if one was loaded
+        /// before; otherwise they are empty.
+        ///
+        /// Loading a font with loadFromFile, loadFromMemory or
+        /// loadFromStream discards the baked glyphs, so call this
+        /// function afterwards. The data is copied, the buffer can
+        /// be freed once the function returns.
+        ///
+        /// The baked glyphs belong to this font and are copied with
+        /// it. Other fonts loaded from the same source share the
+        /// face but don't get them.
+        ///
+        /// \param data        Pointer to the baked atlas in memory
+        /// \param sizeInBytes Size of the data, in bytes
+        ///
+        /// \return True if loading succeeded, false if it failed
+        ///
+        /// \see loadFromFile, loadFromMemory
+        ///
+        ////////////////////////////////////////////////////////////
+        bool loadFromBakedAtlas(const void* data, std::size_t sizeInBytes);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Add glyphs baked by cpp3ds-fontbake from a file
+        ///
+        /// \param filename Path of the baked atlas file
+        ///
+        /// \return True if loading succeeded, false if it failed
+        ///
+        /// \see loadFromBakedAtlas(const void*, std::size_t)
+        ///
+        ////////////////////////////////////////////////////////////
+        bool loadFromBakedAtlas(const std::string& filename);
+
         ////////////////////////////////////////////////////////////
         /// \brief Get the font information
         ///
@@ -178,6 +233,112 @@ namespace cpp3ds
         ////////////////////////////////////////////////////////////
         const Glyph& getGlyph(Uint32 codePoint, unsigned int characterSize, bool bold, float outlineThickness = 0) const;
 
+        ////////////////////////////////////////////////////////////
+        /// \brief Load the glyphs of a set of characters in advance
+        ///
+        /// All the missing glyphs are rasterized first, then written
+        /// to the page textures with one upload per page, instead of
+        /// one upload per glyph when they are loaded by getGlyph.
+        /// Useful in a loading screen, before showing new text.
+        ///
+        /// \param characters       Characters whose glyphs to load
+        /// \param characterSize    Reference character size
+        /// \param bold             Load the bold versions or the regular ones?
+        /// \param outlineThickness Thickness of outline
+        ///
+        /// \see preloadGlyphsAsync
+        ///
+        ////////////////////////////////////////////////////////////
+        void preloadGlyphs(const String& characters, unsigned int characterSize, bool bold = false, float outlineThickness = 0);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Load the glyphs of a set of characters in a
+        ///        background thread
+        ///
+        /// The missing glyphs are rasterized by a worker thread into
+        /// a staging buffer. They only become part of the font when
+        /// publishPreloadedGlyphs is called, so the glyph tables and
+        /// textures are never modified behind the back of the
+        /// rendering thread. Meanwhile, getGlyph keeps working: a
+        /// glyph it needs before being published is loaded as usual.
+        ///
+        /// Preloading stops when the font is destroyed or loads
+        /// another font.
+        ///
+        /// \param characters       Characters whose glyphs to load
+        /// \param characterSize    Reference character size
+        /// \param bold             Load the bold versions or the regular ones?
+        /// \param outlineThickness Thickness of outline
+        ///
+        /// \see publishPreloadedGlyphs, isPreloading
+        ///
+        ////////////////////////////////////////////////////////////
+        void preloadGlyphsAsync(const String& characters, unsigned int characterSize, bool bold = false, float outlineThickness = 0);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Add the glyphs rasterized in the background to
+        ///        the font
+        ///
+        /// Must be called from the rendering thread, typically once
+        /// per frame while isPreloading returns true. The glyphs
+        /// ready so far are written to the page textures, with one
+        /// upload per page.
+        ///
+        /// \return Number of glyphs added to the font
+        ///
+        /// \see preloadGlyphsAsync
+        ///
+        ////////////////////////////////////////////////////////////
+        unsigned int publishPreloadedGlyphs();
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Tell if glyphs are being preloaded
+        ///
+        /// \return True if glyphs are still being rasterized or are
+        ///         waiting to be published
+        ///
+        /// \see preloadGlyphsAsync, publishPreloadedGlyphs
+        ///
+        ////////////////////////////////////////////////////////////
+        bool isPreloading() const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Retrieve a glyph of the distance field atlas
+        ///
+        /// Instead of its coverage, each texel of a distance field
+        /// glyph stores the distance to the outline of the character,
+        /// which can be thresholded at any scale without blurring.
+        /// These glyphs are therefore rasterized once, at
+        /// DistanceFieldSize, and drawn at every character size:
+        /// their memory doesn't grow with the number of sizes used.
+        /// See cpp3ds::Text::setDistanceFieldEnabled.
+        ///
+        /// The metrics are given at DistanceFieldSize, and the
+        /// bounds include the margin of the field around the
+        /// character (DistanceFieldSpread texels on each side).
+        ///
+        /// \param codePoint Unicode code point of the character to get
+        /// \param bold      Retrieve the bold version or the regular one?
+        ///
+        /// \return The distance field glyph corresponding to \a codePoint
+        ///
+        /// \see getDistanceFieldTexture
+        ///
+        ////////////////////////////////////////////////////////////
+        const Glyph& getDistanceFieldGlyph(Uint32 codePoint, bool bold) const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Retrieve a page of the distance field atlas
+        ///
+        /// \param page Index of the page, given by the glyphs
+        ///
+        /// \return Texture containing the distance field glyphs of the page
+        ///
+        /// \see getDistanceFieldGlyph
+        ///
+        ////////////////////////////////////////////////////////////
+        const Texture& getDistanceFieldTexture(unsigned int page = 0) const;
+
         ////////////////////////////////////////////////////////////
         /// \brief Get the kerning offset of two glyphs
         ///
@@ -239,18 +400,50 @@ namespace cpp3ds
         float getUnderlineThickness(unsigned int characterSize) const;
 
         ////////////////////////////////////////////////////////////
-        /// \brief Retrieve the texture containing the loaded glyphs of a certain size
+        /// \brief Retrieve a texture containing the loaded glyphs of a certain size
+        ///
+        /// Glyphs of each size are spread over several textures
+        /// (pages) of fixed size, a new one being added when the
+        /// others are full. The page of a glyph is given by
+        /// Glyph::page.
         ///
         /// The contents of the returned texture changes as more glyphs
         /// are requested, thus it is not very relevant. It is mainly
         /// used internally by cpp3ds::Text.
         ///
         /// \param characterSize Reference character size
+        /// \param page          Index of the page, lower than getPageCount()
+        ///                      (page 0 always exists)
         ///
         /// \return Texture containing the glyphs of the requested size
         ///
+        /// \see getPageCount
+        ///
         ////////////////////////////////////////////////////////////
-        const Texture& getTexture(unsigned int characterSize) const;
+        const Texture& getTexture(unsigned int characterSize, unsigned int page = 0) const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the number of glyph pages of a certain size
+        ///
+        /// \param characterSize Reference character size
+        ///
+        /// \return Number of textures holding the glyphs of this size
+        ///
+        /// \see getTexture
+        ///
+        ////////////////////////////////////////////////////////////
+        unsigned int getPageCount(unsigned int characterSize) const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the amount of memory used by the glyph pages
+        ///
+        /// Grows as new glyphs and character sizes are loaded.
+        /// Pages shared with other fonts are counted by each of them.
+        ///
+        /// \return Size of the page textures, in bytes
+        ///
+        ////////////////////////////////////////////////////////////
+        std::size_t getMemoryUsage() const;
 
         ////////////////////////////////////////////////////////////
         /// \brief Overload of assignment operator
@@ -262,25 +455,57 @@ namespace cpp3ds
         ////////////////////////////////////////////////////////////
         Font& operator =(const Font& right);
 
+        ////////////////////////////////////////////////////////////
+        // Static member data
+        ////////////////////////////////////////////////////////////
+        static const unsigned int DistanceFieldSize;   ///< Character size at which distance field glyphs are rasterized
+        static const unsigned int DistanceFieldSpread; ///< Margin of the distance field around the outline, in texels
+
     private:
 
         ////////////////////////////////////////////////////////////
-        /// \brief Structure defining a row of glyphs
+        /// \brief Structure defining a segment of the skyline of a page
+        ///
+        /// The skyline is the bottom of the glyphs packed so far,
+        /// seen from the bottom of the texture.
         ///
         ////////////////////////////////////////////////////////////
-        struct Row
+        struct SkylineNode
         {
-            Row(unsigned int rowTop, unsigned int rowHeight) : width(0), top(rowTop), height(rowHeight) {}
+            SkylineNode(unsigned int nodeX, unsigned int nodeY, unsigned int nodeWidth) : x(nodeX), y(nodeY), width(nodeWidth) {}
 
-            unsigned int width;  ///< Current width of the row
-            unsigned int top;    ///< Y position of the row into the texture
-            unsigned int height; ///< Height of the row
+            unsigned int x;     ///< X position of the segment
+            unsigned int y;     ///< Y position of the free space below the segment
+            unsigned int width; ///< Width of the segment
         };
 
         ////////////////////////////////////////////////////////////
-        // Types
+        /// \brief Table mapping a glyph key (code point, bold flag and
+        ///        outline thickness) to its glyph
+        ///
+        /// Glyphs are stored in a deque, so that the references
+        /// returned by getGlyph stay valid, and found through an
+        /// open-addressing hash table. Regular glyphs of the first
+        /// 256 code points, which make most of Latin text, are
+        /// indexed directly.
+        ///
         ////////////////////////////////////////////////////////////
-        typedef std::map<Uint64, Glyph> GlyphTable; ///< Table mapping a codepoint to its glyph
+        class GlyphTable
+        {
+        public:
+
+            GlyphTable();
+
+            const Glyph* find(Uint64 key) const;
+
+            const Glyph& insert(Uint64 key, const Glyph& glyph);
+
+        private:
+
+            std::deque<Glyph>         m_glyphs;      ///< Glyphs, in insertion order
+            HashTable<Uint64, Uint32> m_indices;     ///< Index of the glyphs in m_glyphs, by key
+            Uint32                    m_latin1[256]; ///< Index + 1 of the regular glyphs of the first code points, 0 if not loaded
+        };
 
         ////////////////////////////////////////////////////////////
         /// \brief Structure defining a page of glyphs
@@ -288,14 +513,64 @@ namespace cpp3ds
         ////////////////////////////////////////////////////////////
         struct Page
         {
-            Page();
+            explicit Page(unsigned int size = 256);
+            explicit Page(const Image& image);
+
+            Texture                  texture; ///< Texture containing the pixels of the glyphs
+            std::vector<SkylineNode> skyline; ///< Free space left in the texture
+        };
 
-            GlyphTable       glyphs;  ///< Table mapping code points to their corresponding glyph
-            Texture          texture; ///< Texture containing the pixels of the glyphs
-            unsigned int     nextRow; ///< Y position of the next new row in the texture
-            std::vector<Row> rows;    ///< List containing the position of all the existing rows
+        ////////////////////////////////////////////////////////////
+        /// \brief Structure defining the glyphs of a character size
+        ///
+        /// Pages are stored in a deque, so that adding one doesn't
+        /// copy the textures of the others.
+        ///
+        ////////////////////////////////////////////////////////////
+        struct Atlas
+        {
+            Atlas() : baked(false), bakedKerning(false), lineSpacing(0), underlinePosition(0), underlineThickness(0) {}
+
+            GlyphTable               glyphs;             ///< Table mapping code points to their corresponding glyph
+            std::deque<Page>         pages;              ///< Textures containing the glyphs
+            bool                     baked;              ///< Do the metrics below come from a baked atlas?
+            bool                     bakedKerning;       ///< Does the kerning table hold every pair of baked glyphs?
+            float                    lineSpacing;        ///< Baked line spacing
+            float                    underlinePosition;  ///< Baked underline position
+            float                    underlineThickness; ///< Baked underline thickness
+            HashTable<Uint64, float> kerning;            ///< Kerning offsets baked or computed so far, by pair of code points
         };
 
+        ////////////////////////////////////////////////////////////
+        // Shared face and glyph preloading, defined in Font.cpp
+        ////////////////////////////////////////////////////////////
+        struct FaceData;
+        struct StagedGlyph;
+        class Preloader;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the glyphs of a character size
+        ///
+        /// Text asks for one size many times in a row, so the last
+        /// atlas is remembered to skip the search.
+        ///
+        /// \param characterSize Reference character size
+        ///
+        /// \return Glyphs of the character size, created if needed
+        ///
+        ////////////////////////////////////////////////////////////
+        Atlas& getAtlas(unsigned int characterSize) const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Find the glyphs of a character size, if any
+        ///
+        /// \param characterSize Reference character size
+        ///
+        /// \return Glyphs of the character size, or null if none were loaded
+        ///
+        ////////////////////////////////////////////////////////////
+        const Atlas* findAtlas(unsigned int characterSize) const;
+
         ////////////////////////////////////////////////////////////
         /// \brief Free all the internal resources
         ///
@@ -316,20 +591,135 @@ namespace cpp3ds
         Glyph loadGlyph(Uint32 codePoint, unsigned int characterSize, bool bold, float outlineThickness) const;
 
         ////////////////////////////////////////////////////////////
-        /// \brief Find a suitable rectangle within the texture for a glyph
+        /// \brief Place a rasterized glyph in the pages and upload it
+        ///
+        /// \param atlas Glyphs of the character size
+        /// \param glyph Glyph whose texture rectangle and page to set
+        /// \param alpha Alpha of the pixels, row by row
+        ///
+        ////////////////////////////////////////////////////////////
+        void writeGlyph(Atlas& atlas, Glyph& glyph, const std::vector<Uint8>& alpha) const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Rasterize a glyph with FreeType
+        ///
+        /// Only uses the font face, so it can be called from the
+        /// preloading thread.
+        ///
+        /// \param codePoint        Unicode code point of the character to load
+        /// \param characterSize    Reference character size
+        /// \param bold             Retrieve the bold version or the regular one?
+        /// \param outlineThickness Thickness of outline (when != 0 the glyph will not be filled)
+        /// \param glyph            Receives the metrics, the texture rectangle having only a size
+        /// \param alpha            Receives the alpha of the pixels, row by row
+        ///
+        /// \return True on success, false if any error happened
+        ///
+        ////////////////////////////////////////////////////////////
+        bool rasterizeGlyph(Uint32 codePoint, unsigned int characterSize, bool bold, float outlineThickness,
+                            Glyph& glyph, std::vector<Uint8>& alpha) const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Rasterize the distance field of a glyph
+        ///
+        /// The glyph is rasterized at a multiple of DistanceFieldSize,
+        /// then the distance of each texel to the outline is computed
+        /// and stored in the alpha, 128 being on the outline.
+        ///
+        /// \param codePoint Unicode code point of the character to load
+        /// \param bold      Retrieve the bold version or the regular one?
+        /// \param glyph     Receives the metrics, the texture rectangle having only a size
+        /// \param alpha     Receives the distances, row by row
+        ///
+        /// \return True on success, false if any error happened
+        ///
+        ////////////////////////////////////////////////////////////
+        bool rasterizeDistanceField(Uint32 codePoint, bool bold, Glyph& glyph, std::vector<Uint8>& alpha) const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Find a place in the pages for a rasterized glyph
+        ///
+        /// \param atlas Glyphs of the character size
+        /// \param glyph Glyph whose texture rectangle and page to set
+        ///
+        ////////////////////////////////////////////////////////////
+        void placeGlyph(Atlas& atlas, Glyph& glyph) const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief List the glyphs of a set of characters that are not
+        ///        loaded yet
+        ///
+        /// \param glyphs Receives the missing glyphs, not rasterized
+        ///
+        ////////////////////////////////////////////////////////////
+        void collectMissingGlyphs(const String& characters, unsigned int characterSize, bool bold, float outlineThickness,
+                                  std::vector<StagedGlyph>& glyphs) const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Add rasterized glyphs to the tables and pages
+        ///
+        /// Glyphs already loaded meanwhile are skipped. Each page
+        /// receiving new glyphs is updated once.
+        ///
+        /// \param glyphs Rasterized glyphs, their texture rectangle is updated
+        ///
+        /// \return Number of glyphs added
+        ///
+        ////////////////////////////////////////////////////////////
+        unsigned int publishGlyphs(std::vector<StagedGlyph>& glyphs) const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Find a suitable rectangle within the pages for a glyph
         ///
-        /// \param page   Page of glyphs to search in
+        /// A new page is added if the glyph doesn't fit in any
+        /// of the existing ones.
+        ///
+        /// \param atlas     Glyphs of the character size
+        /// \param width     Width of the rectangle
+        /// \param height    Height of the rectangle
+        /// \param pageIndex Receives the index of the page of the rectangle
+        ///
+        /// \return Found rectangle within the texture
+        ///
+        ////////////////////////////////////////////////////////////
+        IntRect findGlyphRect(Atlas& atlas, unsigned int width, unsigned int height, unsigned int& pageIndex) const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Pack a rectangle in a page with the skyline algorithm
+        ///
+        /// The rectangle is placed where its bottom is the highest,
+        /// which keeps the free space of the page in one piece.
+        ///
+        /// \param page   Page to pack the rectangle in
         /// \param width  Width of the rectangle
         /// \param height Height of the rectangle
+        /// \param rect   Receives the position of the rectangle
         ///
-        /// \return Found rectangle within the texture
+        /// \return True if the rectangle fits in the page
         ///
         ////////////////////////////////////////////////////////////
-        IntRect findGlyphRect(Page& page, unsigned int width, unsigned int height) const;
+        static bool insertRect(Page& page, unsigned int width, unsigned int height, IntRect& rect);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the index of the glyph of a character in the face
+        ///
+        /// Indices are cached, as FreeType looks them up in the
+        /// character map of the face each time.
+        ///
+        /// \param codePoint Unicode code point of the character
+        ///
+        /// \return Glyph index, 0 if the face has no glyph for it
+        ///
+        ////////////////////////////////////////////////////////////
+        unsigned int getCharIndex(Uint32 codePoint) const;
 
         ////////////////////////////////////////////////////////////
         /// \brief Make sure that the given size is the current one
         ///
+        /// Each character size gets its own FreeType size object,
+        /// created on first use: switching between sizes only
+        /// activates another object, without scaling the face again.
+        ///
         /// \param characterSize Reference character size
         ///
         /// \return True on success, false if any error happened
@@ -340,19 +730,20 @@ namespace cpp3ds
         ////////////////////////////////////////////////////////////
         // Types
         ////////////////////////////////////////////////////////////
-        typedef std::map<unsigned int, Page> PageTable; ///< Table mapping a character size to its page (texture)
+        typedef std::map<unsigned int, Atlas> AtlasTable; ///< Table mapping a character size to its glyphs
+        typedef HashTable<Uint32, void*> SizeTable;       ///< Table mapping a character size to its FreeType size object
+        typedef HashTable<Uint32, Uint32> CharIndexTable; ///< Table mapping a code point to its glyph index
 
         ////////////////////////////////////////////////////////////
         // Member data
         ////////////////////////////////////////////////////////////
-        void*                      m_library;     ///< Pointer to the internal library interface (it is typeless to avoid exposing implementation details)
-        void*                      m_face;        ///< Pointer to the internal font face (it is typeless to avoid exposing implementation details)
-        void*                      m_streamRec;   ///< Pointer to the stream rec instance (it is typeless to avoid exposing implementation details)
-        void*                      m_stroker;     ///< Pointer to the stroker (it is typeless to avoid exposing implementation details)
-        int*                       m_refCount;    ///< Reference counter used by implicit sharing
-        Info                       m_info;        ///< Information about the font
-        mutable PageTable          m_pages;       ///< Table containing the glyphs pages by character size
-        mutable std::vector<Uint8> m_pixelBuffer; ///< Pixel buffer holding a glyph's pixels before being written to the texture
+        mutable FaceData*          m_data;         ///< Font face and glyph pages, shared by the copies and the fonts loaded from the same source
+        Preloader*                 m_preloader;    ///< Worker thread rasterizing glyphs in advance
+        Info                       m_info;         ///< Information about the font
+        mutable AtlasTable         m_bakedAtlases; ///< Baked glyph pages by character size, owned by this font
+        mutable Atlas*             m_lastAtlas;    ///< Atlas returned by the last call to getAtlas
+        mutable unsigned int       m_lastSize;     ///< Character size of m_lastAtlas
+        mutable std::vector<Uint8> m_pixelBuffer;  ///< Pixel buffer holding a glyph's pixels before being written to the texture
     };
 
 } // namespace cpp3ds
@@ -424,6 +815,25 @@ namespace cpp3ds
 /// with this class. However, it may be useful to access the
 /// font metrics or rasterized glyphs for advanced usage.
 ///
+/// Rasterizing glyphs with FreeType is slow, which shows on
+/// the first frames that display new text. The glyphs known in
+/// advance can be baked at build time with the cpp3ds-fontbake
+/// tool (see bake_fonts() in cpp3ds.cmake) and loaded with
+/// loadFromBakedAtlas. Loading the font file first is only
+/// needed for glyphs that weren't baked:
+/// \code
+/// cpp3ds::Font font;
+/// font.loadFromFile("arial.ttf");
+/// font.loadFromBakedAtlas("arial.ttf.fnt");
+/// \endcode
+///
+/// Fonts are cheap to create from a source that is already
+/// loaded: all the fonts loaded from the same file or buffer
+/// share a single FreeType face and the same glyph pages, so
+/// widgets can each own their cpp3ds::Font without loading the
+/// file or rasterizing the glyphs again. The FreeType library
+/// itself is shared by all the fonts.
+///
 /// Note that if the font is a bitmap font, it is not scalable,
 /// thus not all requested sizes will be available to use. This
 /// needs to be taken into consideration when using cpp3ds::Text.
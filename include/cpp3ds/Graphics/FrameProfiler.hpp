@@ -0,0 +1,387 @@
+#ifndef CPP3DS_FRAMEPROFILER_HPP
+#define CPP3DS_FRAMEPROFILER_HPP
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cpp3ds/Config.hpp>
+#include <cpp3ds/Graphics/Drawable.hpp>
+#include <cpp3ds/Graphics/Font.hpp>
+#include <cpp3ds/Graphics/RectangleShape.hpp>
+#include <cpp3ds/Graphics/RenderTarget.hpp>
+#include <cpp3ds/Graphics/Text.hpp>
+#include <cpp3ds/Graphics/TextLayout.hpp>
+#include <cpp3ds/System/Clock.hpp>
+#include <cpp3ds/System/NonCopyable.hpp>
+#include <cpp3ds/Window/ContextSettings.hpp>
+#include <string>
+#include <vector>
+
+
+namespace cpp3ds
+{
+////////////////////////////////////////////////////////////
+/// \brief Timings of the phases of the game loop, and
+///        rendering counters, over the last frames
+///
+////////////////////////////////////////////////////////////
+class FrameProfiler : public Drawable, NonCopyable
+{
+public :
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Phases of a frame of cpp3ds::Game
+    ///
+    ////////////////////////////////////////////////////////////
+    enum Phase
+    {
+        Events,       ///< Polling and processing the events
+        Update,       ///< Game::update, and the console's update
+        RenderTop,    ///< Game::renderTopScreen, and the overlays drawn on it
+        RenderBottom, ///< Game::renderBottomScreen, and the overlays drawn on it
+        Flush,        ///< Submitting the pending draws and the GPU commands
+        Transfer,     ///< Copying the rendered screens to the framebuffers
+        VBlank,       ///< Swapping the buffers and waiting for the vertical blank
+
+        PhaseCount    ///< Keep last -- the total number of phases
+    };
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Counters of a frame, summed over both screens
+    ///
+    ////////////////////////////////////////////////////////////
+    enum Counter
+    {
+        DrawCalls,      ///< draw() calls made with vertex data
+        Batches,        ///< Draw commands submitted to the GPU
+        Vertices,       ///< Vertices submitted to the GPU
+        TextureBinds,   ///< Textures bound to the GPU
+        BlendChanges,   ///< Blend modes set on the GPU
+        ScissorChanges, ///< Scissor rects set on the GPU
+        TextureBytes,   ///< Bytes of pixels uploaded by textures
+
+        CounterCount    ///< Keep last -- the total number of counters
+    };
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Minimum, average and maximum of a value over the
+    ///        recorded frames
+    ///
+    ////////////////////////////////////////////////////////////
+    struct Summary
+    {
+        float min;     ///< Smallest value
+        float average; ///< Average value
+        float max;     ///< Largest value
+    };
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the profiler of the game loop
+    ///
+    /// \return The unique instance
+    ///
+    ////////////////////////////////////////////////////////////
+    static FrameProfiler& getInstance();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Enable or disable profiling
+    ///
+    /// Profiling is disabled by default, and the profiling
+    /// functions then return immediately. While it is enabled,
+    /// cpp3ds::Game resets the statistics of its windows at the
+    /// end of every frame.
+    ///
+    /// \param enabled True to enable profiling
+    ///
+    /// \see isEnabled
+    ///
+    ////////////////////////////////////////////////////////////
+    void setEnabled(bool enabled);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Tell whether profiling is enabled
+    ///
+    /// \return True if profiling is enabled
+    ///
+    /// \see setEnabled
+    ///
+    ////////////////////////////////////////////////////////////
+    bool isEnabled() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Set the number of frames recorded
+    ///
+    /// Summaries and saved files cover the last \a count
+    /// frames. Changing the count clears the recorded frames.
+    /// The default is 120 frames, two seconds at 60 fps.
+    ///
+    /// \param count Number of frames, at least 1
+    ///
+    /// \see getHistorySize
+    ///
+    ////////////////////////////////////////////////////////////
+    void setHistorySize(std::size_t count);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the number of frames recorded
+    ///
+    /// \return Maximum number of frames recorded
+    ///
+    /// \see setHistorySize, getFrameCount
+    ///
+    ////////////////////////////////////////////////////////////
+    std::size_t getHistorySize() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Show or hide the overlay
+    ///
+    /// The overlay lists the summary of each phase and counter
+    /// in the corner of a screen, over the game and the console.
+    /// It is hidden by default, and only updated while
+    /// profiling is enabled.
+    ///
+    /// \param visible True to show the overlay
+    /// \param screen  Screen to show the overlay on
+    ///
+    /// \see isOverlayVisible
+    ///
+    ////////////////////////////////////////////////////////////
+    void setOverlayVisible(bool visible, Screen screen = TopScreen);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Tell whether the overlay is shown
+    ///
+    /// \return True if the overlay is shown
+    ///
+    /// \see setOverlayVisible
+    ///
+    ////////////////////////////////////////////////////////////
+    bool isOverlayVisible() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the screen the overlay is shown on
+    ///
+    /// \return Screen of the overlay
+    ///
+    ////////////////////////////////////////////////////////////
+    Screen getOverlayScreen() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Start timing a frame
+    ///
+    ////////////////////////////////////////////////////////////
+    void beginFrame();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Start timing a phase of the current frame
+    ///
+    /// A phase can run several times in a frame, its times are
+    /// added up.
+    ///
+    /// \param phase Phase starting
+    ///
+    /// \see endPhase
+    ///
+    ////////////////////////////////////////////////////////////
+    void beginPhase(Phase phase);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Stop timing a phase of the current frame
+    ///
+    /// \param phase Phase ending, started by beginPhase
+    ///
+    /// \see beginPhase
+    ///
+    ////////////////////////////////////////////////////////////
+    void endPhase(Phase phase);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Add the statistics of a render target to the
+    ///        counters of the current frame
+    ///
+    /// \param statistics Statistics gathered during the frame
+    ///
+    ////////////////////////////////////////////////////////////
+    void addStatistics(const RenderTarget::Statistics& statistics);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Stop timing the current frame and record it
+    ///
+    ////////////////////////////////////////////////////////////
+    void endFrame();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the number of frames recorded so far
+    ///
+    /// \return Number of frames, up to the history size
+    ///
+    ////////////////////////////////////////////////////////////
+    std::size_t getFrameCount() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the summary of the durations of the frames
+    ///
+    /// \return Durations from the start of a frame to its end,
+    ///         in milliseconds
+    ///
+    ////////////////////////////////////////////////////////////
+    Summary getFrameSummary() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the summary of the durations of a phase
+    ///
+    /// \param phase Phase to summarize
+    ///
+    /// \return Durations of the phase, in milliseconds
+    ///
+    ////////////////////////////////////////////////////////////
+    Summary getPhaseSummary(Phase phase) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the summary of a counter
+    ///
+    /// \param counter Counter to summarize
+    ///
+    /// \return Values of the counter, per frame
+    ///
+    ////////////////////////////////////////////////////////////
+    Summary getCounterSummary(Counter counter) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Save the recorded frames to a CSV file
+    ///
+    /// The file has a header row, then one row per frame, oldest
+    /// first: the frame duration and the phase durations in
+    /// microseconds, followed by the counters.
+    ///
+    /// \param filename Path of the file to write
+    ///
+    /// \return True if the file was written
+    ///
+    ////////////////////////////////////////////////////////////
+    bool saveToFile(const std::string& filename) const;
+
+private :
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Default constructor
+    ///
+    ////////////////////////////////////////////////////////////
+    FrameProfiler();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Draw the overlay to a render target
+    ///
+    /// \param target Render target to draw to
+    /// \param states Current render states
+    ///
+    ////////////////////////////////////////////////////////////
+    virtual void draw(RenderTarget& target, RenderStates states) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Write the summaries into the overlay
+    ///
+    ////////////////////////////////////////////////////////////
+    void updateOverlay();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Measures of a frame
+    ///
+    ////////////////////////////////////////////////////////////
+    struct Frame
+    {
+        Int64  duration;               ///< Duration of the frame, in microseconds
+        Int64  phases[PhaseCount];     ///< Duration of each phase, in microseconds
+        Uint64 counters[CounterCount]; ///< Value of each counter
+    };
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get a measure of a frame
+    ///
+    /// \param frame  Frame to read
+    /// \param column 0 for the duration, then the phases, then the counters
+    ///
+    /// \return Value of the measure
+    ///
+    ////////////////////////////////////////////////////////////
+    static double getValue(const Frame& frame, int column);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Summarize a measure of the recorded frames
+    ///
+    /// \param column 0 for the duration, then the phases, then the counters
+    /// \param scale  Factor applied to the values
+    ///
+    /// \return Summary of the measure
+    ///
+    ////////////////////////////////////////////////////////////
+    Summary summarize(int column, double scale) const;
+
+    ////////////////////////////////////////////////////////////
+    // Member data
+    ////////////////////////////////////////////////////////////
+    bool               m_enabled;                 ///< Is profiling enabled?
+    std::vector<Frame> m_frames;                  ///< Ring buffer of the recorded frames
+    std::size_t        m_firstFrame;              ///< Index of the oldest frame in m_frames
+    std::size_t        m_frameCount;              ///< Number of frames recorded
+    Frame              m_current;                 ///< Measures of the current frame
+    Clock              m_clock;                   ///< Time since the start of the current frame
+    Int64              m_phaseStart[PhaseCount];  ///< Start of each phase, in microseconds into the frame
+    Uint64             m_uploadedBytes;           ///< Bytes uploaded by textures when the frame started
+    bool               m_overlayVisible;          ///< Is the overlay shown?
+    Screen             m_overlayScreen;           ///< Screen of the overlay
+    std::size_t        m_framesSinceOverlay;      ///< Frames since the overlay was last written
+    Font               m_font;                    ///< Font of the overlay
+    bool               m_fontLoaded;              ///< Was the font loaded?
+    RectangleShape     m_background;              ///< Dark box behind the overlay
+    Text               m_labels;                  ///< Names of the phases and counters
+    TextLayout         m_columnLayouts[3];        ///< Minimums, averages and maximums, right-aligned
+    Text               m_columns[3];              ///< Texts drawing the column layouts
+};
+
+} // namespace cpp3ds
+
+
+#endif // CPP3DS_FRAMEPROFILER_HPP
+
+
+////////////////////////////////////////////////////////////
+/// \class cpp3ds::FrameProfiler
+/// \ingroup graphics
+///
+/// cpp3ds::FrameProfiler tells where the time of a frame goes.
+/// When it is enabled, cpp3ds::Game times each phase of its
+/// loop: events, update, the rendering of each screen, the
+/// submission of the GPU commands, the copies to the
+/// framebuffers and the wait for the vertical blank. It also
+/// adds up the statistics of both windows (draw calls,
+/// vertices, texture binds, blend and scissor changes) and the
+/// bytes uploaded by textures.
+///
+/// The last frames are kept, 120 by default, and summarized by
+/// their minimum, average and maximum. The summaries can be
+/// read from code, shown in an overlay in the corner of a
+/// screen, or the frames saved to a CSV file for analysis on a
+/// computer.
+///
+/// Timings use the system tick on the 3DS, a phase that seems
+/// to take the whole frame is usually waiting for the GPU. The
+/// emulator's timings only give the proportions of the phases,
+/// its GPU and framebuffers have nothing in common with the
+/// console's.
+///
+/// Usage example:
+/// \code
+/// cpp3ds::FrameProfiler& profiler = cpp3ds::FrameProfiler::getInstance();
+/// profiler.setEnabled(true);
+/// profiler.setOverlayVisible(true, cpp3ds::BottomScreen);
+///
+/// // Later, after the slow scene
+/// cpp3ds::FrameProfiler::Summary update = profiler.getPhaseSummary(cpp3ds::FrameProfiler::Update);
+/// if (update.max > 8.f)
+///     profiler.saveToFile("sdmc:/profile.csv");
+/// \endcode
+///
+/// \see cpp3ds::Game, cpp3ds::RenderTarget::getStatistics
+///
+////////////////////////////////////////////////////////////
@@ -45,14 +45,15 @@ namespace cpp3ds
         /// \brief Default constructor
         ///
         ////////////////////////////////////////////////////////////
-        Glyph() : advance(0) {}
+        Glyph() : advance(0), page(0) {}
 
         ////////////////////////////////////////////////////////////
         // Member data
         ////////////////////////////////////////////////////////////
-        float     advance;     ///< Offset to move horizontally to the next character
-        FloatRect bounds;      ///< Bounding rectangle of the glyph, in coordinates relative to the baseline
-        IntRect   textureRect; ///< Texture coordinates of the glyph inside the font's texture
+        float        advance;     ///< Offset to move horizontally to the next character
+        FloatRect    bounds;      ///< Bounding rectangle of the glyph, in coordinates relative to the baseline
+        IntRect      textureRect; ///< Texture coordinates of the glyph inside the font's texture
+        unsigned int page;        ///< Index of the font's texture containing the glyph
     };
 
 } // namespace cpp3ds
@@ -0,0 +1,258 @@
+#ifndef CPP3DS_INDEXEDVERTEXARRAY_HPP
+#define CPP3DS_INDEXEDVERTEXARRAY_HPP
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cpp3ds/Config.hpp>
+#include <cpp3ds/Graphics/Vertex.hpp>
+#include <cpp3ds/Graphics/PrimitiveType.hpp>
+#include <cpp3ds/Graphics/Rect.hpp>
+#include <cpp3ds/Graphics/Drawable.hpp>
+#ifndef EMULATION
+#include <cpp3ds/System/LinearAllocator.hpp>
+#endif
+#include <vector>
+
+
+namespace cpp3ds
+{
+////////////////////////////////////////////////////////////
+/// \brief Define a set of one or more 2D primitives built
+///        from indexed vertices
+///
+////////////////////////////////////////////////////////////
+class IndexedVertexArray : public Drawable
+{
+public :
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Default constructor
+    ///
+    /// Creates an empty indexed vertex array.
+    ///
+    ////////////////////////////////////////////////////////////
+    IndexedVertexArray();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Construct the array with a type and an initial number of vertices and indices
+    ///
+    /// \param type        Type of primitives
+    /// \param vertexCount Initial number of vertices in the array
+    /// \param indexCount  Initial number of indices in the array
+    ///
+    ////////////////////////////////////////////////////////////
+    explicit IndexedVertexArray(PrimitiveType type, unsigned int vertexCount = 0, unsigned int indexCount = 0);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Return the vertex count
+    ///
+    /// \return Number of vertices in the array
+    ///
+    ////////////////////////////////////////////////////////////
+    unsigned int getVertexCount() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Return the index count
+    ///
+    /// \return Number of indices in the array
+    ///
+    ////////////////////////////////////////////////////////////
+    unsigned int getIndexCount() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get a read-write access to a vertex by its index
+    ///
+    /// This function doesn't check \a index, it must be in range
+    /// [0, getVertexCount() - 1]. The behaviour is undefined
+    /// otherwise.
+    ///
+    /// \param index Index of the vertex to get
+    ///
+    /// \return Reference to the index-th vertex
+    ///
+    /// \see getVertexCount
+    ///
+    ////////////////////////////////////////////////////////////
+    Vertex& operator [](unsigned int index);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get a read-only access to a vertex by its index
+    ///
+    /// This function doesn't check \a index, it must be in range
+    /// [0, getVertexCount() - 1]. The behaviour is undefined
+    /// otherwise.
+    ///
+    /// \param index Index of the vertex to get
+    ///
+    /// \return Const reference to the index-th vertex
+    ///
+    /// \see getVertexCount
+    ///
+    ////////////////////////////////////////////////////////////
+    const Vertex& operator [](unsigned int index) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Change an index of the array
+    ///
+    /// This function doesn't check \a position, it must be in range
+    /// [0, getIndexCount() - 1]. The behaviour is undefined
+    /// otherwise.
+    ///
+    /// \param position Position of the index to change
+    /// \param index    Index of the vertex to use
+    ///
+    /// \see getIndex
+    ///
+    ////////////////////////////////////////////////////////////
+    void setIndex(unsigned int position, Uint16 index);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get an index of the array
+    ///
+    /// This function doesn't check \a position, it must be in range
+    /// [0, getIndexCount() - 1]. The behaviour is undefined
+    /// otherwise.
+    ///
+    /// \param position Position of the index to get
+    ///
+    /// \return Index of the vertex used at \a position
+    ///
+    /// \see setIndex
+    ///
+    ////////////////////////////////////////////////////////////
+    Uint16 getIndex(unsigned int position) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Clear the array
+    ///
+    /// This function removes all the vertices and indices from
+    /// the array. It doesn't deallocate the corresponding memory,
+    /// so that adding new elements after clearing doesn't involve
+    /// reallocating all the memory.
+    ///
+    ////////////////////////////////////////////////////////////
+    void clear();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Resize the array
+    ///
+    /// Existing vertices and indices are kept, new ones are
+    /// default-constructed.
+    ///
+    /// \param vertexCount New number of vertices
+    /// \param indexCount  New number of indices
+    ///
+    ////////////////////////////////////////////////////////////
+    void resize(unsigned int vertexCount, unsigned int indexCount);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Add a vertex to the array
+    ///
+    /// \param vertex Vertex to add
+    ///
+    ////////////////////////////////////////////////////////////
+    void append(const Vertex& vertex);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Add an index to the array
+    ///
+    /// \param index Index of the vertex to use
+    ///
+    ////////////////////////////////////////////////////////////
+    void appendIndex(Uint16 index);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Set the type of primitives to draw
+    ///
+    /// This function defines how the indexed vertices must be
+    /// interpreted when it's time to draw them. The default
+    /// primitive type is cpp3ds::Triangles.
+    ///
+    /// \param type Type of primitive
+    ///
+    ////////////////////////////////////////////////////////////
+    void setPrimitiveType(PrimitiveType type);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the type of primitives drawn by the array
+    ///
+    /// \return Primitive type
+    ///
+    ////////////////////////////////////////////////////////////
+    PrimitiveType getPrimitiveType() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Compute the bounding rectangle of the array
+    ///
+    /// This function returns the axis-aligned rectangle that
+    /// contains all the vertices of the array, referenced or not.
+    ///
+    /// \return Bounding rectangle of the array
+    ///
+    ////////////////////////////////////////////////////////////
+    FloatRect getBounds() const;
+
+private :
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Draw the array to a render target
+    ///
+    /// \param target Render target to draw to
+    /// \param states Current render states
+    ///
+    ////////////////////////////////////////////////////////////
+    virtual void draw(RenderTarget& target, RenderStates states) const;
+
+private:
+
+    ////////////////////////////////////////////////////////////
+    // Member data
+    ////////////////////////////////////////////////////////////
+	#ifdef EMULATION
+    std::vector<Vertex> m_vertices;      ///< Vertices contained in the array
+    std::vector<Uint16> m_indices;       ///< Indices of the vertices forming the primitives
+    #else
+    std::vector<Vertex, LinearAllocator<Vertex>> m_vertices;
+    std::vector<Uint16, LinearAllocator<Uint16>> m_indices;
+    #endif
+    PrimitiveType       m_primitiveType; ///< Type of primitives to draw
+};
+
+} // namespace cpp3ds
+
+
+#endif // CPP3DS_INDEXEDVERTEXARRAY_HPP
+
+
+////////////////////////////////////////////////////////////
+/// \class cpp3ds::IndexedVertexArray
+/// \ingroup graphics
+///
+/// cpp3ds::IndexedVertexArray works like cpp3ds::VertexArray,
+/// except that primitives are built from a list of indices
+/// into the vertices. Vertices shared by several primitives
+/// are therefore stored only once, which saves memory and
+/// bandwidth: a quad only needs 4 vertices instead of 6.
+///
+/// It inherits cpp3ds::Drawable, but unlike other drawables it
+/// is not transformable.
+///
+/// Example:
+/// \code
+/// cpp3ds::IndexedVertexArray quad(cpp3ds::Triangles);
+/// quad.append(cpp3ds::Vertex(cpp3ds::Vector2f(0, 0)));
+/// quad.append(cpp3ds::Vertex(cpp3ds::Vector2f(10, 0)));
+/// quad.append(cpp3ds::Vertex(cpp3ds::Vector2f(10, 10)));
+/// quad.append(cpp3ds::Vertex(cpp3ds::Vector2f(0, 10)));
+///
+/// const cpp3ds::Uint16 indices[] = {0, 1, 2, 0, 2, 3};
+/// for (int i = 0; i < 6; ++i)
+///     quad.appendIndex(indices[i]);
+///
+/// window.draw(quad);
+/// \endcode
+///
+/// \see cpp3ds::VertexArray, cpp3ds::Vertex
+///
+////////////////////////////////////////////////////////////
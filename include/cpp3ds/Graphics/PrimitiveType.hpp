@@ -41,6 +41,7 @@ enum PrimitiveType
     Triangles,      ///< List of individual triangles
     TrianglesStrip, ///< List of connected triangles, a point uses the two previous points to form a triangle
     TrianglesFan,   ///< List of connected triangles, a point uses the common center and the previous point to form a triangle
+    Quads           ///< List of individual quads, each made of 4 consecutive points in clockwise or counter-clockwise order
 };
 
 }
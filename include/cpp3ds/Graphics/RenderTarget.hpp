@@ -33,6 +33,7 @@
 #include <cpp3ds/Graphics/RenderStates.hpp>
 #include <cpp3ds/Graphics/PrimitiveType.hpp>
 #include <cpp3ds/Graphics/Vertex.hpp>
+#include <cpp3ds/Graphics/CompactVertex.hpp>
 #include <cpp3ds/System/NonCopyable.hpp>
 #ifndef EMULATION
 #include <citro3d.h>
@@ -53,6 +54,23 @@ friend class Text;
 
 public :
 
+    ////////////////////////////////////////////////////////////
+    /// \brief Rendering statistics gathered by the render target
+    ///
+    ////////////////////////////////////////////////////////////
+    struct Statistics
+    {
+        Statistics();
+
+        Uint32 drawCalls;      ///< Number of draw() calls made with vertex data
+        Uint32 batches;        ///< Number of draw commands actually submitted to the GPU
+        Uint32 mergedDraws;    ///< Number of draw() calls appended to an already pending batch
+        Uint32 vertices;       ///< Number of vertices submitted to the GPU
+        Uint32 textureBinds;   ///< Number of times a texture was bound to the GPU
+        Uint32 blendChanges;   ///< Number of times the blend mode was set on the GPU
+        Uint32 scissorChanges; ///< Number of times the scissor rect was set on the GPU
+    };
+
     ////////////////////////////////////////////////////////////
     /// \brief Destructor
     ///
@@ -248,6 +266,117 @@ public :
     void draw(const Vertex* vertices, unsigned int vertexCount,
               PrimitiveType type, const RenderStates& states = RenderStates::Default);
 
+    ////////////////////////////////////////////////////////////
+    /// \brief Draw primitives defined by indexed vertices
+    ///
+    /// The primitives are built from the vertices referenced by
+    /// \a indices, which allows vertices shared by several
+    /// primitives to be stored only once.
+    ///
+    /// \param vertices    Pointer to the vertices
+    /// \param vertexCount Number of vertices in the array
+    /// \param indices     Pointer to the indices
+    /// \param indexCount  Number of indices in the array
+    /// \param type        Type of primitives to draw
+    /// \param states      Render states to use for drawing
+    ///
+    ////////////////////////////////////////////////////////////
+    void draw(const Vertex* vertices, unsigned int vertexCount,
+              const Uint16* indices, unsigned int indexCount,
+              PrimitiveType type, const RenderStates& states = RenderStates::Default);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Draw primitives defined by an array of compact vertices
+    ///
+    /// Compact vertices have 16-bit integer positions and
+    /// texture coordinates, which the GPU reads with a vertex
+    /// layout of its own. Both formats can be mixed freely.
+    ///
+    /// \param vertices    Pointer to the vertices
+    /// \param vertexCount Number of vertices in the array
+    /// \param type        Type of primitives to draw
+    /// \param states      Render states to use for drawing
+    ///
+    ////////////////////////////////////////////////////////////
+    void draw(const CompactVertex* vertices, unsigned int vertexCount,
+              PrimitiveType type, const RenderStates& states = RenderStates::Default);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Draw primitives defined by indexed compact vertices
+    ///
+    /// \param vertices    Pointer to the vertices
+    /// \param vertexCount Number of vertices in the array
+    /// \param indices     Pointer to the indices
+    /// \param indexCount  Number of indices in the array
+    /// \param type        Type of primitives to draw
+    /// \param states      Render states to use for drawing
+    ///
+    ////////////////////////////////////////////////////////////
+    void draw(const CompactVertex* vertices, unsigned int vertexCount,
+              const Uint16* indices, unsigned int indexCount,
+              PrimitiveType type, const RenderStates& states = RenderStates::Default);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Submit the pending batch of primitives, if any
+    ///
+    /// Consecutive draws sharing the same texture, blend mode,
+    /// scissor and shader are merged into a single batch which
+    /// is only submitted when one of these states changes, the
+    /// view changes, the batch buffer is full, or the target is
+    /// cleared or displayed. You only need to call this function
+    /// yourself when mixing cpp3ds drawing with direct GPU calls.
+    ///
+    /// Note that textures used by pending draws must stay alive
+    /// until the batch is submitted.
+    ///
+    /// \see setBatchingEnabled
+    ///
+    ////////////////////////////////////////////////////////////
+    void flush();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Enable or disable automatic batching of draw calls
+    ///
+    /// Batching is enabled by default. When disabled, every
+    /// call to draw() is submitted to the GPU immediately.
+    ///
+    /// \param enabled True to enable batching, false to disable it
+    ///
+    /// \see isBatchingEnabled, flush
+    ///
+    ////////////////////////////////////////////////////////////
+    void setBatchingEnabled(bool enabled);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Tell whether automatic batching of draw calls is enabled
+    ///
+    /// \return True if batching is enabled, false otherwise
+    ///
+    /// \see setBatchingEnabled
+    ///
+    ////////////////////////////////////////////////////////////
+    bool isBatchingEnabled() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the rendering statistics gathered since the last reset
+    ///
+    /// \return Statistics of the render target
+    ///
+    /// \see resetStatistics
+    ///
+    ////////////////////////////////////////////////////////////
+    const Statistics& getStatistics() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Reset all the rendering statistics to zero
+    ///
+    /// This is typically called once at the start of every frame.
+    ///
+    /// \see getStatistics
+    ///
+    ////////////////////////////////////////////////////////////
+    void resetStatistics();
+
     ////////////////////////////////////////////////////////////
     /// \brief Return the size of the rendering region of the target
     ///
@@ -285,6 +414,11 @@ public :
     /// saved and restored). Take a look at the ResetGLStates
     /// function if you do so.
     ///
+    /// On the 3DS, the saved states are the blending, scissor,
+    /// texture combiners, shader and matrices. Citro3D can't read
+    /// back the other states, so only the ones last set by cpp3ds
+    /// are restored for them. The bound texture isn't restored.
+    ///
     /// \see popGLStates
     ///
     ////////////////////////////////////////////////////////////
@@ -353,6 +487,15 @@ private:
     ////////////////////////////////////////////////////////////
     void applyCurrentView();
 
+    ////////////////////////////////////////////////////////////
+    /// \brief Apply a new transform
+    ///
+    /// \param transform Transform to apply
+    ///
+    ////////////////////////////////////////////////////////////
+    void applyTransform(const Transform& transform);
+
+#ifdef EMULATION
     ////////////////////////////////////////////////////////////
     /// \brief Apply a new blending mode
     ///
@@ -369,14 +512,6 @@ private:
     ////////////////////////////////////////////////////////////
     void applyScissor(const UintRect& rect);
 
-    ////////////////////////////////////////////////////////////
-    /// \brief Apply a new transform
-    ///
-    /// \param transform Transform to apply
-    ///
-    ////////////////////////////////////////////////////////////
-    void applyTransform(const Transform& transform);
-
     ////////////////////////////////////////////////////////////
     /// \brief Apply a new texture
     ///
@@ -392,6 +527,59 @@ private:
     ///
     ////////////////////////////////////////////////////////////
     void applyShader(const Shader* shader);
+#else
+    ////////////////////////////////////////////////////////////
+    /// \brief Apply the blending mode, scissor, texture and shader of a draw
+    ///
+    /// The states are gathered in a pipeline state, and only
+    /// the registers that differ from the ones the GPU already
+    /// uses are sent.
+    ///
+    /// \param blendMode Blending mode to apply
+    /// \param scissor   Scissor rect to use (Empty UintRect() to disable)
+    /// \param texture   Texture to apply, can be null
+    /// \param shader    Shader to apply, null for the default one
+    ///
+    ////////////////////////////////////////////////////////////
+    void applyStates(const BlendMode& blendMode, const UintRect& scissor, const Texture* texture, const Shader* shader);
+#endif
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Draw primitives, with or without indices
+    ///
+    /// \param vertices    Pointer to the vertices, either Vertex or CompactVertex
+    /// \param vertexCount Number of vertices in the array
+    /// \param indices     Pointer to the indices, or NULL to use the vertices in order
+    /// \param indexCount  Number of indices in the array
+    /// \param type        Type of primitives to draw
+    /// \param states      Render states to use for drawing
+    ///
+    ////////////////////////////////////////////////////////////
+    template <typename VertexType>
+    void drawPrimitives(const VertexType* vertices, unsigned int vertexCount,
+                        const Uint16* indices, unsigned int indexCount,
+                        PrimitiveType type, const RenderStates& states);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Append primitives to the pending batch
+    ///
+    /// The vertices are transformed on the CPU and the
+    /// primitives are converted to a list of indexed triangles.
+    /// Compact vertices are expanded to regular ones.
+    ///
+    /// \param vertices    Pointer to the vertices, either Vertex or CompactVertex
+    /// \param vertexCount Number of vertices in the array
+    /// \param indices     Pointer to the indices, or NULL to use the vertices in order
+    /// \param indexCount  Number of indices in the array
+    /// \param type        Type of primitives to draw
+    /// \param states      Render states to use for drawing
+    /// \param batchCount  Number of indices once converted to triangles
+    ///
+    ////////////////////////////////////////////////////////////
+    template <typename VertexType>
+    void addToBatch(const VertexType* vertices, unsigned int vertexCount,
+                    const Uint16* indices, unsigned int indexCount, PrimitiveType type,
+                    const RenderStates& states, unsigned int batchCount);
 
     ////////////////////////////////////////////////////////////
     /// \brief Activate the target for rendering
@@ -407,29 +595,116 @@ private:
     ////////////////////////////////////////////////////////////
     virtual bool activate(bool active) = 0;
 
+#ifdef EMULATION
+    ////////////////////////////////////////////////////////////
+    /// \brief Clear the target without OpenGL
+    ///
+    /// Targets rendered on the CPU override this function, the
+    /// default one leaves the clearing to OpenGL.
+    ///
+    /// \param color Fill color to use to clear the target
+    ///
+    /// \return True if the target was cleared, false to clear it with OpenGL
+    ///
+    ////////////////////////////////////////////////////////////
+    virtual bool clearPixels(const Color& color);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Draw primitives without OpenGL
+    ///
+    /// Targets rendered on the CPU override this function, the
+    /// default one leaves the drawing to OpenGL. The primitives
+    /// are not batched first.
+    ///
+    /// \param vertices    Pointer to the vertices
+    /// \param vertexCount Number of vertices in the array
+    /// \param indices     Pointer to the indices, NULL to use the vertices in order
+    /// \param indexCount  Number of indices in the array
+    /// \param type        Type of primitives to draw
+    /// \param states      Render states to use for drawing
+    ///
+    /// \return True if the primitives were drawn, false to draw them with OpenGL
+    ///
+    ////////////////////////////////////////////////////////////
+    virtual bool rasterize(const Vertex* vertices, unsigned int vertexCount,
+                           const Uint16* indices, unsigned int indexCount,
+                           PrimitiveType type, const RenderStates& states);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Draw compact primitives without OpenGL
+    ///
+    /// Same as the other overload, for compact vertices.
+    ///
+    /// \param vertices    Pointer to the vertices
+    /// \param vertexCount Number of vertices in the array
+    /// \param indices     Pointer to the indices, NULL to use the vertices in order
+    /// \param indexCount  Number of indices in the array
+    /// \param type        Type of primitives to draw
+    /// \param states      Render states to use for drawing
+    ///
+    /// \return True if the primitives were drawn, false to draw them with OpenGL
+    ///
+    ////////////////////////////////////////////////////////////
+    virtual bool rasterize(const CompactVertex* vertices, unsigned int vertexCount,
+                           const Uint16* indices, unsigned int indexCount,
+                           PrimitiveType type, const RenderStates& states);
+#endif
+
     ////////////////////////////////////////////////////////////
     /// \brief Render states cache
     ///
     ////////////////////////////////////////////////////////////
     struct StatesCache
     {
-        enum {VertexCacheSize = 4};
-
         bool      glStatesSet;    ///< Are our internal GL states set yet?
         bool      viewChanged;    ///< Has the current view changed since last draw?
+#ifdef EMULATION
         BlendMode lastBlendMode;  ///< Cached blending mode
         Uint64    lastTextureId;  ///< Cached texture
-        bool      useVertexCache; ///< Did we previously use the vertex cache?
-        Vertex*   vertexCache;    ///< Pre-transformed vertices cache
-        UintRect  lastScissor;
+        UintRect  lastScissor;    ///< Cached scissor rect
+#endif
+    };
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Pending batch of pre-transformed indexed triangles
+    ///
+    ////////////////////////////////////////////////////////////
+    struct Batch
+    {
+        enum
+        {
+            VertexCapacity = 4096,  ///< Number of vertices the batch buffer can hold
+            IndexCapacity  = 12288, ///< Number of indices the batch buffer can hold
+            MaxDrawSize    = 512    ///< Draws with more vertices bypass the batch and are submitted directly
+        };
+
+        Vertex*        vertices;    ///< Vertex buffer, reused once the GPU is done with it
+        Uint16*        indices;     ///< Index buffer, reused once the GPU is done with it
+        unsigned int   vertexStart; ///< Index of the first vertex of the pending batch
+        unsigned int   vertexCount; ///< Number of vertices in the pending batch
+        unsigned int   indexStart;  ///< Position of the first index of the pending batch
+        unsigned int   indexCount;  ///< Number of indices in the pending batch
+        const Texture* texture;     ///< Texture of the pending batch
+        Uint64         textureId;   ///< Cache identifier of the pending batch's texture
+        BlendMode      blendMode;   ///< Blending mode of the pending batch
+        UintRect       scissor;     ///< Scissor rect of the pending batch
+        const Shader*  shader;      ///< Shader of the pending batch
+        Uint32         flushId;     ///< GPU flush counter when the buffers were last written
     };
 
     ////////////////////////////////////////////////////////////
     // Member data
     ////////////////////////////////////////////////////////////
-    View        m_defaultView; ///< Default view
-    View        m_view;        ///< Current view
-    StatesCache m_cache;       ///< Render states cache
+    View        m_defaultView;     ///< Default view
+    View        m_view;            ///< Current view
+    StatesCache m_cache;           ///< Render states cache
+    Batch       m_batch;           ///< Pending batch of primitives
+    bool        m_batchingEnabled; ///< Are draw calls merged into batches?
+    Statistics  m_statistics;      ///< Rendering statistics
+
+#ifndef EMULATION
+    int         m_combiner;        ///< Texture combiner forced on the draws, or -1 to follow their texture
+#endif
 
 protected:
 #ifndef EMULATION
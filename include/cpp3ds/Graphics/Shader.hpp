@@ -65,6 +65,7 @@ public :
     {
         Vertex,   ///< Vertex shader
         Geometry, ///< Geometry shader
+        Fragment  ///< Fragment shader, emulator only (the GPU has fixed-function fragments)
     };
 
     ////////////////////////////////////////////////////////////
@@ -0,0 +1,205 @@
+#ifndef CPP3DS_SOFTWARERENDERTEXTURE_HPP
+#define CPP3DS_SOFTWARERENDERTEXTURE_HPP
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cpp3ds/Graphics/Image.hpp>
+#include <cpp3ds/Graphics/RenderTarget.hpp>
+#include <vector>
+
+
+namespace cpp3ds
+{
+class Texture;
+
+////////////////////////////////////////////////////////////
+/// \brief Render target rasterized on the CPU, into an image
+///
+////////////////////////////////////////////////////////////
+class SoftwareRenderTexture : public RenderTarget
+{
+public :
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Default constructor
+    ///
+    /// Constructs an empty, invalid target. You must
+    /// call create to have a valid target.
+    ///
+    /// \see create
+    ///
+    ////////////////////////////////////////////////////////////
+    SoftwareRenderTexture();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Create the target
+    ///
+    /// The pixels are initialized to transparent black.
+    ///
+    /// \param width  Width of the target
+    /// \param height Height of the target
+    ///
+    /// \return True if creation has been successful
+    ///
+    ////////////////////////////////////////////////////////////
+    bool create(unsigned int width, unsigned int height);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Return the size of the target
+    ///
+    /// \return Size in pixels
+    ///
+    ////////////////////////////////////////////////////////////
+    virtual Vector2u getSize() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the pixels drawn so far
+    ///
+    /// \return Image holding the pixels of the target, the first
+    ///         row being the top of the default view
+    ///
+    ////////////////////////////////////////////////////////////
+    const Image& getImage() const;
+
+private :
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Activate the target for OpenGL rendering
+    ///
+    /// \param active Ignored
+    ///
+    /// \return Always false, the target never uses OpenGL
+    ///
+    ////////////////////////////////////////////////////////////
+    virtual bool activate(bool active);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Fill all the pixels with a color
+    ///
+    /// \param color Fill color
+    ///
+    /// \return Always true
+    ///
+    ////////////////////////////////////////////////////////////
+    virtual bool clearPixels(const Color& color);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Rasterize primitives into the pixels
+    ///
+    /// \param vertices    Pointer to the vertices
+    /// \param vertexCount Number of vertices in the array
+    /// \param indices     Pointer to the indices, NULL to use the vertices in order
+    /// \param indexCount  Number of indices in the array
+    /// \param type        Type of primitives to draw
+    /// \param states      Render states to use for drawing
+    ///
+    /// \return Always true
+    ///
+    ////////////////////////////////////////////////////////////
+    virtual bool rasterize(const Vertex* vertices, unsigned int vertexCount,
+                           const Uint16* indices, unsigned int indexCount,
+                           PrimitiveType type, const RenderStates& states);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Rasterize compact primitives into the pixels
+    ///
+    /// The vertices are expanded to regular ones first.
+    ///
+    /// \param vertices    Pointer to the vertices
+    /// \param vertexCount Number of vertices in the array
+    /// \param indices     Pointer to the indices, NULL to use the vertices in order
+    /// \param indexCount  Number of indices in the array
+    /// \param type        Type of primitives to draw
+    /// \param states      Render states to use for drawing
+    ///
+    /// \return Always true
+    ///
+    ////////////////////////////////////////////////////////////
+    virtual bool rasterize(const CompactVertex* vertices, unsigned int vertexCount,
+                           const Uint16* indices, unsigned int indexCount,
+                           PrimitiveType type, const RenderStates& states);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Rasterize a triangle
+    ///
+    /// \param vertices Vertices of the draw call
+    /// \param a        Index of the first vertex of the triangle
+    /// \param b        Index of the second vertex of the triangle
+    /// \param c        Index of the third vertex of the triangle
+    /// \param states   Render states to use for drawing
+    /// \param clip     Pixels that can be written
+    ///
+    ////////////////////////////////////////////////////////////
+    void fillTriangle(const Vertex* vertices, unsigned int a, unsigned int b, unsigned int c,
+                      const RenderStates& states, const IntRect& clip);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Sample a texture like the GPU
+    ///
+    /// \param texture Texture to sample
+    /// \param u       Horizontal coordinate, in pixels
+    /// \param v       Vertical coordinate, in pixels
+    /// \param texel   Receives the RGBA components, from 0 to 1
+    ///
+    ////////////////////////////////////////////////////////////
+    static void sample(const Texture& texture, float u, float v, float* texel);
+
+    ////////////////////////////////////////////////////////////
+    // Member data
+    ////////////////////////////////////////////////////////////
+    Vector2u              m_size;            ///< Size of the target, in pixels
+    std::vector<Uint8>    m_pixels;          ///< RGBA pixels, top row first
+    std::vector<Vector2f> m_positions;       ///< Vertices of the current draw call, in pixels
+    std::vector<Vertex>   m_expanded;        ///< Compact vertices of the current draw call, expanded
+    mutable Image         m_image;           ///< Copy of the pixels returned by getImage
+    mutable bool          m_imageNeedUpdate; ///< Have the pixels changed since the copy?
+};
+
+} // namespace cpp3ds
+
+
+#endif // CPP3DS_SOFTWARERENDERTEXTURE_HPP
+
+
+////////////////////////////////////////////////////////////
+/// \class cpp3ds::SoftwareRenderTexture
+/// \ingroup graphics
+///
+/// cpp3ds::SoftwareRenderTexture is a render target that draws
+/// without OpenGL nor the GPU: triangles, strips, fans and
+/// quads are rasterized on the CPU into an image. It is only
+/// available in the emulator, and is meant for tests and
+/// benchmarks running on machines without a display: the
+/// output of drawables can be compared with reference images,
+/// and the CPU cost of drawing measured without the driver.
+///
+/// The rules are those of the OpenGL path: the same view and
+/// viewport mapping, pixels covered when their center is inside
+/// a triangle (with the top-left rule on edges, so that shared
+/// edges are drawn once), blend modes, scissor, and textures
+/// sampled nearest or linear, clamped or repeated, and
+/// modulated by the vertex colors. Texels are taken from a copy
+/// of the texture kept on the CPU, at the precision of the
+/// texture's format. The copy is read back from OpenGL when the
+/// texture is first sampled, and kept up to date by its updates
+/// from then on.
+///
+/// Shaders and mipmaps are ignored. Textures filled from a
+/// window or a cpp3ds::RenderTexture after they were first
+/// sampled keep showing their previous pixels.
+///
+/// Usage example:
+/// \code
+/// cpp3ds::SoftwareRenderTexture target;
+/// target.create(400, 240);
+///
+/// target.clear(cpp3ds::Color::Black);
+/// target.draw(sprite);
+///
+/// EXPECT_EQ(cpp3ds::Color::Red, target.getImage().getPixel(10, 10));
+/// \endcode
+///
+/// \see cpp3ds::RenderTarget, cpp3ds::RenderTexture
+///
+////////////////////////////////////////////////////////////
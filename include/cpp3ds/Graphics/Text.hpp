@@ -32,6 +32,7 @@
 #include <cpp3ds/Graphics/Transformable.hpp>
 #include <cpp3ds/Graphics/Font.hpp>
 #include <cpp3ds/Graphics/Rect.hpp>
+#include <cpp3ds/Graphics/TextLayout.hpp>
 #include <cpp3ds/Graphics/VertexArray.hpp>
 #include <cpp3ds/System/String.hpp>
 #include <string>
@@ -101,13 +102,32 @@ namespace cpp3ds
         /// \endcode
         /// A text's string is empty by default.
         ///
+        /// Only the characters following the part common to the
+        /// old and new strings are laid out again, so changing the
+        /// end of a long text is cheap.
+        ///
         /// \param string New string
         ///
-        /// \see getString
+        /// \see getString, append
         ///
         ////////////////////////////////////////////////////////////
         void setString(const String& string);
 
+        ////////////////////////////////////////////////////////////
+        /// \brief Append a string at the end of the text's string
+        ///
+        /// Unlike setString(getString() + string), the geometry of
+        /// the characters already in the text is always kept: only
+        /// the new characters are laid out. This is the function
+        /// to use for text that grows, like a log or an input field.
+        ///
+        /// \param string String to append
+        ///
+        /// \see setString
+        ///
+        ////////////////////////////////////////////////////////////
+        void append(const String& string);
+
         ////////////////////////////////////////////////////////////
         /// \brief Set the text's font
         ///
@@ -201,6 +221,51 @@ namespace cpp3ds
         ////////////////////////////////////////////////////////////
         void setOutlineThickness(float thickness);
 
+        ////////////////////////////////////////////////////////////
+        /// \brief Enable or disable distance field rendering
+        ///
+        /// When enabled, the glyphs are taken from the distance
+        /// field atlas of the font, rasterized once at
+        /// Font::DistanceFieldSize, and thresholded when drawn:
+        /// the text stays sharp at any character size or scale,
+        /// and changing the size rasterizes nothing and uses no
+        /// more memory. This is the mode to use for animated or
+        /// many-sized text.
+        ///
+        /// The outline is not drawn in this mode, and very small
+        /// sizes look slightly softer than with regular glyphs.
+        ///
+        /// Distance field rendering is disabled by default.
+        ///
+        /// \param enabled True to enable distance field rendering, false to disable it
+        ///
+        /// \see isDistanceFieldEnabled
+        ///
+        ////////////////////////////////////////////////////////////
+        void setDistanceFieldEnabled(bool enabled);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Draw a precomputed layout instead of the string
+        ///
+        /// While a layout is set, the text draws the string, font,
+        /// character size and style of the layout, at the positions
+        /// it computed, line breaks and alignment included. The
+        /// text keeps its own colors, outline and transform, and
+        /// its own string, font, size and style are left untouched
+        /// for when the layout is removed.
+        ///
+        /// The text follows the changes of the layout, which must
+        /// exist as long as the text uses it. Pass NULL to draw
+        /// the text's own string again. Layouts are ignored by the
+        /// system font.
+        ///
+        /// \param layout Layout to draw, or NULL
+        ///
+        /// \see getLayout
+        ///
+        ////////////////////////////////////////////////////////////
+        void setLayout(const TextLayout* layout);
+
         ////////////////////////////////////////////////////////////
         /// \brief Get the text's string
         ///
@@ -284,6 +349,26 @@ namespace cpp3ds
         ////////////////////////////////////////////////////////////
         float getOutlineThickness() const;
 
+        ////////////////////////////////////////////////////////////
+        /// \brief Tell whether distance field rendering is enabled
+        ///
+        /// \return True if distance field rendering is enabled, false otherwise
+        ///
+        /// \see setDistanceFieldEnabled
+        ///
+        ////////////////////////////////////////////////////////////
+        bool isDistanceFieldEnabled() const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the layout drawn by the text
+        ///
+        /// \return Pointer to the layout, NULL if the text draws its own string
+        ///
+        /// \see setLayout
+        ///
+        ////////////////////////////////////////////////////////////
+        const TextLayout* getLayout() const;
+
         ////////////////////////////////////////////////////////////
         /// \brief Return the position of the \a index-th character
         ///
@@ -294,6 +379,10 @@ namespace cpp3ds
         /// If \a index is out of range, the position of the end of
         /// the string is returned.
         ///
+        /// The string is walked from its beginning at each call,
+        /// unless the text draws a layout, which already knows
+        /// every position.
+        ///
         /// \param index Index of the character
         ///
         /// \return Position of the character
@@ -342,6 +431,69 @@ namespace cpp3ds
 
         void drawSystemFont(RenderTarget& target, RenderStates states) const;
 
+        ////////////////////////////////////////////////////////////
+        /// \brief Draw the text with the distance field glyphs
+        ///
+        /// \param target Render target to draw to
+        /// \param states Current render states, transform included
+        ///
+        ////////////////////////////////////////////////////////////
+        void drawDistanceField(RenderTarget& target, RenderStates states) const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get a glyph of the font, in the current mode
+        ///
+        /// \param codePoint        Unicode code point of the character
+        /// \param bold             Retrieve the bold version or the regular one?
+        /// \param outlineThickness Thickness of outline, ignored with distance fields
+        ///
+        /// \return The glyph, with metrics at getFontSize()
+        ///
+        ////////////////////////////////////////////////////////////
+        const Glyph& getGlyph(Uint32 codePoint, bool bold, float outlineThickness = 0) const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the bounds of a glyph, scaled to the character size
+        ///
+        /// \param glyph Glyph returned by getGlyph
+        ///
+        /// \return Bounds of the visible part of the glyph
+        ///
+        ////////////////////////////////////////////////////////////
+        FloatRect getGlyphBounds(const Glyph& glyph) const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the character size the font metrics are queried at
+        ///
+        /// \return Font::DistanceFieldSize with distance fields, the character size otherwise
+        ///
+        ////////////////////////////////////////////////////////////
+        unsigned int getFontSize() const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the factor from the font metrics to the character size
+        ///
+        /// \return Scale to apply to the metrics given at getFontSize()
+        ///
+        ////////////////////////////////////////////////////////////
+        float getFontScale() const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the font of the characters drawn
+        ///
+        /// \return Font of the layout if there is one, of the text otherwise
+        ///
+        ////////////////////////////////////////////////////////////
+        const Font* getDrawnFont() const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the size of the characters drawn
+        ///
+        /// \return Character size of the layout if there is one, of the text otherwise
+        ///
+        ////////////////////////////////////////////////////////////
+        unsigned int getDrawnCharacterSize() const;
+
         ////////////////////////////////////////////////////////////
         /// \brief Make sure the text's geometry is updated
         ///
@@ -354,6 +506,101 @@ namespace cpp3ds
         void ensureGeometryUpdateSystemFont() const;
         Vector2f findCharacterPosSystemFont(std::size_t index) const;
 
+        ////////////////////////////////////////////////////////////
+        /// \brief Range of vertices using the same font page
+        ///
+        ////////////////////////////////////////////////////////////
+        struct PageRange
+        {
+            unsigned int page;  ///< Index of the font texture
+            std::size_t  start; ///< Index of the first vertex
+            std::size_t  count; ///< Number of vertices
+        };
+
+        ////////////////////////////////////////////////////////////
+        /// \brief State of the layout before a character
+        ///
+        /// Kept for every character, so that the layout can resume
+        /// after the part of the string that didn't change.
+        ///
+        ////////////////////////////////////////////////////////////
+        struct Pen
+        {
+            float       x;                  ///< Horizontal position of the pen
+            float       y;                  ///< Position of the baseline
+            float       minX;               ///< Left of the bounds so far
+            float       minY;               ///< Top of the bounds so far
+            float       maxX;               ///< Right of the bounds so far
+            float       maxY;               ///< Bottom of the bounds so far
+            std::size_t vertexCount;        ///< Number of fill vertices so far
+            std::size_t outlineVertexCount; ///< Number of outline vertices so far
+        };
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Lay the text's own string out, from a character on
+        ///
+        /// \param start Index of the first character to lay out
+        /// \param pen   Receives the state of the layout at the end
+        ///
+        ////////////////////////////////////////////////////////////
+        void ensureGeometryUpdateString(std::size_t start, Pen& pen) const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Build the geometry of the layout's characters
+        ///
+        /// \param pen Receives the bounds of the geometry
+        ///
+        ////////////////////////////////////////////////////////////
+        void ensureGeometryUpdateLayout(Pen& pen) const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Add the quads of a glyph and its outline
+        ///
+        /// \param codePoint Unicode code point of the character
+        /// \param pen       Position of the glyph, its bounds are added to the pen's
+        /// \param bold      Draw the bold version or the regular one?
+        /// \param italic    Slant of the glyph
+        ///
+        /// \return Advance of the glyph
+        ///
+        ////////////////////////////////////////////////////////////
+        float addGlyph(Uint32 codePoint, Pen& pen, bool bold, float italic) const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Add the underline and strike through of a line
+        ///
+        /// \param left  Left of the line
+        /// \param right Right of the line
+        /// \param y     Baseline of the line
+        /// \param style Text style, nothing is added if it has neither decoration
+        ///
+        ////////////////////////////////////////////////////////////
+        void addDecorations(float left, float right, float y, Uint32 style) const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Group the quads of a vertex array by font page
+        ///
+        /// \param vertices  Quads in the order of the string
+        /// \param quadPages Font page of each quad
+        /// \param ranges    Receives the range of each page
+        /// \param sorted    Receives the quads grouped by page, left
+        ///                  empty when they all use the same page
+        ///
+        ////////////////////////////////////////////////////////////
+        static void sortByPage(const VertexArray& vertices, const std::vector<unsigned int>& quadPages, std::vector<PageRange>& ranges, VertexArray& sorted);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Draw quads with one draw call per font page
+        ///
+        /// \param target   Render target to draw to
+        /// \param states   Current render states
+        /// \param vertices Quads in the order of the string
+        /// \param sorted   Quads grouped by page, if they use several pages
+        /// \param ranges   Range of each page
+        ///
+        ////////////////////////////////////////////////////////////
+        void drawPages(RenderTarget& target, RenderStates states, const VertexArray& vertices, const VertexArray& sorted, const std::vector<PageRange>& ranges) const;
+
         ////////////////////////////////////////////////////////////
         // Member data
         ////////////////////////////////////////////////////////////
@@ -366,9 +613,20 @@ namespace cpp3ds
         float               m_outlineThickness;   ///< Thickness of the text's outline
         mutable VertexArray m_vertices;           ///< Vertex array containing the fill geometry
         mutable VertexArray m_outlineVertices;    ///< Vertex array containing the outline geometry
+        mutable VertexArray m_pageVertices;       ///< Fill geometry grouped by font page, when there are several
+        mutable VertexArray m_outlinePageVertices; ///< Outline geometry grouped by font page, when there are several
+        mutable std::vector<unsigned int> m_quadPages;        ///< Font page of each quad of m_vertices
+        mutable std::vector<unsigned int> m_outlineQuadPages; ///< Font page of each quad of m_outlineVertices
+        mutable std::vector<PageRange> m_pageRanges;        ///< Font page of each range of m_vertices
+        mutable std::vector<PageRange> m_outlinePageRanges; ///< Font page of each range of m_outlineVertices
+        mutable std::vector<Pen> m_pens;          ///< State of the layout before each character, and at the end
         mutable FloatRect   m_bounds;             ///< Bounding rectangle of the text (in local coordinates)
         mutable bool        m_geometryNeedUpdate; ///< Does the geometry need to be recomputed?
+        mutable std::size_t m_validLength;        ///< Number of leading characters whose geometry can be kept
         bool                m_useSystemFont;      ///< Flag to use 3DS system font
+        bool                m_distanceField;      ///< Are the glyphs taken from the distance field atlas?
+        const TextLayout*   m_layout;             ///< Layout drawn instead of the string, if any
+        mutable Uint32      m_layoutRevision;     ///< Revision of the layout the geometry was built from
 #ifndef EMULATION
         mutable std::vector<Uint16> m_systemGlyphTextures;
 #endif
@@ -412,6 +670,14 @@ namespace cpp3ds
 /// used by a cpp3ds::Text (i.e. never write a function that
 /// uses a local cpp3ds::Font instance for creating a text).
 ///
+/// Texts that change size or scale often, or are drawn at many
+/// sizes, can enable distance field rendering: all sizes are then
+/// drawn from a single set of glyphs (see setDistanceFieldEnabled).
+///
+/// Wrapped or aligned paragraphs, and text fields that place a
+/// caret, are best laid out by a cpp3ds::TextLayout, which the
+/// text can draw directly (see setLayout).
+///
 /// See also the note on coordinates and undistorted rendering in cpp3ds::Transformable.
 ///
 /// Usage example:
@@ -430,6 +696,6 @@ namespace cpp3ds
 /// window.draw(text);
 /// \endcode
 ///
-/// \see cpp3ds::Font, cpp3ds::Transformable
+/// \see cpp3ds::Font, cpp3ds::TextLayout, cpp3ds::Transformable
 ///
 ////////////////////////////////////////////////////////////
\ No newline at end of file
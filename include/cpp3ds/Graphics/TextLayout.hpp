@@ -0,0 +1,360 @@
+#ifndef CPP3DS_TEXTLAYOUT_HPP
+#define CPP3DS_TEXTLAYOUT_HPP
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cpp3ds/Config.hpp>
+#include <cpp3ds/Graphics/Font.hpp>
+#include <cpp3ds/Graphics/Rect.hpp>
+#include <cpp3ds/System/String.hpp>
+#include <cpp3ds/System/Vector2.hpp>
+#include <vector>
+
+
+namespace cpp3ds
+{
+////////////////////////////////////////////////////////////
+/// \brief Line breaks and positions of the characters of a
+///        string, computed once for many queries
+///
+////////////////////////////////////////////////////////////
+class TextLayout
+{
+public :
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Horizontal alignment of the lines
+    ///
+    ////////////////////////////////////////////////////////////
+    enum Alignment
+    {
+        Left,   ///< Lines start at the left edge
+        Center, ///< Lines are centered
+        Right   ///< Lines end at the right edge
+    };
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Line of the layout
+    ///
+    ////////////////////////////////////////////////////////////
+    struct Line
+    {
+        std::size_t start; ///< Index of the first character
+        std::size_t end;   ///< Index after the last character, line break included
+        float       left;  ///< Position of the left of the line, alignment applied
+        float       top;   ///< Position of the top of the line
+        float       width; ///< Width of the line, without its trailing spaces
+    };
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Default constructor
+    ///
+    /// Creates an empty layout, without font.
+    ///
+    ////////////////////////////////////////////////////////////
+    TextLayout();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Construct the layout of a string
+    ///
+    /// \param string        String to lay out
+    /// \param font          Font of the characters
+    /// \param characterSize Base size of characters, in pixels
+    ///
+    ////////////////////////////////////////////////////////////
+    TextLayout(const String& string, const Font& font, unsigned int characterSize = 30);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Set the string to lay out
+    ///
+    /// \param string New string
+    ///
+    /// \see getString
+    ///
+    ////////////////////////////////////////////////////////////
+    void setString(const String& string);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Set the font of the characters
+    ///
+    /// The font must exist as long as the layout uses it.
+    ///
+    /// \param font New font
+    ///
+    /// \see getFont
+    ///
+    ////////////////////////////////////////////////////////////
+    void setFont(const Font& font);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Set the character size
+    ///
+    /// The default size is 30.
+    ///
+    /// \param size New character size, in pixels
+    ///
+    /// \see getCharacterSize
+    ///
+    ////////////////////////////////////////////////////////////
+    void setCharacterSize(unsigned int size);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Set the style of the characters
+    ///
+    /// Takes the same flags as cpp3ds::Text::setStyle. Only the
+    /// bold flag changes the layout, the other ones are only
+    /// used by a cpp3ds::Text drawing the layout.
+    ///
+    /// \param style New style
+    ///
+    /// \see getStyle
+    ///
+    ////////////////////////////////////////////////////////////
+    void setStyle(Uint32 style);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Set the width at which lines are wrapped
+    ///
+    /// Lines longer than this width are broken after the last
+    /// space that fits, or inside the word if it doesn't fit
+    /// alone. Spaces at the end of a wrapped line hang past the
+    /// width. A width of 0, the default, disables wrapping:
+    /// lines only end at '\\n'.
+    ///
+    /// \param width Maximum width of the lines, in pixels
+    ///
+    /// \see getWrapWidth
+    ///
+    ////////////////////////////////////////////////////////////
+    void setWrapWidth(float width);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Set the horizontal alignment of the lines
+    ///
+    /// Lines are aligned within the wrap width, or within the
+    /// widest line when wrapping is disabled. The default
+    /// alignment is Left.
+    ///
+    /// \param alignment New alignment
+    ///
+    /// \see getAlignment
+    ///
+    ////////////////////////////////////////////////////////////
+    void setAlignment(Alignment alignment);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the string laid out
+    ///
+    /// \return String of the layout
+    ///
+    ////////////////////////////////////////////////////////////
+    const String& getString() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the font of the characters
+    ///
+    /// \return Pointer to the font, NULL if there is none
+    ///
+    ////////////////////////////////////////////////////////////
+    const Font* getFont() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the character size
+    ///
+    /// \return Size of the characters, in pixels
+    ///
+    ////////////////////////////////////////////////////////////
+    unsigned int getCharacterSize() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the style of the characters
+    ///
+    /// \return Style flags (see cpp3ds::Text::Style)
+    ///
+    ////////////////////////////////////////////////////////////
+    Uint32 getStyle() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the width at which lines are wrapped
+    ///
+    /// \return Wrap width, 0 if wrapping is disabled
+    ///
+    ////////////////////////////////////////////////////////////
+    float getWrapWidth() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the horizontal alignment of the lines
+    ///
+    /// \return Alignment of the lines
+    ///
+    ////////////////////////////////////////////////////////////
+    Alignment getAlignment() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the number of lines
+    ///
+    /// \return Number of lines, at least 1
+    ///
+    ////////////////////////////////////////////////////////////
+    std::size_t getLineCount() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get a line of the layout
+    ///
+    /// \param index Index of the line, must be below getLineCount()
+    ///
+    /// \return The line
+    ///
+    ////////////////////////////////////////////////////////////
+    const Line& getLine(std::size_t index) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Find the line containing a character
+    ///
+    /// The position at the end of the string belongs to the
+    /// last line. Takes O(log(lines)).
+    ///
+    /// \param index Index of the character
+    ///
+    /// \return Index of the line
+    ///
+    ////////////////////////////////////////////////////////////
+    std::size_t findLine(std::size_t index) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the position of the \a index-th character
+    ///
+    /// This is where a caret placed before the character is
+    /// drawn: the left of the character and the top of its
+    /// line. If \a index is out of range, the position of the
+    /// end of the string is returned. Takes O(1).
+    ///
+    /// \param index Index of the character
+    ///
+    /// \return Position of the character, in local coordinates
+    ///
+    ////////////////////////////////////////////////////////////
+    Vector2f findCharacterPos(std::size_t index) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Find the caret position nearest to a point
+    ///
+    /// Points above or below the text hit the first or last
+    /// line, points left or right of a line hit its start or
+    /// its end. Takes O(log(line length)).
+    ///
+    /// \param point Point to test, in local coordinates
+    ///
+    /// \return Index of the character before which the caret goes
+    ///
+    ////////////////////////////////////////////////////////////
+    std::size_t findCharacterAt(const Vector2f& point) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the box of a character
+    ///
+    /// The box spans the advance of the character and the
+    /// height of its line, which is what a selection highlight
+    /// covers. Takes O(log(lines)).
+    ///
+    /// \param index Index of the character, must be below the length of the string
+    ///
+    /// \return Box of the character, in local coordinates
+    ///
+    ////////////////////////////////////////////////////////////
+    FloatRect getCharacterBounds(std::size_t index) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the box of the whole layout
+    ///
+    /// The box spans the lines, from the leftmost start to the
+    /// rightmost end, and from the top of the first line to the
+    /// bottom of the last one. Takes O(1).
+    ///
+    /// \return Bounding rectangle of the layout, in local coordinates
+    ///
+    ////////////////////////////////////////////////////////////
+    FloatRect getBounds() const;
+
+private :
+
+    friend class Text;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Lay the string out again, if anything changed
+    ///
+    ////////////////////////////////////////////////////////////
+    void ensureUpdate() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the advance of a character
+    ///
+    /// \param character Code point of the character
+    ///
+    /// \return Horizontal advance, 0 for line breaks
+    ///
+    ////////////////////////////////////////////////////////////
+    float getAdvance(Uint32 character) const;
+
+    ////////////////////////////////////////////////////////////
+    // Member data
+    ////////////////////////////////////////////////////////////
+    String                        m_string;        ///< String to lay out
+    const Font*                   m_font;          ///< Font of the characters
+    unsigned int                  m_characterSize; ///< Base size of characters, in pixels
+    Uint32                        m_style;         ///< Text style (see Text::Style)
+    float                         m_wrapWidth;     ///< Maximum width of the lines, 0 to disable wrapping
+    Alignment                     m_alignment;     ///< Horizontal alignment of the lines
+    mutable std::vector<Vector2f> m_positions;     ///< Position of each character, and of the end
+    mutable std::vector<Line>     m_lines;         ///< Lines, in order
+    mutable FloatRect             m_bounds;        ///< Box of the lines
+    mutable float                 m_lineSpacing;   ///< Height of a line
+    mutable bool                  m_needUpdate;    ///< Does the layout need to be recomputed?
+    mutable Uint32                m_revision;      ///< Incremented each time the layout is recomputed
+};
+
+} // namespace cpp3ds
+
+
+#endif // CPP3DS_TEXTLAYOUT_HPP
+
+
+////////////////////////////////////////////////////////////
+/// \class cpp3ds::TextLayout
+/// \ingroup graphics
+///
+/// cpp3ds::TextLayout breaks a string into lines, greedily
+/// wrapping words at a width, aligns them, and stores the
+/// position of every character. The work is done in a single
+/// pass over the string, the first time the layout is queried
+/// after a change.
+///
+/// Queries are then cheap: the position of a character, for
+/// drawing a caret, takes O(1), and finding the character under
+/// a point, for a click in a text field, takes a binary search.
+/// cpp3ds::Text::findCharacterPos, in comparison, walks the
+/// string from its beginning at each call.
+///
+/// A cpp3ds::Text can draw a layout directly (see
+/// cpp3ds::Text::setLayout): the text takes the string, font,
+/// size, style and line breaks from the layout, and keeps its
+/// own colors, outline and transform.
+///
+/// Usage example:
+/// \code
+/// cpp3ds::TextLayout layout("Some long paragraph...", font, 16);
+/// layout.setWrapWidth(300);
+/// layout.setAlignment(cpp3ds::TextLayout::Center);
+///
+/// cpp3ds::Text text;
+/// text.setLayout(&layout);
+///
+/// // Place the caret where the user touched the text
+/// std::size_t caret = layout.findCharacterAt(text.getInverseTransform().transformPoint(touch));
+/// caretShape.setPosition(text.getTransform().transformPoint(layout.findCharacterPos(caret)));
+/// \endcode
+///
+/// \see cpp3ds::Text, cpp3ds::Font
+///
+////////////////////////////////////////////////////////////
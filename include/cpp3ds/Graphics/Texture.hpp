@@ -61,6 +61,25 @@ public :
         Pixels      ///< Texture coordinates in range [0 .. size]
     };
 
+    ////////////////////////////////////////////////////////////
+    /// \brief Pixel formats in which the texture can be stored
+    ///
+    /// Pixels are always given as 32-bits RGBA and converted
+    /// when uploaded. Smaller formats use less memory and
+    /// bandwidth, at the cost of precision.
+    ///
+    ////////////////////////////////////////////////////////////
+    enum Format
+    {
+        RGBA8,    ///< 8 bits per channel, 32 bits per pixel
+        RGB565,   ///< 5-6-5 bits color without alpha, 16 bits per pixel
+        RGBA5551, ///< 5 bits per color and 1 bit alpha, 16 bits per pixel
+        RGBA4,    ///< 4 bits per channel, 16 bits per pixel
+        LA8,      ///< 8 bits luminance and 8 bits alpha, 16 bits per pixel
+        L8,       ///< 8 bits luminance without alpha, 8 bits per pixel
+        A8        ///< 8 bits alpha, colored by the vertices, 8 bits per pixel
+    };
+
 public :
 
     ////////////////////////////////////////////////////////////
@@ -92,11 +111,12 @@ public :
     ///
     /// \param width  Width of the texture
     /// \param height Height of the texture
+    /// \param format Pixel format of the texture
     ///
     /// \return True if creation was successful
     ///
     ////////////////////////////////////////////////////////////
-    bool create(unsigned int width, unsigned int height);
+    bool create(unsigned int width, unsigned int height, Format format = RGBA8);
 
     ////////////////////////////////////////////////////////////
     /// \brief Load the texture from a file on disk
@@ -105,7 +125,7 @@ public :
     /// \code
     /// cpp3ds::Image image;
     /// image.loadFromFile(filename);
-    /// texture.loadFromImage(image, area);
+    /// texture.loadFromImage(image, area, format);
     /// \endcode
     ///
     /// The \a area argument can be used to load only a sub-rectangle
@@ -121,13 +141,14 @@ public :
     ///
     /// \param filename Path of the image file to load
     /// \param area     Area of the image to load
+    /// \param format   Pixel format of the texture
     ///
     /// \return True if loading was successful
     ///
     /// \see loadFromMemory, loadFromStream, loadFromImage
     ///
     ////////////////////////////////////////////////////////////
-    bool loadFromFile(const std::string& filename, const IntRect& area = IntRect());
+    bool loadFromFile(const std::string& filename, const IntRect& area = IntRect(), Format format = RGBA8);
 
     ////////////////////////////////////////////////////////////
     /// \brief Load the texture from a file in memory
@@ -136,7 +157,7 @@ public :
     /// \code
     /// cpp3ds::Image image;
     /// image.loadFromMemory(data, size);
-    /// texture.loadFromImage(image, area);
+    /// texture.loadFromImage(image, area, format);
     /// \endcode
     ///
     /// The \a area argument can be used to load only a sub-rectangle
@@ -150,16 +171,17 @@ public :
     ///
     /// If this function fails, the texture is left unchanged.
     ///
-    /// \param data Pointer to the file data in memory
-    /// \param size Size of the data to load, in bytes
-    /// \param area Area of the image to load
+    /// \param data   Pointer to the file data in memory
+    /// \param size   Size of the data to load, in bytes
+    /// \param area   Area of the image to load
+    /// \param format Pixel format of the texture
     ///
     /// \return True if loading was successful
     ///
     /// \see loadFromFile, loadFromStream, loadFromImage
     ///
     ////////////////////////////////////////////////////////////
-    bool loadFromMemory(const void* data, std::size_t size, const IntRect& area = IntRect());
+    bool loadFromMemory(const void* data, std::size_t size, const IntRect& area = IntRect(), Format format = RGBA8);
 
     ////////////////////////////////////////////////////////////
     /// \brief Load the texture from a custom stream
@@ -168,7 +190,7 @@ public :
     /// \code
     /// cpp3ds::Image image;
     /// image.loadFromStream(stream);
-    /// texture.loadFromImage(image, area);
+    /// texture.loadFromImage(image, area, format);
     /// \endcode
     ///
     /// The \a area argument can be used to load only a sub-rectangle
@@ -184,13 +206,14 @@ public :
     ///
     /// \param stream Source stream to read from
     /// \param area   Area of the image to load
+    /// \param format Pixel format of the texture
     ///
     /// \return True if loading was successful
     ///
     /// \see loadFromFile, loadFromMemory, loadFromImage
     ///
     ////////////////////////////////////////////////////////////
-    bool loadFromStream(cpp3ds::InputStream& stream, const IntRect& area = IntRect());
+    bool loadFromStream(cpp3ds::InputStream& stream, const IntRect& area = IntRect(), Format format = RGBA8);
 
     ////////////////////////////////////////////////////////////
     /// \brief Load the texture from an image
@@ -206,17 +229,33 @@ public :
     ///
     /// If this function fails, the texture is left unchanged.
     ///
-    /// \param image Image to load into the texture
-    /// \param area  Area of the image to load
+    /// \param image  Image to load into the texture
+    /// \param area   Area of the image to load
+    /// \param format Pixel format of the texture
     ///
     /// \return True if loading was successful
     ///
     /// \see loadFromFile, loadFromMemory
     ///
     ////////////////////////////////////////////////////////////
-    bool loadFromImage(const Image& image, const IntRect& area = IntRect());
+    bool loadFromImage(const Image& image, const IntRect& area = IntRect(), Format format = RGBA8);
 
 #ifndef EMULATION
+    ////////////////////////////////////////////////////////////
+    /// \brief Load the texture from already tiled data
+    ///
+    /// The file starts with a header giving the GPU format and
+    /// the sizes, followed by the tiled pixels, as produced by
+    /// the cpp3ds-texconv tool (see convert_textures in
+    /// cpp3ds.cmake). The data is read directly into the texture
+    /// without any decoding. If it holds a whole mipmap chain,
+    /// all the levels are loaded.
+    ///
+    /// \param filename Path of the preprocessed texture file
+    ///
+    /// \return True if loading was successful
+    ///
+    ////////////////////////////////////////////////////////////
     bool loadFromPreprocessedFile(const std::string& filename);
     bool loadFromPreprocessedFile(const std::string& filename, size_t width, size_t height, GPU_TEXCOLOR format);
     bool loadFromPreprocessedMemory(void *data, size_t size, size_t width, size_t height, GPU_TEXCOLOR format, bool copyData = true);
@@ -232,6 +271,29 @@ public :
     ////////////////////////////////////////////////////////////
     Vector2u getSize() const;
 
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the amount of memory allocated for the texture
+    ///
+    /// This is the size of the texture data including its
+    /// padding and its mipmap levels. Textures created on
+    /// external data with loadFromPreprocessedMemory don't own
+    /// their data and return 0.
+    ///
+    /// \return Size of the texture data, in bytes
+    ///
+    ////////////////////////////////////////////////////////////
+    std::size_t getMemoryUsage() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Return the pixel format of the texture
+    ///
+    /// \return Pixel format
+    ///
+    /// \see create
+    ///
+    ////////////////////////////////////////////////////////////
+    Format getFormat() const;
+
     ////////////////////////////////////////////////////////////
     /// \brief Copy the texture pixels to an image
     ///
@@ -324,6 +386,43 @@ public :
     ////////////////////////////////////////////////////////////
     void update(const Image& image, unsigned int x, unsigned int y);
 
+    ////////////////////////////////////////////////////////////
+    /// \brief Update several parts of the texture from an array of pixels
+    ///
+    /// The \a pixel array must have the size of the texture and
+    /// contain 32-bits RGBA pixels. Only the given \a regions of
+    /// it are copied to the texture, which is useful to mirror
+    /// changes made to a CPU-side copy of the texture.
+    ///
+    /// Regions are first accumulated in a map of the 8x8 blocks
+    /// they touch, so overlapping regions are copied only once,
+    /// and only the memory of the touched blocks is flushed to
+    /// the GPU. The cost is proportional to the changed area
+    /// rather than to the size of the texture.
+    ///
+    /// Regions are clipped to the texture bounds. This function
+    /// does nothing if \a pixels is null or if the texture was
+    /// not previously created.
+    ///
+    /// \param pixels  Array of pixels, with the size of the texture
+    /// \param regions Rectangles of the texture to update
+    ///
+    ////////////////////////////////////////////////////////////
+    void updateRegions(const Uint8* pixels, const std::vector<IntRect>& regions);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Update several parts of the texture from an image
+    ///
+    /// The image must have the size of the texture.
+    ///
+    /// \param image   Image to copy to the texture
+    /// \param regions Rectangles of the texture to update
+    ///
+    /// \see updateRegions(const Uint8*, const std::vector<IntRect>&)
+    ///
+    ////////////////////////////////////////////////////////////
+    void updateRegions(const Image& image, const std::vector<IntRect>& regions);
+
     ////////////////////////////////////////////////////////////
     /// \brief Update the texture from the contents of a window
     ///
@@ -421,6 +520,56 @@ public :
     ////////////////////////////////////////////////////////////
     bool isRepeated() const;
 
+    ////////////////////////////////////////////////////////////
+    /// \brief Generate a mipmap using the current texture data
+    ///
+    /// Mipmaps are pre-computed chains of optimized textures. Each
+    /// level of texture in a mipmap is generated by halving each
+    /// of the previous level's dimensions. This is done until the
+    /// final level is 8 pixels wide or high. When drawn scaled
+    /// down, the level closest to the drawn size is sampled, which
+    /// avoids aliasing and saves texture cache bandwidth.
+    ///
+    /// Levels are computed on the CPU with a box filter, directly
+    /// in the tiled layout of the GPU. Their memory is allocated
+    /// on the first call, textures that are never mipmapped only
+    /// hold their first level. The mipmap is invalidated
+    /// by any update of the texture, so it must be generated
+    /// again after the texture data changes.
+    ///
+    /// \return True if mipmap generation was successful, false if unsuccessful
+    ///
+    /// \see setMipmapFilter
+    ///
+    ////////////////////////////////////////////////////////////
+    bool generateMipmap();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Enable or disable filtering between mipmap levels
+    ///
+    /// When enabled, texels of the two nearest mipmap levels are
+    /// blended (trilinear filtering with setSmooth), which hides
+    /// the transitions between levels. When disabled, only the
+    /// nearest level is sampled.
+    /// Filtering between levels is enabled by default.
+    ///
+    /// \param smooth True to blend mipmap levels, false to use the nearest one
+    ///
+    /// \see generateMipmap, isMipmapFilterSmooth
+    ///
+    ////////////////////////////////////////////////////////////
+    void setMipmapFilter(bool smooth);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Tell whether mipmap levels are blended or not
+    ///
+    /// \return True if mipmap levels are blended
+    ///
+    /// \see setMipmapFilter
+    ///
+    ////////////////////////////////////////////////////////////
+    bool isMipmapFilterSmooth() const;
+
     ////////////////////////////////////////////////////////////
     /// \brief Overload of assignment operator
     ///
@@ -476,10 +625,25 @@ public :
     ////////////////////////////////////////////////////////////
     static unsigned int getMaximumSize();
 
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the number of bytes uploaded by all the textures
+    ///
+    /// Counts the pixel data sent to the GPU by the load and
+    /// update functions, in the texture's format, since the
+    /// start of the program. The difference between two frames
+    /// is what the frame uploaded (see cpp3ds::FrameProfiler).
+    ///
+    /// \return Number of bytes uploaded
+    ///
+    ////////////////////////////////////////////////////////////
+    static Uint64 getUploadedBytes();
+
 private :
 
     friend class RenderTexture;
     friend class RenderTarget;
+    friend class SoftwareRenderTexture;
+    friend class TextureLoader;
 
     ////////////////////////////////////////////////////////////
     /// \brief Get a valid image size according to hardware support
@@ -496,20 +660,116 @@ private :
     ////////////////////////////////////////////////////////////
     static unsigned int getValidSize(unsigned int size);
 
+    ////////////////////////////////////////////////////////////
+    /// \brief Invalidate the mipmap if one exists
+    ///
+    /// Only the first level is sampled until the mipmap is
+    /// generated again. Called whenever the texture data changes.
+    ///
+    ////////////////////////////////////////////////////////////
+    void invalidateMipmap();
+
+#ifdef EMULATION
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the OpenGL minifying function for the current
+    ///        smooth and mipmap settings
+    ///
+    ////////////////////////////////////////////////////////////
+    int getMinFilter() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Copy pixels to the copy kept on the CPU
+    ///
+    /// The pixels are stored as the GPU would sample them, at
+    /// the precision of the texture's format.
+    ///
+    /// \param pixels Array of RGBA pixels to copy
+    /// \param width  Width of the area to copy
+    /// \param height Height of the area to copy
+    /// \param pitch  Number of pixels from a row of \a pixels to the next
+    /// \param x      X offset in the texture where to copy the pixels
+    /// \param y      Y offset in the texture where to copy the pixels
+    ///
+    ////////////////////////////////////////////////////////////
+    void updateShadow(const Uint8* pixels, unsigned int width, unsigned int height, unsigned int pitch, unsigned int x, unsigned int y) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Make sure the copy of the pixels kept on the CPU exists
+    ///
+    /// Textures created without OpenGL only exist on the CPU.
+    /// The others get their copy from OpenGL the first time a
+    /// SoftwareRenderTexture samples them, so that the textures
+    /// that are never sampled don't pay for it.
+    ///
+    /// \return True if the copy exists, false if the texture is empty
+    ///
+    ////////////////////////////////////////////////////////////
+    bool loadShadow() const;
+#endif
+
+#ifndef EMULATION
+    ////////////////////////////////////////////////////////////
+    /// \brief Create the texture for already tiled data
+    ///
+    /// \param width  Width of the first level, power of two
+    /// \param height Height of the first level, power of two
+    /// \param format GPU pixel format of the data
+    /// \param levels Number of mipmap levels
+    ///
+    /// \return True if creation was successful
+    ///
+    ////////////////////////////////////////////////////////////
+    bool createPreprocessed(size_t width, size_t height, GPU_TEXCOLOR format, unsigned int levels);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Create the texture from pixels already converted
+    ///        by priv::tileImage
+    ///
+    /// \param width  Width of the texture
+    /// \param height Height of the texture
+    /// \param format Pixel format of the texture
+    /// \param tiled  First level of the texture, padded to its
+    ///               actual size
+    ///
+    /// \return True if creation was successful
+    ///
+    ////////////////////////////////////////////////////////////
+    bool loadFromTiled(unsigned int width, unsigned int height, Format format, const std::vector<Uint8>& tiled);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Bind a texture and its texture matrix, but not its combiner
+    ///
+    /// Nothing is sent to the GPU when it already uses the
+    /// same texture and matrix.
+    ///
+    /// \param texture        Pointer to the texture to bind, can be null to use no texture
+    /// \param coordinateType Type of texture coordinates to use
+    ///
+    /// \return True if the texture binding changed
+    ///
+    ////////////////////////////////////////////////////////////
+    static bool bindTexture(const Texture* texture, CoordinateType coordinateType);
+#endif
+
     ////////////////////////////////////////////////////////////
     // Member data
     ////////////////////////////////////////////////////////////
     Vector2u     m_size;          ///< Public texture size
     Vector2u     m_actualSize;    ///< Actual texture size (can be greater than public size because of padding)
+    Format       m_format;        ///< Pixel format of the texture
     bool         m_isSmooth;      ///< Status of the smooth filter
     bool         m_isRepeated;    ///< Is the texture in repeat mode?
+    bool         m_hasMipmap;     ///< Has the mipmap been generated?
+    bool         m_mipmapSmooth;  ///< Are mipmap levels blended?
     mutable bool m_pixelsFlipped; ///< To work around the inconsistency in Y orientation
     Uint64       m_cacheId;       ///< Unique number that identifies the texture to the render target's cache
 #ifdef EMULATION
     unsigned int m_texture;       ///< Internal texture identifier
+    mutable std::vector<Uint8> m_shadow; ///< Copy of the pixels at the actual size, sampled by SoftwareRenderTexture
 #else
     C3D_Tex*     m_texture;       ///< Internal texture identifier
     bool         m_ownsData;      ///< Check if this object owns the data and needs to free it
+    unsigned int m_levelCount;    ///< Number of mipmap levels allocated
 #endif
 };
 
@@ -0,0 +1,285 @@
+#ifndef CPP3DS_TEXTURELOADER_HPP
+#define CPP3DS_TEXTURELOADER_HPP
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cpp3ds/Config.hpp>
+#include <cpp3ds/Graphics/Image.hpp>
+#include <cpp3ds/Graphics/Texture.hpp>
+#include <cpp3ds/System/Mutex.hpp>
+#include <cpp3ds/System/NonCopyable.hpp>
+#include <cpp3ds/System/Thread.hpp>
+#ifdef EMULATION
+#include <pthread.h>
+#else
+#include <3ds.h>
+#endif
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+
+namespace cpp3ds
+{
+////////////////////////////////////////////////////////////
+/// \brief Load textures from files in a background thread
+///
+////////////////////////////////////////////////////////////
+class TextureLoader : NonCopyable
+{
+public :
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Identifier of a load request, 0 is never valid
+    ///
+    ////////////////////////////////////////////////////////////
+    typedef Uint32 Handle;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief State of a load request
+    ///
+    ////////////////////////////////////////////////////////////
+    enum Status
+    {
+        Queued,    ///< Waiting for the worker thread
+        Loading,   ///< Being decoded by the worker thread
+        Ready,     ///< Decoded, waiting to be published by update()
+        Loaded,    ///< Published to its texture
+        Failed,    ///< The file couldn't be loaded
+        Cancelled, ///< Cancelled before being published
+        Unknown    ///< Invalid handle, or finished long ago
+    };
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Function called by update() when a request finishes
+    ///
+    /// Receives the handle of the request and its final status
+    /// (Loaded or Failed).
+    ///
+    ////////////////////////////////////////////////////////////
+    typedef std::function<void(Handle, Status)> Callback;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Construct the loader and start its worker thread
+    ///
+    /// \param capacity Maximum number of unfinished requests
+    ///
+    ////////////////////////////////////////////////////////////
+    explicit TextureLoader(std::size_t capacity = 16);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Destructor
+    ///
+    /// Stops the worker thread once it is done with the current
+    /// file. Unfinished requests are dropped without calling
+    /// their callback.
+    ///
+    ////////////////////////////////////////////////////////////
+    ~TextureLoader();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Request a texture to be loaded from a file
+    ///
+    /// Reading and decoding the file, and converting the pixels
+    /// to the GPU layout, happen in the worker thread. The
+    /// texture itself is only modified by update(), so it can
+    /// keep being drawn meanwhile.
+    ///
+    /// The texture must stay alive until the request finishes
+    /// or is cancelled.
+    ///
+    /// \param texture  Texture to load the file into
+    /// \param filename Path of the image file to load
+    /// \param format   Pixel format of the texture
+    /// \param callback Function to call when the request finishes
+    ///
+    /// \return Handle of the request, 0 if the queue is full
+    ///
+    ////////////////////////////////////////////////////////////
+    Handle loadAsync(Texture& texture, const std::string& filename, Texture::Format format = Texture::RGBA8,
+                     Callback callback = Callback());
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Cancel a request
+    ///
+    /// If the worker thread is decoding the file, the result is
+    /// discarded when it finishes. The texture is left untouched
+    /// and the callback is not called.
+    ///
+    /// \param handle Handle of the request
+    ///
+    /// \return True if the request was cancelled, false if it
+    ///         already finished or the handle is invalid
+    ///
+    ////////////////////////////////////////////////////////////
+    bool cancel(Handle handle);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the state of a request
+    ///
+    /// The status of finished requests is remembered for a
+    /// while, after which Unknown is returned.
+    ///
+    /// \param handle Handle of the request
+    ///
+    /// \return Current status of the request
+    ///
+    ////////////////////////////////////////////////////////////
+    Status getStatus(Handle handle) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the number of unfinished requests
+    ///
+    /// \return Number of queued, loading and ready requests
+    ///
+    ////////////////////////////////////////////////////////////
+    std::size_t getPendingCount() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Publish the decoded textures and call the callbacks
+    ///
+    /// Must be called regularly from the thread that renders,
+    /// typically once per frame. Publishing only copies the
+    /// already converted pixels to the texture, but \a maxUploads
+    /// can spread the cost of many requests over several frames.
+    ///
+    /// \param maxUploads Maximum number of textures to publish,
+    ///                   0 for no limit
+    ///
+    /// \return Number of requests that finished
+    ///
+    ////////////////////////////////////////////////////////////
+    unsigned int update(unsigned int maxUploads = 0);
+
+private :
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Load request shared with the worker thread
+    ///
+    ////////////////////////////////////////////////////////////
+    struct Job
+    {
+        Handle              handle;   ///< Identifier of the request
+        Texture*            texture;  ///< Texture to load into
+        std::string         filename; ///< File to load
+        Texture::Format     format;   ///< Pixel format of the texture
+        Callback            callback; ///< Function to call when finished
+        Status              status;   ///< Current state of the request
+        Image               image;    ///< Decoded pixels
+        Vector2u            size;     ///< Size of the decoded image (3DS only)
+        std::vector<Uint8>  tiled;    ///< Pixels already in the GPU layout (3DS only)
+    };
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Entry point of the worker thread
+    ///
+    ////////////////////////////////////////////////////////////
+    void run();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Decode the file of a request
+    ///
+    /// \param job Request to process, owned by the worker thread
+    ///
+    /// \return True if the file was decoded
+    ///
+    ////////////////////////////////////////////////////////////
+    static bool decode(Job& job);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Copy the decoded pixels of a request to its texture
+    ///
+    /// \param job Request to publish
+    ///
+    /// \return True if the texture was loaded
+    ///
+    ////////////////////////////////////////////////////////////
+    static bool publish(Job& job);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Remember the final status of a request
+    ///
+    ////////////////////////////////////////////////////////////
+    void finish(Handle handle, Status status);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Wake up the worker thread
+    ///
+    /// The signal is kept until the worker thread waits, so it
+    /// isn't lost if the thread is still scanning the queue.
+    ///
+    ////////////////////////////////////////////////////////////
+    void signal();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Block the worker thread until signal is called
+    ///
+    ////////////////////////////////////////////////////////////
+    void waitForSignal();
+
+    ////////////////////////////////////////////////////////////
+    // Member data
+    ////////////////////////////////////////////////////////////
+    Thread                   m_thread;     ///< Worker thread
+    mutable Mutex            m_mutex;      ///< Protects everything below
+    std::deque<Job*>         m_jobs;       ///< Unfinished requests, oldest first
+    std::map<Handle, Status> m_finished;   ///< Status of the last finished requests
+    std::size_t              m_capacity;   ///< Maximum number of unfinished requests
+    Handle                   m_nextHandle; ///< Handle of the next request
+    bool                     m_running;    ///< Should the worker thread keep running?
+#ifdef EMULATION
+    pthread_mutex_t          m_signalMutex;     ///< Protects m_signaled
+    pthread_cond_t           m_signalCondition; ///< Wakes up the worker thread
+    bool                     m_signaled;        ///< Was signal called since the last wait?
+#else
+    LightEvent               m_signal;     ///< Wakes up the worker thread
+#endif
+};
+
+} // namespace cpp3ds
+
+
+#endif // CPP3DS_TEXTURELOADER_HPP
+
+
+////////////////////////////////////////////////////////////
+/// \class cpp3ds::TextureLoader
+/// \ingroup graphics
+///
+/// cpp3ds::TextureLoader moves the slow parts of loading a
+/// texture out of the game loop: file access, image decoding
+/// and, on the 3DS, conversion to the tiled GPU layout all run
+/// in a worker thread. Only the final copy to the texture is
+/// done by update(), on the rendering thread.
+///
+/// The queue is bounded, so that a burst of requests can't
+/// hold an unlimited amount of decoded images in memory:
+/// loadAsync() returns 0 when it is full.
+///
+/// loadAsync(), cancel() and update() must be called from the
+/// rendering thread.
+///
+/// Usage example:
+/// \code
+/// cpp3ds::TextureLoader loader;
+/// cpp3ds::Texture background;
+///
+/// cpp3ds::TextureLoader::Handle handle = loader.loadAsync(background, "background.png");
+///
+/// loader.update();
+/// while (loader.getPendingCount() > 0)
+/// {
+///     drawLoadingScreen();
+///     loader.update();
+/// }
+///
+/// if (loader.getStatus(handle) == cpp3ds::TextureLoader::Loaded)
+///     sprite.setTexture(background, true);
+/// \endcode
+///
+/// \see cpp3ds::Texture
+///
+////////////////////////////////////////////////////////////
@@ -48,6 +48,7 @@
     #define GLEXT_glFramebufferRenderbuffer        glFramebufferRenderbufferEXT
     #define GLEXT_glFramebufferTexture2D           glFramebufferTexture2DEXT
     #define GLEXT_glCheckFramebufferStatus         glCheckFramebufferStatusEXT
+    #define GLEXT_glGenerateMipmap                 glGenerateMipmapEXT
     #define GLEXT_GL_FRAMEBUFFER                   GL_FRAMEBUFFER_EXT
     #define GLEXT_GL_FRAMEBUFFER_BINDING           GL_FRAMEBUFFER_BINDING_EXT
     #define GLEXT_GL_RENDERBUFFER                  GL_RENDERBUFFER_EXT
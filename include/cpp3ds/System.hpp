@@ -6,16 +6,20 @@
 #include <cpp3ds/System/Clock.hpp>
 #include <cpp3ds/System/Err.hpp>
 #include <cpp3ds/System/FileSystem.hpp>
+#include <cpp3ds/System/FrameArena.hpp>
+#include <cpp3ds/System/HashTable.hpp>
 #include <cpp3ds/System/I18n.hpp>
 #include <cpp3ds/System/InputStream.hpp>
 #include <cpp3ds/System/Lock.hpp>
 #include <cpp3ds/System/Mutex.hpp>
+#include <cpp3ds/System/ResourceCache.hpp>
 #include <cpp3ds/System/Sleep.hpp>
 #include <cpp3ds/System/String.hpp>
 #include <cpp3ds/System/Service.hpp>
 #include <cpp3ds/System/Thread.hpp>
 #include <cpp3ds/System/ThreadLocal.hpp>
 #include <cpp3ds/System/ThreadLocalPtr.hpp>
+#include <cpp3ds/System/Trace.hpp>
 #include <cpp3ds/System/Utf.hpp>
 #include <cpp3ds/System/Vector2.hpp>
 #include <cpp3ds/System/Vector3.hpp>
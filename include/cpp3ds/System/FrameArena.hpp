@@ -0,0 +1,141 @@
+#ifndef CPP3DS_FRAMEARENA_HPP
+#define CPP3DS_FRAMEARENA_HPP
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cpp3ds/Config.hpp>
+#include <cstddef>
+#include <vector>
+
+namespace cpp3ds
+{
+////////////////////////////////////////////////////////////
+/// \brief Bump allocator for linear memory that lives for one frame
+///
+////////////////////////////////////////////////////////////
+class FrameArena
+{
+public :
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Allocate a block of transient linear memory
+    ///
+    /// The block stays valid until the next call to reset(),
+    /// which cpp3ds::Game does once the GPU is done with the
+    /// frame. When the arena is full, the block is allocated
+    /// separately and released on the next reset.
+    ///
+    /// \param size Number of bytes to allocate
+    ///
+    /// \return Pointer to the block, or NULL if out of memory
+    ///
+    ////////////////////////////////////////////////////////////
+    static void* allocate(std::size_t size);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Release all the blocks allocated since the last reset
+    ///
+    /// Must only be called when the GPU no longer reads from
+    /// any of them.
+    ///
+    ////////////////////////////////////////////////////////////
+    static void reset();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Change the capacity of the arena
+    ///
+    /// The new capacity takes effect on the next reset if the
+    /// arena is currently in use.
+    ///
+    /// \param capacity Size of the arena, in bytes
+    ///
+    ////////////////////////////////////////////////////////////
+    static void setCapacity(std::size_t capacity);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the capacity of the arena
+    ///
+    /// \return Size of the arena, in bytes
+    ///
+    ////////////////////////////////////////////////////////////
+    static std::size_t getCapacity();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the number of bytes allocated since the last reset
+    ///
+    /// This includes the blocks that didn't fit in the arena.
+    ///
+    /// \return Allocated size, in bytes
+    ///
+    ////////////////////////////////////////////////////////////
+    static std::size_t getSize();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the largest size reached during a single frame
+    ///
+    /// Useful to tune the capacity: a high-water mark above
+    /// the capacity means some blocks had to be allocated
+    /// separately.
+    ///
+    /// \return High-water mark, in bytes
+    ///
+    ////////////////////////////////////////////////////////////
+    static std::size_t getHighWaterMark();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Reset the high-water mark to the current size
+    ///
+    ////////////////////////////////////////////////////////////
+    static void resetHighWaterMark();
+
+private :
+
+    ////////////////////////////////////////////////////////////
+    // Member data
+    ////////////////////////////////////////////////////////////
+    static Uint8*             m_buffer;        ///< Arena memory
+    static std::size_t        m_bufferSize;    ///< Size of the arena memory currently allocated
+    static std::size_t        m_capacity;      ///< Requested size of the arena memory
+    static std::size_t        m_offset;        ///< Next free byte in the arena
+    static std::size_t        m_size;          ///< Bytes allocated since the last reset
+    static std::size_t        m_highWaterMark; ///< Largest size reached since the high-water mark was reset
+    static std::vector<void*> m_overflow;      ///< Blocks that didn't fit in the arena
+};
+
+} // namespace cpp3ds
+
+
+#endif // CPP3DS_FRAMEARENA_HPP
+
+
+////////////////////////////////////////////////////////////
+/// \class cpp3ds::FrameArena
+/// \ingroup system
+///
+/// The GPU can only read vertices that live in linear memory,
+/// but geometry is often built on the stack or in a regular
+/// std::vector. cpp3ds::FrameArena provides cheap linear memory
+/// for such data: allocations are a simple pointer bump and
+/// everything is released at once at the end of the frame,
+/// avoiding linearAlloc/linearFree for short-lived buffers.
+///
+/// cpp3ds::RenderTarget uses it automatically to copy vertices
+/// that are not in linear memory before drawing them.
+///
+/// In the emulator the arena is backed by regular memory.
+/// OpenGL reads vertices during the draw call there, so the
+/// renderer doesn't need the arena and only application code
+/// uses it.
+///
+/// Usage example:
+/// \code
+/// cpp3ds::FrameArena::setCapacity(512 * 1024);
+///
+/// // ... later, after a few frames
+/// std::cout << cpp3ds::FrameArena::getHighWaterMark() << " bytes used" << std::endl;
+/// \endcode
+///
+/// \see cpp3ds::LinearAllocator
+///
+////////////////////////////////////////////////////////////
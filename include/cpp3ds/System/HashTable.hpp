@@ -0,0 +1,172 @@
+#ifndef CPP3DS_HASHTABLE_HPP
+#define CPP3DS_HASHTABLE_HPP
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cpp3ds/Config.hpp>
+#include <cstddef>
+#include <vector>
+
+
+namespace cpp3ds
+{
+////////////////////////////////////////////////////////////
+/// \brief Hash table with integer keys, stored in a single
+///        array
+///
+////////////////////////////////////////////////////////////
+template <typename Key, typename Value>
+class HashTable
+{
+public :
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Default constructor
+    ///
+    /// Creates an empty table, which doesn't allocate anything
+    /// until the first insertion.
+    ///
+    ////////////////////////////////////////////////////////////
+    HashTable();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Find the value of a key
+    ///
+    /// \param key Key to look for
+    ///
+    /// \return Pointer to the value, null if the key is not in the table
+    ///
+    ////////////////////////////////////////////////////////////
+    Value* find(Key key);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Find the value of a key
+    ///
+    /// \param key Key to look for
+    ///
+    /// \return Pointer to the value, null if the key is not in the table
+    ///
+    ////////////////////////////////////////////////////////////
+    const Value* find(Key key) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Insert a key, or change its value
+    ///
+    /// Pointers to the values are invalidated when the table
+    /// grows, unlike references to the elements of a std::map.
+    ///
+    /// \param key   Key to insert
+    /// \param value Value of the key
+    ///
+    /// \return Reference to the value in the table
+    ///
+    ////////////////////////////////////////////////////////////
+    Value& insert(Key key, const Value& value);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Allocate room for a number of keys
+    ///
+    /// \param count Number of keys the table can hold without growing
+    ///
+    ////////////////////////////////////////////////////////////
+    void reserve(std::size_t count);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Remove all the keys and free the memory
+    ///
+    ////////////////////////////////////////////////////////////
+    void clear();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the number of keys in the table
+    ///
+    /// \return Number of keys
+    ///
+    ////////////////////////////////////////////////////////////
+    std::size_t getSize() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the number of slots allocated
+    ///
+    /// \return Number of slots, twice the number of keys the
+    ///         table can hold before growing
+    ///
+    ////////////////////////////////////////////////////////////
+    std::size_t getCapacity() const;
+
+private :
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Slot of the table
+    ///
+    ////////////////////////////////////////////////////////////
+    struct Slot
+    {
+        Key   key;   ///< Key stored in the slot
+        Value value; ///< Value of the key
+        bool  used;  ///< Is there a key in the slot?
+    };
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the index of the slot of a key
+    ///
+    /// \param key Key to look for
+    ///
+    /// \return Index of the slot holding the key, or of the free
+    ///         slot where it would be inserted
+    ///
+    ////////////////////////////////////////////////////////////
+    std::size_t probe(Key key) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Change the number of slots and reinsert the keys
+    ///
+    /// \param capacity New number of slots, power of two
+    ///
+    ////////////////////////////////////////////////////////////
+    void rehash(std::size_t capacity);
+
+    ////////////////////////////////////////////////////////////
+    // Member data
+    ////////////////////////////////////////////////////////////
+    std::vector<Slot> m_slots; ///< Slots, their number is a power of two
+    std::size_t       m_size;  ///< Number of keys
+};
+
+#include <cpp3ds/System/HashTable.inl>
+
+} // namespace cpp3ds
+
+
+#endif // CPP3DS_HASHTABLE_HPP
+
+
+////////////////////////////////////////////////////////////
+/// \class cpp3ds::HashTable
+/// \ingroup system
+///
+/// cpp3ds::HashTable maps integer keys (code points, sizes,
+/// packed pairs...) to values, for lookups done many times per
+/// frame. Unlike std::map, the keys and values are stored side
+/// by side in one array: a lookup is a hash and, most of the
+/// time, a single memory access, instead of a walk through
+/// nodes spread over the heap.
+///
+/// Collisions are resolved by linear probing, and the table
+/// doubles its size when it becomes half full. Keys can't be
+/// removed one by one, only all at once with clear().
+///
+/// Value must be default-constructible and copyable.
+///
+/// Usage example:
+/// \code
+/// cpp3ds::HashTable<cpp3ds::Uint32, float> widths;
+/// widths.insert('A', 12.f);
+///
+/// const float* width = widths.find('A');
+/// if (width)
+///     x += *width;
+/// \endcode
+///
+////////////////////////////////////////////////////////////
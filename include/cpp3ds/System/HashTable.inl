@@ -0,0 +1,132 @@
+////////////////////////////////////////////////////////////
+template <typename Key, typename Value>
+HashTable<Key, Value>::HashTable() :
+m_slots(),
+m_size (0)
+{
+}
+
+
+////////////////////////////////////////////////////////////
+template <typename Key, typename Value>
+Value* HashTable<Key, Value>::find(Key key)
+{
+    if (m_size == 0)
+        return NULL;
+
+    Slot& slot = m_slots[probe(key)];
+    return slot.used ? &slot.value : NULL;
+}
+
+
+////////////////////////////////////////////////////////////
+template <typename Key, typename Value>
+const Value* HashTable<Key, Value>::find(Key key) const
+{
+    if (m_size == 0)
+        return NULL;
+
+    const Slot& slot = m_slots[probe(key)];
+    return slot.used ? &slot.value : NULL;
+}
+
+
+////////////////////////////////////////////////////////////
+template <typename Key, typename Value>
+Value& HashTable<Key, Value>::insert(Key key, const Value& value)
+{
+    // Keep at least half of the slots free, so that probing stays short
+    if ((m_size + 1) * 2 > m_slots.size())
+        rehash(m_slots.empty() ? 16 : m_slots.size() * 2);
+
+    Slot& slot = m_slots[probe(key)];
+    if (!slot.used)
+    {
+        slot.key = key;
+        slot.used = true;
+        ++m_size;
+    }
+
+    slot.value = value;
+    return slot.value;
+}
+
+
+////////////////////////////////////////////////////////////
+template <typename Key, typename Value>
+void HashTable<Key, Value>::reserve(std::size_t count)
+{
+    std::size_t capacity = 16;
+    while (capacity < count * 2)
+        capacity *= 2;
+
+    if (capacity > m_slots.size())
+        rehash(capacity);
+}
+
+
+////////////////////////////////////////////////////////////
+template <typename Key, typename Value>
+void HashTable<Key, Value>::clear()
+{
+    std::vector<Slot>().swap(m_slots);
+    m_size = 0;
+}
+
+
+////////////////////////////////////////////////////////////
+template <typename Key, typename Value>
+std::size_t HashTable<Key, Value>::getSize() const
+{
+    return m_size;
+}
+
+
+////////////////////////////////////////////////////////////
+template <typename Key, typename Value>
+std::size_t HashTable<Key, Value>::getCapacity() const
+{
+    return m_slots.size();
+}
+
+
+////////////////////////////////////////////////////////////
+template <typename Key, typename Value>
+std::size_t HashTable<Key, Value>::probe(Key key) const
+{
+    // Mix the bits (finalizer of MurmurHash3), so that keys
+    // differing only in their high bits get different slots
+    Uint64 hash = static_cast<Uint64>(key);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+
+    std::size_t mask = m_slots.size() - 1;
+    std::size_t index = static_cast<std::size_t>(hash) & mask;
+    while (m_slots[index].used && (m_slots[index].key != key))
+        index = (index + 1) & mask;
+
+    return index;
+}
+
+
+////////////////////////////////////////////////////////////
+template <typename Key, typename Value>
+void HashTable<Key, Value>::rehash(std::size_t capacity)
+{
+    std::vector<Slot> slots(capacity);
+    for (std::size_t i = 0; i < capacity; ++i)
+        slots[i].used = false;
+    slots.swap(m_slots);
+
+    for (typename std::vector<Slot>::const_iterator it = slots.begin(); it != slots.end(); ++it)
+    {
+        if (it->used)
+        {
+            Slot& slot = m_slots[probe(it->key)];
+            slot.key = it->key;
+            slot.value = it->value;
+            slot.used = true;
+        }
+    }
+}
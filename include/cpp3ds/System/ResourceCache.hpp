@@ -0,0 +1,226 @@
+#ifndef CPP3DS_RESOURCECACHE_HPP
+#define CPP3DS_RESOURCECACHE_HPP
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cpp3ds/Config.hpp>
+#include <cpp3ds/System/NonCopyable.hpp>
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+
+
+namespace cpp3ds
+{
+////////////////////////////////////////////////////////////
+/// \brief Share resources loaded from files and keep their
+///        memory within a budget
+///
+////////////////////////////////////////////////////////////
+template <typename T>
+class ResourceCache : NonCopyable
+{
+public :
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Shared handle to a cached resource
+    ///
+    ////////////////////////////////////////////////////////////
+    typedef std::shared_ptr<T> Handle;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Construct an empty cache
+    ///
+    /// \param budget Maximum memory used by the resources, in
+    ///               bytes, 0 for no limit
+    ///
+    ////////////////////////////////////////////////////////////
+    explicit ResourceCache(std::size_t budget = 0);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get a resource, loading it if it's not cached
+    ///
+    /// The resource becomes the most recently used one. When it
+    /// is loaded, the least recently used resources are then
+    /// evicted until the cache fits in its budget again.
+    ///
+    /// \param filename Path of the resource file
+    ///
+    /// \return Handle to the resource, null if it couldn't be loaded
+    ///
+    ////////////////////////////////////////////////////////////
+    Handle get(const std::string& filename);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Check if a resource is cached
+    ///
+    /// \param filename Path of the resource file
+    ///
+    /// \return True if the resource is in the cache
+    ///
+    ////////////////////////////////////////////////////////////
+    bool contains(const std::string& filename) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Prevent a resource from being evicted
+    ///
+    /// Pinned resources stay in the cache even when no handle
+    /// refers to them, typically for assets used by every scene.
+    ///
+    /// \param filename Path of the resource file
+    ///
+    /// \return True if the resource is cached, false otherwise
+    ///
+    /// \see unpin
+    ///
+    ////////////////////////////////////////////////////////////
+    bool pin(const std::string& filename);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Allow a pinned resource to be evicted again
+    ///
+    /// \param filename Path of the resource file
+    ///
+    /// \see pin
+    ///
+    ////////////////////////////////////////////////////////////
+    void unpin(const std::string& filename);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Remove a resource from the cache
+    ///
+    /// Existing handles stay valid, the resource is destroyed
+    /// with the last one.
+    ///
+    /// \param filename Path of the resource file
+    ///
+    ////////////////////////////////////////////////////////////
+    void remove(const std::string& filename);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Remove all the resources from the cache
+    ///
+    /// Pinned resources are removed too.
+    ///
+    ////////////////////////////////////////////////////////////
+    void clear();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Evict resources until the cache fits in its budget
+    ///
+    /// Resources are evicted from the least recently used one.
+    /// Pinned resources, and resources still referred to by a
+    /// handle, are skipped: evicting them wouldn't free their
+    /// memory. The budget can therefore be exceeded when all
+    /// resources are in use.
+    ///
+    /// \return Number of bytes freed
+    ///
+    ////////////////////////////////////////////////////////////
+    std::size_t trim();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Change the memory budget of the cache
+    ///
+    /// Resources are evicted if the cache no longer fits.
+    ///
+    /// \param budget Maximum memory used by the resources, in
+    ///               bytes, 0 for no limit
+    ///
+    ////////////////////////////////////////////////////////////
+    void setBudget(std::size_t budget);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the memory budget of the cache
+    ///
+    /// \return Maximum memory used by the resources, in bytes
+    ///
+    ////////////////////////////////////////////////////////////
+    std::size_t getBudget() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the memory used by the cached resources
+    ///
+    /// Computed from the resources on each call, since some of
+    /// them grow after being loaded (like font glyph pages).
+    ///
+    /// \return Memory used by the resources, in bytes
+    ///
+    ////////////////////////////////////////////////////////////
+    std::size_t getMemoryUsage() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the number of cached resources
+    ///
+    /// \return Number of resources in the cache
+    ///
+    ////////////////////////////////////////////////////////////
+    std::size_t getResourceCount() const;
+
+private :
+
+    ////////////////////////////////////////////////////////////
+    // Types
+    ////////////////////////////////////////////////////////////
+    struct Entry
+    {
+        std::string filename; ///< Path of the resource file
+        Handle      resource; ///< Cached resource
+        bool        pinned;   ///< Is the resource protected from eviction?
+    };
+
+    typedef std::list<Entry> EntryList;                                     ///< Entries, most recently used first
+    typedef std::map<std::string, typename EntryList::iterator> EntryTable; ///< Entries by filename
+
+    ////////////////////////////////////////////////////////////
+    // Member data
+    ////////////////////////////////////////////////////////////
+    EntryList   m_entries; ///< Cached resources, most recently used first
+    EntryTable  m_table;   ///< Lookup table of the entries
+    std::size_t m_budget;  ///< Maximum memory used by the resources
+};
+
+#include <cpp3ds/System/ResourceCache.inl>
+
+} // namespace cpp3ds
+
+
+#endif // CPP3DS_RESOURCECACHE_HPP
+
+
+////////////////////////////////////////////////////////////
+/// \class cpp3ds::ResourceCache
+/// \ingroup system
+///
+/// cpp3ds::ResourceCache loads each resource file once and
+/// hands out shared handles to it, so that every part of a
+/// game asking for the same texture gets the same one.
+///
+/// The cache keeps resources alive after their last handle is
+/// released, so that going back to a scene doesn't reload its
+/// assets. To stay within the linear heap, it evicts the least
+/// recently used of these unreferenced resources when their
+/// total size exceeds the budget. Resources that must never be
+/// reloaded can be pinned.
+///
+/// T must be default-constructible and provide
+/// \c loadFromFile(const std::string&) and \c getMemoryUsage(),
+/// like cpp3ds::Texture, cpp3ds::Font and cpp3ds::SoundBuffer.
+///
+/// The cache is not thread-safe.
+///
+/// Usage example:
+/// \code
+/// cpp3ds::ResourceCache<cpp3ds::Texture> textures(8 * 1024 * 1024);
+///
+/// cpp3ds::ResourceCache<cpp3ds::Texture>::Handle texture = textures.get("images/player.png");
+/// if (!texture)
+///     return -1;
+///
+/// cpp3ds::Sprite sprite(*texture);
+/// \endcode
+///
+////////////////////////////////////////////////////////////
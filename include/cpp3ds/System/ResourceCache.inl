@@ -0,0 +1,156 @@
+////////////////////////////////////////////////////////////
+template <typename T>
+ResourceCache<T>::ResourceCache(std::size_t budget) :
+m_entries(),
+m_table  (),
+m_budget (budget)
+{
+}
+
+
+////////////////////////////////////////////////////////////
+template <typename T>
+typename ResourceCache<T>::Handle ResourceCache<T>::get(const std::string& filename)
+{
+    typename EntryTable::iterator it = m_table.find(filename);
+    if (it != m_table.end())
+    {
+        // Move the entry to the front, keeping iterators valid
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return it->second->resource;
+    }
+
+    Handle resource = std::make_shared<T>();
+    if (!resource->loadFromFile(filename))
+        return Handle();
+
+    Entry entry;
+    entry.filename = filename;
+    entry.resource = resource;
+    entry.pinned   = false;
+    m_entries.push_front(entry);
+    m_table[filename] = m_entries.begin();
+
+    trim();
+
+    return resource;
+}
+
+
+////////////////////////////////////////////////////////////
+template <typename T>
+bool ResourceCache<T>::contains(const std::string& filename) const
+{
+    return m_table.find(filename) != m_table.end();
+}
+
+
+////////////////////////////////////////////////////////////
+template <typename T>
+bool ResourceCache<T>::pin(const std::string& filename)
+{
+    typename EntryTable::iterator it = m_table.find(filename);
+    if (it == m_table.end())
+        return false;
+
+    it->second->pinned = true;
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////
+template <typename T>
+void ResourceCache<T>::unpin(const std::string& filename)
+{
+    typename EntryTable::iterator it = m_table.find(filename);
+    if (it != m_table.end())
+        it->second->pinned = false;
+}
+
+
+////////////////////////////////////////////////////////////
+template <typename T>
+void ResourceCache<T>::remove(const std::string& filename)
+{
+    typename EntryTable::iterator it = m_table.find(filename);
+    if (it != m_table.end())
+    {
+        m_entries.erase(it->second);
+        m_table.erase(it);
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+template <typename T>
+void ResourceCache<T>::clear()
+{
+    m_entries.clear();
+    m_table.clear();
+}
+
+
+////////////////////////////////////////////////////////////
+template <typename T>
+std::size_t ResourceCache<T>::trim()
+{
+    if (m_budget == 0)
+        return 0;
+
+    std::size_t usage = getMemoryUsage();
+    std::size_t freed = 0;
+
+    // Walk from the least recently used entry
+    typename EntryList::iterator it = m_entries.end();
+    while ((usage > m_budget) && (it != m_entries.begin()))
+    {
+        --it;
+        if (it->pinned || (it->resource.use_count() > 1))
+            continue;
+
+        std::size_t size = it->resource->getMemoryUsage();
+        usage -= size;
+        freed += size;
+
+        m_table.erase(it->filename);
+        it = m_entries.erase(it);
+    }
+
+    return freed;
+}
+
+
+////////////////////////////////////////////////////////////
+template <typename T>
+void ResourceCache<T>::setBudget(std::size_t budget)
+{
+    m_budget = budget;
+    trim();
+}
+
+
+////////////////////////////////////////////////////////////
+template <typename T>
+std::size_t ResourceCache<T>::getBudget() const
+{
+    return m_budget;
+}
+
+
+////////////////////////////////////////////////////////////
+template <typename T>
+std::size_t ResourceCache<T>::getMemoryUsage() const
+{
+    std::size_t usage = 0;
+    for (typename EntryList::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+        usage += it->resource->getMemoryUsage();
+    return usage;
+}
+
+
+////////////////////////////////////////////////////////////
+template <typename T>
+std::size_t ResourceCache<T>::getResourceCount() const
+{
+    return m_entries.size();
+}
@@ -0,0 +1,181 @@
+#ifndef CPP3DS_TRACE_HPP
+#define CPP3DS_TRACE_HPP
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cpp3ds/Config.hpp>
+#include <cpp3ds/System/NonCopyable.hpp>
+#include <cstddef>
+#include <string>
+
+namespace cpp3ds
+{
+////////////////////////////////////////////////////////////
+/// \brief Timeline of scoped zones, saved in Chrome's trace format
+///
+////////////////////////////////////////////////////////////
+class Trace
+{
+public :
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the current time on the trace timeline
+    ///
+    /// \return Microseconds since the first use of the trace
+    ///
+    ////////////////////////////////////////////////////////////
+    static Int64 getTime();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Record a zone for the current thread
+    ///
+    /// This is what CPP3DS_TRACE_ZONE does when the zone goes out
+    /// of scope. It never blocks, except on the first event of
+    /// a thread, which allocates the thread's buffer.
+    ///
+    /// \param category Category of the zone, must outlive the trace
+    /// \param name     Name of the zone, must outlive the trace
+    /// \param start    Start of the zone, as returned by getTime()
+    /// \param end      End of the zone, as returned by getTime()
+    ///
+    ////////////////////////////////////////////////////////////
+    static void addEvent(const char* category, const char* name, Int64 start, Int64 end);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Name the current thread in the saved traces
+    ///
+    /// Threads without a name are shown by their number.
+    ///
+    /// \param name Name of the thread
+    ///
+    ////////////////////////////////////////////////////////////
+    static void setThreadName(const std::string& name);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Change the number of events kept for each thread
+    ///
+    /// Only the most recent events are kept. The new size
+    /// applies to the threads that haven't recorded anything
+    /// yet. The default is 4096 events.
+    ///
+    /// \param count Number of events per thread
+    ///
+    ////////////////////////////////////////////////////////////
+    static void setBufferSize(std::size_t count);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the number of events kept for each new thread
+    ///
+    /// \return Number of events per thread
+    ///
+    ////////////////////////////////////////////////////////////
+    static std::size_t getBufferSize();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Forget the events recorded so far
+    ///
+    ////////////////////////////////////////////////////////////
+    static void clear();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Save the recorded events to a JSON file
+    ///
+    /// The file can be opened in chrome://tracing or Perfetto.
+    ///
+    /// \param filename Path of the file to save
+    ///
+    /// \return True if saving was successful
+    ///
+    ////////////////////////////////////////////////////////////
+    static bool saveToFile(const std::string& filename);
+};
+
+namespace priv
+{
+////////////////////////////////////////////////////////////
+/// \brief Record the lifetime of a scope as a trace zone
+///
+////////////////////////////////////////////////////////////
+class TraceZone : NonCopyable
+{
+public :
+
+    TraceZone(const char* category, const char* name) :
+    m_category(category),
+    m_name    (name),
+    m_start   (Trace::getTime())
+    {
+    }
+
+    ~TraceZone()
+    {
+        Trace::addEvent(m_category, m_name, m_start, Trace::getTime());
+    }
+
+private :
+
+    const char* m_category; ///< Category of the zone
+    const char* m_name;     ///< Name of the zone
+    Int64       m_start;    ///< Time the zone was entered
+};
+
+} // namespace priv
+
+} // namespace cpp3ds
+
+
+////////////////////////////////////////////////////////////
+// Tracing macros, which compile to nothing unless the
+// library and the application define CPP3DS_ENABLE_TRACE
+////////////////////////////////////////////////////////////
+#ifdef CPP3DS_ENABLE_TRACE
+    #define CPP3DS_TRACE_CONCAT_(a, b) a##b
+    #define CPP3DS_TRACE_CONCAT(a, b) CPP3DS_TRACE_CONCAT_(a, b)
+    #define CPP3DS_TRACE_ZONE(category, name) cpp3ds::priv::TraceZone CPP3DS_TRACE_CONCAT(cpp3dsTraceZone, __LINE__)(category, name)
+    #define CPP3DS_TRACE_THREAD(name) cpp3ds::Trace::setThreadName(name)
+#else
+    #define CPP3DS_TRACE_ZONE(category, name)
+    #define CPP3DS_TRACE_THREAD(name)
+#endif
+
+
+#endif // CPP3DS_TRACE_HPP
+
+
+////////////////////////////////////////////////////////////
+/// \class cpp3ds::Trace
+/// \ingroup system
+///
+/// cpp3ds::Trace records when scoped zones start and end on
+/// each thread, so that the overlap between the render loop,
+/// audio streaming, asset loading and network requests can be
+/// seen on a timeline.
+///
+/// Zones are declared with the CPP3DS_TRACE_ZONE macro, which
+/// records the scope it is declared in. Each thread writes to
+/// its own ring buffer without locking, so zones are cheap
+/// enough for hot paths. When CPP3DS_ENABLE_TRACE is not
+/// defined (the ENABLE_TRACE CMake option), the macros expand
+/// to nothing and cost nothing.
+///
+/// The library is instrumented in rendering, texture uploads,
+/// glyph loading, image loading, sound streaming and HTTP
+/// requests. Zones that are still open when the trace is
+/// saved are left out.
+///
+/// Usage example:
+/// \code
+/// void Level::load()
+/// {
+///     CPP3DS_TRACE_ZONE("Game", "Level::load");
+///     // ...
+/// }
+///
+/// // ... later
+/// cpp3ds::Trace::saveToFile("sdmc:/trace.json");
+/// \endcode
+///
+/// \see cpp3ds::FrameProfiler
+///
+////////////////////////////////////////////////////////////
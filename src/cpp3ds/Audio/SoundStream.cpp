@@ -29,6 +29,7 @@
 #include <cpp3ds/System/Sleep.hpp>
 #include <cpp3ds/System/Err.hpp>
 #include <cpp3ds/System/Lock.hpp>
+#include <cpp3ds/System/Trace.hpp>
 #include <string.h>
 
 
@@ -282,6 +283,8 @@ bool SoundStream::getLoop() const
 ////////////////////////////////////////////////////////////
 void SoundStream::streamData()
 {
+    CPP3DS_TRACE_THREAD("SoundStream");
+
     bool requestStop = false;
 
     {
@@ -377,6 +380,8 @@ void SoundStream::streamData()
 ////////////////////////////////////////////////////////////
 bool SoundStream::fillAndPushBuffer(unsigned int bufferNum)
 {
+    CPP3DS_TRACE_ZONE("Audio", "SoundStream::fillAndPushBuffer");
+
     bool requestStop = false;
 
     // Acquire audio data
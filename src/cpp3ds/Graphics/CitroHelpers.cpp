@@ -1,28 +1,145 @@
 #include "CitroHelpers.hpp"
+#include <cstring>
+#include <vector>
 
 namespace
 {
 	C3D_MtxStack projectionMatrix, modelviewMatrix, textureMatrix;
+	u32 flushCount = 0;
+
+	const u32 allStates = CitroBlendChanged | CitroCombinerChanged | CitroScissorChanged | CitroProgramChanged;
+
+	// Last states sent to the GPU, so that only the changes are sent again.
+	// The dirty states are unknown and sent whatever their value.
+	struct ShadowState
+	{
+		CitroPipelineState pipeline;
+		u32                dirty;
+		C3D_Tex*           texture;
+		u64                textureVersion;
+		bool               textureDirty;
+		int                vertexFormat; // CitroVertexFormat, or -1 when unknown
+	};
+
+	struct SavedState
+	{
+		ShadowState shadow;
+		C3D_TexEnv  texEnv[2];
+		C3D_Mtx     matrices[3];
+	};
+
+	ShadowState shadow;
+	std::vector<SavedState> savedStates;
+
+	void applyCombiner(u32 combiner, bool reset)
+	{
+		C3D_TexEnv* env = C3D_GetTexEnv(0);
+		C3D_TexEnvInit(env);
+		switch (combiner)
+		{
+			default:
+			case CitroCombinerColor:
+				C3D_TexEnvSrc(env, C3D_Both, GPU_PRIMARY_COLOR, 0, 0);
+				C3D_TexEnvFunc(env, C3D_Both, GPU_REPLACE);
+				break;
+
+			case CitroCombinerModulate:
+				C3D_TexEnvSrc(env, C3D_Both, GPU_TEXTURE0, GPU_PRIMARY_COLOR, 0);
+				C3D_TexEnvFunc(env, C3D_Both, GPU_MODULATE);
+				break;
+
+			case CitroCombinerAlphaModulate:
+				C3D_TexEnvSrc(env, C3D_RGB, GPU_PRIMARY_COLOR, 0, 0);
+				C3D_TexEnvSrc(env, C3D_Alpha, GPU_TEXTURE0, GPU_PRIMARY_COLOR, 0);
+				C3D_TexEnvFunc(env, C3D_RGB, GPU_REPLACE);
+				C3D_TexEnvFunc(env, C3D_Alpha, GPU_MODULATE);
+				break;
+
+			// No fragment shader on the GPU: the first stage turns the
+			// distance into alpha = (distance - 0.375) * 4, a ramp from 0
+			// to 1 centered on the outline, the second one applies the
+			// alpha of the vertices and the alpha test drops the outside
+			case CitroCombinerDistanceField:
+				C3D_TexEnvSrc(env, C3D_RGB, GPU_PRIMARY_COLOR, 0, 0);
+				C3D_TexEnvSrc(env, C3D_Alpha, GPU_TEXTURE0, GPU_CONSTANT, 0);
+				C3D_TexEnvFunc(env, C3D_RGB, GPU_REPLACE);
+				C3D_TexEnvFunc(env, C3D_Alpha, GPU_SUBTRACT);
+				C3D_TexEnvScale(env, C3D_Alpha, GPU_TEVSCALE_4);
+				C3D_TexEnvColor(env, 0x60000000);
+
+				env = C3D_GetTexEnv(1);
+				C3D_TexEnvInit(env);
+				C3D_TexEnvSrc(env, C3D_RGB, GPU_PREVIOUS, 0, 0);
+				C3D_TexEnvSrc(env, C3D_Alpha, GPU_PREVIOUS, GPU_PRIMARY_COLOR, 0);
+				C3D_TexEnvFunc(env, C3D_RGB, GPU_REPLACE);
+				C3D_TexEnvFunc(env, C3D_Alpha, GPU_MODULATE);
+				C3D_AlphaTest(true, GPU_GREATER, 0);
+				return;
+		}
+
+		// Only the distance field uses the second stage and the alpha test
+		if (reset)
+		{
+			C3D_TexEnvInit(C3D_GetTexEnv(1));
+			C3D_AlphaTest(false, GPU_ALWAYS, 0);
+		}
+	}
+
+	// Send the states that changed or are dirty among the given ones
+	u32 applyPipelineState(const CitroPipelineState& state, u32 states)
+	{
+		CitroPipelineState& current = shadow.pipeline;
+		u32 changed = 0;
+
+		if ((states & CitroBlendChanged) && ((shadow.dirty & CitroBlendChanged) || (state.blend != current.blend)))
+		{
+			C3D_AlphaBlend(static_cast<GPU_BLENDEQUATION>(state.blend & 0xF),
+			               static_cast<GPU_BLENDEQUATION>((state.blend >> 4) & 0xF),
+			               static_cast<GPU_BLENDFACTOR>((state.blend >> 8) & 0xF),
+			               static_cast<GPU_BLENDFACTOR>((state.blend >> 12) & 0xF),
+			               static_cast<GPU_BLENDFACTOR>((state.blend >> 16) & 0xF),
+			               static_cast<GPU_BLENDFACTOR>((state.blend >> 20) & 0xF));
+			current.blend = state.blend;
+			changed |= CitroBlendChanged;
+		}
+
+		if ((states & CitroCombinerChanged) && ((shadow.dirty & CitroCombinerChanged) || (state.combiner != current.combiner)))
+		{
+			bool reset = (shadow.dirty & CitroCombinerChanged) || (current.combiner == CitroCombinerDistanceField);
+			applyCombiner(state.combiner, reset);
+			current.combiner = state.combiner;
+			changed |= CitroCombinerChanged;
+		}
+
+		if ((states & CitroScissorChanged) && ((shadow.dirty & CitroScissorChanged) || std::memcmp(state.scissor, current.scissor, sizeof(state.scissor))))
+		{
+			C3D_SetScissor(static_cast<GPU_SCISSORMODE>(state.scissor[0]), state.scissor[1], state.scissor[2], state.scissor[3], state.scissor[4]);
+			std::memcpy(current.scissor, state.scissor, sizeof(state.scissor));
+			changed |= CitroScissorChanged;
+		}
+
+		if ((states & CitroProgramChanged) && ((shadow.dirty & CitroProgramChanged) || (state.program != current.program)))
+		{
+			C3D_BindProgram(state.program);
+			CitroBindUniforms(state.program);
+			current.program = state.program;
+			changed |= CitroProgramChanged;
+		}
+
+		shadow.dirty &= ~changed;
+		return changed;
+	}
 }
 
 void CitroInit(size_t commandBufferSize)
 {
 	C3D_Init(commandBufferSize);
 
-	// Configure attributes for use with the vertex shader
-	C3D_AttrInfo* attrInfo = C3D_GetAttrInfo();
-	AttrInfo_Init(attrInfo);
-	AttrInfo_AddLoader(attrInfo, 0, GPU_FLOAT, 2); // v0=position
-	AttrInfo_AddLoader(attrInfo, 1, GPU_UNSIGNED_BYTE, 4); // v1=color
-	AttrInfo_AddLoader(attrInfo, 2, GPU_FLOAT, 2); // v2=texcoord
-
-	C3D_TexEnv* env = C3D_GetTexEnv(0);
-	C3D_TexEnvSrc(env, C3D_Both, GPU_PRIMARY_COLOR, 0, 0);
-	C3D_TexEnvOp(env, C3D_Both, 0, 0, 0);
-	C3D_TexEnvFunc(env, C3D_Both, GPU_REPLACE);
-
 	C3D_DepthTest(false, GPU_GEQUAL, GPU_WRITE_ALL);
 	C3D_CullFace(GPU_CULL_NONE);
+
+	CitroInvalidateState();
+	CitroSetCombiner(CitroCombinerColor);
 }
 
 void CitroDestroy()
@@ -48,6 +165,19 @@ void CitroUpdateMatrixStacks()
 	MtxStack_Update(&textureMatrix);
 }
 
+void CitroFlush()
+{
+	// C3D_Flush waits for the GPU to execute the command list, so any
+	// buffer referenced by previous draw calls can be reused afterwards
+	C3D_Flush();
+	++flushCount;
+}
+
+u32 CitroGetFlushCount()
+{
+	return flushCount;
+}
+
 C3D_MtxStack* CitroGetProjectionMatrix()
 {
 	return &projectionMatrix;
@@ -62,3 +192,127 @@ C3D_MtxStack* CitroGetTextureMatrix()
 {
 	return &textureMatrix;
 }
+
+u32 CitroPackBlend(GPU_BLENDEQUATION colorEquation, GPU_BLENDEQUATION alphaEquation,
+                   GPU_BLENDFACTOR colorSrc, GPU_BLENDFACTOR colorDst,
+                   GPU_BLENDFACTOR alphaSrc, GPU_BLENDFACTOR alphaDst)
+{
+	return colorEquation | (alphaEquation << 4) | (colorSrc << 8) | (colorDst << 12) | (alphaSrc << 16) | (alphaDst << 20);
+}
+
+u32 CitroApplyPipelineState(const CitroPipelineState* state)
+{
+	// Most draws use the same states as the previous one
+	if (!shadow.dirty &&
+	    (state->blend == shadow.pipeline.blend) && (state->combiner == shadow.pipeline.combiner) &&
+	    (state->program == shadow.pipeline.program) && !std::memcmp(state->scissor, shadow.pipeline.scissor, sizeof(state->scissor)))
+		return 0;
+
+	return applyPipelineState(*state, allStates);
+}
+
+void CitroSetCombiner(CitroCombiner combiner)
+{
+	CitroPipelineState state = shadow.pipeline;
+	state.combiner = combiner;
+	applyPipelineState(state, CitroCombinerChanged);
+}
+
+void CitroSetProgram(shaderProgram_s* program)
+{
+	CitroPipelineState state = shadow.pipeline;
+	state.program = program;
+	applyPipelineState(state, CitroProgramChanged);
+}
+
+bool CitroSetTexture(C3D_Tex* texture, u64 version)
+{
+	// The version tells apart textures recreated at the same address
+	if (!shadow.textureDirty && (texture == shadow.texture) && (version == shadow.textureVersion))
+		return false;
+
+	C3D_TexBind(0, texture);
+	shadow.texture = texture;
+	shadow.textureVersion = version;
+	shadow.textureDirty = false;
+	return true;
+}
+
+void CitroSetVertexFormat(CitroVertexFormat format)
+{
+	if (format == shadow.vertexFormat)
+		return;
+
+	// The loaders convert 16-bit components to floats, so
+	// both formats work with the same vertex shader
+	GPU_FORMATS type = (format == CitroVertexCompact) ? GPU_SHORT : GPU_FLOAT;
+	C3D_AttrInfo* attrInfo = C3D_GetAttrInfo();
+	AttrInfo_Init(attrInfo);
+	AttrInfo_AddLoader(attrInfo, 0, type, 2); // v0=position
+	AttrInfo_AddLoader(attrInfo, 1, GPU_UNSIGNED_BYTE, 4); // v1=color
+	AttrInfo_AddLoader(attrInfo, 2, type, 2); // v2=texcoord
+	shadow.vertexFormat = format;
+}
+
+void CitroSetMatrix(C3D_MtxStack* stack, const float* matrix)
+{
+	// MtxStack_Cur marks the matrix for upload, only do it when it changes
+	if (std::memcmp(stack->m[stack->pos].m, matrix, sizeof(C3D_Mtx)) != 0)
+		std::memcpy(MtxStack_Cur(stack)->m, matrix, sizeof(C3D_Mtx));
+}
+
+void CitroInvalidateState()
+{
+	// Direct citro3d calls may have changed anything
+	shadow.dirty = allStates;
+	shadow.textureDirty = true;
+	MtxStack_Cur(&projectionMatrix);
+	MtxStack_Cur(&modelviewMatrix);
+	MtxStack_Cur(&textureMatrix);
+
+	// Program the float loaders again, which the code drawing
+	// without CitroSetVertexFormat expects
+	shadow.vertexFormat = -1;
+	CitroSetVertexFormat(CitroVertexFloat);
+}
+
+void CitroPushState()
+{
+	SavedState saved;
+	saved.shadow = shadow;
+	saved.texEnv[0] = *C3D_GetTexEnv(0);
+	saved.texEnv[1] = *C3D_GetTexEnv(1);
+	std::memcpy(&saved.matrices[0], &projectionMatrix.m[projectionMatrix.pos], sizeof(C3D_Mtx));
+	std::memcpy(&saved.matrices[1], &modelviewMatrix.m[modelviewMatrix.pos], sizeof(C3D_Mtx));
+	std::memcpy(&saved.matrices[2], &textureMatrix.m[textureMatrix.pos], sizeof(C3D_Mtx));
+	savedStates.push_back(saved);
+}
+
+bool CitroPopState()
+{
+	if (savedStates.empty())
+		return false;
+
+	const SavedState& saved = savedStates.back();
+
+	// Send the known states again, the unknown ones stay dirty
+	shadow.dirty = allStates;
+	applyPipelineState(saved.shadow.pipeline, allStates & ~saved.shadow.dirty);
+	shadow.dirty = saved.shadow.dirty;
+
+	// The saved texture may have been destroyed since, the next draw binds its own
+	shadow.textureDirty = true;
+
+	// Give the code drawing directly the float loaders back
+	shadow.vertexFormat = -1;
+	CitroSetVertexFormat(CitroVertexFloat);
+
+	*C3D_GetTexEnv(0) = saved.texEnv[0];
+	*C3D_GetTexEnv(1) = saved.texEnv[1];
+	CitroSetMatrix(&projectionMatrix, saved.matrices[0].m);
+	CitroSetMatrix(&modelviewMatrix, saved.matrices[1].m);
+	CitroSetMatrix(&textureMatrix, saved.matrices[2].m);
+
+	savedStates.pop_back();
+	return true;
+}
@@ -1,10 +1,60 @@
 #pragma once
 #include <citro3d.h>
 
+// Texture combiner setups used by the renderer
+enum CitroCombiner
+{
+	CitroCombinerColor,          // Vertex color only
+	CitroCombinerModulate,       // Texture color multiplied by the vertex color
+	CitroCombinerAlphaModulate,  // Vertex color, texture alpha multiplied by the vertex alpha
+	CitroCombinerDistanceField   // Vertex color, alpha ramp around the outline of a distance field
+};
+
+// Layouts of the vertices read by the attribute loaders
+enum CitroVertexFormat
+{
+	CitroVertexFloat,   // cpp3ds::Vertex, float position and texture coordinates
+	CitroVertexCompact  // cpp3ds::CompactVertex, 16-bit position and texture coordinates
+};
+
+// Parts of the pipeline state that were actually sent to the GPU
+enum CitroStateChange
+{
+	CitroBlendChanged    = 1 << 0,
+	CitroCombinerChanged = 1 << 1,
+	CitroScissorChanged  = 1 << 2,
+	CitroProgramChanged  = 1 << 3
+};
+
+// Fixed-function states of a draw, compared as a whole with the
+// ones last sent so that unchanged draws cost a few word compares
+struct CitroPipelineState
+{
+	u32              blend;      // Blend equations and factors, from CitroPackBlend
+	u32              combiner;   // CitroCombiner
+	u32              scissor[5]; // Scissor mode, then the C3D_SetScissor coordinates
+	shaderProgram_s* program;    // Vertex shader program
+};
+
 void CitroInit(size_t commandBufferSize);
 void CitroDestroy();
 void CitroBindUniforms(shaderProgram_s* program);
 void CitroUpdateMatrixStacks();
+void CitroFlush();
+u32 CitroGetFlushCount();
 C3D_MtxStack* CitroGetProjectionMatrix();
 C3D_MtxStack* CitroGetModelviewMatrix();
 C3D_MtxStack* CitroGetTextureMatrix();
+
+u32 CitroPackBlend(GPU_BLENDEQUATION colorEquation, GPU_BLENDEQUATION alphaEquation,
+                   GPU_BLENDFACTOR colorSrc, GPU_BLENDFACTOR colorDst,
+                   GPU_BLENDFACTOR alphaSrc, GPU_BLENDFACTOR alphaDst);
+u32 CitroApplyPipelineState(const CitroPipelineState* state);
+void CitroSetCombiner(CitroCombiner combiner);
+void CitroSetProgram(shaderProgram_s* program);
+bool CitroSetTexture(C3D_Tex* texture, u64 version);
+void CitroSetVertexFormat(CitroVertexFormat format);
+void CitroSetMatrix(C3D_MtxStack* stack, const float* matrix);
+void CitroInvalidateState();
+void CitroPushState();
+bool CitroPopState();
@@ -0,0 +1,89 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cpp3ds/Graphics/CompactVertex.hpp>
+#ifndef EMULATION
+#include <3ds.h>
+#include <bits/functexcept.h>
+#endif
+
+
+namespace cpp3ds
+{
+////////////////////////////////////////////////////////////
+CompactVertex::CompactVertex() :
+position (0, 0),
+color    (255, 255, 255),
+texCoords(0, 0)
+{
+}
+
+
+////////////////////////////////////////////////////////////
+CompactVertex::CompactVertex(const Vector2<Int16>& thePosition) :
+position (thePosition),
+color    (255, 255, 255),
+texCoords(0, 0)
+{
+}
+
+
+////////////////////////////////////////////////////////////
+CompactVertex::CompactVertex(const Vector2<Int16>& thePosition, const Color& theColor) :
+position (thePosition),
+color    (theColor),
+texCoords(0, 0)
+{
+}
+
+
+////////////////////////////////////////////////////////////
+CompactVertex::CompactVertex(const Vector2<Int16>& thePosition, const Vector2<Int16>& theTexCoords) :
+position (thePosition),
+color    (255, 255, 255),
+texCoords(theTexCoords)
+{
+}
+
+
+////////////////////////////////////////////////////////////
+CompactVertex::CompactVertex(const Vector2<Int16>& thePosition, const Color& theColor, const Vector2<Int16>& theTexCoords) :
+position (thePosition),
+color    (theColor),
+texCoords(theTexCoords)
+{
+}
+
+#ifndef EMULATION
+////////////////////////////////////////////////////////////
+void* CompactVertex::operator new (std::size_t size)
+{
+	void *p = linearAlloc(size);
+	if (!p)
+		std::__throw_bad_alloc();
+	return p;
+}
+
+////////////////////////////////////////////////////////////
+void CompactVertex::operator delete (void *p)
+{
+	linearFree(p);
+}
+
+////////////////////////////////////////////////////////////
+void* CompactVertex::operator new[] (std::size_t size)
+{
+	void *p = linearAlloc(size);
+	if (!p)
+		std::__throw_bad_alloc();
+	return p;
+}
+
+////////////////////////////////////////////////////////////
+void CompactVertex::operator delete[] (void *p)
+{
+	linearFree(p);
+}
+#endif
+
+} // namespace cpp3ds
@@ -0,0 +1,126 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cpp3ds/Graphics/CompactVertexArray.hpp>
+#include <cpp3ds/Graphics/RenderTarget.hpp>
+
+
+namespace cpp3ds
+{
+////////////////////////////////////////////////////////////
+CompactVertexArray::CompactVertexArray() :
+m_vertices     (),
+m_primitiveType(Triangles)
+{
+}
+
+
+////////////////////////////////////////////////////////////
+CompactVertexArray::CompactVertexArray(PrimitiveType type, unsigned int vertexCount) :
+m_vertices     (vertexCount),
+m_primitiveType(type)
+{
+}
+
+
+////////////////////////////////////////////////////////////
+unsigned int CompactVertexArray::getVertexCount() const
+{
+    return static_cast<unsigned int>(m_vertices.size());
+}
+
+
+////////////////////////////////////////////////////////////
+CompactVertex& CompactVertexArray::operator [](unsigned int index)
+{
+    return m_vertices[index];
+}
+
+
+////////////////////////////////////////////////////////////
+const CompactVertex& CompactVertexArray::operator [](unsigned int index) const
+{
+    return m_vertices[index];
+}
+
+
+////////////////////////////////////////////////////////////
+void CompactVertexArray::clear()
+{
+    m_vertices.clear();
+}
+
+
+////////////////////////////////////////////////////////////
+void CompactVertexArray::resize(unsigned int vertexCount)
+{
+    m_vertices.resize(vertexCount);
+}
+
+
+////////////////////////////////////////////////////////////
+void CompactVertexArray::append(const CompactVertex& vertex)
+{
+    m_vertices.push_back(vertex);
+}
+
+
+////////////////////////////////////////////////////////////
+void CompactVertexArray::setPrimitiveType(PrimitiveType type)
+{
+    m_primitiveType = type;
+}
+
+
+////////////////////////////////////////////////////////////
+PrimitiveType CompactVertexArray::getPrimitiveType() const
+{
+    return m_primitiveType;
+}
+
+
+////////////////////////////////////////////////////////////
+FloatRect CompactVertexArray::getBounds() const
+{
+    if (!m_vertices.empty())
+    {
+        Int16 left   = m_vertices[0].position.x;
+        Int16 top    = m_vertices[0].position.y;
+        Int16 right  = m_vertices[0].position.x;
+        Int16 bottom = m_vertices[0].position.y;
+
+        for (std::size_t i = 1; i < m_vertices.size(); ++i)
+        {
+            Vector2<Int16> position = m_vertices[i].position;
+
+            // Update left and right
+            if (position.x < left)
+                left = position.x;
+            else if (position.x > right)
+                right = position.x;
+
+            // Update top and bottom
+            if (position.y < top)
+                top = position.y;
+            else if (position.y > bottom)
+                bottom = position.y;
+        }
+
+        return FloatRect(left, top, right - left, bottom - top);
+    }
+    else
+    {
+        // Array is empty
+        return FloatRect();
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+void CompactVertexArray::draw(RenderTarget& target, RenderStates states) const
+{
+    if (!m_vertices.empty())
+        target.draw(&m_vertices[0], static_cast<unsigned int>(m_vertices.size()), m_primitiveType, states);
+}
+
+} // namespace cpp3ds
@@ -10,6 +10,7 @@
 #include <cpp3ds/Resources.hpp>
 #include <stdio.h>
 #include <sstream>
+#include <cmath>
 #ifndef EMULATION
 #include <sys/iosupport.h>
 extern u32 __linear_heap_size;
@@ -40,6 +41,17 @@ static const devoptab_t dotab_stdout = {
 
 }
 
+namespace
+{
+	// Size of the console's characters
+	const unsigned int characterSize = 10;
+
+	// Height of the screens, and width of the widest one
+	const float screenHeight = 240.f;
+	const float screenWidth  = 400.f;
+}
+
+
 namespace cpp3ds
 {
 
@@ -48,7 +60,16 @@ bool Console::m_enabledBasic = false;
 
 ////////////////////////////////////////////////////////////
 Console::Console()
-: m_visible(true)
+: m_firstLine      (0)
+, m_lineCount      (0)
+, m_newLines       (0)
+, m_lineOpen       (false)
+, m_lastLineChanged(false)
+, m_firstVertex    (0)
+, m_topRow         (0)
+, m_nextRow        (0)
+, m_limit          (1000)
+, m_visible        (true)
 {
 }
 
@@ -134,8 +155,7 @@ void Console::update(float delta)
 		write(s);
 	g_stdout.clear();
 
-	if (m_lines.size() > m_limit)
-		m_lines.erase(m_lines.begin(), m_lines.end() - m_limit);
+	updateGeometry();
 
 #ifndef EMULATION
 	std::ostringstream ss;
@@ -143,25 +163,198 @@ void Console::update(float delta)
 	m_memoryText.setString(ss.str());
 	m_memoryText.setPosition((m_screen == TopScreen ? 395 : 315) - m_memoryText.getGlobalBounds().width, 5);
 #endif
+}
+
 
-	int h = 240;
-	int i = m_lines.size();
+////////////////////////////////////////////////////////////
+void Console::write(String text)
+{
+	std::size_t start = 0;
+	while (true) {
+		std::size_t end = text.find("\n", start);
+		bool closed = (end != String::InvalidPos);
+		if (!closed)
+			end = text.getSize();
+		if (!closed && end == start)
+			break;
+
+		String segment = text.substring(start, end - start);
+		if (m_lineOpen && m_lineCount > 0) {
+			// Continue the last line, laid out again if it already was
+			getLine(m_lineCount - 1) += segment;
+			if (m_newLines == 0)
+				m_lastLineChanged = true;
+		} else if (m_lineCount < m_limit) {
+			// Fill the ring buffer
+			m_lines.push_back(segment);
+			++m_lineCount;
+			++m_newLines;
+		} else {
+			// Overwrite the oldest line
+			m_lines[m_firstLine] = segment;
+			m_firstLine = (m_firstLine + 1) % m_limit;
+			++m_newLines;
+		}
 
-	while (h > 0 && i > 0) {
-		Text& text = m_lines[--i];
-		h -= text.getGlobalBounds().height;
-		text.setPosition(0, h);
+		m_lineOpen = !closed;
+		if (!closed)
+			break;
+		start = end + 1;
 	}
 }
 
 
 ////////////////////////////////////////////////////////////
-void Console::write(String text)
+String& Console::getLine(std::size_t index)
+{
+	return m_lines[(m_firstLine + index) % m_lines.size()];
+}
+
+
+////////////////////////////////////////////////////////////
+std::size_t Console::getVisibleLineCount() const
+{
+	float lineSpacing = m_font.getLineSpacing(characterSize);
+	if (lineSpacing <= 0)
+		return 0;
+	return static_cast<std::size_t>(std::ceil(screenHeight / lineSpacing));
+}
+
+
+////////////////////////////////////////////////////////////
+void Console::updateGeometry()
+{
+	std::size_t visibleCount = getVisibleLineCount();
+	std::size_t start;
+
+	if (m_newLines >= visibleCount) {
+		// The whole screen changed, only its last lines are laid out
+		clearGeometry();
+		start = m_lineCount - std::min(visibleCount, m_lineCount);
+	} else {
+		start = m_lineCount - m_newLines;
+		if (m_lastLineChanged && !m_visibleLines.empty()) {
+			removeBottomLine();
+			--start;
+		}
+	}
+
+	for (std::size_t i = start; i < m_lineCount; ++i)
+		addLine(getLine(i));
+	while (m_visibleLines.size() > visibleCount)
+		removeTopLine();
+
+	m_newLines = 0;
+	m_lastLineChanged = false;
+}
+
+
+////////////////////////////////////////////////////////////
+void Console::addLine(const String& line)
+{
+	std::size_t count = m_vertices.size();
+	float x = 0.f;
+	float y = m_nextRow * m_font.getLineSpacing(characterSize) + characterSize;
+	float hspace = m_font.getGlyph(L' ', characterSize, false).advance;
+	Uint32 prevChar = 0;
+
+	// Characters past the right of the screen are never seen
+	for (std::size_t i = 0; i < line.getSize() && x < screenWidth; ++i) {
+		Uint32 curChar = line[i];
+		x += m_font.getKerning(prevChar, curChar, characterSize);
+		prevChar = curChar;
+
+		if (curChar == L' ' || curChar == L'\t' || curChar == L'\r') {
+			x += (curChar == L'\t') ? hspace * 4 : (curChar == L' ') ? hspace : 0.f;
+			continue;
+		}
+
+		const Glyph& glyph = m_font.getGlyph(curChar, characterSize, false);
+		float left   = x + glyph.bounds.left;
+		float top    = y + glyph.bounds.top;
+		float right  = left + glyph.bounds.width;
+		float bottom = top + glyph.bounds.height;
+		float u1 = static_cast<float>(glyph.textureRect.left);
+		float v1 = static_cast<float>(glyph.textureRect.top);
+		float u2 = static_cast<float>(glyph.textureRect.left + glyph.textureRect.width);
+		float v2 = static_cast<float>(glyph.textureRect.top + glyph.textureRect.height);
+
+		m_vertices.push_back(Vertex(Vector2f(left,  top),    m_color, Vector2f(u1, v1)));
+		m_vertices.push_back(Vertex(Vector2f(right, top),    m_color, Vector2f(u2, v1)));
+		m_vertices.push_back(Vertex(Vector2f(right, bottom), m_color, Vector2f(u2, v2)));
+		m_vertices.push_back(Vertex(Vector2f(left,  bottom), m_color, Vector2f(u1, v2)));
+
+		if (m_pageRuns.empty() || m_pageRuns.back().page != glyph.page) {
+			PageRun run = {glyph.page, 0};
+			m_pageRuns.push_back(run);
+		}
+		m_pageRuns.back().count += 4;
+
+		x += glyph.advance;
+	}
+
+	m_visibleLines.push_back(m_vertices.size() - count);
+	++m_nextRow;
+}
+
+
+////////////////////////////////////////////////////////////
+void Console::removeTopLine()
+{
+	std::size_t count = m_visibleLines.front();
+	m_visibleLines.pop_front();
+	m_firstVertex += count;
+	++m_topRow;
+
+	while (count > 0) {
+		std::size_t removed = std::min(count, m_pageRuns.front().count);
+		m_pageRuns.front().count -= removed;
+		if (m_pageRuns.front().count == 0)
+			m_pageRuns.pop_front();
+		count -= removed;
+	}
+
+	// Once the dropped quads outnumber the visible ones, move the
+	// visible ones back to the start, and to the top row
+	if (m_firstVertex > m_vertices.size() - m_firstVertex) {
+		float shift = m_topRow * m_font.getLineSpacing(characterSize);
+		m_vertices.erase(m_vertices.begin(), m_vertices.begin() + m_firstVertex);
+		for (std::vector<Vertex>::iterator it = m_vertices.begin(); it != m_vertices.end(); ++it)
+			it->position.y -= shift;
+		m_firstVertex = 0;
+		m_nextRow -= m_topRow;
+		m_topRow = 0;
+	}
+}
+
+
+////////////////////////////////////////////////////////////
+void Console::removeBottomLine()
+{
+	std::size_t count = m_visibleLines.back();
+	m_visibleLines.pop_back();
+	m_vertices.resize(m_vertices.size() - count);
+	--m_nextRow;
+
+	while (count > 0) {
+		std::size_t removed = std::min(count, m_pageRuns.back().count);
+		m_pageRuns.back().count -= removed;
+		if (m_pageRuns.back().count == 0)
+			m_pageRuns.pop_back();
+		count -= removed;
+	}
+}
+
+
+////////////////////////////////////////////////////////////
+void Console::clearGeometry()
 {
-	Text line(text, m_font, 10);
-	line.setFillColor(m_color);
-	line.useSystemFont();
-	m_lines.push_back(line);
+	m_vertices.clear();
+	m_visibleLines.clear();
+	m_pageRuns.clear();
+	m_firstVertex = 0;
+	m_topRow = 0;
+	m_nextRow = 0;
 }
 
 
@@ -206,17 +399,19 @@ void Console::draw(RenderTarget& target, RenderStates states) const
 	if (!m_visible)
 		return;
 
-	int h = 240;
-	int i = m_lines.size();
+	// The last line sits at the bottom of the screen
+	RenderStates textStates = states;
+	textStates.transform.translate(0, screenHeight - m_nextRow * m_font.getLineSpacing(characterSize));
 
-	while (h > 0 && i > 0) {
-		const Text& text = m_lines[--i];
-		h -= text.getGlobalBounds().height;
-//		text.setPosition(0, h);
-		target.draw(text);
+	// One draw call for each run of glyphs on the same font page
+	std::size_t start = m_firstVertex;
+	for (std::deque<PageRun>::const_iterator it = m_pageRuns.begin(); it != m_pageRuns.end(); ++it) {
+		textStates.texture = &m_font.getTexture(characterSize, it->page);
+		target.draw(&m_vertices[start], static_cast<unsigned int>(it->count), Quads, textStates);
+		start += it->count;
 	}
 
-	target.draw(m_memoryText);
+	target.draw(m_memoryText, states);
 }
 
 
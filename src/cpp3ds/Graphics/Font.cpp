@@ -29,14 +29,25 @@
 #include <cpp3ds/OpenGL.hpp>
 #include <cpp3ds/System/InputStream.hpp>
 #include <cpp3ds/System/Err.hpp>
+#include <cpp3ds/System/Lock.hpp>
+#include <cpp3ds/System/Mutex.hpp>
+#include <cpp3ds/System/Thread.hpp>
+#include <cpp3ds/System/NonCopyable.hpp>
+#include <cpp3ds/System/Trace.hpp>
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include FT_GLYPH_H
 #include FT_OUTLINE_H
 #include FT_BITMAP_H
 #include FT_STROKER_H
+#include FT_SIZES_H
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
 #include <cpp3ds/System/FileSystem.hpp>
 
 
@@ -59,38 +70,416 @@ unsigned long read(FT_Stream rec, unsigned long offset, unsigned char* buffer, u
 void close(FT_Stream)
 {
 }
+
+// Little-endian reader of the files written by cpp3ds-fontbake
+class BakedReader
+{
+public:
+
+    BakedReader(const void* data, std::size_t size) :
+    m_data(static_cast<const cpp3ds::Uint8*>(data)),
+    m_size(size),
+    m_position(0)
+    {
+    }
+
+    bool read16(cpp3ds::Uint32& value)
+    {
+        if (m_position + 2 > m_size)
+            return false;
+        value = m_data[m_position] | (m_data[m_position + 1] << 8);
+        m_position += 2;
+        return true;
+    }
+
+    bool read32(cpp3ds::Uint32& value)
+    {
+        cpp3ds::Uint32 low, high;
+        if (!read16(low) || !read16(high))
+            return false;
+        value = low | (high << 16);
+        return true;
+    }
+
+    bool readFloat(float& value)
+    {
+        cpp3ds::Uint32 bits;
+        if (!read32(bits))
+            return false;
+        std::memcpy(&value, &bits, sizeof(value));
+        return true;
+    }
+
+    const cpp3ds::Uint8* readBytes(std::size_t count)
+    {
+        if (m_position + count > m_size)
+            return NULL;
+        const cpp3ds::Uint8* bytes = m_data + m_position;
+        m_position += count;
+        return bytes;
+    }
+
+private:
+
+    const cpp3ds::Uint8* m_data;
+    std::size_t          m_size;
+    std::size_t          m_position;
+};
+
+// The FreeType library is shared by all the fonts, and released with the last
+// face. Its mutex, which also protects the face cache, is allocated on first
+// use and never destroyed, so that fonts with static storage duration can be
+// destroyed at exit whatever the destruction order.
+FT_Library   sharedLibrary  = NULL;
+unsigned int libraryUsers   = 0;
+
+cpp3ds::Mutex& getLibraryMutex()
+{
+    static cpp3ds::Mutex* mutex = new cpp3ds::Mutex;
+    return *mutex;
+}
+
+// Get the shared library, initializing it if needed (the library mutex must be locked)
+FT_Library acquireLibrary()
+{
+    if ((libraryUsers == 0) && (FT_Init_FreeType(&sharedLibrary) != 0))
+        return NULL;
+
+    ++libraryUsers;
+    return sharedLibrary;
+}
+
+// Release the shared library, closing it if it was the last user (the library mutex must be locked)
+void releaseLibrary()
+{
+    if (--libraryUsers == 0)
+    {
+        FT_Done_FreeType(sharedLibrary);
+        sharedLibrary = NULL;
+    }
+}
+
+// Key of a glyph in the tables, combining the code point, bold flag, and outline thickness
+cpp3ds::Uint64 getGlyphKey(cpp3ds::Uint32 codePoint, bool bold, float outlineThickness)
+{
+    cpp3ds::Uint32 outline;
+    std::memcpy(&outline, &outlineThickness, sizeof(outline));
+    return (static_cast<cpp3ds::Uint64>(outline) << 32)
+           | (static_cast<cpp3ds::Uint64>(bold ? 1 : 0) << 31)
+           |  static_cast<cpp3ds::Uint64>(codePoint);
+}
+
+// Key of a pair of code points in the baked kerning tables
+cpp3ds::Uint64 kerningKey(cpp3ds::Uint32 first, cpp3ds::Uint32 second)
+{
+    return (static_cast<cpp3ds::Uint64>(first) << 32) | second;
+}
+
+// Distance field glyphs are stored with the atlases, under a size no text uses
+const unsigned int distanceFieldAtlas = 0xFFFFFFFF;
+
+// Distance field glyphs are rasterized this many times bigger, for precise distances
+const int distanceFieldUpscale = 4;
+
+// Squared Euclidean distance transform of a line of samples (Felzenszwalb and
+// Huttenlocher), samples of the features being 0 and the other ones infinite
+void transformLine(float* samples, int count, int stride, std::vector<float>& line,
+                   std::vector<int>& parabolas, std::vector<float>& bounds)
+{
+    line.resize(count);
+    parabolas.resize(count);
+    bounds.resize(count + 1);
+    for (int i = 0; i < count; ++i)
+        line[i] = samples[i * stride];
+
+    // Lower envelope of the parabolas rooted at each sample
+    int k = 0;
+    parabolas[0] = 0;
+    bounds[0] = -1e20f;
+    bounds[1] = 1e20f;
+    for (int q = 1; q < count; ++q)
+    {
+        float s;
+        for (;;)
+        {
+            int p = parabolas[k];
+            s = ((line[q] + q * q) - (line[p] + p * p)) / (2 * q - 2 * p);
+            if ((s > bounds[k]) || (k == 0))
+                break;
+            --k;
+        }
+
+        if (s <= bounds[k])
+        {
+            // Only possible for k == 0: the new parabola hides the first one
+            parabolas[0] = q;
+            continue;
+        }
+
+        ++k;
+        parabolas[k] = q;
+        bounds[k] = s;
+        bounds[k + 1] = 1e20f;
+    }
+
+    k = 0;
+    for (int q = 0; q < count; ++q)
+    {
+        while (bounds[k + 1] < q)
+            ++k;
+        int p = parabolas[k];
+        samples[q * stride] = (q - p) * (q - p) + line[p];
+    }
+}
+
+// Squared Euclidean distance transform of a grid, columns first then rows
+void transformGrid(std::vector<float>& grid, int width, int height)
+{
+    std::vector<float> line, bounds;
+    std::vector<int> parabolas;
+    for (int x = 0; x < width; ++x)
+        transformLine(&grid[x], height, width, line, parabolas, bounds);
+    for (int y = 0; y < height; ++y)
+        transformLine(&grid[y * width], width, 1, line, parabolas, bounds);
+}
 }
 
 
 namespace cpp3ds
 {
+////////////////////////////////////////////////////////////
+/// \brief Font face and glyphs, shared by the copies of a font
+///        and by the fonts loaded from the same source
+///
+/// FreeType objects are created and destroyed with the library
+/// mutex locked, which also protects the reference counter and
+/// the cache of faces. The face itself is used behind its own
+/// mutex, as preloading threads may rasterize with it.
+///
+////////////////////////////////////////////////////////////
+struct Font::FaceData : NonCopyable
+{
+    FaceData() :
+    library  (NULL),
+    face     (NULL),
+    streamRec(NULL),
+    stroker  (NULL),
+    refCount (1)
+    {
+    }
+
+    ~FaceData()
+    {
+        // Remove the face from the cache, so that it is not shared anymore
+        if (!source.empty())
+            getCache().erase(source);
+
+        // Destroy the stroker
+        if (stroker)
+            FT_Stroker_Done(stroker);
+
+        // Destroy the font face
+        if (face)
+            FT_Done_Face(face);
+
+        // Destroy the stream rec instance, if any (must be done after FT_Done_Face!)
+        delete streamRec;
+
+        // Close the library if this was the last face
+        if (library)
+            releaseLibrary();
+    }
+
+    // Get the face loaded from a source, with a new reference to it
+    static FaceData* share(const std::string& source)
+    {
+        std::map<std::string, FaceData*>::iterator it = getCache().find(source);
+        if (it == getCache().end())
+            return NULL;
+
+        ++it->second->refCount;
+        return it->second;
+    }
+
+    // Make the face available to the fonts loaded from the same source
+    void setSource(const std::string& key)
+    {
+        source = key;
+        getCache()[source] = this;
+    }
+
+    std::string getFamily() const
+    {
+        return (face && face->family_name) ? face->family_name : std::string();
+    }
+
+    // Faces by source, never destroyed for the same reason as the library mutex
+    static std::map<std::string, FaceData*>& getCache()
+    {
+        static std::map<std::string, FaceData*>* cache = new std::map<std::string, FaceData*>;
+        return *cache;
+    }
+
+    FT_Library     library;     ///< Shared FreeType library, null if the face isn't loaded
+    FT_Face        face;        ///< Font face, null for fonts only made of baked glyphs
+    FT_StreamRec*  streamRec;   ///< Stream rec instance of the faces loaded from a stream
+    FT_Stroker     stroker;     ///< Stroker used to outline the glyphs
+    std::string    source;      ///< Key of the face in the cache, empty if it can't be shared
+    int            refCount;    ///< Number of fonts using the face
+    Mutex          mutex;       ///< Serializes the use of the face
+    SizeTable      sizes;       ///< FreeType size objects of the face, by character size
+    CharIndexTable charIndices; ///< Glyph indices of the characters looked up so far
+    AtlasTable     atlases;     ///< Glyph pages by character size
+};
+
+
+////////////////////////////////////////////////////////////
+/// \brief Glyph rasterized by FreeType, waiting to be placed
+///        in the pages
+///
+////////////////////////////////////////////////////////////
+struct Font::StagedGlyph
+{
+    Uint32             codePoint;        ///< Unicode code point of the character
+    unsigned int       characterSize;    ///< Reference character size
+    bool               bold;             ///< Bold version or regular one?
+    float              outlineThickness; ///< Thickness of outline
+    Glyph              glyph;            ///< Metrics, the texture rectangle only has a size yet
+    std::vector<Uint8> alpha;            ///< Alpha of the pixels, row by row
+};
+
+
+////////////////////////////////////////////////////////////
+/// \brief Worker thread rasterizing glyphs ahead of time
+///
+/// The worker never touches the glyph tables nor the page
+/// textures: it only fills a staging list, that the rendering
+/// thread publishes. Only the font face is shared, behind its
+/// mutex.
+///
+////////////////////////////////////////////////////////////
+class Font::Preloader : NonCopyable
+{
+public:
+
+    explicit Preloader(const Font& font) :
+    m_thread(&Preloader::run, this),
+    m_font  (font),
+    m_busy  (false)
+    {
+        // FreeType rasterizes on the stack
+        m_thread.setStackSize(64 * 1024);
+    }
+
+    ~Preloader()
+    {
+        // Drop the pending glyphs, and let the worker finish the current one
+        {
+            Lock lock(m_mutex);
+            m_pending.clear();
+        }
+        m_thread.wait();
+    }
+
+    void add(std::vector<StagedGlyph>& glyphs)
+    {
+        Lock lock(m_mutex);
+        m_pending.insert(m_pending.end(), glyphs.begin(), glyphs.end());
+
+        // The worker exits when it runs out of glyphs, relaunch it
+        if (!m_busy && !m_pending.empty())
+        {
+            m_busy = true;
+            m_thread.launch();
+        }
+    }
+
+    void takeStaged(std::vector<StagedGlyph>& glyphs)
+    {
+        Lock lock(m_mutex);
+        glyphs.swap(m_staged);
+    }
+
+    bool isIdle() const
+    {
+        Lock lock(m_mutex);
+        return !m_busy && m_staged.empty();
+    }
+
+private:
+
+    void run()
+    {
+        for (;;)
+        {
+            StagedGlyph glyph;
+            {
+                Lock lock(m_mutex);
+                if (m_pending.empty())
+                {
+                    m_busy = false;
+                    return;
+                }
+                glyph = m_pending.front();
+                m_pending.pop_front();
+            }
+
+            // Failures are staged too, so that getGlyph doesn't retry them
+            m_font.rasterizeGlyph(glyph.codePoint, glyph.characterSize, glyph.bold, glyph.outlineThickness, glyph.glyph, glyph.alpha);
+
+            Lock lock(m_mutex);
+            m_staged.push_back(StagedGlyph());
+            std::swap(m_staged.back(), glyph);
+        }
+    }
+
+    Thread                   m_thread;  ///< Worker thread
+    const Font&              m_font;    ///< Font owning the face
+    mutable Mutex            m_mutex;   ///< Protects everything below
+    std::deque<StagedGlyph>  m_pending; ///< Glyphs left to rasterize
+    std::vector<StagedGlyph> m_staged;  ///< Glyphs rasterized, waiting to be published
+    bool                     m_busy;    ///< Is the worker thread running?
+};
+
+
+////////////////////////////////////////////////////////////
+// Static member data
+////////////////////////////////////////////////////////////
+const unsigned int Font::DistanceFieldSize   = 32;
+const unsigned int Font::DistanceFieldSpread = 4;
+
+
 ////////////////////////////////////////////////////////////
 Font::Font() :
-        m_library  (NULL),
-        m_face     (NULL),
-        m_streamRec(NULL),
-        m_refCount (NULL),
-        m_info     ()
+        m_data        (NULL),
+        m_preloader   (NULL),
+        m_info        (),
+        m_bakedAtlases(),
+        m_lastAtlas   (NULL),
+        m_lastSize    (0)
 {
 }
 
 
 ////////////////////////////////////////////////////////////
 Font::Font(const Font& copy) :
-        m_library    (copy.m_library),
-        m_face       (copy.m_face),
-        m_streamRec  (copy.m_streamRec),
-        m_refCount   (copy.m_refCount),
-        m_info       (copy.m_info),
-        m_pages      (copy.m_pages),
-        m_pixelBuffer(copy.m_pixelBuffer)
+        m_data        (copy.m_data),
+        m_preloader   (NULL),
+        m_info        (copy.m_info),
+        m_bakedAtlases(copy.m_bakedAtlases),
+        m_lastAtlas   (NULL),
+        m_lastSize    (0),
+        m_pixelBuffer (copy.m_pixelBuffer)
 {
 
     // Note: as FreeType doesn't provide functions for copying/cloning,
-    // we must share all the FreeType pointers
+    // we must share the face, and its glyphs along with it
 
-    if (m_refCount)
-        (*m_refCount)++;
+    if (m_data)
+    {
+        Lock lock(getLibraryMutex());
+        m_data->refCount++;
+    }
 }
 
 
@@ -106,49 +495,60 @@ bool Font::loadFromFile(const std::string& filename)
 {
     // Cleanup the previous resources
     cleanup();
-    m_refCount = new int(1);
 
-    // Initialize FreeType
-    // Note: we initialize FreeType for every font instance in order to avoid having a single
-    // global manager that would create a lot of issues regarding creation and destruction order.
-    FT_Library library;
-    if (FT_Init_FreeType(&library) != 0)
+    std::string path = FileSystem::getFilePath(filename);
+    Lock lock(getLibraryMutex());
+
+    // Share the face of the fonts already loaded from this file
+    m_data = FaceData::share("file:" + path);
+    if (m_data)
+    {
+        m_info.family = m_data->getFamily();
+        return true;
+    }
+
+    // Get the FreeType library, shared by all the fonts
+    FaceData* data = new FaceData;
+    data->library = acquireLibrary();
+    if (!data->library)
     {
         err() << "Failed to load font \"" << filename << "\" (failed to initialize FreeType)" << std::endl;
+        delete data;
         return false;
     }
-    m_library = library;
 
     // Load the new font face from the specified file
-    FT_Face face;
-    if (FT_New_Face(static_cast<FT_Library>(m_library), FileSystem::getFilePath(filename).c_str(), 0, &face) != 0)
+    if (FT_New_Face(data->library, path.c_str(), 0, &data->face) != 0)
     {
         err() << "Failed to load font \"" << filename << "\" (failed to create the font face)" << std::endl;
+        data->face = NULL;
+        delete data;
         return false;
     }
 
     // Load the stroker that will be used to outline the font
-    FT_Stroker stroker;
-    if (FT_Stroker_New(static_cast<FT_Library>(m_library), &stroker) != 0)
+    if (FT_Stroker_New(data->library, &data->stroker) != 0)
     {
         err() << "Failed to load font \"" << filename << "\" (failed to create the stroker)" << std::endl;
+        data->stroker = NULL;
+        delete data;
         return false;
     }
-    m_stroker = stroker;
 
     // Select the unicode character map
-    if (FT_Select_Charmap(face, FT_ENCODING_UNICODE) != 0)
+    if (FT_Select_Charmap(data->face, FT_ENCODING_UNICODE) != 0)
     {
         err() << "Failed to load font \"" << filename << "\" (failed to set the Unicode character set)" << std::endl;
-        FT_Done_Face(face);
+        delete data;
         return false;
     }
 
-    // Store the loaded font in our ugly void* :)
-    m_face = face;
+    // Let the next fonts loaded from this file share the face
+    data->setSource("file:" + path);
+    m_data = data;
 
     // Store the font information
-    m_info.family = face->family_name ? face->family_name : std::string();
+    m_info.family = m_data->getFamily();
 
     return true;
 }
@@ -159,49 +559,63 @@ bool Font::loadFromMemory(const void* data, std::size_t sizeInBytes)
 {
     // Cleanup the previous resources
     cleanup();
-    m_refCount = new int(1);
 
-    // Initialize FreeType
-    // Note: we initialize FreeType for every font instance in order to avoid having a single
-    // global manager that would create a lot of issues regarding creation and destruction order.
-    FT_Library library;
-    if (FT_Init_FreeType(&library) != 0)
+    // The buffer must stay valid as long as the face is used,
+    // so its address identifies it
+    std::ostringstream source;
+    source << "memory:" << data << ":" << sizeInBytes;
+    Lock lock(getLibraryMutex());
+
+    // Share the face of the fonts already loaded from this buffer
+    m_data = FaceData::share(source.str());
+    if (m_data)
+    {
+        m_info.family = m_data->getFamily();
+        return true;
+    }
+
+    // Get the FreeType library, shared by all the fonts
+    FaceData* faceData = new FaceData;
+    faceData->library = acquireLibrary();
+    if (!faceData->library)
     {
         err() << "Failed to load font from memory (failed to initialize FreeType)" << std::endl;
+        delete faceData;
         return false;
     }
-    m_library = library;
 
     // Load the new font face from the specified file
-    FT_Face face;
-    if (FT_New_Memory_Face(static_cast<FT_Library>(m_library), reinterpret_cast<const FT_Byte*>(data), static_cast<FT_Long>(sizeInBytes), 0, &face) != 0)
+    if (FT_New_Memory_Face(faceData->library, reinterpret_cast<const FT_Byte*>(data), static_cast<FT_Long>(sizeInBytes), 0, &faceData->face) != 0)
     {
         err() << "Failed to load font from memory (failed to create the font face)" << std::endl;
+        faceData->face = NULL;
+        delete faceData;
         return false;
     }
 
     // Load the stroker that will be used to outline the font
-    FT_Stroker stroker;
-    if (FT_Stroker_New(static_cast<FT_Library>(m_library), &stroker) != 0)
+    if (FT_Stroker_New(faceData->library, &faceData->stroker) != 0)
     {
         err() << "Failed to load font from memory (failed to create the stroker)" << std::endl;
+        faceData->stroker = NULL;
+        delete faceData;
         return false;
     }
-    m_stroker = stroker;
 
     // Select the Unicode character map
-    if (FT_Select_Charmap(face, FT_ENCODING_UNICODE) != 0)
+    if (FT_Select_Charmap(faceData->face, FT_ENCODING_UNICODE) != 0)
     {
         err() << "Failed to load font from memory (failed to set the Unicode character set)" << std::endl;
-        FT_Done_Face(face);
+        delete faceData;
         return false;
     }
 
-    // Store the loaded font in our ugly void* :)
-    m_face = face;
+    // Let the next fonts loaded from this buffer share the face
+    faceData->setSource(source.str());
+    m_data = faceData;
 
     // Store the font information
-    m_info.family = face->family_name ? face->family_name : std::string();
+    m_info.family = m_data->getFamily();
 
     return true;
 }
@@ -212,18 +626,18 @@ bool Font::loadFromStream(InputStream& stream)
 {
     // Cleanup the previous resources
     cleanup();
-    m_refCount = new int(1);
 
-    // Initialize FreeType
-    // Note: we initialize FreeType for every font instance in order to avoid having a single
-    // global manager that would create a lot of issues regarding creation and destruction order.
-    FT_Library library;
-    if (FT_Init_FreeType(&library) != 0)
+    Lock lock(getLibraryMutex());
+
+    // Get the FreeType library, shared by all the fonts
+    FaceData* data = new FaceData;
+    data->library = acquireLibrary();
+    if (!data->library)
     {
         err() << "Failed to load font from stream (failed to initialize FreeType)" << std::endl;
+        delete data;
         return false;
     }
-    m_library = library;
 
     // Make sure that the stream's reading position is at the beginning
     stream.seek(0);
@@ -245,43 +659,181 @@ bool Font::loadFromStream(InputStream& stream)
     args.driver = 0;
 
     // Load the new font face from the specified stream
-    FT_Face face;
-    if (FT_Open_Face(static_cast<FT_Library>(m_library), &args, 0, &face) != 0)
+    if (FT_Open_Face(data->library, &args, 0, &data->face) != 0)
     {
         err() << "Failed to load font from stream (failed to create the font face)" << std::endl;
+        data->face = NULL;
         delete rec;
+        delete data;
         return false;
     }
+    data->streamRec = rec;
 
     // Load the stroker that will be used to outline the font
-    FT_Stroker stroker;
-    if (FT_Stroker_New(static_cast<FT_Library>(m_library), &stroker) != 0)
+    if (FT_Stroker_New(data->library, &data->stroker) != 0)
     {
         err() << "Failed to load font from stream (failed to create the stroker)" << std::endl;
+        data->stroker = NULL;
+        delete data;
         return false;
     }
-    m_stroker = stroker;
 
     // Select the Unicode character map
-    if (FT_Select_Charmap(face, FT_ENCODING_UNICODE) != 0)
+    if (FT_Select_Charmap(data->face, FT_ENCODING_UNICODE) != 0)
     {
         err() << "Failed to load font from stream (failed to set the Unicode character set)" << std::endl;
-        FT_Done_Face(face);
-        delete rec;
+        delete data;
         return false;
     }
 
-    // Store the loaded font in our ugly void* :)
-    m_face = face;
-    m_streamRec = rec;
+    // Streams can't be told apart, the face is not shared
+    m_data = data;
 
     // Store the font information
-    m_info.family = face->family_name ? face->family_name : std::string();
+    m_info.family = m_data->getFamily();
 
     return true;
 }
 
 
+////////////////////////////////////////////////////////////
+bool Font::loadFromBakedAtlas(const void* data, std::size_t sizeInBytes)
+{
+    BakedReader reader(data, sizeInBytes);
+
+    const Uint8* magic = reader.readBytes(4);
+    Uint32 version, sizeCount, familyLength;
+    if (!magic || (std::memcmp(magic, "C3FB", 4) != 0) || !reader.read16(version) || (version != 1) ||
+        !reader.read16(sizeCount) || !reader.read16(familyLength))
+    {
+        err() << "Failed to load baked font atlas (invalid header)" << std::endl;
+        return false;
+    }
+
+    const Uint8* family = reader.readBytes(familyLength);
+    if (!family)
+    {
+        err() << "Failed to load baked font atlas (unexpected end of data)" << std::endl;
+        return false;
+    }
+
+    // Parse everything before touching the font, so that it is left
+    // unchanged if the data is invalid
+    AtlasTable atlases;
+    std::vector<Uint8> pixels;
+    for (Uint32 i = 0; i < sizeCount; ++i)
+    {
+        Uint32 characterSize, flags, pageCount, glyphCount, kerningCount;
+        float lineSpacing, underlinePosition, underlineThickness;
+        if (!reader.read16(characterSize) || !reader.read16(flags) || !reader.readFloat(lineSpacing) ||
+            !reader.readFloat(underlinePosition) || !reader.readFloat(underlineThickness) ||
+            !reader.read16(pageCount) || !reader.read32(glyphCount) || !reader.read32(kerningCount))
+        {
+            err() << "Failed to load baked font atlas (unexpected end of data)" << std::endl;
+            return false;
+        }
+
+        Atlas& atlas = atlases[characterSize];
+        atlas.baked              = true;
+        atlas.bakedKerning       = (flags & 1) != 0;
+        atlas.lineSpacing        = lineSpacing;
+        atlas.underlinePosition  = underlinePosition;
+        atlas.underlineThickness = underlineThickness;
+
+        // Baked pages are full, missing glyphs go to new pages
+        for (Uint32 p = 0; p < pageCount; ++p)
+        {
+            Uint32 size;
+            const Uint8* alpha = reader.read16(size) ? reader.readBytes(size * size) : NULL;
+            if (!alpha || (size == 0) || (size > Texture::getMaximumSize()))
+            {
+                err() << "Failed to load baked font atlas (invalid page)" << std::endl;
+                return false;
+            }
+
+            // The color channels remain white, just fill the alpha channel
+            pixels.assign(size * size * 4, 255);
+            for (std::size_t j = 0; j < size * size; ++j)
+                pixels[j * 4 + 3] = alpha[j];
+
+            Image image;
+            image.create(size, size, &pixels[0]);
+            atlas.pages.emplace_back(image);
+        }
+
+        for (Uint32 g = 0; g < glyphCount; ++g)
+        {
+            Uint32 codePoint, bold, page, left, top, width, height;
+            Glyph glyph;
+            if (!reader.read32(codePoint) || !reader.read16(bold) || !reader.read16(page) ||
+                !reader.readFloat(glyph.advance) ||
+                !reader.readFloat(glyph.bounds.left) || !reader.readFloat(glyph.bounds.top) ||
+                !reader.readFloat(glyph.bounds.width) || !reader.readFloat(glyph.bounds.height) ||
+                !reader.read16(left) || !reader.read16(top) || !reader.read16(width) || !reader.read16(height) ||
+                (page >= pageCount))
+            {
+                err() << "Failed to load baked font atlas (invalid glyph)" << std::endl;
+                return false;
+            }
+
+            glyph.page        = page;
+            glyph.textureRect = IntRect(left, top, width, height);
+
+            atlas.glyphs.insert(getGlyphKey(codePoint, bold != 0, 0.f), glyph);
+        }
+
+        for (Uint32 k = 0; k < kerningCount; ++k)
+        {
+            Uint32 first, second;
+            float offset;
+            if (!reader.read32(first) || !reader.read32(second) || !reader.readFloat(offset))
+            {
+                err() << "Failed to load baked font atlas (unexpected end of data)" << std::endl;
+                return false;
+            }
+            atlas.kerning.insert(kerningKey(first, second), offset);
+        }
+    }
+
+    // Fonts without a face only hold baked glyphs
+    if (!m_data)
+        m_data = new FaceData;
+
+    // Replace the glyphs of the baked sizes, keep the font face as fallback.
+    // The face may be shared with other fonts, so the baked glyphs are kept
+    // apart from its atlases.
+    for (AtlasTable::iterator it = atlases.begin(); it != atlases.end(); ++it)
+        std::swap(m_bakedAtlases[it->first], it->second);
+    m_lastAtlas = NULL;
+
+    if (!m_data->face)
+        m_info.family = std::string(reinterpret_cast<const char*>(family), familyLength);
+
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////
+bool Font::loadFromBakedAtlas(const std::string& filename)
+{
+    std::ifstream file(FileSystem::getFilePath(filename).c_str(), std::ios::binary);
+    if (!file)
+    {
+        err() << "Failed to load baked font atlas \"" << filename << "\" (couldn't open the file)" << std::endl;
+        return false;
+    }
+
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.empty())
+    {
+        err() << "Failed to load baked font atlas \"" << filename << "\" (empty file)" << std::endl;
+        return false;
+    }
+
+    return loadFromBakedAtlas(&data[0], data.size());
+}
+
+
 ////////////////////////////////////////////////////////////
 const Font::Info& Font::getInfo() const
 {
@@ -292,30 +844,78 @@ const Font::Info& Font::getInfo() const
 ////////////////////////////////////////////////////////////
 const Glyph& Font::getGlyph(Uint32 codePoint, unsigned int characterSize, bool bold, float outlineThickness) const
 {
-    // Get the page corresponding to the character size
-    GlyphTable& glyphs = m_pages[characterSize].glyphs;
+    // Get the glyphs corresponding to the character size
+    GlyphTable& glyphs = getAtlas(characterSize).glyphs;
 
     // Build the key by combining the code point, bold flag, and outline thickness
-    Uint64 key = (static_cast<Uint64>(*reinterpret_cast<Uint32*>(&outlineThickness)) << 32)
-                 | (static_cast<Uint64>(bold ? 1 : 0) << 31)
-                 |  static_cast<Uint64>(codePoint);
+    Uint64 key = getGlyphKey(codePoint, bold, outlineThickness);
 
     // Search the glyph into the cache
-    GlyphTable::const_iterator it = glyphs.find(key);
-    if (it != glyphs.end())
+    if (const Glyph* found = glyphs.find(key))
     {
         // Found: just return it
-        return it->second;
+        return *found;
     }
     else
     {
         // Not found: we have to load it
         Glyph glyph = loadGlyph(codePoint, characterSize, bold, outlineThickness);
-        return glyphs.insert(std::make_pair(key, glyph)).first->second;
+        return glyphs.insert(key, glyph);
     }
 }
 
 
+////////////////////////////////////////////////////////////
+void Font::preloadGlyphs(const String& characters, unsigned int characterSize, bool bold, float outlineThickness)
+{
+    std::vector<StagedGlyph> glyphs;
+    collectMissingGlyphs(characters, characterSize, bold, outlineThickness, glyphs);
+
+    for (std::vector<StagedGlyph>::iterator it = glyphs.begin(); it != glyphs.end(); ++it)
+        rasterizeGlyph(it->codePoint, it->characterSize, it->bold, it->outlineThickness, it->glyph, it->alpha);
+
+    publishGlyphs(glyphs);
+}
+
+
+////////////////////////////////////////////////////////////
+void Font::preloadGlyphsAsync(const String& characters, unsigned int characterSize, bool bold, float outlineThickness)
+{
+    // Without a face, missing glyphs can't be rasterized anyway
+    if (!m_data || !m_data->face)
+        return;
+
+    std::vector<StagedGlyph> glyphs;
+    collectMissingGlyphs(characters, characterSize, bold, outlineThickness, glyphs);
+    if (glyphs.empty())
+        return;
+
+    if (!m_preloader)
+        m_preloader = new Preloader(*this);
+    m_preloader->add(glyphs);
+}
+
+
+////////////////////////////////////////////////////////////
+unsigned int Font::publishPreloadedGlyphs()
+{
+    if (!m_preloader)
+        return 0;
+
+    std::vector<StagedGlyph> glyphs;
+    m_preloader->takeStaged(glyphs);
+
+    return publishGlyphs(glyphs);
+}
+
+
+////////////////////////////////////////////////////////////
+bool Font::isPreloading() const
+{
+    return m_preloader && !m_preloader->isIdle();
+}
+
+
 ////////////////////////////////////////////////////////////
 float Font::getKerning(Uint32 first, Uint32 second, unsigned int characterSize) const
 {
@@ -323,24 +923,38 @@ float Font::getKerning(Uint32 first, Uint32 second, unsigned int characterSize)
     if (first == 0 || second == 0)
         return 0.f;
 
-    FT_Face face = static_cast<FT_Face>(m_face);
+    // Pairs already seen, or baked, don't need FreeType
+    Atlas& atlas = getAtlas(characterSize);
+    Uint64 key = kerningKey(first, second);
+    if (const float* kerning = atlas.kerning.find(key))
+        return *kerning;
+
+    // Baked pairs missing from the table have no kerning. Kerning only applies
+    // to regular glyphs, so they are enough to tell if both code points were baked.
+    if (atlas.bakedKerning && atlas.glyphs.find(first) && atlas.glyphs.find(second))
+        return 0.f;
+
+    // The face may be shared with a preloading thread
+    Lock lock(m_data->mutex);
+    FT_Face face = m_data->face;
 
     if (face && FT_HAS_KERNING(face) && setCurrentSize(characterSize))
     {
         // Convert the characters to indices
-        FT_UInt index1 = FT_Get_Char_Index(face, first);
-        FT_UInt index2 = FT_Get_Char_Index(face, second);
+        FT_UInt index1 = getCharIndex(first);
+        FT_UInt index2 = getCharIndex(second);
 
         // Get the kerning vector
         FT_Vector kerning;
         FT_Get_Kerning(face, index1, index2, FT_KERNING_DEFAULT, &kerning);
 
         // X advance is already in pixels for bitmap fonts
-        if (!FT_IS_SCALABLE(face))
-            return static_cast<float>(kerning.x);
+        float offset = static_cast<float>(kerning.x);
+        if (FT_IS_SCALABLE(face))
+            offset /= static_cast<float>(1 << 6);
 
-        // Return the X advance
-        return static_cast<float>(kerning.x) / static_cast<float>(1 << 6);
+        // Remember the pair, zero offsets included as they are the most common
+        return atlas.kerning.insert(key, offset);
     }
     else
     {
@@ -353,7 +967,16 @@ float Font::getKerning(Uint32 first, Uint32 second, unsigned int characterSize)
 ////////////////////////////////////////////////////////////
 float Font::getLineSpacing(unsigned int characterSize) const
 {
-    FT_Face face = static_cast<FT_Face>(m_face);
+    if (!m_data)
+        return 0.f;
+
+    const Atlas* atlas = findAtlas(characterSize);
+    if (atlas && atlas->baked)
+        return atlas->lineSpacing;
+
+    // The face may be shared with a preloading thread
+    Lock lock(m_data->mutex);
+    FT_Face face = m_data->face;
 
     if (face && setCurrentSize(characterSize))
     {
@@ -369,7 +992,16 @@ float Font::getLineSpacing(unsigned int characterSize) const
 ////////////////////////////////////////////////////////////
 float Font::getUnderlinePosition(unsigned int characterSize) const
 {
-    FT_Face face = static_cast<FT_Face>(m_face);
+    if (!m_data)
+        return 0.f;
+
+    const Atlas* atlas = findAtlas(characterSize);
+    if (atlas && atlas->baked)
+        return atlas->underlinePosition;
+
+    // The face may be shared with a preloading thread
+    Lock lock(m_data->mutex);
+    FT_Face face = m_data->face;
 
     if (face && setCurrentSize(characterSize))
     {
@@ -389,7 +1021,16 @@ float Font::getUnderlinePosition(unsigned int characterSize) const
 ////////////////////////////////////////////////////////////
 float Font::getUnderlineThickness(unsigned int characterSize) const
 {
-    FT_Face face = static_cast<FT_Face>(m_face);
+    if (!m_data)
+        return 0.f;
+
+    const Atlas* atlas = findAtlas(characterSize);
+    if (atlas && atlas->baked)
+        return atlas->underlineThickness;
+
+    // The face may be shared with a preloading thread
+    Lock lock(m_data->mutex);
+    FT_Face face = m_data->face;
 
     if (face && setCurrentSize(characterSize))
     {
@@ -407,69 +1048,108 @@ float Font::getUnderlineThickness(unsigned int characterSize) const
 
 
 ////////////////////////////////////////////////////////////
-const Texture& Font::getTexture(unsigned int characterSize) const
+const Texture& Font::getTexture(unsigned int characterSize, unsigned int page) const
 {
-    return m_pages[characterSize].texture;
+    std::deque<Page>& pages = getAtlas(characterSize).pages;
+    if (pages.empty())
+        pages.emplace_back();
+
+    return pages[std::min<std::size_t>(page, pages.size() - 1)].texture;
 }
 
 
 ////////////////////////////////////////////////////////////
-Font& Font::operator =(const Font& right)
+const Glyph& Font::getDistanceFieldGlyph(Uint32 codePoint, bool bold) const
 {
-    Font temp(right);
+    Atlas& atlas = getAtlas(distanceFieldAtlas);
+    Uint64 key = getGlyphKey(codePoint, bold, 0.f);
 
-    std::swap(m_library,     temp.m_library);
-    std::swap(m_face,        temp.m_face);
-    std::swap(m_streamRec,   temp.m_streamRec);
-    std::swap(m_refCount,    temp.m_refCount);
-    std::swap(m_info,        temp.m_info);
-    std::swap(m_pages,       temp.m_pages);
-    std::swap(m_pixelBuffer, temp.m_pixelBuffer);
+    if (const Glyph* found = atlas.glyphs.find(key))
+        return *found;
 
-    return *this;
+    // Rasterized once, whatever the size the glyph is drawn at
+    Glyph glyph;
+    std::vector<Uint8> alpha;
+    if (rasterizeDistanceField(codePoint, bold, glyph, alpha))
+        writeGlyph(atlas, glyph, alpha);
+
+    return atlas.glyphs.insert(key, glyph);
 }
 
 
 ////////////////////////////////////////////////////////////
-void Font::cleanup()
+const Texture& Font::getDistanceFieldTexture(unsigned int page) const
 {
-    // Check if we must destroy the FreeType pointers
-    if (m_refCount)
-    {
-        // Decrease the reference counter
-        (*m_refCount)--;
+    return getTexture(distanceFieldAtlas, page);
+}
 
-        // Free the resources only if we are the last owner
-        if (*m_refCount == 0)
-        {
-            // Delete the reference counter
-            delete m_refCount;
 
-            // Destroy the stroker
-            if (m_stroker)
-                FT_Stroker_Done(static_cast<FT_Stroker>(m_stroker));
+////////////////////////////////////////////////////////////
+unsigned int Font::getPageCount(unsigned int characterSize) const
+{
+    if (!m_data)
+        return 0;
 
-            // Destroy the font face
-            if (m_face)
-                FT_Done_Face(static_cast<FT_Face>(m_face));
+    const Atlas* atlas = findAtlas(characterSize);
+    return atlas ? static_cast<unsigned int>(atlas->pages.size()) : 0;
+}
 
-            // Destroy the stream rec instance, if any (must be done after FT_Done_Face!)
-            if (m_streamRec)
-                delete static_cast<FT_StreamRec*>(m_streamRec);
 
-            // Close the library
-            if (m_library)
-                FT_Done_FreeType(static_cast<FT_Library>(m_library));
-        }
+////////////////////////////////////////////////////////////
+std::size_t Font::getMemoryUsage() const
+{
+    if (!m_data)
+        return 0;
+
+    std::size_t size = 0;
+    const AtlasTable* tables[] = {&m_data->atlases, &m_bakedAtlases};
+    for (std::size_t i = 0; i < 2; ++i)
+        for (AtlasTable::const_iterator it = tables[i]->begin(); it != tables[i]->end(); ++it)
+            for (std::deque<Page>::const_iterator page = it->second.pages.begin(); page != it->second.pages.end(); ++page)
+                size += page->texture.getMemoryUsage();
+    return size;
+}
+
+
+////////////////////////////////////////////////////////////
+Font& Font::operator =(const Font& right)
+{
+    Font temp(right);
+
+    // The preloader works on the face being replaced
+    delete m_preloader;
+    m_preloader = NULL;
+
+    std::swap(m_data,         temp.m_data);
+    std::swap(m_info,         temp.m_info);
+    std::swap(m_bakedAtlases, temp.m_bakedAtlases);
+    std::swap(m_lastAtlas,    temp.m_lastAtlas);
+    std::swap(m_lastSize,     temp.m_lastSize);
+    std::swap(m_pixelBuffer,  temp.m_pixelBuffer);
+
+    return *this;
+}
+
+
+////////////////////////////////////////////////////////////
+void Font::cleanup()
+{
+    // Stop rasterizing glyphs before the face goes away
+    delete m_preloader;
+    m_preloader = NULL;
+
+    // Destroy the face and its glyphs only if we are the last owner
+    if (m_data)
+    {
+        Lock lock(getLibraryMutex());
+        if (--m_data->refCount == 0)
+            delete m_data;
     }
 
     // Reset members
-    m_library   = NULL;
-    m_face      = NULL;
-    m_stroker   = NULL;
-    m_streamRec = NULL;
-    m_refCount  = NULL;
-    m_pages.clear();
+    m_data      = NULL;
+    m_lastAtlas = NULL;
+    m_bakedAtlases.clear();
     m_pixelBuffer.clear();
 }
 
@@ -477,29 +1157,81 @@ void Font::cleanup()
 ////////////////////////////////////////////////////////////
 Glyph Font::loadGlyph(Uint32 codePoint, unsigned int characterSize, bool bold, float outlineThickness) const
 {
+    CPP3DS_TRACE_ZONE("Graphics", "Font::loadGlyph");
+
     // The glyph to return
     Glyph glyph;
 
-    // First, transform our ugly void* to a FT_Face
-    FT_Face face = static_cast<FT_Face>(m_face);
-    if (!face)
+    std::vector<Uint8> alpha;
+    if (!rasterizeGlyph(codePoint, characterSize, bold, outlineThickness, glyph, alpha))
         return glyph;
 
+    // Find a good position for the new glyph into the pages, and write its pixels
+    writeGlyph(getAtlas(characterSize), glyph, alpha);
+
+    // Done :)
+    return glyph;
+}
+
+
+////////////////////////////////////////////////////////////
+void Font::writeGlyph(Atlas& atlas, Glyph& glyph, const std::vector<Uint8>& alpha) const
+{
+    int width  = glyph.textureRect.width;
+    int height = glyph.textureRect.height;
+
+    if ((width <= 0) || (height <= 0))
+        return;
+
+    // Find a good position for the new glyph into the pages
+    placeGlyph(atlas, glyph);
+
+    // The color channels remain white, just fill the alpha channel
+    m_pixelBuffer.resize(width * height * 4, 255);
+    for (int i = 0; i < width * height; ++i)
+        m_pixelBuffer[i * 4 + 3] = alpha[i];
+
+    // Write the pixels to the texture
+    unsigned int x = glyph.textureRect.left;
+    unsigned int y = glyph.textureRect.top;
+    unsigned int w = glyph.textureRect.width;
+    unsigned int h = glyph.textureRect.height;
+    atlas.pages[glyph.page].texture.update(&m_pixelBuffer[0], w, h, x, y);
+
+    // Force an OpenGL flush, so that the font's texture will appear updated
+    // in all contexts immediately (solves problems in multi-threaded apps)
+#ifdef EMULATION
+    glCheck(glFlush());
+#endif
+}
+
+
+////////////////////////////////////////////////////////////
+bool Font::rasterizeGlyph(Uint32 codePoint, unsigned int characterSize, bool bold, float outlineThickness,
+                          Glyph& glyph, std::vector<Uint8>& alpha) const
+{
+    if (!m_data || !m_data->face)
+        return false;
+
+    // The face may be shared with a preloading thread
+    FT_Face face = m_data->face;
+    Lock lock(m_data->mutex);
+
     // Set the character size
     if (!setCurrentSize(characterSize))
-        return glyph;
+        return false;
 
     // Load the glyph corresponding to the code point
     FT_Int32 flags = FT_LOAD_TARGET_NORMAL | FT_LOAD_FORCE_AUTOHINT;
     if (outlineThickness != 0)
         flags |= FT_LOAD_NO_BITMAP;
     if (FT_Load_Char(face, codePoint, flags) != 0)
-        return glyph;
+        return false;
 
     // Retrieve the glyph
     FT_Glyph glyphDesc;
     if (FT_Get_Glyph(face->glyph, &glyphDesc) != 0)
-        return glyph;
+        return false;
 
     // Apply bold and outline (there is no fallback for outline) if necessary -- first technique using outline (highest quality)
     FT_Pos weight = 1 << 6;
@@ -514,7 +1246,7 @@ Glyph Font::loadGlyph(Uint32 codePoint, unsigned int characterSize, bool bold, f
 
         if (outlineThickness != 0)
         {
-            FT_Stroker stroker = static_cast<FT_Stroker>(m_stroker);
+            FT_Stroker stroker = m_data->stroker;
 
             FT_Stroker_Set(stroker, static_cast<FT_Fixed>(outlineThickness * static_cast<float>(1 << 6)), FT_STROKER_LINECAP_ROUND, FT_STROKER_LINEJOIN_ROUND, 0);
             FT_Glyph_Stroke(&glyphDesc, stroker, false);
@@ -529,7 +1261,7 @@ Glyph Font::loadGlyph(Uint32 codePoint, unsigned int characterSize, bool bold, f
     if (!outline)
     {
         if (bold)
-            FT_Bitmap_Embolden(static_cast<FT_Library>(m_library), &bitmap, weight, weight);
+            FT_Bitmap_Embolden(m_data->library, &bitmap, weight, weight);
 
         if (outlineThickness != 0)
             err() << "Failed to outline glyph (no fallback available)" << std::endl;
@@ -545,22 +1277,8 @@ Glyph Font::loadGlyph(Uint32 codePoint, unsigned int characterSize, bool bold, f
 
     if ((width > 0) && (height > 0))
     {
-        // Leave a small padding around characters, so that filtering doesn't
-        // pollute them with pixels from neighbors
-        const unsigned int padding = 1;
-
-        // Get the glyphs page corresponding to the character size
-        Page& page = m_pages[characterSize];
-
-        // Find a good position for the new glyph into the texture
-        glyph.textureRect = findGlyphRect(page, width + 2 * padding, height + 2 * padding);
-
-        // Make sure the texture data is positioned in the center
-        // of the allocated texture rectangle
-        glyph.textureRect.left += padding;
-        glyph.textureRect.top += padding;
-        glyph.textureRect.width -= 2 * padding;
-        glyph.textureRect.height -= 2 * padding;
+        // The position in the pages is chosen by the caller
+        glyph.textureRect = IntRect(0, 0, width, height);
 
         // Compute the glyph's bounding box
         glyph.bounds.left   =  static_cast<float>(face->glyph->metrics.horiBearingX) / static_cast<float>(1 << 6);
@@ -569,7 +1287,7 @@ Glyph Font::loadGlyph(Uint32 codePoint, unsigned int characterSize, bool bold, f
         glyph.bounds.height =  static_cast<float>(face->glyph->metrics.height)       / static_cast<float>(1 << 6) + outlineThickness * 2;
 
         // Extract the glyph's pixels from the bitmap
-        m_pixelBuffer.resize(width * height * 4, 255);
+        alpha.resize(width * height);
         const Uint8* pixels = bitmap.buffer;
         if (bitmap.pixel_mode == FT_PIXEL_MODE_MONO)
         {
@@ -577,11 +1295,7 @@ Glyph Font::loadGlyph(Uint32 codePoint, unsigned int characterSize, bool bold, f
             for (int y = 0; y < height; ++y)
             {
                 for (int x = 0; x < width; ++x)
-                {
-                    // The color channels remain white, just fill the alpha channel
-                    std::size_t index = (x + y * width) * 4 + 3;
-                    m_pixelBuffer[index] = ((pixels[x / 8]) & (1 << (7 - (x % 8)))) ? 255 : 0;
-                }
+                    alpha[x + y * width] = ((pixels[x / 8]) & (1 << (7 - (x % 8)))) ? 255 : 0;
                 pixels += bitmap.pitch;
             }
         }
@@ -590,157 +1304,466 @@ Glyph Font::loadGlyph(Uint32 codePoint, unsigned int characterSize, bool bold, f
             // Pixels are 8 bits gray levels
             for (int y = 0; y < height; ++y)
             {
-                for (int x = 0; x < width; ++x)
-                {
-                    // The color channels remain white, just fill the alpha channel
-                    std::size_t index = (x + y * width) * 4 + 3;
-                    m_pixelBuffer[index] = pixels[x];
-                }
+                std::memcpy(&alpha[y * width], pixels, width);
                 pixels += bitmap.pitch;
             }
         }
-
-        // Write the pixels to the texture
-        unsigned int x = glyph.textureRect.left;
-        unsigned int y = glyph.textureRect.top;
-        unsigned int w = glyph.textureRect.width;
-        unsigned int h = glyph.textureRect.height;
-        page.texture.update(&m_pixelBuffer[0], w, h, x, y);
     }
 
     // Delete the FT glyph
     FT_Done_Glyph(glyphDesc);
 
-    // Force an OpenGL flush, so that the font's texture will appear updated
-    // in all contexts immediately (solves problems in multi-threaded apps)
-#ifdef EMULATION
-    glCheck(glFlush());
-#endif
-
-    // Done :)
-    return glyph;
+    return true;
 }
 
 
 ////////////////////////////////////////////////////////////
-IntRect Font::findGlyphRect(Page& page, unsigned int width, unsigned int height) const
+bool Font::rasterizeDistanceField(Uint32 codePoint, bool bold, Glyph& glyph, std::vector<Uint8>& alpha) const
 {
-    // Find the line that fits well the glyph
-    Row* row = NULL;
-    float bestRatio = 0;
-    for (std::vector<Row>::iterator it = page.rows.begin(); it != page.rows.end() && !row; ++it)
+    // Rasterize the glyph bigger than the atlas, so that the outline is precise
+    Glyph large;
+    std::vector<Uint8> coverage;
+    if (!rasterizeGlyph(codePoint, DistanceFieldSize * distanceFieldUpscale, bold, 0, large, coverage))
+        return false;
+
+    glyph.advance = large.advance / distanceFieldUpscale;
+
+    int largeWidth  = large.textureRect.width;
+    int largeHeight = large.textureRect.height;
+    if ((largeWidth <= 0) || (largeHeight <= 0))
+        return true;
+
+    // The field covers the glyph and a margin of the spread on each side, in whole texels
+    int margin = static_cast<int>(DistanceFieldSpread) * distanceFieldUpscale;
+    int width  = (largeWidth  + 2 * margin + distanceFieldUpscale - 1) / distanceFieldUpscale;
+    int height = (largeHeight + 2 * margin + distanceFieldUpscale - 1) / distanceFieldUpscale;
+    int gridWidth  = width  * distanceFieldUpscale;
+    int gridHeight = height * distanceFieldUpscale;
+
+    // Distances of each pixel to the nearest pixel inside, and outside, the glyph
+    std::vector<float> toInside(gridWidth * gridHeight, 1e20f);
+    std::vector<float> toOutside(gridWidth * gridHeight, 0.f);
+    for (int y = 0; y < largeHeight; ++y)
+    {
+        for (int x = 0; x < largeWidth; ++x)
+        {
+            if (coverage[x + y * largeWidth] >= 128)
+            {
+                std::size_t index = (x + margin) + (y + margin) * gridWidth;
+                toInside[index] = 0.f;
+                toOutside[index] = 1e20f;
+            }
+        }
+    }
+    transformGrid(toInside, gridWidth, gridHeight);
+    transformGrid(toOutside, gridWidth, gridHeight);
+
+    // Each texel gets the signed distance at its center, between four pixels of
+    // the grid, mapped so that the outline is at 128 and the inside is brighter
+    alpha.resize(width * height);
+    int center = distanceFieldUpscale / 2;
+    for (int y = 0; y < height; ++y)
     {
-        float ratio = static_cast<float>(height) / it->height;
+        for (int x = 0; x < width; ++x)
+        {
+            float distance = 0.f;
+            for (int j = center - 1; j <= center; ++j)
+            {
+                for (int i = center - 1; i <= center; ++i)
+                {
+                    std::size_t index = (x * distanceFieldUpscale + i) + (y * distanceFieldUpscale + j) * gridWidth;
+                    distance += std::sqrt(toInside[index]) - std::sqrt(toOutside[index]);
+                }
+            }
+            distance /= 4.f * distanceFieldUpscale;
 
-        // Ignore rows that are either too small or too high
-        if ((ratio < 0.7f) || (ratio > 1.f))
-            continue;
+            float value = 0.5f - distance / (2.f * DistanceFieldSpread);
+            alpha[x + y * width] = static_cast<Uint8>(std::min(std::max(value, 0.f), 1.f) * 255.f + 0.5f);
+        }
+    }
 
-        // Check if there's enough horizontal space left in the row
-        if (width > page.texture.getSize().x - it->width)
+    glyph.textureRect   = IntRect(0, 0, width, height);
+    glyph.bounds.left   = large.bounds.left / distanceFieldUpscale - DistanceFieldSpread;
+    glyph.bounds.top    = large.bounds.top  / distanceFieldUpscale - DistanceFieldSpread;
+    glyph.bounds.width  = static_cast<float>(width);
+    glyph.bounds.height = static_cast<float>(height);
+
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////
+void Font::placeGlyph(Atlas& atlas, Glyph& glyph) const
+{
+    // Leave a small padding around characters, so that filtering doesn't
+    // pollute them with pixels from neighbors
+    const unsigned int padding = 1;
+
+    IntRect rect = findGlyphRect(atlas, glyph.textureRect.width + 2 * padding, glyph.textureRect.height + 2 * padding, glyph.page);
+
+    // Make sure the texture data is positioned in the center
+    // of the allocated texture rectangle
+    glyph.textureRect.left   = rect.left + padding;
+    glyph.textureRect.top    = rect.top + padding;
+    glyph.textureRect.width  = rect.width - 2 * padding;
+    glyph.textureRect.height = rect.height - 2 * padding;
+}
+
+
+////////////////////////////////////////////////////////////
+void Font::collectMissingGlyphs(const String& characters, unsigned int characterSize, bool bold, float outlineThickness,
+                                std::vector<StagedGlyph>& glyphs) const
+{
+    const GlyphTable& table = getAtlas(characterSize).glyphs;
+    std::vector<Uint64> keys;
+
+    for (std::size_t i = 0; i < characters.getSize(); ++i)
+    {
+        Uint32 codePoint = characters[i];
+        Uint64 key = getGlyphKey(codePoint, bold, outlineThickness);
+        if (table.find(key) || (std::find(keys.begin(), keys.end(), key) != keys.end()))
             continue;
 
-        // Make sure that this new row is the best found so far
-        if (ratio < bestRatio)
+        keys.push_back(key);
+        glyphs.push_back(StagedGlyph());
+        glyphs.back().codePoint        = codePoint;
+        glyphs.back().characterSize    = characterSize;
+        glyphs.back().bold             = bold;
+        glyphs.back().outlineThickness = outlineThickness;
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+unsigned int Font::publishGlyphs(std::vector<StagedGlyph>& glyphs) const
+{
+    // Place the new glyphs, grouped by page texture
+    typedef std::map<std::pair<unsigned int, unsigned int>, std::vector<const StagedGlyph*> > PageBatches;
+    PageBatches batches;
+    unsigned int count = 0;
+
+    for (std::vector<StagedGlyph>::iterator it = glyphs.begin(); it != glyphs.end(); ++it)
+    {
+        // The glyph may have been loaded by getGlyph meanwhile
+        Atlas& atlas = getAtlas(it->characterSize);
+        Uint64 key = getGlyphKey(it->codePoint, it->bold, it->outlineThickness);
+        if (atlas.glyphs.find(key))
             continue;
 
-        // The current row passed all the tests: we can select it
-        row = &*it;
-        bestRatio = ratio;
+        if ((it->glyph.textureRect.width > 0) && (it->glyph.textureRect.height > 0))
+        {
+            placeGlyph(atlas, it->glyph);
+            batches[std::make_pair(it->characterSize, it->glyph.page)].push_back(&*it);
+        }
+
+        atlas.glyphs.insert(key, it->glyph);
+        ++count;
     }
 
-    // If we didn't find a matching row, create a new one (10% taller than the glyph)
-    if (!row)
+    // Upload each page once, only the blocks of the new glyphs are copied
+    std::vector<Uint8> pixels;
+    std::vector<IntRect> regions;
+    for (PageBatches::const_iterator batch = batches.begin(); batch != batches.end(); ++batch)
     {
-        int rowHeight = height + height / 10;
-        while ((page.nextRow + rowHeight >= page.texture.getSize().y) || (width >= page.texture.getSize().x))
+        Texture& texture = getAtlas(batch->first.first).pages[batch->first.second].texture;
+        Vector2u size = texture.getSize();
+
+        pixels.assign(size.x * size.y * 4, 255);
+        regions.clear();
+        for (std::vector<const StagedGlyph*>::const_iterator it = batch->second.begin(); it != batch->second.end(); ++it)
         {
-            // Not enough space: resize the texture if possible
-            unsigned int textureWidth  = page.texture.getSize().x;
-            unsigned int textureHeight = page.texture.getSize().y;
-            if ((textureWidth * 2 <= Texture::getMaximumSize()) && (textureHeight * 2 <= Texture::getMaximumSize()))
-            {
-                // Make the texture 2 times bigger
-                Image newImage;
-                newImage.create(textureWidth * 2, textureHeight * 2, Color(255, 255, 255, 0));
-                newImage.copy(page.texture.copyToImage(), 0, 0);
-                page.texture.loadFromImage(newImage);
-            }
-            else
-            {
-                // Oops, we've reached the maximum texture size...
-                err() << "Failed to add a new character to the font: the maximum texture size has been reached" << std::endl;
-                return IntRect(0, 0, 2, 2);
-            }
+            const IntRect& rect = (*it)->glyph.textureRect;
+            for (int y = 0; y < rect.height; ++y)
+                for (int x = 0; x < rect.width; ++x)
+                    pixels[((rect.top + y) * size.x + rect.left + x) * 4 + 3] = (*it)->alpha[y * rect.width + x];
+            regions.push_back(rect);
         }
 
-        // We can now create the new row
-        page.rows.push_back(Row(page.nextRow, rowHeight));
-        page.nextRow += rowHeight;
-        row = &page.rows.back();
+        texture.updateRegions(&pixels[0], regions);
     }
 
-    // Find the glyph's rectangle on the selected row
-    IntRect rect(row->width, row->top, width, height);
+#ifdef EMULATION
+    if (!batches.empty())
+    {
+        glCheck(glFlush());
+    }
+#endif
+
+    return count;
+}
 
-    // Update the row informations
-    row->width += width;
 
+////////////////////////////////////////////////////////////
+IntRect Font::findGlyphRect(Atlas& atlas, unsigned int width, unsigned int height, unsigned int& pageIndex) const
+{
+    IntRect rect;
+    for (pageIndex = 0; pageIndex < atlas.pages.size(); ++pageIndex)
+        if (insertRect(atlas.pages[pageIndex], width, height, rect))
+            return rect;
+
+    // No room left: add a page, bigger than usual if the glyph needs it.
+    // The existing pages are left untouched.
+    unsigned int size = 256;
+    while (((width + 3 > size) || (height + 3 > size)) && (size < Texture::getMaximumSize()))
+        size *= 2;
+
+    atlas.pages.emplace_back(size);
+    if (!insertRect(atlas.pages.back(), width, height, rect))
+    {
+        // Oops, the glyph is bigger than the maximum texture size...
+        err() << "Failed to add a new character to the font: the maximum texture size has been reached" << std::endl;
+        pageIndex = 0;
+        return IntRect(0, 0, 2, 2);
+    }
+
+    pageIndex = static_cast<unsigned int>(atlas.pages.size() - 1);
     return rect;
 }
 
 
 ////////////////////////////////////////////////////////////
-bool Font::setCurrentSize(unsigned int characterSize) const
+bool Font::insertRect(Page& page, unsigned int width, unsigned int height, IntRect& rect)
 {
-    // FT_Set_Pixel_Sizes is an expensive function, so we must call it
-    // only when necessary to avoid killing performances
+    std::vector<SkylineNode>& skyline = page.skyline;
+    Vector2u size = page.texture.getSize();
+
+    // Find the position where the bottom of the rectangle is the highest,
+    // preferring the narrowest segment to limit the space wasted below it
+    std::size_t bestIndex = skyline.size();
+    unsigned int bestBottom = 0;
+    unsigned int bestWidth = 0;
+    unsigned int bestY = 0;
+    for (std::size_t i = 0; i < skyline.size(); ++i)
+    {
+        // Segments are sorted by position, the next ones can't fit either
+        if (skyline[i].x + width > size.x)
+            break;
+
+        // The rectangle rests on the lowest segment it spans
+        unsigned int y = 0;
+        unsigned int remaining = width;
+        for (std::size_t j = i; remaining > 0; ++j)
+        {
+            y = std::max(y, skyline[j].y);
+            remaining -= std::min(remaining, skyline[j].width);
+        }
 
-    FT_Face face = static_cast<FT_Face>(m_face);
-    FT_UShort currentSize = face->size->metrics.x_ppem;
+        if (y + height > size.y)
+            continue;
 
-    if (currentSize != characterSize)
+        if ((bestIndex == skyline.size()) || (y + height < bestBottom) ||
+            ((y + height == bestBottom) && (skyline[i].width < bestWidth)))
+        {
+            bestIndex = i;
+            bestBottom = y + height;
+            bestWidth = skyline[i].width;
+            bestY = y;
+        }
+    }
+
+    if (bestIndex == skyline.size())
+        return false;
+
+    rect = IntRect(skyline[bestIndex].x, bestY, width, height);
+
+    // Add the segment of the rectangle, and shorten the ones it covers
+    skyline.insert(skyline.begin() + bestIndex, SkylineNode(rect.left, bestBottom, width));
+    for (std::size_t i = bestIndex + 1; i < skyline.size();)
     {
-        FT_Error result = FT_Set_Pixel_Sizes(face, 0, characterSize);
+        unsigned int previousEnd = skyline[i - 1].x + skyline[i - 1].width;
+        if (skyline[i].x >= previousEnd)
+            break;
 
-        if (result == FT_Err_Invalid_Pixel_Size)
+        unsigned int overlap = previousEnd - skyline[i].x;
+        if (skyline[i].width > overlap)
         {
-            // In the case of bitmap fonts, resizing can
-            // fail if the requested size is not available
-            if (!FT_IS_SCALABLE(face))
-            {
-                err() << "Failed to set bitmap font size to " << characterSize << std::endl;
-                err() << "Available sizes are: ";
-                for (int i = 0; i < face->num_fixed_sizes; ++i)
-                    err() << face->available_sizes[i].height << " ";
-                err() << std::endl;
-            }
+            skyline[i].x += overlap;
+            skyline[i].width -= overlap;
+            break;
         }
 
-        return result == FT_Err_Ok;
+        skyline.erase(skyline.begin() + i);
     }
-    else
+
+    // Merge the neighbour segments at the same height
+    for (std::size_t i = 0; i + 1 < skyline.size();)
+    {
+        if (skyline[i].y == skyline[i + 1].y)
+        {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else
+            ++i;
+    }
+
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////
+Font::Atlas& Font::getAtlas(unsigned int characterSize) const
+{
+    // Fonts that were never loaded still hand out empty glyphs and pages
+    if (!m_data)
+        m_data = new FaceData;
+
+    // Elements of a std::map don't move, the pointer stays valid
+    // until the atlases are destroyed
+    if (!m_lastAtlas || (m_lastSize != characterSize))
     {
+        AtlasTable::iterator baked = m_bakedAtlases.find(characterSize);
+        m_lastAtlas = (baked != m_bakedAtlases.end()) ? &baked->second : &m_data->atlases[characterSize];
+        m_lastSize = characterSize;
+    }
+
+    return *m_lastAtlas;
+}
+
+
+////////////////////////////////////////////////////////////
+const Font::Atlas* Font::findAtlas(unsigned int characterSize) const
+{
+    AtlasTable::const_iterator baked = m_bakedAtlases.find(characterSize);
+    if (baked != m_bakedAtlases.end())
+        return &baked->second;
+
+    if (!m_data)
+        return NULL;
+
+    AtlasTable::const_iterator it = m_data->atlases.find(characterSize);
+    return (it != m_data->atlases.end()) ? &it->second : NULL;
+}
+
+
+////////////////////////////////////////////////////////////
+unsigned int Font::getCharIndex(Uint32 codePoint) const
+{
+    if (const Uint32* index = m_data->charIndices.find(codePoint))
+        return *index;
+
+    return m_data->charIndices.insert(codePoint, FT_Get_Char_Index(m_data->face, codePoint));
+}
+
+
+////////////////////////////////////////////////////////////
+bool Font::setCurrentSize(unsigned int characterSize) const
+{
+    // FT_Set_Pixel_Sizes is an expensive function, so each character
+    // size keeps its own FT_Size, scaled once and activated when needed
+
+    FT_Face face = m_data->face;
+
+    if (void** size = m_data->sizes.find(characterSize))
+    {
+        if (face->size != *size)
+            FT_Activate_Size(static_cast<FT_Size>(*size));
         return true;
     }
+
+    FT_Size size;
+    if (FT_New_Size(face, &size) != 0)
+    {
+        err() << "Failed to create a FreeType size object" << std::endl;
+        return false;
+    }
+    FT_Activate_Size(size);
+
+    FT_Error result = FT_Set_Pixel_Sizes(face, 0, characterSize);
+
+    if (result == FT_Err_Invalid_Pixel_Size)
+    {
+        // In the case of bitmap fonts, resizing can
+        // fail if the requested size is not available
+        if (!FT_IS_SCALABLE(face))
+        {
+            err() << "Failed to set bitmap font size to " << characterSize << std::endl;
+            err() << "Available sizes are: ";
+            for (int i = 0; i < face->num_fixed_sizes; ++i)
+                err() << face->available_sizes[i].height << " ";
+            err() << std::endl;
+        }
+    }
+
+    if (result != FT_Err_Ok)
+    {
+        // Another size of the face becomes the active one
+        FT_Done_Size(size);
+        return false;
+    }
+
+    m_data->sizes.insert(characterSize, size);
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////
+Font::GlyphTable::GlyphTable()
+{
+    std::memset(m_latin1, 0, sizeof(m_latin1));
+}
+
+
+////////////////////////////////////////////////////////////
+const Glyph* Font::GlyphTable::find(Uint64 key) const
+{
+    // Keys below 256 are regular glyphs of the first code points
+    if (key < 256)
+        return m_latin1[key] ? &m_glyphs[m_latin1[key] - 1] : NULL;
+
+    const Uint32* index = m_indices.find(key);
+    return index ? &m_glyphs[*index] : NULL;
+}
+
+
+////////////////////////////////////////////////////////////
+const Glyph& Font::GlyphTable::insert(Uint64 key, const Glyph& glyph)
+{
+    // Replace the glyph if the key is already there
+    if ((key < 256) && m_latin1[key])
+        return m_glyphs[m_latin1[key] - 1] = glyph;
+    if (Uint32* existing = (key < 256) ? NULL : m_indices.find(key))
+        return m_glyphs[*existing] = glyph;
+
+    m_glyphs.push_back(glyph);
+    Uint32 index = static_cast<Uint32>(m_glyphs.size() - 1);
+    if (key < 256)
+        m_latin1[key] = index + 1;
+    else
+        m_indices.insert(key, index);
+
+    return m_glyphs.back();
 }
 
 
 ////////////////////////////////////////////////////////////
-Font::Page::Page() :
-        nextRow(3)
+Font::Page::Page(unsigned int size)
 {
     // Make sure that the texture is initialized by default
     cpp3ds::Image image;
-    image.create(128, 128, Color(255, 255, 255, 0));
+    image.create(size, size, Color(255, 255, 255, 0));
 
     // Reserve a 2x2 white square for texturing underlines
     for (int x = 0; x < 2; ++x)
         for (int y = 0; y < 2; ++y)
             image.setPixel(x, y, Color(255, 255, 255, 255));
 
-    // Create the texture
-    texture.loadFromImage(image);
+    // Create the texture, glyphs only need their alpha channel
+    texture.loadFromImage(image, IntRect(), Texture::A8);
+    texture.setSmooth(true);
+
+    // Everything is free, except the white square and its padding
+    skyline.push_back(SkylineNode(0, 3, 3));
+    skyline.push_back(SkylineNode(3, 0, size - 3));
+}
+
+
+////////////////////////////////////////////////////////////
+Font::Page::Page(const Image& image)
+{
+    // The image is already packed: leave the skyline empty, so that
+    // no new glyph is added to it
+    texture.loadFromImage(image, IntRect(), Texture::A8);
     texture.setSmooth(true);
 }
 
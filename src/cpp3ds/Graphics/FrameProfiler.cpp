@@ -0,0 +1,361 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cpp3ds/Graphics/FrameProfiler.hpp>
+#include <cpp3ds/Graphics/Texture.hpp>
+#include <cpp3ds/System/Err.hpp>
+#include <cpp3ds/System/FileSystem.hpp>
+#include <cpp3ds/Resources.hpp>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+
+namespace
+{
+// Names of the columns of the saved files
+const char* columnNames[] =
+{
+    "frame_us", "events_us", "update_us", "render_top_us", "render_bottom_us", "flush_us", "transfer_us", "vblank_us",
+    "draw_calls", "batches", "vertices", "texture_binds", "blend_changes", "scissor_changes", "texture_bytes"
+};
+
+// Names of the lines of the overlay
+const char* overlayNames[] =
+{
+    "frame ms", "events", "update", "top", "bottom", "flush", "transfer", "vblank",
+    "draws", "batches", "vertices", "binds", "blends", "scissors", "upload KB"
+};
+
+// Layout of the overlay
+const unsigned int characterSize = 10;
+const float        labelWidth    = 62.f;
+const float        columnWidth   = 42.f;
+const float        margin        = 4.f;
+
+// Frames between two updates of the overlay, so that it can be read
+const std::size_t overlayPeriod = 15;
+}
+
+
+namespace cpp3ds
+{
+////////////////////////////////////////////////////////////
+FrameProfiler& FrameProfiler::getInstance()
+{
+    static FrameProfiler instance;
+    return instance;
+}
+
+
+////////////////////////////////////////////////////////////
+FrameProfiler::FrameProfiler() :
+m_enabled           (false),
+m_frames            (120),
+m_firstFrame        (0),
+m_frameCount        (0),
+m_current           (),
+m_clock             (),
+m_uploadedBytes     (0),
+m_overlayVisible    (false),
+m_overlayScreen     (TopScreen),
+m_framesSinceOverlay(0),
+m_font              (),
+m_fontLoaded        (false),
+m_background        (),
+m_labels            ()
+{
+    std::fill(m_phaseStart, m_phaseStart + PhaseCount, 0);
+}
+
+
+////////////////////////////////////////////////////////////
+void FrameProfiler::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+}
+
+
+////////////////////////////////////////////////////////////
+bool FrameProfiler::isEnabled() const
+{
+    return m_enabled;
+}
+
+
+////////////////////////////////////////////////////////////
+void FrameProfiler::setHistorySize(std::size_t count)
+{
+    m_frames.assign(std::max<std::size_t>(count, 1), Frame());
+    m_firstFrame = 0;
+    m_frameCount = 0;
+}
+
+
+////////////////////////////////////////////////////////////
+std::size_t FrameProfiler::getHistorySize() const
+{
+    return m_frames.size();
+}
+
+
+////////////////////////////////////////////////////////////
+void FrameProfiler::setOverlayVisible(bool visible, Screen screen)
+{
+    m_overlayVisible = visible;
+    m_overlayScreen = screen;
+
+    if (visible && !m_fontLoaded)
+    {
+        priv::ResourceInfo font = priv::core_resources["opensans.ttf"];
+        m_fontLoaded = m_font.loadFromMemory(font.data, font.size);
+
+        m_background.setFillColor(Color(0, 0, 0, 160));
+        m_background.setSize(Vector2f(labelWidth + 3 * columnWidth + 2 * margin,
+                                      (PhaseCount + CounterCount + 2) * m_font.getLineSpacing(characterSize)));
+        m_labels.setFont(m_font);
+        m_labels.setCharacterSize(characterSize);
+        m_labels.setPosition(margin, 0.f);
+
+        std::ostringstream labels;
+        for (int i = 0; i < 1 + PhaseCount + CounterCount; ++i)
+            labels << '\n' << overlayNames[i];
+        m_labels.setString(labels.str());
+
+        for (int i = 0; i < 3; ++i)
+        {
+            m_columnLayouts[i].setFont(m_font);
+            m_columnLayouts[i].setCharacterSize(characterSize);
+            m_columnLayouts[i].setWrapWidth(columnWidth);
+            m_columnLayouts[i].setAlignment(TextLayout::Right);
+            m_columns[i].setLayout(&m_columnLayouts[i]);
+            m_columns[i].setPosition(margin + labelWidth + i * columnWidth, 0.f);
+        }
+    }
+
+    updateOverlay();
+}
+
+
+////////////////////////////////////////////////////////////
+bool FrameProfiler::isOverlayVisible() const
+{
+    return m_overlayVisible;
+}
+
+
+////////////////////////////////////////////////////////////
+Screen FrameProfiler::getOverlayScreen() const
+{
+    return m_overlayScreen;
+}
+
+
+////////////////////////////////////////////////////////////
+void FrameProfiler::beginFrame()
+{
+    if (!m_enabled)
+        return;
+
+    m_current = Frame();
+    m_uploadedBytes = Texture::getUploadedBytes();
+    m_clock.restart();
+}
+
+
+////////////////////////////////////////////////////////////
+void FrameProfiler::beginPhase(Phase phase)
+{
+    if (!m_enabled)
+        return;
+
+    m_phaseStart[phase] = m_clock.getElapsedTime().asMicroseconds();
+}
+
+
+////////////////////////////////////////////////////////////
+void FrameProfiler::endPhase(Phase phase)
+{
+    if (!m_enabled)
+        return;
+
+    m_current.phases[phase] += m_clock.getElapsedTime().asMicroseconds() - m_phaseStart[phase];
+}
+
+
+////////////////////////////////////////////////////////////
+void FrameProfiler::addStatistics(const RenderTarget::Statistics& statistics)
+{
+    if (!m_enabled)
+        return;
+
+    m_current.counters[DrawCalls]      += statistics.drawCalls;
+    m_current.counters[Batches]        += statistics.batches;
+    m_current.counters[Vertices]       += statistics.vertices;
+    m_current.counters[TextureBinds]   += statistics.textureBinds;
+    m_current.counters[BlendChanges]   += statistics.blendChanges;
+    m_current.counters[ScissorChanges] += statistics.scissorChanges;
+}
+
+
+////////////////////////////////////////////////////////////
+void FrameProfiler::endFrame()
+{
+    if (!m_enabled)
+        return;
+
+    m_current.duration = m_clock.getElapsedTime().asMicroseconds();
+    m_current.counters[TextureBytes] = Texture::getUploadedBytes() - m_uploadedBytes;
+
+    // Overwrite the oldest frame once the history is full
+    if (m_frameCount < m_frames.size())
+    {
+        m_frames[(m_firstFrame + m_frameCount) % m_frames.size()] = m_current;
+        ++m_frameCount;
+    }
+    else
+    {
+        m_frames[m_firstFrame] = m_current;
+        m_firstFrame = (m_firstFrame + 1) % m_frames.size();
+    }
+
+    if (m_overlayVisible && (++m_framesSinceOverlay >= overlayPeriod))
+        updateOverlay();
+}
+
+
+////////////////////////////////////////////////////////////
+std::size_t FrameProfiler::getFrameCount() const
+{
+    return m_frameCount;
+}
+
+
+////////////////////////////////////////////////////////////
+FrameProfiler::Summary FrameProfiler::getFrameSummary() const
+{
+    return summarize(0, 0.001);
+}
+
+
+////////////////////////////////////////////////////////////
+FrameProfiler::Summary FrameProfiler::getPhaseSummary(Phase phase) const
+{
+    return summarize(1 + phase, 0.001);
+}
+
+
+////////////////////////////////////////////////////////////
+FrameProfiler::Summary FrameProfiler::getCounterSummary(Counter counter) const
+{
+    return summarize(1 + PhaseCount + counter, 1.0);
+}
+
+
+////////////////////////////////////////////////////////////
+bool FrameProfiler::saveToFile(const std::string& filename) const
+{
+    std::ofstream file(FileSystem::getFilePath(filename).c_str());
+    if (!file)
+    {
+        err() << "Failed to save frame profile to \"" << filename << "\"" << std::endl;
+        return false;
+    }
+
+    const int columnCount = 1 + PhaseCount + CounterCount;
+    for (int i = 0; i < columnCount; ++i)
+        file << (i ? "," : "") << columnNames[i];
+    file << '\n';
+
+    for (std::size_t i = 0; i < m_frameCount; ++i)
+    {
+        const Frame& frame = m_frames[(m_firstFrame + i) % m_frames.size()];
+        for (int j = 0; j < columnCount; ++j)
+            file << (j ? "," : "") << static_cast<Uint64>(getValue(frame, j));
+        file << '\n';
+    }
+
+    return static_cast<bool>(file);
+}
+
+
+////////////////////////////////////////////////////////////
+void FrameProfiler::draw(RenderTarget& target, RenderStates states) const
+{
+    if (!m_overlayVisible || !m_fontLoaded)
+        return;
+
+    target.draw(m_background, states);
+    target.draw(m_labels, states);
+    for (int i = 0; i < 3; ++i)
+        target.draw(m_columns[i], states);
+}
+
+
+////////////////////////////////////////////////////////////
+void FrameProfiler::updateOverlay()
+{
+    m_framesSinceOverlay = 0;
+    if (!m_fontLoaded)
+        return;
+
+    std::ostringstream columns[3];
+    columns[0] << "min";
+    columns[1] << "avg";
+    columns[2] << "max";
+
+    for (int i = 0; i < 1 + PhaseCount + CounterCount; ++i)
+    {
+        // Times in milliseconds, uploads in kilobytes, other counters as they are
+        bool isTime = (i <= PhaseCount);
+        double scale = isTime ? 0.001 : (i == PhaseCount + TextureBytes + 1) ? 1.0 / 1024 : 1.0;
+        Summary summary = summarize(i, scale);
+        int precision = (isTime || (scale < 1.0)) ? 1 : 0;
+
+        columns[0] << '\n' << std::fixed << std::setprecision(precision) << summary.min;
+        columns[1] << '\n' << std::fixed << std::setprecision(precision) << summary.average;
+        columns[2] << '\n' << std::fixed << std::setprecision(precision) << summary.max;
+    }
+
+    for (int i = 0; i < 3; ++i)
+        m_columnLayouts[i].setString(columns[i].str());
+}
+
+
+////////////////////////////////////////////////////////////
+double FrameProfiler::getValue(const Frame& frame, int column)
+{
+    if (column == 0)
+        return static_cast<double>(frame.duration);
+    if (column <= PhaseCount)
+        return static_cast<double>(frame.phases[column - 1]);
+    return static_cast<double>(frame.counters[column - 1 - PhaseCount]);
+}
+
+
+////////////////////////////////////////////////////////////
+FrameProfiler::Summary FrameProfiler::summarize(int column, double scale) const
+{
+    Summary summary = {0.f, 0.f, 0.f};
+    if (m_frameCount == 0)
+        return summary;
+
+    double min = getValue(m_frames[m_firstFrame], column);
+    double max = min;
+    double total = 0.0;
+    for (std::size_t i = 0; i < m_frameCount; ++i)
+    {
+        double value = getValue(m_frames[(m_firstFrame + i) % m_frames.size()], column);
+        min = std::min(min, value);
+        max = std::max(max, value);
+        total += value;
+    }
+
+    summary.min     = static_cast<float>(min * scale);
+    summary.average = static_cast<float>(total / m_frameCount * scale);
+    summary.max     = static_cast<float>(max * scale);
+    return summary;
+}
+
+} // namespace cpp3ds
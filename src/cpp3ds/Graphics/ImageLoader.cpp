@@ -29,6 +29,7 @@
 #include <cpp3ds/Resources.hpp>
 #include <cpp3ds/System/InputStream.hpp>
 #include <cpp3ds/System/Err.hpp>
+#include <cpp3ds/System/Trace.hpp>
 #define STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <cpp3ds/Graphics/stb_image/stb_image.h>
@@ -101,6 +102,8 @@ ImageLoader::~ImageLoader()
 ////////////////////////////////////////////////////////////
 bool ImageLoader::loadImageFromFile(const std::string& filename, std::vector<Uint8>& pixels, Vector2u& size)
 {
+    CPP3DS_TRACE_ZONE("Graphics", "ImageLoader::loadImageFromFile");
+
     // Clear the array (just in case)
     pixels.clear();
 
@@ -136,6 +139,8 @@ bool ImageLoader::loadImageFromFile(const std::string& filename, std::vector<Uin
 ////////////////////////////////////////////////////////////
 bool ImageLoader::loadImageFromMemory(const void* data, std::size_t dataSize, std::vector<Uint8>& pixels, Vector2u& size)
 {
+    CPP3DS_TRACE_ZONE("Graphics", "ImageLoader::loadImageFromMemory");
+
     // Check input parameters
     if (data && dataSize)
     {
@@ -181,6 +186,8 @@ bool ImageLoader::loadImageFromMemory(const void* data, std::size_t dataSize, st
 ////////////////////////////////////////////////////////////
 bool ImageLoader::loadImageFromStream(InputStream& stream, std::vector<Uint8>& pixels, Vector2u& size)
 {
+    CPP3DS_TRACE_ZONE("Graphics", "ImageLoader::loadImageFromStream");
+
     // Clear the array (just in case)
     pixels.clear();
 
@@ -225,6 +232,8 @@ bool ImageLoader::loadImageFromStream(InputStream& stream, std::vector<Uint8>& p
 ////////////////////////////////////////////////////////////
 bool ImageLoader::saveImageToFile(const std::string& filename, const std::vector<Uint8>& pixels, const Vector2u& size)
 {
+    CPP3DS_TRACE_ZONE("Graphics", "ImageLoader::saveImageToFile");
+
     // Make sure the image is not empty
     if (!pixels.empty() && (size.x > 0) && (size.y > 0))
     {
@@ -0,0 +1,159 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cpp3ds/Graphics/IndexedVertexArray.hpp>
+#include <cpp3ds/Graphics/RenderTarget.hpp>
+
+
+namespace cpp3ds
+{
+////////////////////////////////////////////////////////////
+IndexedVertexArray::IndexedVertexArray() :
+m_vertices     (),
+m_indices      (),
+m_primitiveType(Triangles)
+{
+}
+
+
+////////////////////////////////////////////////////////////
+IndexedVertexArray::IndexedVertexArray(PrimitiveType type, unsigned int vertexCount, unsigned int indexCount) :
+m_vertices     (vertexCount),
+m_indices      (indexCount),
+m_primitiveType(type)
+{
+}
+
+
+////////////////////////////////////////////////////////////
+unsigned int IndexedVertexArray::getVertexCount() const
+{
+    return static_cast<unsigned int>(m_vertices.size());
+}
+
+
+////////////////////////////////////////////////////////////
+unsigned int IndexedVertexArray::getIndexCount() const
+{
+    return static_cast<unsigned int>(m_indices.size());
+}
+
+
+////////////////////////////////////////////////////////////
+Vertex& IndexedVertexArray::operator [](unsigned int index)
+{
+    return m_vertices[index];
+}
+
+
+////////////////////////////////////////////////////////////
+const Vertex& IndexedVertexArray::operator [](unsigned int index) const
+{
+    return m_vertices[index];
+}
+
+
+////////////////////////////////////////////////////////////
+void IndexedVertexArray::setIndex(unsigned int position, Uint16 index)
+{
+    m_indices[position] = index;
+}
+
+
+////////////////////////////////////////////////////////////
+Uint16 IndexedVertexArray::getIndex(unsigned int position) const
+{
+    return m_indices[position];
+}
+
+
+////////////////////////////////////////////////////////////
+void IndexedVertexArray::clear()
+{
+    m_vertices.clear();
+    m_indices.clear();
+}
+
+
+////////////////////////////////////////////////////////////
+void IndexedVertexArray::resize(unsigned int vertexCount, unsigned int indexCount)
+{
+    m_vertices.resize(vertexCount);
+    m_indices.resize(indexCount);
+}
+
+
+////////////////////////////////////////////////////////////
+void IndexedVertexArray::append(const Vertex& vertex)
+{
+    m_vertices.push_back(vertex);
+}
+
+
+////////////////////////////////////////////////////////////
+void IndexedVertexArray::appendIndex(Uint16 index)
+{
+    m_indices.push_back(index);
+}
+
+
+////////////////////////////////////////////////////////////
+void IndexedVertexArray::setPrimitiveType(PrimitiveType type)
+{
+    m_primitiveType = type;
+}
+
+
+////////////////////////////////////////////////////////////
+PrimitiveType IndexedVertexArray::getPrimitiveType() const
+{
+    return m_primitiveType;
+}
+
+
+////////////////////////////////////////////////////////////
+FloatRect IndexedVertexArray::getBounds() const
+{
+    if (!m_vertices.empty())
+    {
+        float left   = m_vertices[0].position.x;
+        float top    = m_vertices[0].position.y;
+        float right  = m_vertices[0].position.x;
+        float bottom = m_vertices[0].position.y;
+
+        for (std::size_t i = 1; i < m_vertices.size(); ++i)
+        {
+            Vector2f position = m_vertices[i].position;
+
+            // Update left and right
+            if (position.x < left)
+                left = position.x;
+            else if (position.x > right)
+                right = position.x;
+
+            // Update top and bottom
+            if (position.y < top)
+                top = position.y;
+            else if (position.y > bottom)
+                bottom = position.y;
+        }
+
+        return FloatRect(left, top, right - left, bottom - top);
+    }
+    else
+    {
+        // Array is empty
+        return FloatRect();
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+void IndexedVertexArray::draw(RenderTarget& target, RenderStates states) const
+{
+    if (!m_vertices.empty() && !m_indices.empty())
+        target.draw(&m_vertices[0], static_cast<unsigned int>(m_vertices.size()),
+                    &m_indices[0], static_cast<unsigned int>(m_indices.size()), m_primitiveType, states);
+}
+
+} // namespace cpp3ds
@@ -32,8 +32,12 @@
 #include <cpp3ds/Graphics/VertexArray.hpp>
 #include <cpp3ds/OpenGL.hpp>
 #include <cpp3ds/System/Err.hpp>
+#include <cpp3ds/System/FrameArena.hpp>
+#include <cpp3ds/System/Trace.hpp>
 #include <c3d/renderbuffer.h>
 #include "CitroHelpers.hpp"
+#include <algorithm>
+#include <cstring>
 
 namespace
 {
@@ -68,18 +72,151 @@ namespace
         }
     }
 
+    // Number of quads in the shared quad index buffer
+    const unsigned int sharedQuadCount = 4096;
+
+
+    // Compute the number of indices needed to draw primitives as independent triangles
+    unsigned int getTriangleIndexCount(cpp3ds::PrimitiveType type, unsigned int count)
+    {
+        switch (type)
+        {
+            default:
+            case cpp3ds::Triangles:      return count;
+            case cpp3ds::TrianglesStrip:
+            case cpp3ds::TrianglesFan:   return (count < 3) ? 0 : (count - 2) * 3;
+            case cpp3ds::Quads:          return count / 4 * 6;
+        }
+    }
+
+
+    // Get the vertex used by the i-th element of a primitive stream, offset by base
+    inline cpp3ds::Uint16 element(const cpp3ds::Uint16* indices, unsigned int i, unsigned int base)
+    {
+        return static_cast<cpp3ds::Uint16>(base + (indices ? indices[i] : i));
+    }
+
+
+    // Write the indices of primitives as independent triangles, offset by base.
+    // When indices is NULL, the primitives use consecutive vertices.
+    void writeTriangleIndices(cpp3ds::Uint16* out, const cpp3ds::Uint16* indices, unsigned int count,
+                              cpp3ds::PrimitiveType type, unsigned int base)
+    {
+        switch (type)
+        {
+            default:
+            case cpp3ds::Triangles:
+                for (unsigned int i = 0; i < count; ++i)
+                    *out++ = element(indices, i, base);
+                break;
+
+            // Strips reuse the two previous vertices, fans reuse the first and the previous one
+            case cpp3ds::TrianglesStrip:
+            case cpp3ds::TrianglesFan:
+                for (unsigned int i = 2; i < count; ++i)
+                {
+                    *out++ = element(indices, type == cpp3ds::TrianglesFan ? 0 : i - 2, base);
+                    *out++ = element(indices, i - 1, base);
+                    *out++ = element(indices, i, base);
+                }
+                break;
+
+            case cpp3ds::Quads:
+                for (unsigned int i = 0; i + 4 <= count; i += 4)
+                {
+                    *out++ = element(indices, i, base);
+                    *out++ = element(indices, i + 1, base);
+                    *out++ = element(indices, i + 2, base);
+                    *out++ = element(indices, i, base);
+                    *out++ = element(indices, i + 2, base);
+                    *out++ = element(indices, i + 3, base);
+                }
+                break;
+        }
+    }
+
+
+    // Get the index buffer shared by all the quads drawn without indices
+    const cpp3ds::Uint16* getQuadIndices()
+    {
+        static cpp3ds::Uint16* indices = NULL;
+        if (!indices)
+        {
+            indices = static_cast<cpp3ds::Uint16*>(linearAlloc(sharedQuadCount * 6 * sizeof(cpp3ds::Uint16)));
+            if (indices)
+            {
+                writeTriangleIndices(indices, NULL, sharedQuadCount * 4, cpp3ds::Quads, 0);
+                GSPGPU_FlushDataCache(indices, sharedQuadCount * 6 * sizeof(cpp3ds::Uint16));
+            }
+        }
+        return indices;
+    }
+
+
+    // Return data the GPU can read: either the data itself, or a copy in the frame arena
+    template <typename T>
+    const T* toLinearMemory(const T* data, unsigned int count)
+    {
+        if (osConvertVirtToPhys(data) != 0)
+            return data;
+
+        T* copy = static_cast<T*>(cpp3ds::FrameArena::allocate(count * sizeof(T)));
+        if (copy)
+        {
+            std::memcpy(copy, data, count * sizeof(T));
+            GSPGPU_FlushDataCache(copy, count * sizeof(T));
+        }
+        return copy;
+    }
+
+
+    // Set the vertex buffer used by the next draw commands
+    void setVertexBuffer(const cpp3ds::Vertex* vertices)
+    {
+        CitroSetVertexFormat(CitroVertexFloat);
+        C3D_BufInfo* bufInfo = C3D_GetBufInfo();
+        BufInfo_Init(bufInfo);
+        BufInfo_Add(bufInfo, vertices, sizeof(cpp3ds::Vertex), 3, 0x210);
+    }
+
+
+    // Set the compact vertex buffer used by the next draw commands
+    void setVertexBuffer(const cpp3ds::CompactVertex* vertices)
+    {
+        CitroSetVertexFormat(CitroVertexCompact);
+        C3D_BufInfo* bufInfo = C3D_GetBufInfo();
+        BufInfo_Init(bufInfo);
+        BufInfo_Add(bufInfo, vertices, sizeof(cpp3ds::CompactVertex), 3, 0x210);
+    }
+
 }
 
 
 namespace cpp3ds
 {
+////////////////////////////////////////////////////////////
+RenderTarget::Statistics::Statistics() :
+drawCalls     (0),
+batches       (0),
+mergedDraws   (0),
+vertices      (0),
+textureBinds  (0),
+blendChanges  (0),
+scissorChanges(0)
+{
+}
+
+
 ////////////////////////////////////////////////////////////
 RenderTarget::RenderTarget() :
-m_defaultView(),
-m_view       (),
-m_cache      ()
+m_defaultView    (),
+m_view           (),
+m_cache          (),
+m_batch          (),
+m_batchingEnabled(true),
+m_statistics     (),
+m_combiner       (-1)
 {
-	m_cache.vertexCache = new Vertex[StatesCache::VertexCacheSize];
 	m_cache.glStatesSet = false;
 }
 
@@ -87,7 +224,9 @@ m_cache      ()
 ////////////////////////////////////////////////////////////
 RenderTarget::~RenderTarget()
 {
-	delete[] m_cache.vertexCache;
+	delete[] m_batch.vertices;
+	if (m_batch.indices)
+		linearFree(m_batch.indices);
 }
 
 
@@ -96,6 +235,8 @@ void RenderTarget::clear(const Color& color)
 {
     if (activate(true))
     {
+        flush();
+
         u32 clearColor = (((color.r)&0xFF)<<24) | (((color.g)&0xFF)<<16) | (((color.b)&0xFF)<<8) | (((color.a)&0xFF)<<0);
 //        C3D_RenderTargetSetClear(m_target, C3D_CLEAR_ALL, clearColor, 0);
         m_target->renderBuf.clearColor = clearColor;
@@ -107,6 +248,9 @@ void RenderTarget::clear(const Color& color)
 ////////////////////////////////////////////////////////////
 void RenderTarget::setView(const View& view)
 {
+    // Pending primitives must be drawn with the previous view
+    flush();
+
     m_view = view;
     m_cache.viewChanged = true;
 }
@@ -194,17 +338,56 @@ void RenderTarget::draw(const Drawable& drawable, const RenderStates& states)
 ////////////////////////////////////////////////////////////
 void RenderTarget::draw(const Vertex* vertices, unsigned int vertexCount,
                         PrimitiveType type, const RenderStates& states)
+{
+    drawPrimitives(vertices, vertexCount, NULL, 0, type, states);
+}
+
+
+////////////////////////////////////////////////////////////
+void RenderTarget::draw(const Vertex* vertices, unsigned int vertexCount,
+                        const Uint16* indices, unsigned int indexCount,
+                        PrimitiveType type, const RenderStates& states)
+{
+    // Nothing to draw?
+    if (!indices || (indexCount == 0))
+        return;
+
+    drawPrimitives(vertices, vertexCount, indices, indexCount, type, states);
+}
+
+
+////////////////////////////////////////////////////////////
+void RenderTarget::draw(const CompactVertex* vertices, unsigned int vertexCount,
+                        PrimitiveType type, const RenderStates& states)
+{
+    drawPrimitives(vertices, vertexCount, NULL, 0, type, states);
+}
+
+
+////////////////////////////////////////////////////////////
+void RenderTarget::draw(const CompactVertex* vertices, unsigned int vertexCount,
+                        const Uint16* indices, unsigned int indexCount,
+                        PrimitiveType type, const RenderStates& states)
+{
+    // Nothing to draw?
+    if (!indices || (indexCount == 0))
+        return;
+
+    drawPrimitives(vertices, vertexCount, indices, indexCount, type, states);
+}
+
+
+////////////////////////////////////////////////////////////
+template <typename VertexType>
+void RenderTarget::drawPrimitives(const VertexType* vertices, unsigned int vertexCount,
+                                  const Uint16* indices, unsigned int indexCount,
+                                  PrimitiveType type, const RenderStates& states)
 {
     // Nothing to draw?
     if (!vertices || (vertexCount == 0))
         return;
 
-	// Vertices allocated in the stack (common) can't be converted to physical address
-	if (osConvertVirtToPhys(vertices) == 0)
-	{
-		err() << "RenderTarget::draw() called with vertex array in inaccessible memory space." << std::endl;
-		return;
-	}
+    CPP3DS_TRACE_ZONE("Graphics", "RenderTarget::draw");
 
     if (activate(true))
     {
@@ -212,93 +395,174 @@ void RenderTarget::draw(const Vertex* vertices, unsigned int vertexCount,
         if (!m_cache.glStatesSet)
             resetGLStates();
 
-        // Check if the vertex count is low enough so that we can pre-transform them
-//        bool useVertexCache = (vertexCount <= StatesCache::VertexCacheSize);
-        bool useVertexCache = false;
-        if (useVertexCache)
+        ++m_statistics.drawCalls;
+
+        // Small draws are transformed on the CPU and merged into the pending batch
+        unsigned int batchCount = getTriangleIndexCount(type, indices ? indexCount : vertexCount);
+        if (m_batchingEnabled && (vertexCount <= Batch::MaxDrawSize) && (batchCount <= Batch::MaxDrawSize * 3))
+        {
+            addToBatch(vertices, vertexCount, indices, indexCount, type, states, batchCount);
+            return;
+        }
+
+        // Vertices allocated in the stack (common) can't be converted to physical address,
+        // so copy them to linear memory that lives until the end of the frame
+        vertices = toLinearMemory(vertices, vertexCount);
+        if (indices)
         {
-            // Pre-transform the vertices and store them into the vertex cache
-            for (unsigned int i = 0; i < vertexCount; ++i)
+            // The GPU has no quad primitive, convert them to triangles
+            if (type == Quads)
             {
-                Vertex& vertex = m_cache.vertexCache[i];
-                vertex.position = states.transform * vertices[i].position;
-                vertex.color = vertices[i].color;
-                vertex.texCoords = vertices[i].texCoords;
+                Uint16* triangles = static_cast<Uint16*>(FrameArena::allocate(batchCount * sizeof(Uint16)));
+                if (triangles)
+                {
+                    writeTriangleIndices(triangles, indices, indexCount, Quads, 0);
+                    GSPGPU_FlushDataCache(triangles, batchCount * sizeof(Uint16));
+                }
+                indices = triangles;
+                indexCount = batchCount;
             }
-
-            // Since vertices are transformed, we must use an identity transform to render them
-            if (!m_cache.useVertexCache)
-                applyTransform(Transform::Identity);
+            else
+                indices = toLinearMemory(indices, indexCount);
         }
-        else
+
+        const Uint16* quadIndices = (type == Quads) ? getQuadIndices() : NULL;
+        if (!vertices || ((type == Quads) && !indices && !quadIndices) || (indexCount > 0 && !indices))
         {
-            applyTransform(states.transform);
+            err() << "RenderTarget::draw() called with vertex array in inaccessible memory space." << std::endl;
+            return;
         }
 
+        // Keep the drawing order: pending primitives go first
+        flush();
+
+        applyTransform(states.transform);
+
         // Apply the view
         if (m_cache.viewChanged)
             applyCurrentView();
 
-        // Apply the blend mode
-        if (states.blendMode != m_cache.lastBlendMode)
-            applyBlendMode(states.blendMode);
+        // Apply the blend mode, scissor, texture and shader
+        applyStates(states.blendMode, states.scissor, states.texture, states.shader);
 
-        // Apply the scissor mode
-        if (states.scissor != m_cache.lastScissor)
-            applyScissor(states.scissor);
-
-        // Apply the texture
-        Uint64 textureId = states.texture ? states.texture->m_cacheId : 0;
-        if (textureId != m_cache.lastTextureId)
-            applyTexture(states.texture);
+        // Find the OpenGL primitive type
+        static const GPU_Primitive_t modes[] = {GPU_TRIANGLES, GPU_TRIANGLE_STRIP, GPU_TRIANGLE_FAN, GPU_TRIANGLES};
+        GPU_Primitive_t mode = modes[type];
 
-        // Apply the shader
-        if (states.shader)
-            applyShader(states.shader);
+        CitroUpdateMatrixStacks();
 
-        // If we pre-transform the vertices, we must use our internal vertex cache
-        if (useVertexCache)
+        // Draw the primitives
+        if (indices)
         {
-            // ... and if we already used it previously, we don't need to set the pointers again
-            if (!m_cache.useVertexCache)
-                vertices = m_cache.vertexCache;
-            else
-                vertices = NULL;
+            setVertexBuffer(vertices);
+            C3D_DrawElements(mode, indexCount, C3D_UNSIGNED_SHORT, indices);
         }
-
-        // Setup the pointers to the vertices' components
-        if (vertices)
+        else if (type == Quads)
+        {
+            // All quads share the same index buffer, bigger arrays are drawn in chunks
+            for (unsigned int first = 0; first + 4 <= vertexCount; first += sharedQuadCount * 4)
+            {
+                unsigned int quadCount = std::min((vertexCount - first) / 4, sharedQuadCount);
+                setVertexBuffer(vertices + first);
+                C3D_DrawElements(mode, quadCount * 6, C3D_UNSIGNED_SHORT, quadIndices);
+            }
+        }
+        else
         {
-            C3D_BufInfo* bufInfo = C3D_GetBufInfo();
-            BufInfo_Init(bufInfo);
-            BufInfo_Add(bufInfo, vertices, sizeof(Vertex), 3, 0x210);
+            setVertexBuffer(vertices);
+            C3D_DrawArrays(mode, 0, vertexCount);
         }
 
-        // Find the OpenGL primitive type
-        static const GPU_Primitive_t modes[] = {GPU_TRIANGLES, GPU_TRIANGLE_STRIP, GPU_TRIANGLE_FAN, GPU_GEOMETRY_PRIM};
-        GPU_Primitive_t mode = modes[type];
+        ++m_statistics.batches;
+        m_statistics.vertices += vertexCount;
+    }
+}
 
-        CitroUpdateMatrixStacks();
 
-        // Draw the primitives
-        C3D_DrawArrays(mode, 0, vertexCount);
+////////////////////////////////////////////////////////////
+void RenderTarget::flush()
+{
+    if (m_batch.indexCount == 0)
+        return;
 
-        // Unbind the shader, if any
-        if (states.shader)
-            applyShader(NULL);
+    if (activate(true))
+    {
+        // Batched vertices are already transformed
+        applyTransform(Transform::Identity);
 
-        // Update the cache
-        m_cache.useVertexCache = useVertexCache;
+        // Apply the view
+        if (m_cache.viewChanged)
+            applyCurrentView();
+
+        // Apply the blend mode, scissor, texture and shader
+        applyStates(m_batch.blendMode, m_batch.scissor, m_batch.texture, m_batch.shader);
+
+        // Make sure the GPU sees the data written by the CPU
+        Vertex* vertices = m_batch.vertices + m_batch.vertexStart;
+        Uint16* indices  = m_batch.indices + m_batch.indexStart;
+        GSPGPU_FlushDataCache(vertices, m_batch.vertexCount * sizeof(Vertex));
+        GSPGPU_FlushDataCache(indices, m_batch.indexCount * sizeof(Uint16));
+
+        setVertexBuffer(vertices);
+
+        CitroUpdateMatrixStacks();
+
+        C3D_DrawElements(GPU_TRIANGLES, m_batch.indexCount, C3D_UNSIGNED_SHORT, indices);
+
+        ++m_statistics.batches;
+        m_statistics.vertices += m_batch.vertexCount;
     }
+
+    // The GPU reads the buffers only when the command list is executed,
+    // so the next batch must not overwrite this one until then
+    m_batch.vertexStart += m_batch.vertexCount;
+    m_batch.vertexCount = 0;
+    m_batch.indexStart += m_batch.indexCount;
+    m_batch.indexCount = 0;
+    m_batch.flushId = CitroGetFlushCount();
+}
+
+
+////////////////////////////////////////////////////////////
+void RenderTarget::setBatchingEnabled(bool enabled)
+{
+    if (!enabled)
+        flush();
+
+    m_batchingEnabled = enabled;
+}
+
+
+////////////////////////////////////////////////////////////
+bool RenderTarget::isBatchingEnabled() const
+{
+    return m_batchingEnabled;
+}
+
+
+////////////////////////////////////////////////////////////
+const RenderTarget::Statistics& RenderTarget::getStatistics() const
+{
+    return m_statistics;
+}
+
+
+////////////////////////////////////////////////////////////
+void RenderTarget::resetStatistics()
+{
+    m_statistics = Statistics();
 }
 
 
 ////////////////////////////////////////////////////////////
 void RenderTarget::pushGLStates()
 {
-	if (activate(true))
+    if (activate(true))
     {
-        // TODO: implement pushGlStates
+        // Pending primitives rely on the current states
+        flush();
+
+        CitroPushState();
     }
     resetGLStates();
 }
@@ -309,7 +573,13 @@ void RenderTarget::popGLStates()
 {
     if (activate(true))
     {
-        // TODO: implement popGLStates
+        flush();
+
+        if (!CitroPopState())
+            err() << "RenderTarget::popGLStates() called without a matching pushGLStates()" << std::endl;
+
+        // The restored projection may not be the one of the current view
+        m_cache.viewChanged = true;
     }
 }
 
@@ -317,22 +587,19 @@ void RenderTarget::popGLStates()
 ////////////////////////////////////////////////////////////
 void RenderTarget::resetGLStates()
 {
-	// Check here to make sure a context change does not happen after activate(true)
-    bool shaderAvailable = Shader::isAvailable();
+    // Pending primitives rely on the current states
+    flush();
 
     if (activate(true))
     {
         m_cache.glStatesSet = true;
 
+        // Direct citro3d calls may have changed any state, so send them all again
+        CitroInvalidateState();
+
         // Apply the default SFML states
-        applyBlendMode(BlendAlpha);
         applyTransform(Transform::Identity);
-        applyTexture(NULL);
-        applyScissor(UintRect());
-        if (shaderAvailable)
-            applyShader(NULL);
-
-        m_cache.useVertexCache = false;
+        applyStates(BlendAlpha, UintRect(), NULL, NULL);
 
         // Set the default view
         setView(getView());
@@ -360,76 +627,154 @@ C3D_RenderTarget* RenderTarget::getCitroTarget()
 
 
 ////////////////////////////////////////////////////////////
-void RenderTarget::applyCurrentView()
+template <typename VertexType>
+void RenderTarget::addToBatch(const VertexType* vertices, unsigned int vertexCount,
+                              const Uint16* indices, unsigned int indexCount, PrimitiveType type,
+                              const RenderStates& states, unsigned int batchCount)
 {
-	// Set the viewport
-    IntRect viewport = getViewport(m_view);
-    int top = getSize().y - (viewport.top + viewport.height);
-    C3D_SetViewport(top, viewport.left, viewport.height, viewport.width);
+    if (batchCount == 0)
+        return;
 
-	// Set the projection matrix
-    memcpy(MtxStack_Cur(CitroGetProjectionMatrix())->m, m_view.getTransform().getMatrix(), sizeof(C3D_Mtx));
+    // Any change of state ends the pending batch, and so does a full buffer
+    Uint64 textureId = states.texture ? states.texture->m_cacheId : 0;
+    if (m_batch.indexCount > 0)
+    {
+        if ((textureId != m_batch.textureId) || (states.blendMode != m_batch.blendMode) ||
+            (states.scissor != m_batch.scissor) || (states.shader != m_batch.shader) ||
+            (m_batch.vertexStart + m_batch.vertexCount + vertexCount > Batch::VertexCapacity) ||
+            (m_batch.indexStart + m_batch.indexCount + batchCount > Batch::IndexCapacity))
+            flush();
+        else
+            ++m_statistics.mergedDraws;
+    }
 
-    m_cache.viewChanged = false;
-}
+    if (!m_batch.vertices)
+    {
+        m_batch.vertices = new Vertex[Batch::VertexCapacity];
+        m_batch.indices  = static_cast<Uint16*>(linearAlloc(Batch::IndexCapacity * sizeof(Uint16)));
+        if (!m_batch.indices)
+            std::__throw_bad_alloc();
+    }
 
+    // Start a new batch
+    if (m_batch.indexCount == 0)
+    {
+        // Once the GPU has executed its command list, the whole buffers are free again
+        if (m_batch.flushId != CitroGetFlushCount())
+        {
+            m_batch.vertexStart = 0;
+            m_batch.indexStart = 0;
+        }
 
-////////////////////////////////////////////////////////////
-void RenderTarget::applyBlendMode(const BlendMode& mode)
-{
-    // Apply the blend mode
-    C3D_AlphaBlend(equationToGlConstant(mode.colorEquation),
-                   equationToGlConstant(mode.alphaEquation),
-                   factorToGlConstant(mode.colorSrcFactor),
-                   factorToGlConstant(mode.colorDstFactor),
-                   factorToGlConstant(mode.alphaSrcFactor),
-                   factorToGlConstant(mode.alphaDstFactor));
+        // Not enough room left: wait for the GPU to consume the buffers
+        if ((m_batch.vertexStart + vertexCount > Batch::VertexCapacity) ||
+            (m_batch.indexStart + batchCount > Batch::IndexCapacity))
+        {
+            CitroFlush();
+            m_batch.vertexStart = 0;
+            m_batch.indexStart = 0;
+        }
+
+        m_batch.texture   = states.texture;
+        m_batch.textureId = textureId;
+        m_batch.blendMode = states.blendMode;
+        m_batch.scissor   = states.scissor;
+        m_batch.shader    = states.shader;
+    }
+
+    // Pre-transform the vertices, compact ones are expanded to floats
+    Vertex* out = m_batch.vertices + m_batch.vertexStart + m_batch.vertexCount;
+    const Transform& transform = states.transform;
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+        out[i].position  = transform * Vector2f(vertices[i].position);
+        out[i].color     = vertices[i].color;
+        out[i].texCoords = Vector2f(vertices[i].texCoords);
+    }
+
+    // Store the primitives as independent triangles
+    writeTriangleIndices(m_batch.indices + m_batch.indexStart + m_batch.indexCount,
+                         indices, indices ? indexCount : vertexCount, type, m_batch.vertexCount);
 
-    m_cache.lastBlendMode = mode;
+    m_batch.vertexCount += vertexCount;
+    m_batch.indexCount += batchCount;
 }
 
 
 ////////////////////////////////////////////////////////////
-void RenderTarget::applyScissor(const UintRect& rect)
+void RenderTarget::applyCurrentView()
 {
-    if (rect == UintRect())
-        C3D_SetScissor(GPU_SCISSOR_DISABLE, 0, 0, 0, 0);
-    else {
-        // Keep in mind the sideway 3ds screen, so it seems screwy
-        int bottom = getSize().x - rect.left;
-        int top = getSize().y - rect.top;
-        int left = top - rect.height;
-        int right = bottom - rect.width;
-        if (bottom < 0) bottom = 0;
-        if (top < 0) top = 0;
-        if (left < 0) left = 0;
-        if (right < 0) right = 0;
-        C3D_SetScissor(GPU_SCISSOR_NORMAL, left, right, top, bottom);
-    }
-    m_cache.lastScissor = rect;
+	// Set the viewport
+    IntRect viewport = getViewport(m_view);
+    int top = getSize().y - (viewport.top + viewport.height);
+    C3D_SetViewport(top, viewport.left, viewport.height, viewport.width);
+
+	// Set the projection matrix
+    CitroSetMatrix(CitroGetProjectionMatrix(), m_view.getTransform().getMatrix());
+
+    m_cache.viewChanged = false;
 }
 
 
 ////////////////////////////////////////////////////////////
 void RenderTarget::applyTransform(const Transform& transform)
 {
-    memcpy(MtxStack_Cur(CitroGetModelviewMatrix())->m, transform.getMatrix(), sizeof(C3D_Mtx));
+    CitroSetMatrix(CitroGetModelviewMatrix(), transform.getMatrix());
 }
 
 
 ////////////////////////////////////////////////////////////
-void RenderTarget::applyTexture(const Texture* texture)
+void RenderTarget::applyStates(const BlendMode& blendMode, const UintRect& scissor, const Texture* texture, const Shader* shader)
 {
-    Texture::bind(texture, Texture::Pixels);
-
-    m_cache.lastTextureId = texture ? texture->m_cacheId : 0;
-}
+    if (Texture::bindTexture(texture, Texture::Pixels))
+        ++m_statistics.textureBinds;
+
+    CitroPipelineState state;
+
+    state.blend = CitroPackBlend(equationToGlConstant(blendMode.colorEquation),
+                                 equationToGlConstant(blendMode.alphaEquation),
+                                 factorToGlConstant(blendMode.colorSrcFactor),
+                                 factorToGlConstant(blendMode.colorDstFactor),
+                                 factorToGlConstant(blendMode.alphaSrcFactor),
+                                 factorToGlConstant(blendMode.alphaDstFactor));
+
+    // Alpha-only textures take their color from the vertices
+    if (m_combiner >= 0)
+        state.combiner = m_combiner;
+    else if (texture && texture->m_texture)
+        state.combiner = (texture->m_format == Texture::A8) ? CitroCombinerAlphaModulate : CitroCombinerModulate;
+    else
+        state.combiner = CitroCombinerColor;
+
+    if (scissor == UintRect())
+    {
+        state.scissor[0] = GPU_SCISSOR_DISABLE;
+        state.scissor[1] = state.scissor[2] = state.scissor[3] = state.scissor[4] = 0;
+    }
+    else
+    {
+        // Keep in mind the sideway 3ds screen, so it seems screwy
+        int bottom = getSize().x - scissor.left;
+        int top = getSize().y - scissor.top;
+        int left = top - scissor.height;
+        int right = bottom - scissor.width;
+        state.scissor[0] = GPU_SCISSOR_NORMAL;
+        state.scissor[1] = std::max(left, 0);
+        state.scissor[2] = std::max(right, 0);
+        state.scissor[3] = std::max(top, 0);
+        state.scissor[4] = std::max(bottom, 0);
+    }
 
+    // Shaders that failed to load fall back to the default one
+    state.program = shader ? shader->getNativeHandle() : NULL;
+    if (!state.program)
+        state.program = Shader::Default.getNativeHandle();
 
-////////////////////////////////////////////////////////////
-void RenderTarget::applyShader(const Shader* shader)
-{
-    Shader::bind(shader);
+    Uint32 changes = CitroApplyPipelineState(&state);
+    if (changes & CitroBlendChanged)
+        ++m_statistics.blendChanges;
+    if (changes & CitroScissorChanged)
+        ++m_statistics.scissorChanges;
 }
 
 } // namespace cpp3ds
@@ -449,25 +794,38 @@ void RenderTarget::applyShader(const Shader* shader)
 //   lead, in worst case, to changing it every 4 vertices.
 //   To avoid that, when the vertex count is low enough, we
 //   pre-transform them and therefore use an identity transform
-//   to render them.
+//   to render them. Matrices are only marked for upload when
+//   they differ from the one already set.
 //
-// * Blending mode
-//   Since it overloads the == operator, we can easily check
-//   whether any of the 6 blending components changed and,
-//   thus, whether we need to update the blend mode.
+// * Batching
+//   Pre-transformed vertices are appended to a pending batch
+//   as long as texture, blend mode, scissor and shader don't
+//   change, so that consecutive sprites or shapes sharing the
+//   same states cost a single GPU draw call. All primitives
+//   are stored as indexed triangles, so that quads only need
+//   4 vertices. The batch is submitted when a state or the
+//   view changes, when the buffers are full, or when the
+//   target is cleared/displayed.
 //
-// * Texture
-//   Storing the pointer or OpenGL ID of the last used texture
-//   is not enough; if the cpp3ds::Texture instance is destroyed,
-//   both the pointer and the OpenGL ID might be recycled in
-//   a new texture instance. We need to use our own unique
-//   identifier system to ensure consistent caching.
+// * Vertex format
+//   Compact vertices are read by their own attribute layout,
+//   which is only set again when the format of the submitted
+//   vertices changes. Batched vertices are always floats.
+//
+// * Pipeline state
+//   The GPU state is shared by all the targets, so it is cached
+//   by a shadow copy in CitroHelpers rather than by each target.
+//   Blend mode, texture combiner, scissor and shader program are
+//   gathered in a pipeline state for each submission; when it
+//   matches the shadow, nothing is sent, otherwise only the
+//   registers that changed are.
+//   resetGLStates marks the whole shadow dirty, in case direct
+//   citro3d calls changed anything.
 //
-// * Shader
-//   Shaders are very hard to optimize, because they have
-//   parameters that can be hard (if not impossible) to track,
-//   like matrices or textures. The only optimization that we
-//   do is that we avoid setting a null shader if there was
-//   already none for the previous draw.
+// * Texture
+//   Storing the pointer of the last used texture is not enough;
+//   if the cpp3ds::Texture instance is destroyed, the pointer
+//   might be recycled in a new texture instance. The shadow
+//   also compares the texture's unique cache identifier.
 //
 ////////////////////////////////////////////////////////////
@@ -113,6 +113,9 @@ bool RenderTexture::setActive(bool active)
 ////////////////////////////////////////////////////////////
 void RenderTexture::display()
 {
+    // Submit the primitives still waiting in the batch
+    flush();
+
     // Update the target texture
     if (setActive(true))
     {
@@ -120,6 +123,7 @@ void RenderTexture::display()
 //        glCheck(glBindTexture(GL_TEXTURE_2D, m_texture.m_texture));
 //        glCheck(glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, m_width, m_height));
         m_texture.m_pixelsFlipped = true;
+        m_texture.invalidateMipmap();
     }
 }
 
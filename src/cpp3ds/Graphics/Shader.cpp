@@ -282,18 +282,11 @@ void Shader::bind(const Shader* shader)
         return;
     }
 
+    // Only sent to the GPU if another program is bound
     if (shader && shader->m_shaderProgram)
-    {
-        // Enable the program
-        C3D_BindProgram(shader->m_shaderProgram);
-        CitroBindUniforms(shader->m_shaderProgram);
-    }
+        CitroSetProgram(shader->m_shaderProgram);
     else
-    {
-        // Bind default shader
-        C3D_BindProgram(Default.m_shaderProgram);
-        CitroBindUniforms(Default.m_shaderProgram);
-    }
+        CitroSetProgram(Default.m_shaderProgram);
 }
 
 
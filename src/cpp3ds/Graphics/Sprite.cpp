@@ -172,7 +172,7 @@ void Sprite::draw(RenderTarget& target, RenderStates states) const
     {
         states.transform *= getTransform();
         states.texture = m_texture;
-        target.draw(m_vertices, 4, TrianglesStrip, states);
+        target.draw(m_vertices, 4, Quads, states);
     }
 }
 
@@ -184,8 +184,8 @@ void Sprite::updatePositions()
 
     m_vertices[0].position = Vector2f(0, 0);
     m_vertices[1].position = Vector2f(0, bounds.height);
-    m_vertices[2].position = Vector2f(bounds.width, 0);
-    m_vertices[3].position = Vector2f(bounds.width, bounds.height);
+    m_vertices[2].position = Vector2f(bounds.width, bounds.height);
+    m_vertices[3].position = Vector2f(bounds.width, 0);
 }
 
 
@@ -199,8 +199,8 @@ void Sprite::updateTexCoords()
 
     m_vertices[0].texCoords = Vector2f(left, top);
     m_vertices[1].texCoords = Vector2f(left, bottom);
-    m_vertices[2].texCoords = Vector2f(right, top);
-    m_vertices[3].texCoords = Vector2f(right, bottom);
+    m_vertices[2].texCoords = Vector2f(right, bottom);
+    m_vertices[3].texCoords = Vector2f(right, top);
 }
 
 } // namespace cpp3ds
@@ -28,7 +28,10 @@
 #include <cpp3ds/Graphics/Text.hpp>
 #include <cpp3ds/Graphics/Texture.hpp>
 #include <cpp3ds/Graphics/RenderTarget.hpp>
+#include <cpp3ds/Graphics/Shader.hpp>
+#include <cpp3ds/System/Err.hpp>
 #include <cpp3ds/Resources.hpp>
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #ifndef EMULATION
@@ -40,26 +43,24 @@
 namespace
 {
 // Add an underline or strikethrough line to the vertex array
-void addLine(cpp3ds::VertexArray& vertices, float lineLength, float lineTop, const cpp3ds::Color& color, float offset, float thickness, float outlineThickness = 0)
+void addLine(cpp3ds::VertexArray& vertices, float lineLeft, float lineRight, float lineTop, const cpp3ds::Color& color, float offset, float thickness, float outlineThickness = 0)
 {
     float top = std::floor(lineTop + offset - (thickness / 2) + 0.5f);
     float bottom = top + std::floor(thickness + 0.5f);
 
-    vertices.append(cpp3ds::Vertex(cpp3ds::Vector2f(-outlineThickness,             top    - outlineThickness), color, cpp3ds::Vector2f(1, 1)));
-    vertices.append(cpp3ds::Vertex(cpp3ds::Vector2f(lineLength + outlineThickness, top    - outlineThickness), color, cpp3ds::Vector2f(1, 1)));
-    vertices.append(cpp3ds::Vertex(cpp3ds::Vector2f(-outlineThickness,             bottom + outlineThickness), color, cpp3ds::Vector2f(1, 1)));
-    vertices.append(cpp3ds::Vertex(cpp3ds::Vector2f(-outlineThickness,             bottom + outlineThickness), color, cpp3ds::Vector2f(1, 1)));
-    vertices.append(cpp3ds::Vertex(cpp3ds::Vector2f(lineLength + outlineThickness, top    - outlineThickness), color, cpp3ds::Vector2f(1, 1)));
-    vertices.append(cpp3ds::Vertex(cpp3ds::Vector2f(lineLength + outlineThickness, bottom + outlineThickness), color, cpp3ds::Vector2f(1, 1)));
+    vertices.append(cpp3ds::Vertex(cpp3ds::Vector2f(lineLeft  - outlineThickness, top    - outlineThickness), color, cpp3ds::Vector2f(1, 1)));
+    vertices.append(cpp3ds::Vertex(cpp3ds::Vector2f(lineRight + outlineThickness, top    - outlineThickness), color, cpp3ds::Vector2f(1, 1)));
+    vertices.append(cpp3ds::Vertex(cpp3ds::Vector2f(lineRight + outlineThickness, bottom + outlineThickness), color, cpp3ds::Vector2f(1, 1)));
+    vertices.append(cpp3ds::Vertex(cpp3ds::Vector2f(lineLeft  - outlineThickness, bottom + outlineThickness), color, cpp3ds::Vector2f(1, 1)));
 }
 
 // Add a glyph quad to the vertex array
-void addGlyphQuad(cpp3ds::VertexArray& vertices, cpp3ds::Vector2f position, const cpp3ds::Color& color, const cpp3ds::Glyph& glyph, float italic, float outlineThickness = 0)
+void addGlyphQuad(cpp3ds::VertexArray& vertices, cpp3ds::Vector2f position, const cpp3ds::Color& color, const cpp3ds::Glyph& glyph, float italic, float outlineThickness = 0, float scale = 1)
 {
-    float left   = glyph.bounds.left;
-    float top    = glyph.bounds.top;
-    float right  = glyph.bounds.left + glyph.bounds.width;
-    float bottom = glyph.bounds.top  + glyph.bounds.height;
+    float left   = glyph.bounds.left * scale;
+    float top    = glyph.bounds.top * scale;
+    float right  = (glyph.bounds.left + glyph.bounds.width) * scale;
+    float bottom = (glyph.bounds.top  + glyph.bounds.height) * scale;
 
     float u1 = static_cast<float>(glyph.textureRect.left);
     float v1 = static_cast<float>(glyph.textureRect.top);
@@ -68,11 +69,37 @@ void addGlyphQuad(cpp3ds::VertexArray& vertices, cpp3ds::Vector2f position, cons
 
     vertices.append(cpp3ds::Vertex(cpp3ds::Vector2f(position.x + left  - italic * top    - outlineThickness, position.y + top    - outlineThickness), color, cpp3ds::Vector2f(u1, v1)));
     vertices.append(cpp3ds::Vertex(cpp3ds::Vector2f(position.x + right - italic * top    - outlineThickness, position.y + top    - outlineThickness), color, cpp3ds::Vector2f(u2, v1)));
-    vertices.append(cpp3ds::Vertex(cpp3ds::Vector2f(position.x + left  - italic * bottom - outlineThickness, position.y + bottom - outlineThickness), color, cpp3ds::Vector2f(u1, v2)));
-    vertices.append(cpp3ds::Vertex(cpp3ds::Vector2f(position.x + left  - italic * bottom - outlineThickness, position.y + bottom - outlineThickness), color, cpp3ds::Vector2f(u1, v2)));
-    vertices.append(cpp3ds::Vertex(cpp3ds::Vector2f(position.x + right - italic * top    - outlineThickness, position.y + top    - outlineThickness), color, cpp3ds::Vector2f(u2, v1)));
     vertices.append(cpp3ds::Vertex(cpp3ds::Vector2f(position.x + right - italic * bottom - outlineThickness, position.y + bottom - outlineThickness), color, cpp3ds::Vector2f(u2, v2)));
+    vertices.append(cpp3ds::Vertex(cpp3ds::Vector2f(position.x + left  - italic * bottom - outlineThickness, position.y + bottom - outlineThickness), color, cpp3ds::Vector2f(u1, v2)));
+}
+
+#ifdef EMULATION
+// Thresholds the distance stored in the alpha of the glyphs, with an
+// antialiased edge about one screen pixel wide whatever the scale
+const char distanceFieldShaderCode[] =
+    "uniform sampler2D texture;\n"
+    "void main()\n"
+    "{\n"
+    "    float distance = texture2D(texture, gl_TexCoord[0].xy).a;\n"
+    "    float width = fwidth(distance) * 0.75;\n"
+    "    float alpha = smoothstep(0.5 - width, 0.5 + width, distance);\n"
+    "    gl_FragColor = vec4(gl_Color.rgb, gl_Color.a * alpha);\n"
+    "}\n";
+
+// Shader shared by all the distance field texts, loaded on first use
+const cpp3ds::Shader& getDistanceFieldShader()
+{
+    // Never destroyed: the GL context may be gone at exit
+    static cpp3ds::Shader* shader = NULL;
+    if (!shader)
+    {
+        shader = new cpp3ds::Shader;
+        if (!shader->loadFromMemory(distanceFieldShaderCode, cpp3ds::Shader::Fragment))
+            cpp3ds::err() << "Failed to load the distance field text shader" << std::endl;
+    }
+    return *shader;
 }
+#endif
 }
 
 
@@ -99,11 +126,22 @@ Text::Text() :
         m_fillColor         (255, 255, 255),
         m_outlineColor      (0, 0, 0),
         m_outlineThickness  (0),
-        m_vertices          (Triangles),
-        m_outlineVertices   (Triangles),
+        m_vertices          (Quads),
+        m_outlineVertices   (Quads),
+        m_pageVertices      (Quads),
+        m_outlinePageVertices(Quads),
+        m_quadPages         (),
+        m_outlineQuadPages  (),
+        m_pageRanges        (),
+        m_outlinePageRanges (),
+        m_pens              (),
         m_bounds            (),
         m_geometryNeedUpdate(false),
-        m_useSystemFont     (false)
+        m_validLength       (0),
+        m_useSystemFont     (false),
+        m_distanceField     (false),
+        m_layout            (NULL),
+        m_layoutRevision    (0)
 {
 
 }
@@ -118,11 +156,22 @@ Text::Text(const String& string, const Font& font, unsigned int characterSize) :
         m_fillColor         (255, 255, 255),
         m_outlineColor      (0, 0, 0),
         m_outlineThickness  (0),
-        m_vertices          (Triangles),
-        m_outlineVertices   (Triangles),
+        m_vertices          (Quads),
+        m_outlineVertices   (Quads),
+        m_pageVertices      (Quads),
+        m_outlinePageVertices(Quads),
+        m_quadPages         (),
+        m_outlineQuadPages  (),
+        m_pageRanges        (),
+        m_outlinePageRanges (),
+        m_pens              (),
         m_bounds            (),
         m_geometryNeedUpdate(true),
-        m_useSystemFont     (false)
+        m_validLength       (0),
+        m_useSystemFont     (false),
+        m_distanceField     (false),
+        m_layout            (NULL),
+        m_layoutRevision    (0)
 {
 
 }
@@ -133,7 +182,26 @@ void Text::setString(const String& string)
 {
     if (m_string != string)
     {
+        // The geometry of the characters both strings begin with can be kept
+        std::size_t length = std::min(m_string.getSize(), string.getSize());
+        std::size_t common = 0;
+        while ((common < length) && (m_string[common] == string[common]))
+            ++common;
+
         m_string = string;
+        m_validLength = std::min(m_validLength, common);
+        m_geometryNeedUpdate = true;
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+void Text::append(const String& string)
+{
+    if (!string.isEmpty())
+    {
+        m_validLength = std::min(m_validLength, m_string.getSize());
+        m_string += string;
         m_geometryNeedUpdate = true;
     }
 }
@@ -146,6 +214,7 @@ void Text::setFont(const Font& font)
     {
         m_font = &font;
         m_geometryNeedUpdate = true;
+        m_validLength = 0;
         m_useSystemFont = false;
     }
 }
@@ -156,6 +225,7 @@ void Text::useSystemFont()
 {
 #ifndef EMULATION
     m_geometryNeedUpdate = true;
+    m_validLength = 0;
     m_useSystemFont = true;
 #endif
 }
@@ -168,6 +238,7 @@ void Text::setCharacterSize(unsigned int size)
     {
         m_characterSize = size;
         m_geometryNeedUpdate = true;
+        m_validLength = 0;
     }
 }
 
@@ -179,6 +250,7 @@ void Text::setStyle(Uint32 style)
     {
         m_style = style;
         m_geometryNeedUpdate = true;
+        m_validLength = 0;
     }
 }
 
@@ -191,12 +263,11 @@ void Text::setFillColor(const Color& color)
         m_fillColor = color;
 
         // Change vertex colors directly, no need to update whole geometry
-        // (if geometry is updated anyway, we can skip this step)
-        if (!m_geometryNeedUpdate)
-        {
-            for (std::size_t i = 0; i < m_vertices.getVertexCount(); ++i)
-                m_vertices[i].color = m_fillColor;
-        }
+        // (even if it is updated, the unchanged characters are kept)
+        for (std::size_t i = 0; i < m_vertices.getVertexCount(); ++i)
+            m_vertices[i].color = m_fillColor;
+        for (std::size_t i = 0; i < m_pageVertices.getVertexCount(); ++i)
+            m_pageVertices[i].color = m_fillColor;
     }
 }
 
@@ -209,12 +280,11 @@ void Text::setOutlineColor(const Color& color)
         m_outlineColor = color;
 
         // Change vertex colors directly, no need to update whole geometry
-        // (if geometry is updated anyway, we can skip this step)
-        if (!m_geometryNeedUpdate)
-        {
-            for (std::size_t i = 0; i < m_outlineVertices.getVertexCount(); ++i)
-                m_outlineVertices[i].color = m_outlineColor;
-        }
+        // (even if it is updated, the unchanged characters are kept)
+        for (std::size_t i = 0; i < m_outlineVertices.getVertexCount(); ++i)
+            m_outlineVertices[i].color = m_outlineColor;
+        for (std::size_t i = 0; i < m_outlinePageVertices.getVertexCount(); ++i)
+            m_outlinePageVertices[i].color = m_outlineColor;
     }
 }
 
@@ -226,6 +296,32 @@ void Text::setOutlineThickness(float thickness)
     {
         m_outlineThickness = thickness;
         m_geometryNeedUpdate = true;
+        m_validLength = 0;
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+void Text::setDistanceFieldEnabled(bool enabled)
+{
+    if (enabled != m_distanceField)
+    {
+        m_distanceField = enabled;
+        m_geometryNeedUpdate = true;
+        m_validLength = 0;
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+void Text::setLayout(const TextLayout* layout)
+{
+    if (layout != m_layout)
+    {
+        m_layout = layout;
+        m_layoutRevision = 0;
+        m_geometryNeedUpdate = true;
+        m_validLength = 0;
     }
 }
 
@@ -279,6 +375,20 @@ float Text::getOutlineThickness() const
 }
 
 
+////////////////////////////////////////////////////////////
+bool Text::isDistanceFieldEnabled() const
+{
+    return m_distanceField;
+}
+
+
+////////////////////////////////////////////////////////////
+const TextLayout* Text::getLayout() const
+{
+    return m_layout;
+}
+
+
 ////////////////////////////////////////////////////////////
 Vector2f Text::findCharacterPosSystemFont(std::size_t index) const
 {
@@ -292,6 +402,10 @@ Vector2f Text::findCharacterPos(std::size_t index) const
     if (m_useSystemFont)
         return findCharacterPosSystemFont(index);
 
+    // The layout knows the position of every character
+    if (m_layout)
+        return getTransform().transformPoint(m_layout->findCharacterPos(index));
+
     // Make sure that we have a valid font
     if (!m_font)
         return Vector2f();
@@ -301,9 +415,11 @@ Vector2f Text::findCharacterPos(std::size_t index) const
         index = m_string.getSize();
 
     // Precompute the variables needed by the algorithm
-    bool  bold   = (m_style & Bold) != 0;
-    float hspace = static_cast<float>(m_font->getGlyph(L' ', m_characterSize, bold).advance);
-    float vspace = static_cast<float>(m_font->getLineSpacing(m_characterSize));
+    bool         bold     = (m_style & Bold) != 0;
+    unsigned int fontSize = getFontSize();
+    float        scale    = getFontScale();
+    float        hspace   = getGlyph(L' ', bold).advance * scale;
+    float        vspace   = m_font->getLineSpacing(fontSize) * scale;
 
     // Compute the position
     Vector2f position;
@@ -313,7 +429,7 @@ Vector2f Text::findCharacterPos(std::size_t index) const
         Uint32 curChar = m_string[i];
 
         // Apply the kerning offset
-        position.x += static_cast<float>(m_font->getKerning(prevChar, curChar, m_characterSize));
+        position.x += m_font->getKerning(prevChar, curChar, fontSize) * scale;
         prevChar = curChar;
 
         // Handle special characters
@@ -325,7 +441,7 @@ Vector2f Text::findCharacterPos(std::size_t index) const
         }
 
         // For regular characters, add the advance offset of the glyph
-        position.x += static_cast<float>(m_font->getGlyph(curChar, m_characterSize, bold).advance);
+        position.x += getGlyph(curChar, bold).advance * scale;
     }
 
     // Transform the position to global coordinates
@@ -356,69 +472,293 @@ void Text::drawSystemFont(RenderTarget& target, RenderStates states) const
 {
     ensureGeometryUpdate();
     states.transform *= getTransform();
+
+    // The system font is drawn directly, pending primitives must go first
+    target.flush();
 #ifdef _3DS
     if (target.m_cache.viewChanged)
         target.applyCurrentView();
-    if (states.blendMode != target.m_cache.lastBlendMode)
-        target.applyBlendMode(states.blendMode);
-    if (states.shader)
-        target.applyShader(states.shader);
-    if (states.scissor != target.m_cache.lastScissor)
-        target.applyScissor(states.scissor);
+
+    // The glyph textures are bound below, the combiner only takes their alpha
+    target.m_combiner = CitroCombinerAlphaModulate;
+    target.applyStates(states.blendMode, states.scissor, NULL, states.shader);
+    target.m_combiner = -1;
 
     target.applyTransform(states.transform);
-    Mtx_Identity(MtxStack_Cur(CitroGetTextureMatrix()));
     CitroUpdateMatrixStacks();
 
+    // The previous draw may have used compact vertices
+    CitroSetVertexFormat(CitroVertexFloat);
     C3D_BufInfo* bufInfo = C3D_GetBufInfo();
     BufInfo_Init(bufInfo);
     BufInfo_Add(bufInfo, &m_vertices[0], sizeof(Vertex), 3, 0x210);
 
-    C3D_TexEnv* env = C3D_GetTexEnv(0);
-    C3D_TexEnvSrc(env, C3D_RGB, GPU_PRIMARY_COLOR, 0, 0);
-    C3D_TexEnvSrc(env, C3D_Alpha, GPU_TEXTURE0, GPU_PRIMARY_COLOR, 0);
-    C3D_TexEnvOp(env, C3D_Both, 0, 0, 0);
-    C3D_TexEnvFunc(env, C3D_RGB, GPU_REPLACE);
-    C3D_TexEnvFunc(env, C3D_Alpha, GPU_MODULATE);
-
+    // Consecutive glyphs on the same texture don't bind it again
     int vertexIndex = 0;
-    int lastTextureIndex = -1;
     for (Uint16 textureIndex : m_systemGlyphTextures)
     {
-        if (lastTextureIndex != textureIndex) {
-            lastTextureIndex = textureIndex;
-            C3D_TexBind(0, system_font_textures[textureIndex].getNativeTexture());
-        }
+        CitroSetTexture(system_font_textures[textureIndex].getNativeTexture(), 0);
         C3D_DrawArrays(GPU_TRIANGLE_STRIP, vertexIndex, 4);
         vertexIndex += 4;
     }
 #endif
-    target.applyTexture(NULL);
 }
 
 
 ////////////////////////////////////////////////////////////
 void Text::draw(RenderTarget& target, RenderStates states) const
 {
-    if (m_string.isEmpty())
+    if (m_layout ? m_layout->getString().isEmpty() : m_string.isEmpty())
         return;
 
     if (m_useSystemFont)
     {
         drawSystemFont(target, states);
     }
-    else if (m_font)
+    else if (getDrawnFont())
     {
         ensureGeometryUpdate();
 
         states.transform *= getTransform();
-        states.texture = &m_font->getTexture(m_characterSize);
+
+        if (m_distanceField)
+        {
+            drawDistanceField(target, states);
+            return;
+        }
 
         // Only draw the outline if there is something to draw
         if (m_outlineThickness != 0)
-            target.draw(m_outlineVertices, states);
+            drawPages(target, states, m_outlineVertices, m_outlinePageVertices, m_outlinePageRanges);
+
+        drawPages(target, states, m_vertices, m_pageVertices, m_pageRanges);
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+void Text::drawPages(RenderTarget& target, RenderStates states, const VertexArray& vertices, const VertexArray& sorted, const std::vector<PageRange>& ranges) const
+{
+    const VertexArray& source = (sorted.getVertexCount() > 0) ? sorted : vertices;
+    for (std::vector<PageRange>::const_iterator it = ranges.begin(); it != ranges.end(); ++it)
+    {
+        if (m_distanceField)
+            states.texture = &getDrawnFont()->getDistanceFieldTexture(it->page);
+        else
+            states.texture = &getDrawnFont()->getTexture(getDrawnCharacterSize(), it->page);
+        target.draw(&source[it->start], static_cast<unsigned int>(it->count), Quads, states);
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+void Text::drawDistanceField(RenderTarget& target, RenderStates states) const
+{
+#ifdef EMULATION
+    states.shader = &getDistanceFieldShader();
+    drawPages(target, states, m_vertices, m_pageVertices, m_pageRanges);
+#else
+    // No fragment shader on the GPU: the texture combiners turn the
+    // distance into alpha, and the alpha test drops what is outside
+    target.flush();
+    target.m_combiner = CitroCombinerDistanceField;
+    drawPages(target, states, m_vertices, m_pageVertices, m_pageRanges);
+    target.flush();
+    target.m_combiner = -1;
+#endif
+}
+
+
+////////////////////////////////////////////////////////////
+const Glyph& Text::getGlyph(Uint32 codePoint, bool bold, float outlineThickness) const
+{
+    if (m_distanceField)
+        return getDrawnFont()->getDistanceFieldGlyph(codePoint, bold);
+    else
+        return getDrawnFont()->getGlyph(codePoint, getDrawnCharacterSize(), bold, outlineThickness);
+}
+
+
+////////////////////////////////////////////////////////////
+FloatRect Text::getGlyphBounds(const Glyph& glyph) const
+{
+    FloatRect bounds = glyph.bounds;
+
+    // Distance field glyphs have a margin around the character
+    if (m_distanceField && (bounds.width > 0) && (bounds.height > 0))
+    {
+        float spread = static_cast<float>(Font::DistanceFieldSpread);
+        bounds.left   += spread;
+        bounds.top    += spread;
+        bounds.width  -= 2 * spread;
+        bounds.height -= 2 * spread;
+    }
+
+    float scale = getFontScale();
+    return FloatRect(bounds.left * scale, bounds.top * scale, bounds.width * scale, bounds.height * scale);
+}
+
+
+////////////////////////////////////////////////////////////
+unsigned int Text::getFontSize() const
+{
+    return m_distanceField ? Font::DistanceFieldSize : getDrawnCharacterSize();
+}
+
+
+////////////////////////////////////////////////////////////
+float Text::getFontScale() const
+{
+    return m_distanceField ? static_cast<float>(getDrawnCharacterSize()) / Font::DistanceFieldSize : 1.f;
+}
+
+
+////////////////////////////////////////////////////////////
+const Font* Text::getDrawnFont() const
+{
+    return m_layout ? m_layout->getFont() : m_font;
+}
+
+
+////////////////////////////////////////////////////////////
+unsigned int Text::getDrawnCharacterSize() const
+{
+    return m_layout ? m_layout->getCharacterSize() : m_characterSize;
+}
+
+
+////////////////////////////////////////////////////////////
+float Text::addGlyph(Uint32 codePoint, Pen& pen, bool bold, float italic) const
+{
+    float outlineThickness = m_distanceField ? 0.f : m_outlineThickness;
+
+    // Apply the outline
+    if (outlineThickness != 0)
+    {
+        const Glyph& glyph = getGlyph(codePoint, bold, outlineThickness);
+
+        float left   = glyph.bounds.left;
+        float top    = glyph.bounds.top;
+        float right  = glyph.bounds.left + glyph.bounds.width;
+        float bottom = glyph.bounds.top  + glyph.bounds.height;
+
+        // Add the outline glyph to the vertices
+        addGlyphQuad(m_outlineVertices, Vector2f(pen.x, pen.y), m_outlineColor, glyph, italic, outlineThickness);
+        m_outlineQuadPages.push_back(glyph.page);
+
+        // Update the current bounds with the outlined glyph bounds
+        pen.minX = std::min(pen.minX, pen.x + left   - italic * bottom - outlineThickness);
+        pen.maxX = std::max(pen.maxX, pen.x + right  - italic * top    - outlineThickness);
+        pen.minY = std::min(pen.minY, pen.y + top    - outlineThickness);
+        pen.maxY = std::max(pen.maxY, pen.y + bottom - outlineThickness);
+    }
+
+    // Extract the current glyph's description
+    const Glyph& glyph = getGlyph(codePoint, bold);
+    float scale = getFontScale();
+
+    // Add the glyph to the vertices
+    addGlyphQuad(m_vertices, Vector2f(pen.x, pen.y), m_fillColor, glyph, italic, 0, scale);
+    m_quadPages.push_back(glyph.page);
 
-        target.draw(m_vertices, states);
+    // Update the current bounds with the non outlined glyph bounds
+    if (outlineThickness == 0)
+    {
+        FloatRect bounds = getGlyphBounds(glyph);
+        float left   = bounds.left;
+        float top    = bounds.top;
+        float right  = bounds.left + bounds.width;
+        float bottom = bounds.top  + bounds.height;
+
+        pen.minX = std::min(pen.minX, pen.x + left  - italic * bottom);
+        pen.maxX = std::max(pen.maxX, pen.x + right - italic * top);
+        pen.minY = std::min(pen.minY, pen.y + top);
+        pen.maxY = std::max(pen.maxY, pen.y + bottom);
+    }
+
+    return glyph.advance * scale;
+}
+
+
+////////////////////////////////////////////////////////////
+void Text::addDecorations(float left, float right, float y, Uint32 style) const
+{
+    bool underlined    = (style & Underlined) != 0;
+    bool strikeThrough = (style & StrikeThrough) != 0;
+    if (!underlined && !strikeThrough)
+        return;
+
+    unsigned int fontSize         = getFontSize();
+    float        scale            = getFontScale();
+    float        outlineThickness = m_distanceField ? 0.f : m_outlineThickness;
+
+    // We reuse the underline thickness as the thickness of the strike through as well
+    float thickness = getDrawnFont()->getUnderlineThickness(fontSize) * scale;
+
+    // Lines use the page of the previous glyph, any page has the white square
+    unsigned int page        = m_quadPages.empty() ? 0 : m_quadPages.back();
+    unsigned int outlinePage = m_outlineQuadPages.empty() ? 0 : m_outlineQuadPages.back();
+
+    std::vector<float> offsets;
+    if (underlined)
+        offsets.push_back(getDrawnFont()->getUnderlinePosition(fontSize) * scale);
+
+    // Compute the location of the strike through dynamically
+    // We use the center point of the lowercase 'x' glyph as the reference
+    if (strikeThrough)
+    {
+        FloatRect xBounds = getGlyphBounds(getGlyph(L'x', (style & Bold) != 0));
+        offsets.push_back(xBounds.top + xBounds.height / 2.f);
+    }
+
+    for (std::vector<float>::const_iterator offset = offsets.begin(); offset != offsets.end(); ++offset)
+    {
+        addLine(m_vertices, left, right, y, m_fillColor, *offset, thickness);
+        m_quadPages.push_back(page);
+
+        if (outlineThickness != 0)
+        {
+            addLine(m_outlineVertices, left, right, y, m_outlineColor, *offset, thickness, outlineThickness);
+            m_outlineQuadPages.push_back(outlinePage);
+        }
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+void Text::sortByPage(const VertexArray& vertices, const std::vector<unsigned int>& quadPages, std::vector<PageRange>& ranges, VertexArray& sorted)
+{
+    sorted.clear();
+    if (quadPages.empty())
+        return;
+
+    // Count the quads of each page, to find where each page starts
+    unsigned int pageCount = *std::max_element(quadPages.begin(), quadPages.end()) + 1;
+    std::vector<std::size_t> starts(pageCount + 1, 0);
+    for (std::size_t i = 0; i < quadPages.size(); ++i)
+        ++starts[quadPages[i] + 1];
+    for (unsigned int page = 0; page < pageCount; ++page)
+        starts[page + 1] += starts[page];
+
+    for (unsigned int page = 0; page < pageCount; ++page)
+    {
+        if (starts[page + 1] > starts[page])
+        {
+            PageRange range = {page, starts[page] * 4, (starts[page + 1] - starts[page]) * 4};
+            ranges.push_back(range);
+        }
+    }
+
+    // Most texts use a single page and are already sorted
+    if (ranges.size() < 2)
+        return;
+
+    sorted.resize(vertices.getVertexCount());
+    for (std::size_t i = 0; i < quadPages.size(); ++i)
+    {
+        std::size_t dest = starts[quadPages[i]]++ * 4;
+        for (std::size_t j = 0; j < 4; ++j)
+            sorted[dest + j] = vertices[i * 4 + j];
     }
 }
 
@@ -494,6 +834,18 @@ void Text::ensureGeometryUpdate() const
 		priv::system_font.loadFromMemory(font.data, font.size);
 	}
 
+    // A layout changed since the last update invalidates everything
+    if (m_layout)
+    {
+        m_layout->ensureUpdate();
+        if (m_layoutRevision != m_layout->m_revision)
+        {
+            m_layoutRevision = m_layout->m_revision;
+            m_geometryNeedUpdate = true;
+            m_validLength = 0;
+        }
+    }
+
     // Do nothing, if geometry has not changed
     if (!m_geometryNeedUpdate)
         return;
@@ -501,14 +853,33 @@ void Text::ensureGeometryUpdate() const
     // Mark geometry as updated
     m_geometryNeedUpdate = false;
 
+    const String& string = m_layout ? m_layout->getString() : m_string;
+
+    // The characters before this one keep their geometry
+    std::size_t start = (m_useSystemFont || m_layout) ? 0 : m_validLength;
+    m_validLength = string.getSize();
+
     // Clear the previous geometry
-    m_vertices.clear();
-    m_outlineVertices.clear();
+    if (start == 0)
+    {
+        m_vertices.clear();
+        m_outlineVertices.clear();
+        m_quadPages.clear();
+        m_outlineQuadPages.clear();
+        m_pens.clear();
+    }
+    m_pageVertices.clear();
+    m_outlinePageVertices.clear();
+    m_pageRanges.clear();
+    m_outlinePageRanges.clear();
     m_bounds = FloatRect();
 
     // No font or text: nothing to draw
-    if (!m_font || m_string.isEmpty())
+    if (!getDrawnFont() || string.isEmpty())
+    {
+        m_validLength = 0;
         return;
+    }
 
     if (m_useSystemFont)
     {
@@ -516,148 +887,149 @@ void Text::ensureGeometryUpdate() const
         return;
     }
 
+    float size = static_cast<float>(getDrawnCharacterSize());
+    Pen   pen  = {0.f, size, size, size, 0.f, 0.f, 0, 0};
+
+    if (m_layout)
+        ensureGeometryUpdateLayout(pen);
+    else
+        ensureGeometryUpdateString(start, pen);
+
+    // Draw the glyphs of each font page at once
+    sortByPage(m_vertices, m_quadPages, m_pageRanges, m_pageVertices);
+    sortByPage(m_outlineVertices, m_outlineQuadPages, m_outlinePageRanges, m_outlinePageVertices);
+
+    // Update the bounding rectangle
+    m_bounds.left = pen.minX;
+    m_bounds.top = pen.minY;
+    m_bounds.width = pen.maxX - pen.minX;
+    m_bounds.height = pen.maxY - pen.minY;
+}
+
+
+////////////////////////////////////////////////////////////
+void Text::ensureGeometryUpdateString(std::size_t start, Pen& pen) const
+{
     // Compute values related to the text style
-    bool  bold               = (m_style & Bold) != 0;
-    bool  underlined         = (m_style & Underlined) != 0;
-    bool  strikeThrough      = (m_style & StrikeThrough) != 0;
-    float italic             = (m_style & Italic) ? 0.208f : 0.f; // 12 degrees
-    float underlineOffset    = m_font->getUnderlinePosition(m_characterSize);
-    float underlineThickness = m_font->getUnderlineThickness(m_characterSize);
+    bool  bold   = (m_style & Bold) != 0;
+    float italic = (m_style & Italic) ? 0.208f : 0.f; // 12 degrees
 
-    // Compute the location of the strike through dynamically
-    // We use the center point of the lowercase 'x' glyph as the reference
-    // We reuse the underline thickness as the thickness of the strike through as well
-    FloatRect xBounds = m_font->getGlyph(L'x', m_characterSize, bold).bounds;
-    float strikeThroughOffset = xBounds.top + xBounds.height / 2.f;
+    // With distance fields, the metrics are given at the reference size
+    unsigned int fontSize = getFontSize();
+    float        scale    = getFontScale();
 
     // Precompute the variables needed by the algorithm
-    float hspace = static_cast<float>(m_font->getGlyph(L' ', m_characterSize, bold).advance);
-    float vspace = static_cast<float>(m_font->getLineSpacing(m_characterSize));
-    float x      = 0.f;
-    float y      = static_cast<float>(m_characterSize);
+    float hspace = getGlyph(L' ', bold).advance * scale;
+    float vspace = m_font->getLineSpacing(fontSize) * scale;
+
+    // Start where the kept characters end, dropping the geometry after them
+    if (start > 0)
+    {
+        pen = m_pens[start];
+        m_pens.resize(start);
+        m_vertices.resize(pen.vertexCount);
+        m_outlineVertices.resize(pen.outlineVertexCount);
+        m_quadPages.resize(pen.vertexCount / 4);
+        m_outlineQuadPages.resize(pen.outlineVertexCount / 4);
+    }
 
     // Create one quad for each character
-    float minX = static_cast<float>(m_characterSize);
-    float minY = static_cast<float>(m_characterSize);
-    float maxX = 0.f;
-    float maxY = 0.f;
-    Uint32 prevChar = 0;
-    for (std::size_t i = 0; i < m_string.getSize(); ++i)
+    Uint32 prevChar = (start > 0) ? m_string[start - 1] : 0;
+    m_pens.reserve(m_string.getSize() + 1);
+    for (std::size_t i = start; i < m_string.getSize(); ++i)
     {
+        // Remember the state of the layout, to resume from here later
+        pen.vertexCount = m_vertices.getVertexCount();
+        pen.outlineVertexCount = m_outlineVertices.getVertexCount();
+        m_pens.push_back(pen);
+
         Uint32 curChar = m_string[i];
 
         // Apply the kerning offset
-        x += m_font->getKerning(prevChar, curChar, m_characterSize);
+        pen.x += m_font->getKerning(prevChar, curChar, fontSize) * scale;
         prevChar = curChar;
 
-        // If we're using the underlined style and there's a new line, draw a line
-        if (underlined && (curChar == L'\n'))
-        {
-            addLine(m_vertices, x, y, m_fillColor, underlineOffset, underlineThickness);
-
-            if (m_outlineThickness != 0)
-                addLine(m_outlineVertices, x, y, m_outlineColor, underlineOffset, underlineThickness, m_outlineThickness);
-        }
-
-        // If we're using the strike through style and there's a new line, draw a line across all characters
-        if (strikeThrough && (curChar == L'\n'))
-        {
-            addLine(m_vertices, x, y, m_fillColor, strikeThroughOffset, underlineThickness);
-
-            if (m_outlineThickness != 0)
-                addLine(m_outlineVertices, x, y, m_outlineColor, strikeThroughOffset, underlineThickness, m_outlineThickness);
-        }
+        // If we're using the underlined or strike through style and there's a new line, draw the lines
+        if (curChar == L'\n')
+            addDecorations(0.f, pen.x, pen.y, m_style);
 
         // Handle special characters
         if ((curChar == ' ') || (curChar == '\t') || (curChar == '\n'))
         {
             // Update the current bounds (min coordinates)
-            minX = std::min(minX, x);
-            minY = std::min(minY, y);
+            pen.minX = std::min(pen.minX, pen.x);
+            pen.minY = std::min(pen.minY, pen.y);
 
             switch (curChar)
             {
-                case ' ':  x += hspace;        break;
-                case '\t': x += hspace * 4;    break;
-                case '\n': y += vspace; x = 0; break;
+                case ' ':  pen.x += hspace;            break;
+                case '\t': pen.x += hspace * 4;        break;
+                case '\n': pen.y += vspace; pen.x = 0; break;
             }
 
             // Update the current bounds (max coordinates)
-            maxX = std::max(maxX, x);
-            maxY = std::max(maxY, y);
+            pen.maxX = std::max(pen.maxX, pen.x);
+            pen.maxY = std::max(pen.maxY, pen.y);
 
             // Next glyph, no need to create a quad for whitespace
             continue;
         }
 
+        // Add the glyph and advance to the next character
+        pen.x += addGlyph(curChar, pen, bold, italic);
+    }
 
-        // Apply the outline
-        if (m_outlineThickness != 0)
-        {
-            const Glyph& glyph = m_font->getGlyph(curChar, m_characterSize, bold, m_outlineThickness);
-
-            float left   = glyph.bounds.left;
-            float top    = glyph.bounds.top;
-            float right  = glyph.bounds.left + glyph.bounds.width;
-            float bottom = glyph.bounds.top  + glyph.bounds.height;
-
-            // Add the outline glyph to the vertices
-            addGlyphQuad(m_outlineVertices, Vector2f(x, y), m_outlineColor, glyph, italic, m_outlineThickness);
+    // The state at the end is where appended characters start
+    pen.vertexCount = m_vertices.getVertexCount();
+    pen.outlineVertexCount = m_outlineVertices.getVertexCount();
+    m_pens.push_back(pen);
 
-            // Update the current bounds with the outlined glyph bounds
-            minX = std::min(minX, x + left   - italic * bottom - m_outlineThickness);
-            maxX = std::max(maxX, x + right  - italic * top    - m_outlineThickness);
-            minY = std::min(minY, y + top    - m_outlineThickness);
-            maxY = std::max(maxY, y + bottom - m_outlineThickness);
-        }
+    // If we're using the underlined or strike through style, add the last lines
+    if (pen.x > 0)
+        addDecorations(0.f, pen.x, pen.y, m_style);
+}
 
-        // Extract the current glyph's description
-        const Glyph& glyph = m_font->getGlyph(curChar, m_characterSize, bold);
 
-        // Add the glyph to the vertices
-        addGlyphQuad(m_vertices, Vector2f(x, y), m_fillColor, glyph, italic);
+////////////////////////////////////////////////////////////
+void Text::ensureGeometryUpdateLayout(Pen& pen) const
+{
+    const String& string = m_layout->getString();
+    Uint32        style  = m_layout->getStyle();
+    bool          bold   = (style & Bold) != 0;
+    float         italic = (style & Italic) ? 0.208f : 0.f; // 12 degrees
+    float         size   = static_cast<float>(getDrawnCharacterSize());
+
+    // The layout has placed every character, only the quads are left to build
+    for (std::size_t l = 0; l < m_layout->m_lines.size(); ++l)
+    {
+        const TextLayout::Line& line = m_layout->m_lines[l];
 
-        // Update the current bounds with the non outlined glyph bounds
-        if (m_outlineThickness == 0)
+        for (std::size_t i = line.start; i < line.end; ++i)
         {
-            float left   = glyph.bounds.left;
-            float top    = glyph.bounds.top;
-            float right  = glyph.bounds.left + glyph.bounds.width;
-            float bottom = glyph.bounds.top  + glyph.bounds.height;
-
-            minX = std::min(minX, x + left  - italic * bottom);
-            maxX = std::max(maxX, x + right - italic * top);
-            minY = std::min(minY, y + top);
-            maxY = std::max(maxY, y + bottom);
-        }
+            Uint32 curChar = string[i];
+            const Vector2f& position = m_layout->m_positions[i];
+            pen.x = position.x;
+            pen.y = position.y + size;
 
-        // Advance to the next character
-        x += glyph.advance;
-    }
-
-    // If we're using the underlined style, add the last line
-    if (underlined && (x > 0))
-    {
-        addLine(m_vertices, x, y, m_fillColor, underlineOffset, underlineThickness);
-
-        if (m_outlineThickness != 0)
-            addLine(m_outlineVertices, x, y, m_outlineColor, underlineOffset, underlineThickness, m_outlineThickness);
-    }
+            // Whitespace only extends the bounds
+            if ((curChar == ' ') || (curChar == '\t') || (curChar == '\n'))
+            {
+                const Vector2f& next = m_layout->m_positions[i + 1];
+                pen.minX = std::min(pen.minX, pen.x);
+                pen.minY = std::min(pen.minY, pen.y);
+                pen.maxX = std::max(pen.maxX, next.x);
+                pen.maxY = std::max(pen.maxY, next.y + size);
+                continue;
+            }
 
-    // If we're using the strike through style, add the last line across all characters
-    if (strikeThrough && (x > 0))
-    {
-        addLine(m_vertices, x, y, m_fillColor, strikeThroughOffset, underlineThickness);
+            addGlyph(curChar, pen, bold, italic);
+        }
 
-        if (m_outlineThickness != 0)
-            addLine(m_outlineVertices, x, y, m_outlineColor, strikeThroughOffset, underlineThickness, m_outlineThickness);
+        // Underline and strike through the visible part of the line
+        if (line.width > 0)
+            addDecorations(line.left, line.left + line.width, line.top + size, style);
     }
-
-    // Update the bounding rectangle
-    m_bounds.left = minX;
-    m_bounds.top = minY;
-    m_bounds.width = maxX - minX;
-    m_bounds.height = maxY - minY;
 }
 
+
 } // namespace cpp3ds
\ No newline at end of file
@@ -0,0 +1,406 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cpp3ds/Graphics/TextLayout.hpp>
+#include <cpp3ds/Graphics/Text.hpp>
+#include <algorithm>
+
+
+namespace
+{
+// Orders lines by their first character
+bool startsBefore(std::size_t index, const cpp3ds::TextLayout::Line& line)
+{
+    return index < line.start;
+}
+
+// Orders positions horizontally
+bool isLeftOf(const cpp3ds::Vector2f& position, float x)
+{
+    return position.x < x;
+}
+}
+
+
+namespace cpp3ds
+{
+////////////////////////////////////////////////////////////
+TextLayout::TextLayout() :
+m_string       (),
+m_font         (NULL),
+m_characterSize(30),
+m_style        (Text::Regular),
+m_wrapWidth    (0.f),
+m_alignment    (Left),
+m_positions    (),
+m_lines        (),
+m_bounds       (),
+m_lineSpacing  (0.f),
+m_needUpdate   (true),
+m_revision     (0)
+{
+}
+
+
+////////////////////////////////////////////////////////////
+TextLayout::TextLayout(const String& string, const Font& font, unsigned int characterSize) :
+m_string       (string),
+m_font         (&font),
+m_characterSize(characterSize),
+m_style        (Text::Regular),
+m_wrapWidth    (0.f),
+m_alignment    (Left),
+m_positions    (),
+m_lines        (),
+m_bounds       (),
+m_lineSpacing  (0.f),
+m_needUpdate   (true),
+m_revision     (0)
+{
+}
+
+
+////////////////////////////////////////////////////////////
+void TextLayout::setString(const String& string)
+{
+    if (m_string != string)
+    {
+        m_string = string;
+        m_needUpdate = true;
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+void TextLayout::setFont(const Font& font)
+{
+    if (m_font != &font)
+    {
+        m_font = &font;
+        m_needUpdate = true;
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+void TextLayout::setCharacterSize(unsigned int size)
+{
+    if (m_characterSize != size)
+    {
+        m_characterSize = size;
+        m_needUpdate = true;
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+void TextLayout::setStyle(Uint32 style)
+{
+    if (m_style != style)
+    {
+        m_style = style;
+        m_needUpdate = true;
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+void TextLayout::setWrapWidth(float width)
+{
+    if (m_wrapWidth != width)
+    {
+        m_wrapWidth = width;
+        m_needUpdate = true;
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+void TextLayout::setAlignment(Alignment alignment)
+{
+    if (m_alignment != alignment)
+    {
+        m_alignment = alignment;
+        m_needUpdate = true;
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+const String& TextLayout::getString() const
+{
+    return m_string;
+}
+
+
+////////////////////////////////////////////////////////////
+const Font* TextLayout::getFont() const
+{
+    return m_font;
+}
+
+
+////////////////////////////////////////////////////////////
+unsigned int TextLayout::getCharacterSize() const
+{
+    return m_characterSize;
+}
+
+
+////////////////////////////////////////////////////////////
+Uint32 TextLayout::getStyle() const
+{
+    return m_style;
+}
+
+
+////////////////////////////////////////////////////////////
+float TextLayout::getWrapWidth() const
+{
+    return m_wrapWidth;
+}
+
+
+////////////////////////////////////////////////////////////
+TextLayout::Alignment TextLayout::getAlignment() const
+{
+    return m_alignment;
+}
+
+
+////////////////////////////////////////////////////////////
+std::size_t TextLayout::getLineCount() const
+{
+    ensureUpdate();
+
+    return m_lines.size();
+}
+
+
+////////////////////////////////////////////////////////////
+const TextLayout::Line& TextLayout::getLine(std::size_t index) const
+{
+    ensureUpdate();
+
+    return m_lines[index];
+}
+
+
+////////////////////////////////////////////////////////////
+std::size_t TextLayout::findLine(std::size_t index) const
+{
+    ensureUpdate();
+
+    // The line is the last one starting at or before the character
+    std::vector<Line>::const_iterator it = std::upper_bound(m_lines.begin(), m_lines.end(), index, startsBefore);
+    return static_cast<std::size_t>(it - m_lines.begin()) - 1;
+}
+
+
+////////////////////////////////////////////////////////////
+Vector2f TextLayout::findCharacterPos(std::size_t index) const
+{
+    ensureUpdate();
+
+    return m_positions[std::min(index, m_string.getSize())];
+}
+
+
+////////////////////////////////////////////////////////////
+std::size_t TextLayout::findCharacterAt(const Vector2f& point) const
+{
+    ensureUpdate();
+
+    // All the lines have the same height
+    std::size_t lineIndex = 0;
+    if ((m_lineSpacing > 0) && (point.y > 0))
+        lineIndex = std::min(static_cast<std::size_t>(point.y / m_lineSpacing), m_lines.size() - 1);
+    const Line& line = m_lines[lineIndex];
+
+    // The caret can't go after the line break, which belongs to the next line
+    std::size_t first = line.start;
+    std::size_t last  = (lineIndex + 1 < m_lines.size()) ? line.end - 1 : line.end;
+
+    // Take the nearest of the two positions around the point
+    std::vector<Vector2f>::const_iterator begin = m_positions.begin();
+    std::size_t index = std::lower_bound(begin + first, begin + last + 1, point.x, isLeftOf) - begin;
+    if (index == first)
+        return first;
+    if (index > last)
+        return last;
+
+    float right = m_positions[index].x - point.x;
+    float left  = point.x - m_positions[index - 1].x;
+    return (left <= right) ? index - 1 : index;
+}
+
+
+////////////////////////////////////////////////////////////
+FloatRect TextLayout::getCharacterBounds(std::size_t index) const
+{
+    ensureUpdate();
+
+    std::size_t lineIndex = findLine(index);
+    const Line& line = m_lines[lineIndex];
+    const Vector2f& position = m_positions[index];
+
+    // The last character of a broken line has no follower on its line
+    float width;
+    if ((index + 1 < line.end) || (lineIndex + 1 == m_lines.size()))
+        width = m_positions[index + 1].x - position.x;
+    else
+        width = getAdvance(m_string[index]);
+
+    return FloatRect(position.x, position.y, width, m_lineSpacing);
+}
+
+
+////////////////////////////////////////////////////////////
+FloatRect TextLayout::getBounds() const
+{
+    ensureUpdate();
+
+    return m_bounds;
+}
+
+
+////////////////////////////////////////////////////////////
+void TextLayout::ensureUpdate() const
+{
+    // Do nothing, if nothing has changed
+    if (!m_needUpdate)
+        return;
+
+    // Mark the layout as updated
+    m_needUpdate = false;
+    ++m_revision;
+
+    std::size_t count = m_string.getSize();
+    m_positions.assign(count + 1, Vector2f());
+    m_lines.clear();
+    m_bounds = FloatRect();
+    m_lineSpacing = m_font ? m_font->getLineSpacing(m_characterSize) : 0.f;
+
+    // Place the characters on lines, wrapping them as they come
+    Line        line       = {0, 0, 0.f, 0.f, 0.f};
+    float       x          = 0.f; // Position of the pen
+    float       visible    = 0.f; // Width of the line without its trailing spaces
+    std::size_t breakStart = 0;   // Where a new line would start, after the last space
+    float       breakWidth = 0.f; // Width of the line if broken there
+    Uint32      prevChar   = 0;
+    for (std::size_t i = 0; m_font && (i < count); ++i)
+    {
+        Uint32 curChar = m_string[i];
+
+        // Apply the kerning offset
+        x += m_font->getKerning(prevChar, curChar, m_characterSize);
+        prevChar = curChar;
+        m_positions[i].x = x;
+
+        // Explicit line break
+        if (curChar == L'\n')
+        {
+            line.end = i + 1;
+            line.width = visible;
+            m_lines.push_back(line);
+
+            line.start = i + 1;
+            line.top += m_lineSpacing;
+            breakStart = line.start;
+            x = visible = 0.f;
+            continue;
+        }
+
+        float advance = getAdvance(curChar);
+
+        // Spaces never wrap, they hang past the width and the line can break after them
+        if ((curChar == L' ') || (curChar == L'\t'))
+        {
+            x += advance;
+            breakStart = i + 1;
+            breakWidth = visible;
+            continue;
+        }
+
+        // Wrap before this character if it doesn't fit, after the last space
+        // of the line or, if there is none, inside the word
+        if ((m_wrapWidth > 0) && (x + advance > m_wrapWidth) && (i > line.start))
+        {
+            bool afterSpace = breakStart > line.start;
+            std::size_t start = afterSpace ? breakStart : i;
+
+            line.end = start;
+            line.width = afterSpace ? breakWidth : visible;
+            m_lines.push_back(line);
+
+            // Move the beginning of the word to the new line
+            float shift = m_positions[start].x;
+            for (std::size_t j = start; j <= i; ++j)
+                m_positions[j].x -= shift;
+            x -= shift;
+            visible = (start < i) ? visible - shift : 0.f;
+
+            line.start = start;
+            line.top += m_lineSpacing;
+            breakStart = start;
+        }
+
+        x += advance;
+        visible = x;
+    }
+
+    m_positions[count].x = x;
+    line.end = count;
+    line.width = visible;
+    m_lines.push_back(line);
+
+    // Lines are aligned within the wrap width, or the widest line
+    float alignWidth = m_wrapWidth;
+    if (alignWidth <= 0)
+    {
+        for (std::vector<Line>::const_iterator it = m_lines.begin(); it != m_lines.end(); ++it)
+            alignWidth = std::max(alignWidth, it->width);
+    }
+
+    float minX = 0.f;
+    float maxX = 0.f;
+    for (std::vector<Line>::iterator it = m_lines.begin(); it != m_lines.end(); ++it)
+    {
+        switch (m_alignment)
+        {
+            case Left:   it->left = 0.f;                               break;
+            case Center: it->left = (alignWidth - it->width) / 2.f;    break;
+            case Right:  it->left = alignWidth - it->width;            break;
+        }
+
+        // The end of the string is positioned with the last line
+        std::size_t end = (it + 1 == m_lines.end()) ? count + 1 : it->end;
+        for (std::size_t i = it->start; i < end; ++i)
+        {
+            m_positions[i].x += it->left;
+            m_positions[i].y = it->top;
+        }
+
+        if ((it == m_lines.begin()) || (it->left < minX))
+            minX = it->left;
+        maxX = std::max(maxX, it->left + it->width);
+    }
+
+    m_bounds = FloatRect(minX, 0.f, maxX - minX, m_lines.size() * m_lineSpacing);
+}
+
+
+////////////////////////////////////////////////////////////
+float TextLayout::getAdvance(Uint32 character) const
+{
+    bool bold = (m_style & Text::Bold) != 0;
+    switch (character)
+    {
+        case L' ':  return m_font->getGlyph(L' ', m_characterSize, bold).advance;
+        case L'\t': return m_font->getGlyph(L' ', m_characterSize, bold).advance * 4;
+        case L'\n': return 0.f;
+        default:    return m_font->getGlyph(character, m_characterSize, bold).advance;
+    }
+}
+
+} // namespace cpp3ds
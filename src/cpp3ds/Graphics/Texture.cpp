@@ -32,7 +32,9 @@
 #include <cpp3ds/System/Mutex.hpp>
 #include <cpp3ds/System/Lock.hpp>
 #include <cpp3ds/System/Err.hpp>
+#include <cpp3ds/System/Trace.hpp>
 #include <cpp3ds/OpenGL.hpp>
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <iostream>
@@ -40,6 +42,7 @@
 #include <cpp3ds/System/FileInputStream.hpp>
 #include <cpp3ds/System/FileSystem.hpp>
 #include "CitroHelpers.hpp"
+#include "TextureTiling.hpp"
 
 // Note: vertical flip flag set so 0,0 is top left of texture
 #define TEXTURE_TRANSFER_FLAGS \
@@ -73,56 +76,14 @@ namespace
 		return id++;
 	}
 
-    // Grabbed from Citra Emulator (citra/src/video_core/utils.h)
-    static inline u32 morton_interleave(u32 x, u32 y)
-    {
-        u32 i = (x & 7) | ((y & 7) << 8); // ---- -210
-        i = (i ^ (i << 2)) & 0x1313;      // ---2 --10
-        i = (i ^ (i << 1)) & 0x1515;      // ---2 -1-0
-        i = (i | (	i >> 7)) & 0x3F;
-        return i;
-    }
-
-    //Grabbed from Citra Emulator (citra/src/video_core/utils.h)
-    static inline u32 get_morton_offset(u32 x, u32 y, u32 bytes_per_pixel)
-    {
-        u32 i = morton_interleave(x, y);
-        unsigned int offset = (x & ~7) * 8;
-        return (i + offset) * bytes_per_pixel;
-    }
+    // Bytes of pixels sent to the GPU by all the textures
+    cpp3ds::Uint64 uploadedBytes = 0;
 
-    void imageTile32(u8* dest, const u8* source, unsigned x, unsigned y, unsigned src_w, unsigned src_h, unsigned dest_w, unsigned dest_h)
+    void countUpload(std::size_t bytes)
     {
-        int i, j;
-        for (j = 0; j < src_h; j++) {
-            for (i = 0; i < src_w; i++) {
-
-                int pos_y = (dest_h - 1 - j - y);
+        cpp3ds::Lock lock(mutex);
 
-                u32 coarse_y = pos_y & ~7;
-                u32 dst_offset = get_morton_offset(i+x, pos_y, 4) + coarse_y * dest_w * 4;
-
-                u32 v = ((u32 *)source)[i + j*src_w];
-                *(u32 *)(dest + dst_offset) = __builtin_bswap32(v);
-            }
-        }
-    }
-
-    void imageUntile32(u8* dest, const u8* source, unsigned x, unsigned y, unsigned src_w, unsigned src_h, unsigned dest_w, unsigned dest_h)
-    {
-        int i, j;
-        for (j = 0; j < src_h; j++) {
-            for (i = 0; i < src_w; i++) {
-
-                int pos_y = (dest_h - 1 - j - y);
-
-                u32 coarse_y = pos_y & ~7;
-                u32 src_offset = get_morton_offset(i+x, pos_y, 4) + coarse_y * dest_w * 4;
-
-                u32 v = *(u32 *)(source + src_offset);
-                ((u32 *)dest)[i + j*src_w] = __builtin_bswap32(v);
-            }
-        }
+        uploadedBytes += bytes;
     }
 
     inline size_t fmtSize(GPU_TEXCOLOR fmt)
@@ -152,6 +113,98 @@ namespace
                 return 0;
         }
     }
+
+    // Get the size of the first mipmap levels of tiled texture data
+    size_t getLevelsSize(size_t width, size_t height, GPU_TEXCOLOR format, unsigned int levels)
+    {
+        size_t size = 0;
+        for (unsigned int i = 0; i < levels; ++i, width /= 2, height /= 2)
+            size += width * height * fmtSize(format) / 8;
+        return size;
+    }
+
+    // Get the number of mipmap levels contained in tiled texture data,
+    // levels being stored one after the other down to 8x8 pixels.
+    // Returns 0 if the data size doesn't match any mipmap chain.
+    unsigned int getMipmapLevels(size_t size, size_t width, size_t height, GPU_TEXCOLOR format)
+    {
+        size_t chainSize = 0;
+        for (unsigned int levels = 1; (width >= 8) && (height >= 8); ++levels, width /= 2, height /= 2)
+        {
+            chainSize += width * height * fmtSize(format) / 8;
+            if (chainSize == size)
+                return levels;
+            if (chainSize > size)
+                break;
+        }
+        return 0;
+    }
+
+    // Get the number of mipmap levels of a full chain, down to 8x8 pixels
+    unsigned int getMaximumLevels(unsigned int width, unsigned int height)
+    {
+        unsigned int levels = 1;
+        while (((width >> levels) >= 8) && ((height >> levels) >= 8))
+            ++levels;
+        return levels;
+    }
+
+    // Flush the cache lines of the tiles touched by a region of a texture.
+    // Each tile row is contiguous in memory, as are the tiles in it.
+    void flushRegion(C3D_Tex* texture, unsigned int bytesPerPixel,
+                     unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+    {
+        if ((width == 0) || (height == 0))
+            return;
+
+        cpp3ds::Uint8* data = static_cast<cpp3ds::Uint8*>(texture->data);
+        unsigned int tileRowSize = texture->width * 8 * bytesPerPixel;
+        unsigned int start = (x / 8) * 64 * bytesPerPixel;
+        unsigned int end = ((x + width + 7) / 8) * 64 * bytesPerPixel;
+
+        // Rows are stored bottom to top
+        unsigned int firstRow = (texture->height - y - height) / 8;
+        unsigned int lastRow = (texture->height - 1 - y) / 8;
+
+        if ((start == 0) && (end == tileRowSize))
+            GSPGPU_FlushDataCache(data + firstRow * tileRowSize, (lastRow - firstRow + 1) * tileRowSize);
+        else
+            for (unsigned int row = firstRow; row <= lastRow; ++row)
+                GSPGPU_FlushDataCache(data + row * tileRowSize + start, end - start);
+
+        countUpload((lastRow - firstRow + 1) * (end - start));
+    }
+
+    // Get the GPU texture format used to store a texture format
+    inline GPU_TEXCOLOR getNativeFormat(cpp3ds::Texture::Format format)
+    {
+        switch (format)
+        {
+            case cpp3ds::Texture::RGB565:   return GPU_RGB565;
+            case cpp3ds::Texture::RGBA5551: return GPU_RGBA5551;
+            case cpp3ds::Texture::RGBA4:    return GPU_RGBA4;
+            case cpp3ds::Texture::LA8:      return GPU_LA8;
+            case cpp3ds::Texture::L8:       return GPU_L8;
+            case cpp3ds::Texture::A8:       return GPU_A8;
+            default:                        return GPU_RGBA8;
+        }
+    }
+
+    // Get the texture format matching a GPU format, if it can be converted from RGBA
+    inline bool toTextureFormat(GPU_TEXCOLOR nativeFormat, cpp3ds::Texture::Format& format)
+    {
+        switch (nativeFormat)
+        {
+            case GPU_RGBA8:    format = cpp3ds::Texture::RGBA8;    return true;
+            case GPU_RGB565:   format = cpp3ds::Texture::RGB565;   return true;
+            case GPU_RGBA5551: format = cpp3ds::Texture::RGBA5551; return true;
+            case GPU_RGBA4:    format = cpp3ds::Texture::RGBA4;    return true;
+            case GPU_LA8:      format = cpp3ds::Texture::LA8;      return true;
+            case GPU_L8:       format = cpp3ds::Texture::L8;       return true;
+            case GPU_A8:       format = cpp3ds::Texture::A8;       return true;
+            default:           return false;
+        }
+    }
 }
 
 
@@ -161,11 +214,15 @@ namespace cpp3ds
 Texture::Texture() :
 m_size         (0, 0),
 m_actualSize   (0, 0),
+m_format       (RGBA8),
 m_texture      (nullptr),
 m_isSmooth     (false),
 m_isRepeated   (false),
+m_hasMipmap    (false),
+m_mipmapSmooth (true),
 m_pixelsFlipped(false),
 m_ownsData     (true),
+m_levelCount   (0),
 m_cacheId      (getUniqueId())
 {
 
@@ -176,15 +233,19 @@ m_cacheId      (getUniqueId())
 Texture::Texture(const Texture& copy) :
 m_size         (0, 0),
 m_actualSize   (0, 0),
+m_format       (copy.m_format),
 m_texture      (nullptr),
 m_isSmooth     (copy.m_isSmooth),
 m_isRepeated   (copy.m_isRepeated),
+m_hasMipmap    (false),
+m_mipmapSmooth (copy.m_mipmapSmooth),
 m_pixelsFlipped(false),
 m_ownsData     (true),
+m_levelCount   (0),
 m_cacheId      (getUniqueId())
 {
     if (copy.m_texture)
-        loadFromImage(copy.copyToImage());
+        loadFromImage(copy.copyToImage(), IntRect(), copy.m_format);
 }
 
 
@@ -201,7 +262,7 @@ Texture::~Texture()
 
 
 ////////////////////////////////////////////////////////////
-bool Texture::create(unsigned int width, unsigned int height)
+bool Texture::create(unsigned int width, unsigned int height, Format format)
 {
     // Check if texture parameters are valid before creating it
     if ((width == 0) || (height == 0))
@@ -230,7 +291,9 @@ bool Texture::create(unsigned int width, unsigned int height)
     m_size.x        = width;
     m_size.y        = height;
     m_actualSize    = actualSize;
+    m_format        = format;
     m_pixelsFlipped = false;
+    m_hasMipmap     = false;
 
 	ensureGlContext();
 
@@ -242,8 +305,18 @@ bool Texture::create(unsigned int width, unsigned int height)
 
     if (!m_texture)
         return false;
-    if (!C3D_TexInit(m_texture, m_actualSize.x, m_actualSize.y, GPU_RGBA8))
+    // Only the first level is allocated, generateMipmap reallocates
+    // the texture with the whole mipmap chain when it is called
+    C3D_TexInitParams params;
+    params.width    = m_actualSize.x;
+    params.height   = m_actualSize.y;
+    params.maxLevel = 0;
+    params.format   = getNativeFormat(m_format);
+    params.type     = GPU_TEX_2D;
+    params.onVram   = false;
+    if (!C3D_TexInitWithParams(m_texture, NULL, params))
         return false;
+    m_levelCount = 1;
 
     C3D_TexSetWrap(m_texture,
                    m_isRepeated ? GPU_REPEAT : GPU_CLAMP_TO_EDGE,
@@ -259,30 +332,30 @@ bool Texture::create(unsigned int width, unsigned int height)
 
 
 ////////////////////////////////////////////////////////////
-bool Texture::loadFromFile(const std::string& filename, const IntRect& area)
+bool Texture::loadFromFile(const std::string& filename, const IntRect& area, Format format)
 {
     Image image;
-    return image.loadFromFile(filename) && loadFromImage(image, area);
+    return image.loadFromFile(filename) && loadFromImage(image, area, format);
 }
 
 
 ////////////////////////////////////////////////////////////
-bool Texture::loadFromMemory(const void* data, std::size_t size, const IntRect& area)
+bool Texture::loadFromMemory(const void* data, std::size_t size, const IntRect& area, Format format)
 {
     Image image;
-    return image.loadFromMemory(data, size) && loadFromImage(image, area);
+    return image.loadFromMemory(data, size) && loadFromImage(image, area, format);
 }
 
 
 ////////////////////////////////////////////////////////////
-bool Texture::loadFromStream(InputStream& stream, const IntRect& area)
+bool Texture::loadFromStream(InputStream& stream, const IntRect& area, Format format)
 {
     Image image;
-    return image.loadFromStream(stream) && loadFromImage(image, area);
+    return image.loadFromStream(stream) && loadFromImage(image, area, format);
 }
 
 ////////////////////////////////////////////////////////////
-bool Texture::loadFromImage(const Image& image, const IntRect& area)
+bool Texture::loadFromImage(const Image& image, const IntRect& area, Format format)
 {
     // Retrieve the image size
     int width = static_cast<int>(image.getSize().x);
@@ -293,7 +366,7 @@ bool Texture::loadFromImage(const Image& image, const IntRect& area)
        ((area.left <= 0) && (area.top <= 0) && (area.width >= width) && (area.height >= height)))
     {
         // Load the entire image
-        if (create(image.getSize().x, image.getSize().y))
+        if (create(image.getSize().x, image.getSize().y, format))
         {
             update(image);
             return true;
@@ -315,18 +388,13 @@ bool Texture::loadFromImage(const Image& image, const IntRect& area)
         if (rectangle.top + rectangle.height > height) rectangle.height = height - rectangle.top;
 
         // Create the texture and upload the pixels
-        if (create(rectangle.width, rectangle.height))
+        if (create(rectangle.width, rectangle.height, format))
         {
-            err() << "Unsupported texture operation!" << std::endl;
-            // Copy the pixels to the texture, row by row
+            // Tile the pixels straight from the image, skipping the rest of its rows
             const Uint8* pixels = image.getPixelsPtr() + 4 * (rectangle.left + (width * rectangle.top));
-//            glCheck(glBindTexture(GL_TEXTURE_2D, m_texture));
-            for (int i = 0; i < rectangle.height; ++i)
-            {
-                // TODO: implement GX_TextureCopy
-//                glCheck(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, i, rectangle.width, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
-                pixels += 4 * width;
-            }
+            priv::tileImage(static_cast<Uint8*>(m_texture->data), pixels, 0, 0, rectangle.width, rectangle.height,
+                            m_texture->width, m_texture->height, m_format, width);
+            C3D_TexFlush(m_texture);
 
             return true;
         }
@@ -352,23 +420,29 @@ bool Texture::loadFromPreprocessedFile(const std::string& filename)
     file.read(&header, sizeof(Header));
     size_t size = file.getSize() - sizeof(Header);
 
-    // Verify header
+    // Verify header, the data may hold a whole mipmap chain
     GPU_TEXCOLOR format = static_cast<GPU_TEXCOLOR>(header.format);
-    if (size != header.width * header.height * fmtSize(format) / 8)
+    unsigned int levels = getMipmapLevels(size, header.width, header.height, format);
+    if (levels == 0)
     {
         err() << "Improper file header: " << filename << std::endl;
         return false;
     }
 
-    void *data = malloc(size);
-    file.read(data, size);
+    // Read the tiled data directly into the texture memory
+    if (!createPreprocessed(header.width, header.height, format, levels))
+        return false;
+    if (file.read(m_texture->data, size) != static_cast<Int64>(size))
+    {
+        err() << "Failed to read texture data: " << filename << std::endl;
+        return false;
+    }
+    C3D_TexFlush(m_texture);
 
-    bool ret = loadFromPreprocessedMemory(data, size, header.width, header.height, format, true);
     m_size.x = header.widthOriginal;
     m_size.y = header.heightOriginal;
 
-    free(data);
-    return ret;
+    return true;
 }
 
 
@@ -384,12 +458,24 @@ bool Texture::loadFromPreprocessedFile(const std::string& filename, size_t width
         return false;
 
     size_t size = file.getSize();
-    void *data = malloc(size);
-    file.read(data, size);
+    unsigned int levels = getMipmapLevels(size, width, height, format);
+    if (levels == 0)
+    {
+        err() << "Improper texture size: " << filename << std::endl;
+        return false;
+    }
 
-    bool ret = loadFromPreprocessedMemory(data, size, width, height, format, true);
-    free(data);
-    return ret;
+    // Read the tiled data directly into the texture memory
+    if (!createPreprocessed(width, height, format, levels))
+        return false;
+    if (file.read(m_texture->data, size) != static_cast<Int64>(size))
+    {
+        err() << "Failed to read texture data: " << filename << std::endl;
+        return false;
+    }
+    C3D_TexFlush(m_texture);
+
+    return true;
 }
 
 
@@ -399,7 +485,25 @@ bool Texture::loadFromPreprocessedMemory(void *data, size_t size, size_t width,
     if (!data)
         return false;
 
-    m_ownsData      = copyData;
+    // Data that isn't a whole mipmap chain is used as a single level
+    unsigned int levels = getMipmapLevels(size, width, height, format);
+    if (levels == 0)
+        levels = 1;
+
+    if (copyData)
+    {
+        if (!createPreprocessed(width, height, format, levels))
+            return false;
+
+        // Mipmap levels are contiguous, the whole chain is copied at once
+        std::size_t copied = std::min(size, getLevelsSize(width, height, format, levels));
+        std::memcpy(m_texture->data, data, copied);
+        C3D_TexFlush(m_texture);
+        countUpload(copied);
+        return true;
+    }
+
+    m_ownsData      = false;
     m_size.x        = width;
     m_size.y        = height;
     m_actualSize    = m_size;
@@ -416,18 +520,20 @@ bool Texture::loadFromPreprocessedMemory(void *data, size_t size, size_t width,
     if (!m_texture)
         return false;
 
-    if (copyData)
-    {
-        C3D_TexInit(m_texture, width, height, format);
-        C3D_TexUpload(m_texture, data);
-    }
-    else
-        m_texture->data = data;
-
-    m_texture->size = size;
+    // Like citro3d, the size is the one of the first level
+    m_texture->data = data;
+    m_texture->size = (levels > 1) ? getLevelsSize(width, height, format, 1) : size;
     m_texture->fmt = format;
     m_texture->height = height;
     m_texture->width = width;
+    m_texture->maxLevel = levels - 1;
+    m_texture->minLevel = 0;
+    m_levelCount = levels;
+
+    // Compressed and other formats can't be converted from RGBA,
+    // keep the default and let update/copyToImage reject them
+    if (!toTextureFormat(format, m_format))
+        m_format = RGBA8;
 
     C3D_TexFlush(m_texture);
 
@@ -437,6 +543,81 @@ bool Texture::loadFromPreprocessedMemory(void *data, size_t size, size_t width,
     C3D_TexSetFilter(m_texture,
                      m_isSmooth ? GPU_LINEAR : GPU_NEAREST,
                      m_isSmooth ? GPU_LINEAR : GPU_NEAREST);
+    C3D_TexSetFilterMipmap(m_texture, m_mipmapSmooth ? GPU_LINEAR : GPU_NEAREST);
+    m_hasMipmap = levels > 1;
+
+    m_cacheId = getUniqueId();
+
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////
+bool Texture::loadFromTiled(unsigned int width, unsigned int height, Format format, const std::vector<Uint8>& tiled)
+{
+    if (!create(width, height, format))
+        return false;
+
+    if (tiled.size() != m_actualSize.x * m_actualSize.y * priv::getBytesPerPixel(format))
+    {
+        err() << "Failed to load texture, tiled data doesn't match its size" << std::endl;
+        return false;
+    }
+
+    std::memcpy(m_texture->data, &tiled[0], tiled.size());
+    C3D_TexFlush(m_texture);
+    countUpload(tiled.size());
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////
+bool Texture::createPreprocessed(size_t width, size_t height, GPU_TEXCOLOR format, unsigned int levels)
+{
+    m_ownsData      = true;
+    m_size.x        = width;
+    m_size.y        = height;
+    m_actualSize    = m_size;
+    m_pixelsFlipped = false;
+
+    ensureGlContext();
+
+    // Create the citro3d texture, or delete if already created
+    if (!m_texture)
+        m_texture = new C3D_Tex();
+    else
+        C3D_TexDelete(m_texture);
+
+    if (!m_texture)
+        return false;
+
+    C3D_TexInitParams params;
+    params.width    = width;
+    params.height   = height;
+    params.maxLevel = levels - 1;
+    params.format   = format;
+    params.type     = GPU_TEX_2D;
+    params.onVram   = false;
+    if (!C3D_TexInitWithParams(m_texture, NULL, params))
+    {
+        err() << "Failed to create texture (" << width << "x" << height << ", " << levels << " levels)" << std::endl;
+        return false;
+    }
+    m_levelCount = levels;
+
+    // Compressed and other formats can't be converted from RGBA,
+    // keep the default and let update/copyToImage reject them
+    if (!toTextureFormat(format, m_format))
+        m_format = RGBA8;
+
+    C3D_TexSetWrap(m_texture,
+                   m_isRepeated ? GPU_REPEAT : GPU_CLAMP_TO_EDGE,
+                   m_isRepeated ? GPU_REPEAT : GPU_CLAMP_TO_EDGE);
+    C3D_TexSetFilter(m_texture,
+                     m_isSmooth ? GPU_LINEAR : GPU_NEAREST,
+                     m_isSmooth ? GPU_LINEAR : GPU_NEAREST);
+    C3D_TexSetFilterMipmap(m_texture, m_mipmapSmooth ? GPU_LINEAR : GPU_NEAREST);
+    m_hasMipmap = levels > 1;
 
     m_cacheId = getUniqueId();
 
@@ -451,6 +632,24 @@ Vector2u Texture::getSize() const
 }
 
 
+////////////////////////////////////////////////////////////
+std::size_t Texture::getMemoryUsage() const
+{
+    if (!m_texture || !m_ownsData)
+        return 0;
+
+    // Mipmap levels are only allocated once generateMipmap is called
+    return getLevelsSize(m_texture->width, m_texture->height, m_texture->fmt, m_levelCount);
+}
+
+
+////////////////////////////////////////////////////////////
+Texture::Format Texture::getFormat() const
+{
+    return m_format;
+}
+
+
 ////////////////////////////////////////////////////////////
 Image Texture::copyToImage() const
 {
@@ -458,27 +657,29 @@ Image Texture::copyToImage() const
     if (!m_texture)
         return Image();
 
+    if (m_texture->fmt != getNativeFormat(m_format))
+    {
+        err() << "Failed to copy texture to image, unsupported texture format" << std::endl;
+        return Image();
+    }
+
     // Create an array of pixels
     std::vector<Uint8> pixels(m_size.x * m_size.y * 4);
 
-    u32 *data = (u32*)linearAlloc(m_texture->size);
-
-        imageUntile32((u8*)data, (u8*)m_texture->data, 0, 0, m_texture->width, m_texture->height, m_texture->width, m_texture->height);
-        GSPGPU_FlushDataCache(data, m_texture->size);
+    // All the pixels are first untiled and converted to RGBA in a temporary array
+    std::vector<Uint8> allPixels(m_texture->width * m_texture->height * 4);
+    priv::untileImage(&allPixels[0], static_cast<const Uint8*>(m_texture->data), 0, 0,
+                      m_texture->width, m_texture->height, m_texture->width, m_texture->height, m_format);
 
     if ((m_size == m_actualSize) && !m_pixelsFlipped)
 	{
-		// Texture is not padded nor flipped, we can use a direct copy
-        std::memcpy(&pixels[0], data, pixels.size());
+		// Texture is not padded nor flipped, we can use the pixels directly
+        pixels.swap(allPixels);
 	}
 	else
 	{
 		// Texture is either padded or flipped, we have to use a slower algorithm
 
-		// All the pixels will first be copied to a temporary array
-		std::vector<Uint8> allPixels(m_actualSize.x * m_actualSize.y * 4);
-        std::memcpy(&allPixels[0], data, allPixels.size());
-
 		// Then we copy the useful pixels from the temporary array to the final one
 		const Uint8* src = &allPixels[0];
 		Uint8* dst = &pixels[0];
@@ -504,8 +705,6 @@ Image Texture::copyToImage() const
     Image image;
     image.create(m_size.x, m_size.y, &pixels[0]);
 
-    linearFree(data);
-
     return image;
 }
 
@@ -521,16 +720,26 @@ void Texture::update(const Uint8* pixels)
 ////////////////////////////////////////////////////////////
 void Texture::update(const Uint8* pixels, unsigned int width, unsigned int height, unsigned int x, unsigned int y)
 {
+    CPP3DS_TRACE_ZONE("Graphics", "Texture::update");
+
     assert(x + width <= m_size.x);
     assert(y + height <= m_size.y);
 
     if (pixels && m_texture)
     {
-            u8* dest = (u8*)m_texture->data;
+        if (m_texture->fmt != getNativeFormat(m_format))
+        {
+            err() << "Failed to update texture, unsupported texture format" << std::endl;
+            return;
+        }
 
-            imageTile32(dest, pixels, x, y, width, height, m_texture->width, m_texture->height);
+        // Convert the pixels to the texture format while tiling them
+        priv::tileImage(static_cast<Uint8*>(m_texture->data), pixels, x, y, width, height,
+                        m_texture->width, m_texture->height, m_format);
 
-            C3D_TexFlush(m_texture);
+        // Only the touched tiles need to reach the GPU
+        flushRegion(m_texture, priv::getBytesPerPixel(m_format), x, y, width, height);
+        invalidateMipmap();
 
         m_pixelsFlipped = false;
         m_cacheId = getUniqueId();
@@ -553,6 +762,81 @@ void Texture::update(const Image& image, unsigned int x, unsigned int y)
 }
 
 
+////////////////////////////////////////////////////////////
+void Texture::updateRegions(const Uint8* pixels, const std::vector<IntRect>& regions)
+{
+    CPP3DS_TRACE_ZONE("Graphics", "Texture::updateRegions");
+
+    if (!pixels || !m_texture || regions.empty())
+        return;
+
+    if (m_texture->fmt != getNativeFormat(m_format))
+    {
+        err() << "Failed to update texture, unsupported texture format" << std::endl;
+        return;
+    }
+
+    // Accumulate the regions in a map of the 8x8 blocks they touch
+    unsigned int blocksX = (m_size.x + 7) / 8;
+    unsigned int blocksY = (m_size.y + 7) / 8;
+    std::vector<bool> dirty(blocksX * blocksY, false);
+    for (std::vector<IntRect>::const_iterator it = regions.begin(); it != regions.end(); ++it)
+    {
+        int left   = std::max(it->left, 0);
+        int top    = std::max(it->top, 0);
+        int right  = std::min(it->left + it->width, static_cast<int>(m_size.x));
+        int bottom = std::min(it->top + it->height, static_cast<int>(m_size.y));
+        if ((left >= right) || (top >= bottom))
+            continue;
+
+        for (int by = top / 8; by <= (bottom - 1) / 8; ++by)
+            for (int bx = left / 8; bx <= (right - 1) / 8; ++bx)
+                dirty[by * blocksX + bx] = true;
+    }
+
+    // Convert and flush each run of dirty blocks, block row by block row
+    unsigned int bytesPerPixel = priv::getBytesPerPixel(m_format);
+    bool updated = false;
+    for (unsigned int by = 0; by < blocksY; ++by)
+    {
+        for (unsigned int bx = 0; bx < blocksX; ++bx)
+        {
+            if (!dirty[by * blocksX + bx])
+                continue;
+
+            unsigned int start = bx;
+            while ((bx < blocksX) && dirty[by * blocksX + bx])
+                ++bx;
+
+            unsigned int x = start * 8;
+            unsigned int y = by * 8;
+            unsigned int width = std::min(bx * 8, m_size.x) - x;
+            unsigned int height = std::min(y + 8, m_size.y) - y;
+            priv::tileImage(static_cast<Uint8*>(m_texture->data), pixels + 4 * (x + y * m_size.x), x, y, width, height,
+                            m_texture->width, m_texture->height, m_format, m_size.x);
+            flushRegion(m_texture, bytesPerPixel, x, y, width, height);
+            updated = true;
+        }
+    }
+
+    if (updated)
+    {
+        invalidateMipmap();
+        m_pixelsFlipped = false;
+        m_cacheId = getUniqueId();
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+void Texture::updateRegions(const Image& image, const std::vector<IntRect>& regions)
+{
+    assert(image.getSize() == m_size);
+
+    updateRegions(image.getPixelsPtr(), regions);
+}
+
+
 ////////////////////////////////////////////////////////////
 void Texture::update(const Window& window)
 {
@@ -624,19 +908,134 @@ bool Texture::isRepeated() const
 }
 
 
+////////////////////////////////////////////////////////////
+bool Texture::generateMipmap()
+{
+    if (!m_texture)
+        return false;
+
+    if (m_texture->fmt != getNativeFormat(m_format))
+    {
+        err() << "Failed to generate mipmap, unsupported texture format" << std::endl;
+        return false;
+    }
+
+    // Reallocate the texture with the whole mipmap chain, keeping its
+    // first level. External data is used with the levels it provides.
+    unsigned int maxLevels = getMaximumLevels(m_texture->width, m_texture->height);
+    if (m_ownsData && (m_levelCount < maxLevels))
+    {
+        C3D_TexInitParams params;
+        params.width    = m_texture->width;
+        params.height   = m_texture->height;
+        params.maxLevel = maxLevels - 1;
+        params.format   = m_texture->fmt;
+        params.type     = GPU_TEX_2D;
+        params.onVram   = false;
+
+        C3D_Tex texture;
+        if (!C3D_TexInitWithParams(&texture, NULL, params))
+        {
+            err() << "Failed to generate mipmap, not enough memory for the mipmap levels" << std::endl;
+            return false;
+        }
+        std::memcpy(texture.data, m_texture->data, m_texture->size);
+
+        C3D_TexDelete(m_texture);
+        *m_texture = texture;
+        m_levelCount = maxLevels;
+
+        C3D_TexSetWrap(m_texture,
+                       m_isRepeated ? GPU_REPEAT : GPU_CLAMP_TO_EDGE,
+                       m_isRepeated ? GPU_REPEAT : GPU_CLAMP_TO_EDGE);
+        C3D_TexSetFilter(m_texture,
+                         m_isSmooth ? GPU_LINEAR : GPU_NEAREST,
+                         m_isSmooth ? GPU_LINEAR : GPU_NEAREST);
+
+        // The texture data moved, so it must be bound again
+        m_cacheId = getUniqueId();
+    }
+
+    unsigned int levels = m_levelCount;
+    if (levels < 2)
+        return false;
+
+    // Each level is computed from the previous one, right before it in memory
+    unsigned int bytesPerPixel = priv::getBytesPerPixel(m_format);
+    Uint8* level = static_cast<Uint8*>(m_texture->data);
+    unsigned int width = m_texture->width;
+    unsigned int height = m_texture->height;
+    for (unsigned int i = 1; i < levels; ++i)
+    {
+        Uint8* nextLevel = level + width * height * bytesPerPixel;
+        priv::downsampleImage(nextLevel, level, width, height, m_format);
+        level = nextLevel;
+        width /= 2;
+        height /= 2;
+    }
+
+    // Flushing covers the levels up to maxLevel
+    m_texture->maxLevel = levels - 1;
+    C3D_TexFlush(m_texture);
+
+    C3D_TexSetFilterMipmap(m_texture, m_mipmapSmooth ? GPU_LINEAR : GPU_NEAREST);
+    m_hasMipmap = true;
+
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////
+void Texture::setMipmapFilter(bool smooth)
+{
+    m_mipmapSmooth = smooth;
+
+    if (m_texture)
+        C3D_TexSetFilterMipmap(m_texture, m_mipmapSmooth ? GPU_LINEAR : GPU_NEAREST);
+}
+
+
+////////////////////////////////////////////////////////////
+bool Texture::isMipmapFilterSmooth() const
+{
+    return m_mipmapSmooth;
+}
+
+
+////////////////////////////////////////////////////////////
+void Texture::invalidateMipmap()
+{
+    if (!m_hasMipmap)
+        return;
+
+    m_texture->maxLevel = 0;
+    m_hasMipmap = false;
+}
+
+
 ////////////////////////////////////////////////////////////
 void Texture::bind(const Texture* texture, CoordinateType coordinateType)
 {
+    bindTexture(texture, coordinateType);
+
+    // Alpha-only textures take their color from the vertices
     if (texture && texture->m_texture)
-    {
-        // Bind the texture
-        C3D_TexBind(0, texture->m_texture);
+        CitroSetCombiner((texture->m_format == A8) ? CitroCombinerAlphaModulate : CitroCombinerModulate);
+    else
+        CitroSetCombiner(CitroCombinerColor);
+}
+
 
-        C3D_TexEnv* env = C3D_GetTexEnv(0);
-        C3D_TexEnvSrc(env, C3D_Both, GPU_TEXTURE0, GPU_PRIMARY_COLOR, 0);
-        C3D_TexEnvOp(env, C3D_Both, 0, 0, 0);
-        C3D_TexEnvFunc(env, C3D_Both, GPU_MODULATE);
+////////////////////////////////////////////////////////////
+bool Texture::bindTexture(const Texture* texture, CoordinateType coordinateType)
+{
+    static const float identity[16] = {1.f, 0.f, 0.f, 0.f,
+                                       0.f, 1.f, 0.f, 0.f,
+                                       0.f, 0.f, 1.f, 0.f,
+                                       0.f, 0.f, 0.f, 1.f};
 
+    if (texture && texture->m_texture)
+    {
         // Check if we need to define a special texture matrix
         if ((coordinateType == Pixels) || texture->m_pixelsFlipped)
         {
@@ -661,21 +1060,17 @@ void Texture::bind(const Texture* texture, CoordinateType coordinateType)
             }
 
             // Load the matrix
-            memcpy(MtxStack_Cur(CitroGetTextureMatrix())->m, matrix, sizeof(C3D_Mtx));
+            CitroSetMatrix(CitroGetTextureMatrix(), matrix);
         }
+
+        // The cache id changes whenever the texture data does
+        return CitroSetTexture(texture->m_texture, texture->m_cacheId);
     }
     else
     {
-        // Bind no texture
-        C3D_TexBind(0, NULL);
-
-        C3D_TexEnv* env = C3D_GetTexEnv(0);
-        C3D_TexEnvSrc(env, C3D_Both, GPU_PRIMARY_COLOR, 0, 0);
-        C3D_TexEnvOp(env, C3D_Both, 0, 0, 0);
-        C3D_TexEnvFunc(env, C3D_Both, GPU_REPLACE);
-
-        // Reset the texture matrix
-        Mtx_Identity(MtxStack_Cur(CitroGetTextureMatrix()));
+        // Bind no texture and reset the texture matrix
+        CitroSetMatrix(CitroGetTextureMatrix(), identity);
+        return CitroSetTexture(NULL, 0);
     }
 }
 
@@ -687,6 +1082,15 @@ unsigned int Texture::getMaximumSize()
 }
 
 
+////////////////////////////////////////////////////////////
+Uint64 Texture::getUploadedBytes()
+{
+    Lock lock(mutex);
+
+    return uploadedBytes;
+}
+
+
 ////////////////////////////////////////////////////////////
 Texture& Texture::operator =(const Texture& right)
 {
@@ -694,10 +1098,15 @@ Texture& Texture::operator =(const Texture& right)
 
     std::swap(m_size,          temp.m_size);
     std::swap(m_actualSize,    temp.m_actualSize);
+    std::swap(m_format,        temp.m_format);
     std::swap(m_texture,       temp.m_texture);
     std::swap(m_isSmooth,      temp.m_isSmooth);
     std::swap(m_isRepeated,    temp.m_isRepeated);
+    std::swap(m_hasMipmap,     temp.m_hasMipmap);
+    std::swap(m_mipmapSmooth,  temp.m_mipmapSmooth);
     std::swap(m_pixelsFlipped, temp.m_pixelsFlipped);
+    std::swap(m_ownsData,      temp.m_ownsData);
+    std::swap(m_levelCount,    temp.m_levelCount);
     m_cacheId = getUniqueId();
 
     return *this;
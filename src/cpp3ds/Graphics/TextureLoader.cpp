@@ -0,0 +1,311 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cpp3ds/Graphics/TextureLoader.hpp>
+#include <cpp3ds/System/Err.hpp>
+#include <cpp3ds/System/Lock.hpp>
+#include <algorithm>
+#ifndef EMULATION
+#include "TextureTiling.hpp"
+#endif
+
+
+namespace
+{
+    // Number of finished requests whose status is remembered
+    const std::size_t finishedHistory = 64;
+}
+
+
+namespace cpp3ds
+{
+////////////////////////////////////////////////////////////
+TextureLoader::TextureLoader(std::size_t capacity) :
+m_thread    (&TextureLoader::run, this),
+m_capacity  (std::max<std::size_t>(capacity, 1)),
+m_nextHandle(1),
+m_running   (true)
+{
+#ifdef EMULATION
+    pthread_mutex_init(&m_signalMutex, NULL);
+    pthread_cond_init(&m_signalCondition, NULL);
+    m_signaled = false;
+#else
+    LightEvent_Init(&m_signal, RESET_ONESHOT);
+#endif
+
+    // stb_image needs more than the default stack
+    m_thread.setStackSize(64 * 1024);
+    m_thread.launch();
+}
+
+
+////////////////////////////////////////////////////////////
+TextureLoader::~TextureLoader()
+{
+    {
+        Lock lock(m_mutex);
+        m_running = false;
+    }
+    signal();
+    m_thread.wait();
+
+    for (std::deque<Job*>::iterator it = m_jobs.begin(); it != m_jobs.end(); ++it)
+        delete *it;
+
+#ifdef EMULATION
+    pthread_cond_destroy(&m_signalCondition);
+    pthread_mutex_destroy(&m_signalMutex);
+#endif
+}
+
+
+////////////////////////////////////////////////////////////
+TextureLoader::Handle TextureLoader::loadAsync(Texture& texture, const std::string& filename, Texture::Format format,
+                                               Callback callback)
+{
+    Lock lock(m_mutex);
+
+    if (m_jobs.size() >= m_capacity)
+        return 0;
+
+    Job* job = new Job;
+    job->handle   = m_nextHandle;
+    job->texture  = &texture;
+    job->filename = filename;
+    job->format   = format;
+    job->callback = callback;
+    job->status   = Queued;
+    m_jobs.push_back(job);
+
+    // Skip 0 when the counter wraps around
+    if (++m_nextHandle == 0)
+        m_nextHandle = 1;
+
+    signal();
+
+    return job->handle;
+}
+
+
+////////////////////////////////////////////////////////////
+bool TextureLoader::cancel(Handle handle)
+{
+    Lock lock(m_mutex);
+
+    for (std::deque<Job*>::iterator it = m_jobs.begin(); it != m_jobs.end(); ++it)
+    {
+        Job* job = *it;
+        if (job->handle != handle)
+            continue;
+
+        m_jobs.erase(it);
+
+        // The worker thread deletes the jobs it is decoding when it finishes
+        if (job->status == Loading)
+            job->status = Cancelled;
+        else
+            delete job;
+
+        finish(handle, Cancelled);
+        return true;
+    }
+
+    return false;
+}
+
+
+////////////////////////////////////////////////////////////
+TextureLoader::Status TextureLoader::getStatus(Handle handle) const
+{
+    Lock lock(m_mutex);
+
+    for (std::deque<Job*>::const_iterator it = m_jobs.begin(); it != m_jobs.end(); ++it)
+        if ((*it)->handle == handle)
+            return (*it)->status;
+
+    std::map<Handle, Status>::const_iterator finished = m_finished.find(handle);
+    if (finished != m_finished.end())
+        return finished->second;
+
+    return Unknown;
+}
+
+
+////////////////////////////////////////////////////////////
+std::size_t TextureLoader::getPendingCount() const
+{
+    Lock lock(m_mutex);
+
+    return m_jobs.size();
+}
+
+
+////////////////////////////////////////////////////////////
+unsigned int TextureLoader::update(unsigned int maxUploads)
+{
+    // Take the finished jobs out of the queue, so that publishing
+    // and callbacks don't block the worker thread
+    std::vector<Job*> finished;
+    {
+        Lock lock(m_mutex);
+
+        unsigned int uploads = 0;
+        for (std::deque<Job*>::iterator it = m_jobs.begin(); it != m_jobs.end();)
+        {
+            Job* job = *it;
+            bool upload = (job->status == Ready) && ((maxUploads == 0) || (uploads < maxUploads));
+            if (upload || (job->status == Failed))
+            {
+                if (upload)
+                    ++uploads;
+                finished.push_back(job);
+                it = m_jobs.erase(it);
+            }
+            else
+                ++it;
+        }
+    }
+
+    for (std::vector<Job*>::iterator it = finished.begin(); it != finished.end(); ++it)
+    {
+        Job* job = *it;
+        if ((job->status == Ready) && !publish(*job))
+            job->status = Failed;
+        else if (job->status == Ready)
+            job->status = Loaded;
+
+        {
+            Lock lock(m_mutex);
+            finish(job->handle, job->status);
+        }
+
+        if (job->callback)
+            job->callback(job->handle, job->status);
+        delete job;
+    }
+
+    return static_cast<unsigned int>(finished.size());
+}
+
+
+////////////////////////////////////////////////////////////
+void TextureLoader::run()
+{
+    for (;;)
+    {
+        Job* job = NULL;
+        {
+            Lock lock(m_mutex);
+            if (!m_running)
+                return;
+
+            for (std::deque<Job*>::iterator it = m_jobs.begin(); it != m_jobs.end(); ++it)
+            {
+                if ((*it)->status == Queued)
+                {
+                    job = *it;
+                    job->status = Loading;
+                    break;
+                }
+            }
+        }
+
+        if (!job)
+        {
+            waitForSignal();
+            continue;
+        }
+
+        // The filename and format don't change once queued, so
+        // the job can be read without holding the lock
+        bool decoded = decode(*job);
+
+        Lock lock(m_mutex);
+        if (job->status == Cancelled)
+            delete job;
+        else
+            job->status = decoded ? Ready : Failed;
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+bool TextureLoader::decode(Job& job)
+{
+    if (!job.image.loadFromFile(job.filename))
+        return false;
+
+#ifndef EMULATION
+    // Convert the pixels to the layout of the GPU texture that
+    // Texture::create will allocate, and drop the decoded image
+    job.size = job.image.getSize();
+    Vector2u actualSize(std::max(Texture::getValidSize(job.size.x), 8u), std::max(Texture::getValidSize(job.size.y), 8u));
+    if ((actualSize.x > Texture::getMaximumSize()) || (actualSize.y > Texture::getMaximumSize()))
+    {
+        err() << "Failed to load texture \"" << job.filename << "\", its internal size is too high "
+              << "(" << actualSize.x << "x" << actualSize.y << ")" << std::endl;
+        return false;
+    }
+
+    job.tiled.resize(actualSize.x * actualSize.y * priv::getBytesPerPixel(job.format));
+    priv::tileImage(&job.tiled[0], job.image.getPixelsPtr(), 0, 0, job.size.x, job.size.y,
+                    actualSize.x, actualSize.y, job.format);
+    job.image = Image();
+#endif
+
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////
+bool TextureLoader::publish(Job& job)
+{
+#ifdef EMULATION
+    return job.texture->loadFromImage(job.image, IntRect(), job.format);
+#else
+    return job.texture->loadFromTiled(job.size.x, job.size.y, job.format, job.tiled);
+#endif
+}
+
+
+////////////////////////////////////////////////////////////
+void TextureLoader::finish(Handle handle, Status status)
+{
+    m_finished[handle] = status;
+
+    // Handles increase, so the first ones are the oldest
+    while (m_finished.size() > finishedHistory)
+        m_finished.erase(m_finished.begin());
+}
+
+
+////////////////////////////////////////////////////////////
+void TextureLoader::signal()
+{
+#ifdef EMULATION
+    pthread_mutex_lock(&m_signalMutex);
+    m_signaled = true;
+    pthread_cond_signal(&m_signalCondition);
+    pthread_mutex_unlock(&m_signalMutex);
+#else
+    LightEvent_Signal(&m_signal);
+#endif
+}
+
+
+////////////////////////////////////////////////////////////
+void TextureLoader::waitForSignal()
+{
+#ifdef EMULATION
+    pthread_mutex_lock(&m_signalMutex);
+    while (!m_signaled)
+        pthread_cond_wait(&m_signalCondition, &m_signalMutex);
+    m_signaled = false;
+    pthread_mutex_unlock(&m_signalMutex);
+#else
+    LightEvent_Wait(&m_signal);
+#endif
+}
+
+} // namespace cpp3ds
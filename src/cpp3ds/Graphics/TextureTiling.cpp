@@ -0,0 +1,476 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include "TextureTiling.hpp"
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
+
+namespace
+{
+    // Position of a pixel inside an 8x8 tile, from its x and y coordinates
+    // in the tile: the bits of x and y are interleaved (Morton order)
+    const unsigned int mortonX[8] = {0x00, 0x01, 0x04, 0x05, 0x10, 0x11, 0x14, 0x15};
+    const unsigned int mortonY[8] = {0x00, 0x02, 0x08, 0x0A, 0x20, 0x22, 0x28, 0x2A};
+
+    // Get the position of a pixel relative to the start of its tile row
+    inline unsigned int tileOffset(unsigned int x)
+    {
+        return (x & ~7u) * 8 + mortonX[x & 7];
+    }
+
+    // Get the start of the tile row containing the (flipped) line y, offset by the line position in the tiles
+    inline unsigned int tileRowOffset(unsigned int y, unsigned int width)
+    {
+        return (y & ~7u) * width + mortonY[y & 7];
+    }
+
+    // Channels of a RGBA pixel read as a little-endian 32-bit integer
+    inline cpp3ds::Uint32 red(cpp3ds::Uint32 pixel)   {return pixel & 0xFF;}
+    inline cpp3ds::Uint32 green(cpp3ds::Uint32 pixel) {return (pixel >> 8) & 0xFF;}
+    inline cpp3ds::Uint32 blue(cpp3ds::Uint32 pixel)  {return (pixel >> 16) & 0xFF;}
+    inline cpp3ds::Uint32 alpha(cpp3ds::Uint32 pixel) {return pixel >> 24;}
+
+    inline cpp3ds::Uint32 luminance(cpp3ds::Uint32 pixel)
+    {
+        return (red(pixel) * 77 + green(pixel) * 150 + blue(pixel) * 29) >> 8;
+    }
+
+    inline cpp3ds::Uint32 makePixel(cpp3ds::Uint32 r, cpp3ds::Uint32 g, cpp3ds::Uint32 b, cpp3ds::Uint32 a)
+    {
+        return r | (g << 8) | (b << 16) | (a << 24);
+    }
+
+    // Expand a channel of n bits to 8 bits
+    inline cpp3ds::Uint32 expand4(cpp3ds::Uint32 value) {return value * 0x11;}
+    inline cpp3ds::Uint32 expand5(cpp3ds::Uint32 value) {return (value << 3) | (value >> 2);}
+    inline cpp3ds::Uint32 expand6(cpp3ds::Uint32 value) {return (value << 2) | (value >> 4);}
+
+
+    // Converters between RGBA pixels and the texels of each GPU format
+    struct PixelRGBA8
+    {
+        // The GPU expects ABGR pixels
+        typedef cpp3ds::Uint32 Texel;
+        static Texel pack(cpp3ds::Uint32 pixel) {return __builtin_bswap32(pixel);}
+        static cpp3ds::Uint32 unpack(Texel texel) {return __builtin_bswap32(texel);}
+    };
+
+    struct PixelRGB565
+    {
+        typedef cpp3ds::Uint16 Texel;
+        static Texel pack(cpp3ds::Uint32 pixel)
+        {
+            return static_cast<Texel>(((red(pixel) >> 3) << 11) | ((green(pixel) >> 2) << 5) | (blue(pixel) >> 3));
+        }
+        static cpp3ds::Uint32 unpack(Texel texel)
+        {
+            return makePixel(expand5(texel >> 11), expand6((texel >> 5) & 0x3F), expand5(texel & 0x1F), 0xFF);
+        }
+    };
+
+    struct PixelRGBA5551
+    {
+        typedef cpp3ds::Uint16 Texel;
+        static Texel pack(cpp3ds::Uint32 pixel)
+        {
+            return static_cast<Texel>(((red(pixel) >> 3) << 11) | ((green(pixel) >> 3) << 6) | ((blue(pixel) >> 3) << 1) | (alpha(pixel) >> 7));
+        }
+        static cpp3ds::Uint32 unpack(Texel texel)
+        {
+            return makePixel(expand5(texel >> 11), expand5((texel >> 6) & 0x1F), expand5((texel >> 1) & 0x1F), (texel & 1) * 0xFF);
+        }
+    };
+
+    struct PixelRGBA4
+    {
+        typedef cpp3ds::Uint16 Texel;
+        static Texel pack(cpp3ds::Uint32 pixel)
+        {
+            return static_cast<Texel>(((red(pixel) >> 4) << 12) | ((green(pixel) >> 4) << 8) | ((blue(pixel) >> 4) << 4) | (alpha(pixel) >> 4));
+        }
+        static cpp3ds::Uint32 unpack(Texel texel)
+        {
+            return makePixel(expand4(texel >> 12), expand4((texel >> 8) & 0xF), expand4((texel >> 4) & 0xF), expand4(texel & 0xF));
+        }
+    };
+
+    struct PixelLA8
+    {
+        typedef cpp3ds::Uint16 Texel;
+        static Texel pack(cpp3ds::Uint32 pixel)
+        {
+            return static_cast<Texel>((luminance(pixel) << 8) | alpha(pixel));
+        }
+        static cpp3ds::Uint32 unpack(Texel texel)
+        {
+            return makePixel(texel >> 8, texel >> 8, texel >> 8, texel & 0xFF);
+        }
+    };
+
+    struct PixelL8
+    {
+        typedef cpp3ds::Uint8 Texel;
+        static Texel pack(cpp3ds::Uint32 pixel) {return static_cast<Texel>(luminance(pixel));}
+        static cpp3ds::Uint32 unpack(Texel texel) {return makePixel(texel, texel, texel, 0xFF);}
+    };
+
+    struct PixelA8
+    {
+        // Alpha-only textures are drawn with the vertex color
+        typedef cpp3ds::Uint8 Texel;
+        static Texel pack(cpp3ds::Uint32 pixel) {return static_cast<Texel>(alpha(pixel));}
+        static cpp3ds::Uint32 unpack(Texel texel) {return makePixel(0xFF, 0xFF, 0xFF, texel);}
+    };
+
+
+    // Write a row of 8 pixels into a tile. Pixels go by pairs, at
+    // positions 0, 4, 16 and 20 from the start of the line in the tile.
+    template <typename Format>
+    inline void tileRow8(typename Format::Texel* tile, const cpp3ds::Uint32* pixels)
+    {
+        tile[0x00] = Format::pack(pixels[0]);
+        tile[0x01] = Format::pack(pixels[1]);
+        tile[0x04] = Format::pack(pixels[2]);
+        tile[0x05] = Format::pack(pixels[3]);
+        tile[0x10] = Format::pack(pixels[4]);
+        tile[0x11] = Format::pack(pixels[5]);
+        tile[0x14] = Format::pack(pixels[6]);
+        tile[0x15] = Format::pack(pixels[7]);
+    }
+
+    // Read a row of 8 pixels from a tile
+    template <typename Format>
+    inline void untileRow8(cpp3ds::Uint32* pixels, const typename Format::Texel* tile)
+    {
+        pixels[0] = Format::unpack(tile[0x00]);
+        pixels[1] = Format::unpack(tile[0x01]);
+        pixels[2] = Format::unpack(tile[0x04]);
+        pixels[3] = Format::unpack(tile[0x05]);
+        pixels[4] = Format::unpack(tile[0x10]);
+        pixels[5] = Format::unpack(tile[0x11]);
+        pixels[6] = Format::unpack(tile[0x14]);
+        pixels[7] = Format::unpack(tile[0x15]);
+    }
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+    // Vectorized byteswap for RGBA8 on host builds
+    template <>
+    inline void tileRow8<PixelRGBA8>(cpp3ds::Uint32* tile, const cpp3ds::Uint32* pixels)
+    {
+#if defined(__SSE2__)
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + 4));
+        a = _mm_or_si128(_mm_slli_epi16(a, 8), _mm_srli_epi16(a, 8));
+        b = _mm_or_si128(_mm_slli_epi16(b, 8), _mm_srli_epi16(b, 8));
+        a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(a, 0xB1), 0xB1);
+        b = _mm_shufflehi_epi16(_mm_shufflelo_epi16(b, 0xB1), 0xB1);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(tile + 0x00), a);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(tile + 0x04), _mm_unpackhi_epi64(a, a));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(tile + 0x10), b);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(tile + 0x14), _mm_unpackhi_epi64(b, b));
+#elif defined(__ARM_NEON)
+        uint32x4_t a = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(pixels))));
+        uint32x4_t b = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(pixels + 4))));
+        vst1_u32(tile + 0x00, vget_low_u32(a));
+        vst1_u32(tile + 0x04, vget_high_u32(a));
+        vst1_u32(tile + 0x10, vget_low_u32(b));
+        vst1_u32(tile + 0x14, vget_high_u32(b));
+#endif
+    }
+
+    template <>
+    inline void untileRow8<PixelRGBA8>(cpp3ds::Uint32* pixels, const cpp3ds::Uint32* tile)
+    {
+#if defined(__SSE2__)
+        __m128i a = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(tile + 0x00)),
+                                       _mm_loadl_epi64(reinterpret_cast<const __m128i*>(tile + 0x04)));
+        __m128i b = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(tile + 0x10)),
+                                       _mm_loadl_epi64(reinterpret_cast<const __m128i*>(tile + 0x14)));
+        a = _mm_or_si128(_mm_slli_epi16(a, 8), _mm_srli_epi16(a, 8));
+        b = _mm_or_si128(_mm_slli_epi16(b, 8), _mm_srli_epi16(b, 8));
+        a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(a, 0xB1), 0xB1);
+        b = _mm_shufflehi_epi16(_mm_shufflelo_epi16(b, 0xB1), 0xB1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), a);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + 4), b);
+#elif defined(__ARM_NEON)
+        uint32x4_t a = vcombine_u32(vld1_u32(tile + 0x00), vld1_u32(tile + 0x04));
+        uint32x4_t b = vcombine_u32(vld1_u32(tile + 0x10), vld1_u32(tile + 0x14));
+        vst1q_u8(reinterpret_cast<uint8_t*>(pixels), vrev32q_u8(vreinterpretq_u8_u32(a)));
+        vst1q_u8(reinterpret_cast<uint8_t*>(pixels + 4), vrev32q_u8(vreinterpretq_u8_u32(b)));
+#endif
+    }
+#endif
+
+
+    // Average 4 texels, for mipmap generation
+    template <typename Format>
+    inline typename Format::Texel average4(const typename Format::Texel* texels)
+    {
+        cpp3ds::Uint32 r = 2, g = 2, b = 2, a = 2;
+        for (int i = 0; i < 4; ++i)
+        {
+            cpp3ds::Uint32 pixel = Format::unpack(texels[i]);
+            r += red(pixel);
+            g += green(pixel);
+            b += blue(pixel);
+            a += alpha(pixel);
+        }
+        return Format::pack(makePixel(r >> 2, g >> 2, b >> 2, a >> 2));
+    }
+
+    // RGBA8 channels are averaged two at a time in 16-bit lanes,
+    // which doesn't depend on their byte order
+    template <>
+    inline cpp3ds::Uint32 average4<PixelRGBA8>(const cpp3ds::Uint32* texels)
+    {
+        cpp3ds::Uint32 even = 0x00020002;
+        cpp3ds::Uint32 odd  = 0x00020002;
+        for (int i = 0; i < 4; ++i)
+        {
+            even += texels[i] & 0x00FF00FF;
+            odd  += (texels[i] >> 8) & 0x00FF00FF;
+        }
+        return ((even >> 2) & 0x00FF00FF) | (((odd >> 2) & 0x00FF00FF) << 8);
+    }
+
+    // Downsample a tile to a quarter of a tile. In Morton order each 2x2
+    // block of pixels is 4 consecutive texels, and the 4x4 result is
+    // in the same order, so the 64 texels simply reduce to 16.
+    template <typename Format>
+    inline void downsampleTile(typename Format::Texel* dest, const typename Format::Texel* source)
+    {
+        for (int i = 0; i < 16; ++i)
+            dest[i] = average4<Format>(source + i * 4);
+    }
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+    // Vectorized RGBA8 average on host builds, 4 output texels at a time
+    template <>
+    inline void downsampleTile<PixelRGBA8>(cpp3ds::Uint32* dest, const cpp3ds::Uint32* source)
+    {
+        for (int i = 0; i < 16; i += 4)
+        {
+#if defined(__SSE2__)
+            // Transpose so that each vector holds one texel of each 2x2 block
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 4));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 4 + 4));
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 4 + 8));
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 4 + 12));
+            __m128i ab0 = _mm_unpacklo_epi32(a, b);
+            __m128i cd0 = _mm_unpacklo_epi32(c, d);
+            __m128i ab1 = _mm_unpackhi_epi32(a, b);
+            __m128i cd1 = _mm_unpackhi_epi32(c, d);
+            __m128i t0 = _mm_unpacklo_epi64(ab0, cd0);
+            __m128i t1 = _mm_unpackhi_epi64(ab0, cd0);
+            __m128i t2 = _mm_unpacklo_epi64(ab1, cd1);
+            __m128i t3 = _mm_unpackhi_epi64(ab1, cd1);
+
+            // Sum the channels in 16-bit lanes, then round and narrow back
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i two = _mm_set1_epi16(2);
+            __m128i low = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(t0, zero), _mm_unpacklo_epi8(t1, zero)),
+                                        _mm_add_epi16(_mm_unpacklo_epi8(t2, zero), _mm_unpacklo_epi8(t3, zero)));
+            __m128i high = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(t0, zero), _mm_unpackhi_epi8(t1, zero)),
+                                         _mm_add_epi16(_mm_unpackhi_epi8(t2, zero), _mm_unpackhi_epi8(t3, zero)));
+            low = _mm_srli_epi16(_mm_add_epi16(low, two), 2);
+            high = _mm_srli_epi16(_mm_add_epi16(high, two), 2);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_packus_epi16(low, high));
+#elif defined(__ARM_NEON)
+            // De-interleaving load: each vector holds one texel of each 2x2 block
+            uint32x4x4_t t = vld4q_u32(source + i * 4);
+            uint8x16_t t0 = vreinterpretq_u8_u32(t.val[0]);
+            uint8x16_t t1 = vreinterpretq_u8_u32(t.val[1]);
+            uint8x16_t t2 = vreinterpretq_u8_u32(t.val[2]);
+            uint8x16_t t3 = vreinterpretq_u8_u32(t.val[3]);
+            uint16x8_t low = vaddq_u16(vaddl_u8(vget_low_u8(t0), vget_low_u8(t1)), vaddl_u8(vget_low_u8(t2), vget_low_u8(t3)));
+            uint16x8_t high = vaddq_u16(vaddl_u8(vget_high_u8(t0), vget_high_u8(t1)), vaddl_u8(vget_high_u8(t2), vget_high_u8(t3)));
+            vst1q_u8(reinterpret_cast<uint8_t*>(dest + i), vcombine_u8(vrshrn_n_u16(low, 2), vrshrn_n_u16(high, 2)));
+#endif
+        }
+    }
+#endif
+
+    // Compute the next mipmap level of a tiled texture. Each destination
+    // tile is built from 4 source tiles, one for each of its quarters.
+    template <typename Format>
+    void downsample(cpp3ds::Uint8* dest, const cpp3ds::Uint8* source, unsigned int srcWidth, unsigned int srcHeight)
+    {
+        typedef typename Format::Texel Texel;
+        const Texel* sourceTiles = reinterpret_cast<const Texel*>(source);
+        Texel* tile = reinterpret_cast<Texel*>(dest);
+
+        unsigned int srcTilesX = srcWidth / 8;
+        for (unsigned int ty = 0; ty < srcHeight / 16; ++ty)
+            for (unsigned int tx = 0; tx < srcWidth / 16; ++tx, tile += 64)
+                for (unsigned int quarter = 0; quarter < 4; ++quarter)
+                {
+                    unsigned int sourceTile = (ty * 2 + (quarter >> 1)) * srcTilesX + tx * 2 + (quarter & 1);
+                    downsampleTile<Format>(tile + quarter * 16, sourceTiles + sourceTile * 64);
+                }
+    }
+
+    // Copy a block of RGBA pixels into a tiled texture of the given format
+    template <typename Format>
+    void tile(cpp3ds::Uint8* dest, const cpp3ds::Uint8* source, unsigned int x, unsigned int y,
+              unsigned int srcWidth, unsigned int srcHeight, unsigned int destWidth, unsigned int destHeight,
+              unsigned int srcStride)
+    {
+        typedef typename Format::Texel Texel;
+        Texel* tiles = reinterpret_cast<Texel*>(dest);
+
+        for (unsigned int j = 0; j < srcHeight; ++j)
+        {
+            // Rows are stored bottom to top
+            Texel* row = tiles + tileRowOffset(destHeight - 1 - j - y, destWidth);
+            const cpp3ds::Uint32* pixels = reinterpret_cast<const cpp3ds::Uint32*>(source) + j * srcStride;
+
+            unsigned int i = 0;
+            unsigned int tx = x;
+
+            // Pixels before the first full tile
+            for (; (i < srcWidth) && (tx & 7); ++i, ++tx)
+                row[tileOffset(tx)] = Format::pack(pixels[i]);
+
+            // Whole tile rows
+            for (; i + 8 <= srcWidth; i += 8, tx += 8)
+                tileRow8<Format>(row + tx * 8, pixels + i);
+
+            // Pixels after the last full tile
+            for (; i < srcWidth; ++i, ++tx)
+                row[tileOffset(tx)] = Format::pack(pixels[i]);
+        }
+    }
+
+    // Copy a block of a tiled texture of the given format into RGBA pixels
+    template <typename Format>
+    void untile(cpp3ds::Uint8* dest, const cpp3ds::Uint8* source, unsigned int x, unsigned int y,
+                unsigned int destWidth, unsigned int destHeight, unsigned int srcWidth, unsigned int srcHeight)
+    {
+        typedef typename Format::Texel Texel;
+        const Texel* tiles = reinterpret_cast<const Texel*>(source);
+
+        for (unsigned int j = 0; j < destHeight; ++j)
+        {
+            // Rows are stored bottom to top
+            const Texel* row = tiles + tileRowOffset(srcHeight - 1 - j - y, srcWidth);
+            cpp3ds::Uint32* pixels = reinterpret_cast<cpp3ds::Uint32*>(dest) + j * destWidth;
+
+            unsigned int i = 0;
+            unsigned int tx = x;
+
+            // Pixels before the first full tile
+            for (; (i < destWidth) && (tx & 7); ++i, ++tx)
+                pixels[i] = Format::unpack(row[tileOffset(tx)]);
+
+            // Whole tile rows
+            for (; i + 8 <= destWidth; i += 8, tx += 8)
+                untileRow8<Format>(pixels + i, row + tx * 8);
+
+            // Pixels after the last full tile
+            for (; i < destWidth; ++i, ++tx)
+                pixels[i] = Format::unpack(row[tileOffset(tx)]);
+        }
+    }
+}
+
+
+namespace cpp3ds
+{
+namespace priv
+{
+////////////////////////////////////////////////////////////
+void tileImage32(Uint8* dest, const Uint8* source, unsigned int x, unsigned int y,
+                 unsigned int srcWidth, unsigned int srcHeight, unsigned int destWidth, unsigned int destHeight)
+{
+    tile<PixelRGBA8>(dest, source, x, y, srcWidth, srcHeight, destWidth, destHeight, srcWidth);
+}
+
+
+////////////////////////////////////////////////////////////
+void untileImage32(Uint8* dest, const Uint8* source, unsigned int x, unsigned int y,
+                   unsigned int destWidth, unsigned int destHeight, unsigned int srcWidth, unsigned int srcHeight)
+{
+    untile<PixelRGBA8>(dest, source, x, y, destWidth, destHeight, srcWidth, srcHeight);
+}
+
+
+////////////////////////////////////////////////////////////
+void tileImage(Uint8* dest, const Uint8* source, unsigned int x, unsigned int y,
+               unsigned int srcWidth, unsigned int srcHeight, unsigned int destWidth, unsigned int destHeight,
+               Texture::Format format, unsigned int srcStride)
+{
+    if (srcStride == 0)
+        srcStride = srcWidth;
+
+    switch (format)
+    {
+        case Texture::RGB565:   tile<PixelRGB565>  (dest, source, x, y, srcWidth, srcHeight, destWidth, destHeight, srcStride); break;
+        case Texture::RGBA5551: tile<PixelRGBA5551>(dest, source, x, y, srcWidth, srcHeight, destWidth, destHeight, srcStride); break;
+        case Texture::RGBA4:    tile<PixelRGBA4>   (dest, source, x, y, srcWidth, srcHeight, destWidth, destHeight, srcStride); break;
+        case Texture::LA8:      tile<PixelLA8>     (dest, source, x, y, srcWidth, srcHeight, destWidth, destHeight, srcStride); break;
+        case Texture::L8:       tile<PixelL8>      (dest, source, x, y, srcWidth, srcHeight, destWidth, destHeight, srcStride); break;
+        case Texture::A8:       tile<PixelA8>      (dest, source, x, y, srcWidth, srcHeight, destWidth, destHeight, srcStride); break;
+        default:                tile<PixelRGBA8>   (dest, source, x, y, srcWidth, srcHeight, destWidth, destHeight, srcStride); break;
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+void untileImage(Uint8* dest, const Uint8* source, unsigned int x, unsigned int y,
+                 unsigned int destWidth, unsigned int destHeight, unsigned int srcWidth, unsigned int srcHeight,
+                 Texture::Format format)
+{
+    switch (format)
+    {
+        case Texture::RGB565:   untile<PixelRGB565>  (dest, source, x, y, destWidth, destHeight, srcWidth, srcHeight); break;
+        case Texture::RGBA5551: untile<PixelRGBA5551>(dest, source, x, y, destWidth, destHeight, srcWidth, srcHeight); break;
+        case Texture::RGBA4:    untile<PixelRGBA4>   (dest, source, x, y, destWidth, destHeight, srcWidth, srcHeight); break;
+        case Texture::LA8:      untile<PixelLA8>     (dest, source, x, y, destWidth, destHeight, srcWidth, srcHeight); break;
+        case Texture::L8:       untile<PixelL8>      (dest, source, x, y, destWidth, destHeight, srcWidth, srcHeight); break;
+        case Texture::A8:       untile<PixelA8>      (dest, source, x, y, destWidth, destHeight, srcWidth, srcHeight); break;
+        default:                untile<PixelRGBA8>   (dest, source, x, y, destWidth, destHeight, srcWidth, srcHeight); break;
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+void downsampleImage(Uint8* dest, const Uint8* source, unsigned int srcWidth, unsigned int srcHeight, Texture::Format format)
+{
+    switch (format)
+    {
+        case Texture::RGB565:   downsample<PixelRGB565>  (dest, source, srcWidth, srcHeight); break;
+        case Texture::RGBA5551: downsample<PixelRGBA5551>(dest, source, srcWidth, srcHeight); break;
+        case Texture::RGBA4:    downsample<PixelRGBA4>   (dest, source, srcWidth, srcHeight); break;
+        case Texture::LA8:      downsample<PixelLA8>     (dest, source, srcWidth, srcHeight); break;
+        case Texture::L8:       downsample<PixelL8>      (dest, source, srcWidth, srcHeight); break;
+        case Texture::A8:       downsample<PixelA8>      (dest, source, srcWidth, srcHeight); break;
+        default:                downsample<PixelRGBA8>   (dest, source, srcWidth, srcHeight); break;
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+unsigned int getBytesPerPixel(Texture::Format format)
+{
+    switch (format)
+    {
+        case Texture::RGB565:
+        case Texture::RGBA5551:
+        case Texture::RGBA4:
+        case Texture::LA8:
+            return 2;
+        case Texture::L8:
+        case Texture::A8:
+            return 1;
+        default:
+            return 4;
+    }
+}
+
+} // namespace priv
+
+} // namespace cpp3ds
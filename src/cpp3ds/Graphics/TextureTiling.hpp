@@ -0,0 +1,126 @@
+#ifndef CPP3DS_TEXTURETILING_HPP
+#define CPP3DS_TEXTURETILING_HPP
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cpp3ds/Config.hpp>
+#include <cpp3ds/Graphics/Texture.hpp>
+
+
+namespace cpp3ds
+{
+namespace priv
+{
+////////////////////////////////////////////////////////////
+/// \brief Copy linear RGBA pixels into a tiled GPU texture
+///
+/// The GPU stores textures as 8x8 tiles with Morton-ordered
+/// pixels, bottom row first and with each pixel byteswapped.
+/// This converts a \a srcWidth x \a srcHeight block of linear
+/// RGBA pixels and writes it at (\a x, \a y) in the tiled
+/// texture of size \a destWidth x \a destHeight.
+///
+/// Pure CPU code, which doesn't depend on the 3DS libraries.
+///
+/// \param dest       Tiled texture data
+/// \param source     Linear RGBA pixels, row by row
+/// \param x          X offset of the block in the texture
+/// \param y          Y offset of the block in the texture
+/// \param srcWidth   Width of the block
+/// \param srcHeight  Height of the block
+/// \param destWidth  Width of the texture, multiple of 8
+/// \param destHeight Height of the texture, multiple of 8
+///
+////////////////////////////////////////////////////////////
+void tileImage32(Uint8* dest, const Uint8* source, unsigned int x, unsigned int y,
+                 unsigned int srcWidth, unsigned int srcHeight, unsigned int destWidth, unsigned int destHeight);
+
+////////////////////////////////////////////////////////////
+/// \brief Copy pixels from a tiled GPU texture to linear RGBA
+///
+/// Reverse operation of tileImage32: reads a \a destWidth x
+/// \a destHeight block at (\a x, \a y) of the tiled texture
+/// of size \a srcWidth x \a srcHeight.
+///
+/// \param dest       Linear RGBA pixels, row by row
+/// \param source     Tiled texture data
+/// \param x          X offset of the block in the texture
+/// \param y          Y offset of the block in the texture
+/// \param destWidth  Width of the block
+/// \param destHeight Height of the block
+/// \param srcWidth   Width of the texture, multiple of 8
+/// \param srcHeight  Height of the texture, multiple of 8
+///
+////////////////////////////////////////////////////////////
+void untileImage32(Uint8* dest, const Uint8* source, unsigned int x, unsigned int y,
+                   unsigned int destWidth, unsigned int destHeight, unsigned int srcWidth, unsigned int srcHeight);
+
+////////////////////////////////////////////////////////////
+/// \brief Convert linear RGBA pixels into a tiled GPU texture
+///        of any format
+///
+/// Same as tileImage32, but each pixel is converted to
+/// \a format while being tiled. Luminance formats use the
+/// weighted average of the red, green and blue channels.
+///
+/// \param format    Pixel format of the tiled texture
+/// \param srcStride Number of pixels between two rows of \a source,
+///                  0 if the rows are packed (\a srcWidth)
+///
+/// \see tileImage32
+///
+////////////////////////////////////////////////////////////
+void tileImage(Uint8* dest, const Uint8* source, unsigned int x, unsigned int y,
+               unsigned int srcWidth, unsigned int srcHeight, unsigned int destWidth, unsigned int destHeight,
+               Texture::Format format, unsigned int srcStride = 0);
+
+////////////////////////////////////////////////////////////
+/// \brief Convert pixels from a tiled GPU texture of any
+///        format to linear RGBA
+///
+/// Same as untileImage32, but each texel is expanded from
+/// \a format to RGBA. Missing color channels are set to 255,
+/// missing alpha is opaque.
+///
+/// \param format Pixel format of the tiled texture
+///
+/// \see untileImage32
+///
+////////////////////////////////////////////////////////////
+void untileImage(Uint8* dest, const Uint8* source, unsigned int x, unsigned int y,
+                 unsigned int destWidth, unsigned int destHeight, unsigned int srcWidth, unsigned int srcHeight,
+                 Texture::Format format);
+
+////////////////////////////////////////////////////////////
+/// \brief Compute the next mipmap level of a tiled GPU texture
+///
+/// Each texel of \a dest is the average of a 2x2 block of
+/// \a source. Both images are tiled, the destination being
+/// half the size of the source in each dimension.
+///
+/// \param dest      Tiled data of the next level
+/// \param source    Tiled data of the current level
+/// \param srcWidth  Width of the current level, multiple of 16
+/// \param srcHeight Height of the current level, multiple of 16
+/// \param format    Pixel format of the texture
+///
+////////////////////////////////////////////////////////////
+void downsampleImage(Uint8* dest, const Uint8* source, unsigned int srcWidth, unsigned int srcHeight, Texture::Format format);
+
+////////////////////////////////////////////////////////////
+/// \brief Get the size of a texel in a given format
+///
+/// \param format Pixel format
+///
+/// \return Number of bytes per texel
+///
+////////////////////////////////////////////////////////////
+unsigned int getBytesPerPixel(Texture::Format format);
+
+} // namespace priv
+
+} // namespace cpp3ds
+
+
+#endif // CPP3DS_TEXTURETILING_HPP
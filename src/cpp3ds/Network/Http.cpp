@@ -27,6 +27,7 @@
 ////////////////////////////////////////////////////////////
 #include <cpp3ds/Network/Http.hpp>
 #include <cpp3ds/System/Err.hpp>
+#include <cpp3ds/System/Trace.hpp>
 #include <cctype>
 #include <algorithm>
 #include <iterator>
@@ -270,6 +271,8 @@ void Http::setHost(const std::string& host, unsigned short port)
 ////////////////////////////////////////////////////////////
 Http::Response Http::sendRequest(const Http::Request& request, Time timeout, RequestCallback callback, size_t bufferSize)
 {
+    CPP3DS_TRACE_ZONE("Network", "Http::sendRequest");
+
     close();
 
     // Use 90 second default timeout for httpc
@@ -37,7 +37,10 @@ namespace priv {
 
 	static Time getCurrentTime()
 	{
-		return seconds(static_cast<float>(svcGetSystemTick())/TICKS_PER_SEC);
+		// Whole seconds and the remainder apart, so that the
+		// microseconds stay exact however long the system runs
+		Uint64 ticks = svcGetSystemTick();
+		return microseconds(static_cast<Int64>((ticks / TICKS_PER_SEC) * 1000000 + (ticks % TICKS_PER_SEC) * 1000000 / TICKS_PER_SEC));
 	}
 }
 
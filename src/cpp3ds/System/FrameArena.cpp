@@ -0,0 +1,143 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cpp3ds/System/FrameArena.hpp>
+#include <cpp3ds/System/Err.hpp>
+#ifdef EMULATION
+#include <cstdlib>
+#else
+#include <3ds.h>
+#endif
+
+namespace
+{
+    // Keep blocks aligned for the GPU and the data cache
+    const std::size_t alignment = 16;
+
+
+    // Blocks come from linear memory on hardware, from the heap in the emulator
+    void* allocateBlock(std::size_t size)
+    {
+    #ifdef EMULATION
+        return std::malloc(size);
+    #else
+        return linearMemAlign(size, alignment);
+    #endif
+    }
+
+
+    void freeBlock(void* block)
+    {
+    #ifdef EMULATION
+        std::free(block);
+    #else
+        linearFree(block);
+    #endif
+    }
+}
+
+
+namespace cpp3ds
+{
+Uint8*             FrameArena::m_buffer        = NULL;
+std::size_t        FrameArena::m_bufferSize    = 0;
+std::size_t        FrameArena::m_capacity      = 256 * 1024;
+std::size_t        FrameArena::m_offset        = 0;
+std::size_t        FrameArena::m_size          = 0;
+std::size_t        FrameArena::m_highWaterMark = 0;
+std::vector<void*> FrameArena::m_overflow;
+
+
+////////////////////////////////////////////////////////////
+void* FrameArena::allocate(std::size_t size)
+{
+    // Rounding up such a size would wrap around
+    if (size > static_cast<std::size_t>(-1) - alignment)
+    {
+        err() << "FrameArena: failed to allocate " << size << " bytes" << std::endl;
+        return NULL;
+    }
+
+    size = (size + alignment - 1) & ~(alignment - 1);
+
+    // (Re)allocate the arena when it is not in use
+    if ((m_offset == 0) && (m_bufferSize != m_capacity))
+    {
+        if (m_buffer)
+            freeBlock(m_buffer);
+        m_buffer = static_cast<Uint8*>(allocateBlock(m_capacity));
+        m_bufferSize = m_buffer ? m_capacity : 0;
+    }
+
+    void* block;
+    if (m_offset + size <= m_bufferSize)
+    {
+        block = m_buffer + m_offset;
+        m_offset += size;
+    }
+    else
+    {
+        block = allocateBlock(size);
+        if (!block)
+        {
+            err() << "FrameArena: failed to allocate " << size << " bytes" << std::endl;
+            return NULL;
+        }
+        m_overflow.push_back(block);
+    }
+
+    m_size += size;
+    if (m_size > m_highWaterMark)
+        m_highWaterMark = m_size;
+
+    return block;
+}
+
+
+////////////////////////////////////////////////////////////
+void FrameArena::reset()
+{
+    for (std::vector<void*>::iterator i = m_overflow.begin(); i != m_overflow.end(); ++i)
+        freeBlock(*i);
+    m_overflow.clear();
+
+    m_offset = 0;
+    m_size = 0;
+}
+
+
+////////////////////////////////////////////////////////////
+void FrameArena::setCapacity(std::size_t capacity)
+{
+    m_capacity = (capacity + alignment - 1) & ~(alignment - 1);
+}
+
+
+////////////////////////////////////////////////////////////
+std::size_t FrameArena::getCapacity()
+{
+    return m_capacity;
+}
+
+
+////////////////////////////////////////////////////////////
+std::size_t FrameArena::getSize()
+{
+    return m_size;
+}
+
+
+////////////////////////////////////////////////////////////
+std::size_t FrameArena::getHighWaterMark()
+{
+    return m_highWaterMark;
+}
+
+
+////////////////////////////////////////////////////////////
+void FrameArena::resetHighWaterMark()
+{
+    m_highWaterMark = m_size;
+}
+
+} // namespace cpp3ds
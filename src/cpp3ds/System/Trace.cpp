@@ -0,0 +1,202 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cpp3ds/System/Trace.hpp>
+#include <cpp3ds/System/Clock.hpp>
+#include <cpp3ds/System/Err.hpp>
+#include <cpp3ds/System/FileSystem.hpp>
+#include <cpp3ds/System/Lock.hpp>
+#include <cpp3ds/System/Mutex.hpp>
+#include <atomic>
+#include <fstream>
+#include <vector>
+
+
+namespace
+{
+    struct Event
+    {
+        const char*   category;
+        const char*   name;
+        cpp3ds::Int64 start;
+        cpp3ds::Int64 duration;
+    };
+
+    // Events of one thread. Only the owner thread writes to it,
+    // and publishes each event by incrementing the count.
+    struct ThreadBuffer
+    {
+        ThreadBuffer(unsigned int threadId, std::size_t size) :
+        id    (threadId),
+        name  (),
+        events(size),
+        count (0)
+        {
+        }
+
+        unsigned int                id;
+        std::string                 name;
+        std::vector<Event>          events;
+        std::atomic<cpp3ds::Uint32> count;
+    };
+
+    // Thread buffers are never freed, so that the events of
+    // threads that have exited can still be saved
+    cpp3ds::Mutex              mutex;
+    std::vector<ThreadBuffer*> buffers;
+    std::size_t                bufferSize = 4096;
+    cpp3ds::Int64              clearTime  = -1;
+
+    thread_local ThreadBuffer* currentBuffer = NULL;
+
+    const cpp3ds::Clock& getClock()
+    {
+        static cpp3ds::Clock clock;
+        return clock;
+    }
+
+    ThreadBuffer& getCurrentBuffer()
+    {
+        if (!currentBuffer)
+        {
+            cpp3ds::Lock lock(mutex);
+            currentBuffer = new ThreadBuffer(buffers.size() + 1, bufferSize);
+            buffers.push_back(currentBuffer);
+        }
+        return *currentBuffer;
+    }
+
+    void writeString(std::ostream& stream, const char* string)
+    {
+        stream << '"';
+        for (; *string; ++string)
+        {
+            if ((*string == '"') || (*string == '\\'))
+                stream << '\\';
+            stream << *string;
+        }
+        stream << '"';
+    }
+}
+
+
+namespace cpp3ds
+{
+////////////////////////////////////////////////////////////
+Int64 Trace::getTime()
+{
+    return getClock().getElapsedTime().asMicroseconds();
+}
+
+
+////////////////////////////////////////////////////////////
+void Trace::addEvent(const char* category, const char* name, Int64 start, Int64 end)
+{
+    ThreadBuffer& buffer = getCurrentBuffer();
+
+    Uint32 index = buffer.count.load(std::memory_order_relaxed);
+    Event& event = buffer.events[index % buffer.events.size()];
+    event.category = category;
+    event.name     = name;
+    event.start    = start;
+    event.duration = end - start;
+
+    buffer.count.store(index + 1, std::memory_order_release);
+}
+
+
+////////////////////////////////////////////////////////////
+void Trace::setThreadName(const std::string& name)
+{
+    ThreadBuffer& buffer = getCurrentBuffer();
+
+    Lock lock(mutex);
+    buffer.name = name;
+}
+
+
+////////////////////////////////////////////////////////////
+void Trace::setBufferSize(std::size_t count)
+{
+    Lock lock(mutex);
+    bufferSize = count ? count : 1;
+}
+
+
+////////////////////////////////////////////////////////////
+std::size_t Trace::getBufferSize()
+{
+    Lock lock(mutex);
+    return bufferSize;
+}
+
+
+////////////////////////////////////////////////////////////
+void Trace::clear()
+{
+    // The buffers belong to their threads, so older events
+    // are skipped when saving rather than erased
+    Lock lock(mutex);
+    clearTime = getTime();
+}
+
+
+////////////////////////////////////////////////////////////
+bool Trace::saveToFile(const std::string& filename)
+{
+    std::ofstream file(FileSystem::getFilePath(filename).c_str());
+    if (!file)
+    {
+        err() << "Failed to save trace to \"" << filename << "\"" << std::endl;
+        return false;
+    }
+
+    Lock lock(mutex);
+    bool first = true;
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (std::vector<ThreadBuffer*>::const_iterator i = buffers.begin(); i != buffers.end(); ++i)
+    {
+        const ThreadBuffer& buffer = **i;
+
+        if (!buffer.name.empty())
+        {
+            file << (first ? "" : ",") << "\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":0,\"tid\":" << buffer.id << ",\"args\":{\"name\":";
+            writeString(file, buffer.name.c_str());
+            file << "}}";
+            first = false;
+        }
+
+        // Copy the events first, then drop the ones the owner
+        // thread may have overwritten or be writing meanwhile
+        Uint32 size  = static_cast<Uint32>(buffer.events.size());
+        Uint32 end   = buffer.count.load(std::memory_order_acquire);
+        Uint32 begin = (end > size) ? end - size : 0;
+        std::vector<Event> events;
+        events.reserve(end - begin);
+        for (Uint32 j = begin; j != end; ++j)
+            events.push_back(buffer.events[j % size]);
+
+        Uint32 written = buffer.count.load(std::memory_order_acquire) + 1;
+        Uint32 skipped = (written - begin > size) ? written - begin - size : 0;
+
+        for (std::size_t j = skipped; j < events.size(); ++j)
+        {
+            const Event& event = events[j];
+            if (event.start < clearTime)
+                continue;
+
+            file << (first ? "" : ",") << "\n{\"ph\":\"X\",\"cat\":";
+            writeString(file, event.category);
+            file << ",\"name\":";
+            writeString(file, event.name);
+            file << ",\"ts\":" << event.start << ",\"dur\":" << event.duration << ",\"pid\":0,\"tid\":" << buffer.id << "}";
+            first = false;
+        }
+    }
+    file << "\n]}\n";
+
+    return static_cast<bool>(file);
+}
+
+} // namespace cpp3ds
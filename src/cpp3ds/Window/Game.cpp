@@ -1,6 +1,9 @@
 #include <cpp3ds/Graphics.hpp>
+#include <cpp3ds/Graphics/FrameProfiler.hpp>
 #include <cpp3ds/Resources.hpp>
+#include <cpp3ds/System/FrameArena.hpp>
 #include <cpp3ds/System/Service.hpp>
+#include <cpp3ds/System/Trace.hpp>
 #include <cpp3ds/Window/Game.hpp>
 #include <cpp3ds/System/I18n.hpp>
 #include "../Graphics/CitroHelpers.hpp"
@@ -70,9 +73,13 @@ Game::~Game()
 
 void Game::render()
 {
+	CPP3DS_TRACE_ZONE("Window", "Game::render");
+
 	Console& console = Console::getInstance();
+	FrameProfiler& profiler = FrameProfiler::getInstance();
 
 	if (!console.isEnabledBasic() || console.getScreen() != TopScreen) {
+		profiler.beginPhase(FrameProfiler::RenderTop);
 		C3D_RenderTarget* target = windowTop.getCitroTarget();
 		C3D_RenderBufBind(&target->renderBuf);
 		windowTop.resetGLStates();
@@ -81,11 +88,24 @@ void Game::render()
 			windowTop.setView(windowTop.getDefaultView());
 			windowTop.draw(console);
 		}
-		C3D_Flush();
+		if (profiler.isOverlayVisible() && profiler.getOverlayScreen() == TopScreen) {
+			windowTop.setView(windowTop.getDefaultView());
+			windowTop.draw(profiler);
+		}
+		profiler.endPhase(FrameProfiler::RenderTop);
+
+		profiler.beginPhase(FrameProfiler::Flush);
+		windowTop.flush();
+		CitroFlush();
+		profiler.endPhase(FrameProfiler::Flush);
+
+		profiler.beginPhase(FrameProfiler::Transfer);
 		C3D_RenderBufTransfer(&target->renderBuf, (u32*)gfxGetFramebuffer(GFX_TOP, GFX_LEFT, NULL, NULL), target->transferFlags);
+		profiler.endPhase(FrameProfiler::Transfer);
 	}
 
 	if (!console.isEnabledBasic() || console.getScreen() != BottomScreen) {
+		profiler.beginPhase(FrameProfiler::RenderBottom);
 		C3D_RenderTarget* target = windowBottom.getCitroTarget();
 		C3D_RenderBufBind(&target->renderBuf);
 		windowBottom.resetGLStates();
@@ -94,15 +114,39 @@ void Game::render()
 			windowBottom.setView(windowBottom.getDefaultView());
 			windowBottom.draw(console);
 		}
-		C3D_Flush();
+		if (profiler.isOverlayVisible() && profiler.getOverlayScreen() == BottomScreen) {
+			windowBottom.setView(windowBottom.getDefaultView());
+			windowBottom.draw(profiler);
+		}
+		profiler.endPhase(FrameProfiler::RenderBottom);
+
+		profiler.beginPhase(FrameProfiler::Flush);
+		windowBottom.flush();
+		CitroFlush();
+		profiler.endPhase(FrameProfiler::Flush);
+
+		profiler.beginPhase(FrameProfiler::Transfer);
 		C3D_RenderBufTransfer(&target->renderBuf, (u32*)gfxGetFramebuffer(GFX_BOTTOM, GFX_LEFT, NULL, NULL), target->transferFlags);
+		profiler.endPhase(FrameProfiler::Transfer);
 	}
 
+	// The GPU is done with this frame's transient vertices
+	FrameArena::reset();
+
+	profiler.beginPhase(FrameProfiler::VBlank);
 	gfxSwapBuffersGpu();
 	gspWaitForVBlank();
+	profiler.endPhase(FrameProfiler::VBlank);
 
 	// This currently is only use to properly use frameTimeLimit
 	windowTop.display();
+
+	if (profiler.isEnabled()) {
+		profiler.addStatistics(windowTop.getStatistics());
+		profiler.addStatistics(windowBottom.getStatistics());
+		windowTop.resetStatistics();
+		windowBottom.resetStatistics();
+	}
 }
 
 
@@ -120,13 +164,19 @@ void Game::run()
 	Time deltaTime;
 
 	Console& console = Console::getInstance();
+	FrameProfiler& profiler = FrameProfiler::getInstance();
+
+	CPP3DS_TRACE_THREAD("Main");
 
 	// Hook for clock
 	aptHook(&apt_hook_cookie, apt_clock_hook, &clock);
 
 	while (aptMainLoop())
 	{
+		profiler.beginFrame();
+
 		// Update sensors only once outside of EventManager, they change too often
+		profiler.beginPhase(FrameProfiler::Events);
 		Sensor::update();
 
 		while (eventmanager.pollEvent(event)) {
@@ -136,16 +186,21 @@ void Game::run()
 			}
 			processEvent(event);
 		}
+		profiler.endPhase(FrameProfiler::Events);
 		deltaTime = clock.restart();
 
 		if (m_triggerExit)
 			break;
 
+		profiler.beginPhase(FrameProfiler::Update);
 		if (console.isEnabled())
 			console.update(deltaTime.asSeconds());
 
 		update(deltaTime.asSeconds());
+		profiler.endPhase(FrameProfiler::Update);
+
 		render();
+		profiler.endFrame();
 	}
 
 	aptUnhook(&apt_hook_cookie);
@@ -181,6 +181,9 @@ void Window::setFramerateLimit(unsigned int limit)
 ////////////////////////////////////////////////////////////
 void Window::display()
 {
+	// Submit the primitives still waiting in the batch
+	flush();
+
 	// Display the backbuffer on screen
 	if (setActive())
 		m_context->display();
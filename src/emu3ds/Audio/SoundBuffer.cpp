@@ -200,6 +200,13 @@ Time SoundBuffer::getDuration() const
 }
 
 
+////////////////////////////////////////////////////////////
+std::size_t SoundBuffer::getMemoryUsage() const
+{
+    return m_samples.size() * sizeof(Int16);
+}
+
+
 ////////////////////////////////////////////////////////////
 SoundBuffer& SoundBuffer::operator =(const SoundBuffer& right)
 {
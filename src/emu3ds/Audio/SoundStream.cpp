@@ -31,6 +31,7 @@
 #include <cpp3ds/System/Sleep.hpp>
 #include <cpp3ds/System/Err.hpp>
 #include <cpp3ds/System/Lock.hpp>
+#include <cpp3ds/System/Trace.hpp>
 
 #ifdef _MSC_VER
     #pragma warning(disable: 4355) // 'this' used in base member initializer list
@@ -263,6 +264,8 @@ bool SoundStream::getLoop() const
 ////////////////////////////////////////////////////////////
 void SoundStream::streamData()
 {
+    CPP3DS_TRACE_THREAD("SoundStream");
+
     bool requestStop = false;
 
     {
@@ -397,6 +400,8 @@ void SoundStream::streamData()
 ////////////////////////////////////////////////////////////
 bool SoundStream::fillAndPushBuffer(unsigned int bufferNum)
 {
+    CPP3DS_TRACE_ZONE("Audio", "SoundStream::fillAndPushBuffer");
+
     bool requestStop = false;
 
     // Acquire audio data
@@ -32,6 +32,9 @@
 #include <cpp3ds/Graphics/VertexArray.hpp>
 #include <cpp3ds/OpenGL.hpp>
 #include <cpp3ds/System/Err.hpp>
+#include <cpp3ds/System/Trace.hpp>
+#include <algorithm>
+#include <vector>
 
 
 namespace
@@ -66,18 +69,129 @@ namespace
             case cpp3ds::BlendMode::Subtract:        return GL_FUNC_SUBTRACT;
         }
     }
+
+    // Number of quads in the shared quad index buffer
+    const unsigned int sharedQuadCount = 4096;
+
+
+    // Compute the number of indices needed to draw primitives as independent triangles
+    unsigned int getTriangleIndexCount(cpp3ds::PrimitiveType type, unsigned int count)
+    {
+        switch (type)
+        {
+            default:
+            case cpp3ds::Triangles:      return count;
+            case cpp3ds::TrianglesStrip:
+            case cpp3ds::TrianglesFan:   return (count < 3) ? 0 : (count - 2) * 3;
+            case cpp3ds::Quads:          return count / 4 * 6;
+        }
+    }
+
+
+    // Get the vertex used by the i-th element of a primitive stream, offset by base
+    inline cpp3ds::Uint16 element(const cpp3ds::Uint16* indices, unsigned int i, unsigned int base)
+    {
+        return static_cast<cpp3ds::Uint16>(base + (indices ? indices[i] : i));
+    }
+
+
+    // Write the indices of primitives as independent triangles, offset by base.
+    // When indices is NULL, the primitives use consecutive vertices.
+    void writeTriangleIndices(cpp3ds::Uint16* out, const cpp3ds::Uint16* indices, unsigned int count,
+                              cpp3ds::PrimitiveType type, unsigned int base)
+    {
+        switch (type)
+        {
+            default:
+            case cpp3ds::Triangles:
+                for (unsigned int i = 0; i < count; ++i)
+                    *out++ = element(indices, i, base);
+                break;
+
+            // Strips reuse the two previous vertices, fans reuse the first and the previous one
+            case cpp3ds::TrianglesStrip:
+            case cpp3ds::TrianglesFan:
+                for (unsigned int i = 2; i < count; ++i)
+                {
+                    *out++ = element(indices, type == cpp3ds::TrianglesFan ? 0 : i - 2, base);
+                    *out++ = element(indices, i - 1, base);
+                    *out++ = element(indices, i, base);
+                }
+                break;
+
+            case cpp3ds::Quads:
+                for (unsigned int i = 0; i + 4 <= count; i += 4)
+                {
+                    *out++ = element(indices, i, base);
+                    *out++ = element(indices, i + 1, base);
+                    *out++ = element(indices, i + 2, base);
+                    *out++ = element(indices, i, base);
+                    *out++ = element(indices, i + 2, base);
+                    *out++ = element(indices, i + 3, base);
+                }
+                break;
+        }
+    }
+
+
+    // Get the index buffer shared by all the quads drawn without indices
+    const cpp3ds::Uint16* getQuadIndices()
+    {
+        static std::vector<cpp3ds::Uint16> indices;
+        if (indices.empty())
+        {
+            indices.resize(sharedQuadCount * 6);
+            writeTriangleIndices(&indices[0], NULL, sharedQuadCount * 4, cpp3ds::Quads, 0);
+        }
+        return &indices[0];
+    }
+
+
+    // Setup the pointers to the vertices' components
+    void setVertexPointers(const cpp3ds::Vertex* vertices)
+    {
+        const char* data = reinterpret_cast<const char*>(vertices);
+        glCheck(glVertexPointer(2, GL_FLOAT, sizeof(cpp3ds::Vertex), data + 0));
+        glCheck(glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(cpp3ds::Vertex), data + 8)); // 8 = sizeof(Vector2f)
+        glCheck(glTexCoordPointer(2, GL_FLOAT, sizeof(cpp3ds::Vertex), data + 12)); // 12 = 8 + sizeof(Color)
+    }
+
+
+    // Setup the pointers to the compact vertices' components
+    void setVertexPointers(const cpp3ds::CompactVertex* vertices)
+    {
+        const char* data = reinterpret_cast<const char*>(vertices);
+        glCheck(glVertexPointer(2, GL_SHORT, sizeof(cpp3ds::CompactVertex), data + 0));
+        glCheck(glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(cpp3ds::CompactVertex), data + 4)); // 4 = sizeof(Vector2<Int16>)
+        glCheck(glTexCoordPointer(2, GL_SHORT, sizeof(cpp3ds::CompactVertex), data + 8)); // 8 = 4 + sizeof(Color)
+    }
 }
 
 
 namespace cpp3ds
 {
+////////////////////////////////////////////////////////////
+RenderTarget::Statistics::Statistics() :
+drawCalls     (0),
+batches       (0),
+mergedDraws   (0),
+vertices      (0),
+textureBinds  (0),
+blendChanges  (0),
+scissorChanges(0)
+{
+}
+
+
 ////////////////////////////////////////////////////////////
 RenderTarget::RenderTarget() :
-m_defaultView(),
-m_view       (),
-m_cache      ()
+m_defaultView    (),
+m_view           (),
+m_cache          (),
+m_batch          (),
+m_batchingEnabled(true),
+m_statistics     ()
 {
-	m_cache.vertexCache = new Vertex[StatesCache::VertexCacheSize];
 	m_cache.glStatesSet = false;
 }
 
@@ -85,15 +199,21 @@ m_cache      ()
 ////////////////////////////////////////////////////////////
 RenderTarget::~RenderTarget()
 {
-	delete[] m_cache.vertexCache;
+	delete[] m_batch.vertices;
+	delete[] m_batch.indices;
 }
 
 
 ////////////////////////////////////////////////////////////
 void RenderTarget::clear(const Color& color)
 {
+    if (clearPixels(color))
+        return;
+
     if (activate(true))
     {
+        flush();
+
         // Unbind texture to fix RenderTexture preventing clear
         applyTexture(NULL);
 
@@ -111,6 +231,9 @@ void RenderTarget::clear(const Color& color)
 ////////////////////////////////////////////////////////////
 void RenderTarget::setView(const View& view)
 {
+    // Pending primitives must be drawn with the previous view
+    flush();
+
     m_view = view;
     m_cache.viewChanged = true;
 }
@@ -198,21 +321,65 @@ void RenderTarget::draw(const Drawable& drawable, const RenderStates& states)
 ////////////////////////////////////////////////////////////
 void RenderTarget::draw(const Vertex* vertices, unsigned int vertexCount,
                         PrimitiveType type, const RenderStates& states)
+{
+    drawPrimitives(vertices, vertexCount, NULL, 0, type, states);
+}
+
+
+////////////////////////////////////////////////////////////
+void RenderTarget::draw(const Vertex* vertices, unsigned int vertexCount,
+                        const Uint16* indices, unsigned int indexCount,
+                        PrimitiveType type, const RenderStates& states)
+{
+    // Nothing to draw?
+    if (!indices || (indexCount == 0))
+        return;
+
+    drawPrimitives(vertices, vertexCount, indices, indexCount, type, states);
+}
+
+
+////////////////////////////////////////////////////////////
+void RenderTarget::draw(const CompactVertex* vertices, unsigned int vertexCount,
+                        PrimitiveType type, const RenderStates& states)
+{
+    drawPrimitives(vertices, vertexCount, NULL, 0, type, states);
+}
+
+
+////////////////////////////////////////////////////////////
+void RenderTarget::draw(const CompactVertex* vertices, unsigned int vertexCount,
+                        const Uint16* indices, unsigned int indexCount,
+                        PrimitiveType type, const RenderStates& states)
+{
+    // Nothing to draw?
+    if (!indices || (indexCount == 0))
+        return;
+
+    drawPrimitives(vertices, vertexCount, indices, indexCount, type, states);
+}
+
+
+////////////////////////////////////////////////////////////
+template <typename VertexType>
+void RenderTarget::drawPrimitives(const VertexType* vertices, unsigned int vertexCount,
+                                  const Uint16* indices, unsigned int indexCount,
+                                  PrimitiveType type, const RenderStates& states)
 {
     // Nothing to draw?
     if (!vertices || (vertexCount == 0))
         return;
 
-	// Vertices allocated in the stack (common) can't be converted to physical address
-	#ifndef EMULATION
-	if (osConvertVirtToPhys(vertices) == 0)
-	{
-		err() << "RenderTarget::draw() called with vertex array in inaccessible memory space." << std::endl;
-		return;
-	}
-	#endif
+    CPP3DS_TRACE_ZONE("Graphics", "RenderTarget::draw");
 
-	// GL_QUADS is unavailable on OpenGL ES
+    // Targets rendered on the CPU draw everything themselves
+    if (rasterize(vertices, vertexCount, indices, indexCount, type, states))
+    {
+        ++m_statistics.drawCalls;
+        ++m_statistics.batches;
+        m_statistics.vertices += vertexCount;
+        return;
+    }
 
     if (activate(true))
     {
@@ -220,28 +387,21 @@ void RenderTarget::draw(const Vertex* vertices, unsigned int vertexCount,
         if (!m_cache.glStatesSet)
             resetGLStates();
 
-        // Check if the vertex count is low enough so that we can pre-transform them
-        bool useVertexCache = (vertexCount <= StatesCache::VertexCacheSize);
-        if (useVertexCache)
-        {
-            // Pre-transform the vertices and store them into the vertex cache
-            for (unsigned int i = 0; i < vertexCount; ++i)
-            {
-                Vertex& vertex = m_cache.vertexCache[i];
-                vertex.position = states.transform * vertices[i].position;
-                vertex.color = vertices[i].color;
-                vertex.texCoords = vertices[i].texCoords;
-            }
+        ++m_statistics.drawCalls;
 
-            // Since vertices are transformed, we must use an identity transform to render them
-            if (!m_cache.useVertexCache)
-                applyTransform(Transform::Identity);
-        }
-        else
+        // Small draws are transformed on the CPU and merged into the pending batch
+        unsigned int batchCount = getTriangleIndexCount(type, indices ? indexCount : vertexCount);
+        if (m_batchingEnabled && (vertexCount <= Batch::MaxDrawSize) && (batchCount <= Batch::MaxDrawSize * 3))
         {
-            applyTransform(states.transform);
+            addToBatch(vertices, vertexCount, indices, indexCount, type, states, batchCount);
+            return;
         }
 
+        // Keep the drawing order: pending primitives go first
+        flush();
+
+        applyTransform(states.transform);
+
         // Apply the view
         if (m_cache.viewChanged)
             applyCurrentView();
@@ -263,39 +423,133 @@ void RenderTarget::draw(const Vertex* vertices, unsigned int vertexCount,
         if (states.shader)
             applyShader(states.shader);
 
-        // If we pre-transform the vertices, we must use our internal vertex cache
-        if (useVertexCache)
+        // Find the OpenGL primitive type
+        static const GLenum modes[] = {GL_TRIANGLES, GL_TRIANGLE_STRIP, GL_TRIANGLE_FAN, GL_TRIANGLES};
+        GLenum mode = modes[type];
+
+        // Draw the primitives
+        if (indices)
         {
-            // ... and if we already used it previously, we don't need to set the pointers again
-            if (!m_cache.useVertexCache)
-                vertices = m_cache.vertexCache;
-            else
-                vertices = NULL;
-        }
+            std::vector<Uint16> triangles;
+            if (type == Quads)
+            {
+                triangles.resize(batchCount);
+                if (batchCount > 0)
+                    writeTriangleIndices(&triangles[0], indices, indexCount, Quads, 0);
+                indices = triangles.empty() ? NULL : &triangles[0];
+                indexCount = batchCount;
+            }
 
-        // Setup the pointers to the vertices' components
-        if (vertices)
+            setVertexPointers(vertices);
+            if (indices)
+                glCheck(glDrawElements(mode, indexCount, GL_UNSIGNED_SHORT, indices));
+        }
+        else if (type == Quads)
+        {
+            // All quads share the same index buffer, bigger arrays are drawn in chunks
+            const Uint16* quadIndices = getQuadIndices();
+            for (unsigned int first = 0; first + 4 <= vertexCount; first += sharedQuadCount * 4)
+            {
+                unsigned int quadCount = std::min((vertexCount - first) / 4, sharedQuadCount);
+                setVertexPointers(vertices + first);
+                glCheck(glDrawElements(mode, quadCount * 6, GL_UNSIGNED_SHORT, quadIndices));
+            }
+        }
+        else
         {
-            const char* data = reinterpret_cast<const char*>(vertices);
-            glCheck(glVertexPointer(2, GL_FLOAT, sizeof(Vertex), data + 0));
-            glCheck(glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), data + 8)); // 8 = sizeof(Vector2f)
-            glCheck(glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), data + 12)); // 12 = 8 + sizeof(Color)
+            setVertexPointers(vertices);
+            glCheck(glDrawArrays(mode, 0, vertexCount));
         }
 
-        // Find the OpenGL primitive type
-        static const GLenum modes[] = {GL_TRIANGLES, GL_TRIANGLE_STRIP, GL_TRIANGLE_FAN};
-        GLenum mode = modes[type];
+        // Unbind the shader, if any
+        if (states.shader)
+            applyShader(NULL);
 
-        // Draw the primitives
-        glCheck(glDrawArrays(mode, 0, vertexCount));
+        ++m_statistics.batches;
+        m_statistics.vertices += vertexCount;
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+void RenderTarget::flush()
+{
+    if (m_batch.indexCount == 0)
+        return;
+
+    if (activate(true))
+    {
+        // Batched vertices are already transformed
+        applyTransform(Transform::Identity);
+
+        // Apply the view
+        if (m_cache.viewChanged)
+            applyCurrentView();
+
+        // Apply the blend mode
+        if (m_batch.blendMode != m_cache.lastBlendMode)
+            applyBlendMode(m_batch.blendMode);
+
+        // Apply the scissor mode
+        if (m_batch.scissor != m_cache.lastScissor)
+            applyScissor(m_batch.scissor);
+
+        // Apply the texture
+        if (m_batch.textureId != m_cache.lastTextureId)
+            applyTexture(m_batch.texture);
+
+        // Apply the shader
+        if (m_batch.shader)
+            applyShader(m_batch.shader);
+
+        setVertexPointers(m_batch.vertices + m_batch.vertexStart);
+
+        glCheck(glDrawElements(GL_TRIANGLES, m_batch.indexCount, GL_UNSIGNED_SHORT, m_batch.indices + m_batch.indexStart));
 
         // Unbind the shader, if any
-        if (states.shader)
+        if (m_batch.shader)
             applyShader(NULL);
 
-        // Update the cache
-        m_cache.useVertexCache = useVertexCache;
+        ++m_statistics.batches;
+        m_statistics.vertices += m_batch.vertexCount;
     }
+
+    // OpenGL reads client-side arrays during the draw call, so the buffers can be reused right away
+    m_batch.vertexStart = 0;
+    m_batch.vertexCount = 0;
+    m_batch.indexStart = 0;
+    m_batch.indexCount = 0;
+}
+
+
+////////////////////////////////////////////////////////////
+void RenderTarget::setBatchingEnabled(bool enabled)
+{
+    if (!enabled)
+        flush();
+
+    m_batchingEnabled = enabled;
+}
+
+
+////////////////////////////////////////////////////////////
+bool RenderTarget::isBatchingEnabled() const
+{
+    return m_batchingEnabled;
+}
+
+
+////////////////////////////////////////////////////////////
+const RenderTarget::Statistics& RenderTarget::getStatistics() const
+{
+    return m_statistics;
+}
+
+
+////////////////////////////////////////////////////////////
+void RenderTarget::resetStatistics()
+{
+    m_statistics = Statistics();
 }
 
 
@@ -304,6 +558,8 @@ void RenderTarget::pushGLStates()
 {
 	if (activate(true))
     {
+        flush();
+
         #ifdef CPP3DS_DEBUG
             // make sure that the user didn't leave an unchecked OpenGL error
             GLenum error = glGetError();
@@ -334,6 +590,9 @@ void RenderTarget::popGLStates()
 {
     if (activate(true))
     {
+        // Pending primitives were drawn with the pushed states
+        flush();
+
 		glCheck(glMatrixMode(GL_PROJECTION));
 		glCheck(glPopMatrix());
 		glCheck(glMatrixMode(GL_MODELVIEW));
@@ -350,6 +609,9 @@ void RenderTarget::popGLStates()
 ////////////////////////////////////////////////////////////
 void RenderTarget::resetGLStates()
 {
+    // Pending primitives rely on the current states
+    flush();
+
 	// Check here to make sure a context change does not happen after activate(true)
     bool shaderAvailable = Shader::isAvailable();
 
@@ -385,8 +647,6 @@ void RenderTarget::resetGLStates()
         if (shaderAvailable)
             applyShader(NULL);
 
-        m_cache.useVertexCache = false;
-
         // Set the default view
         setView(getView());
     }
@@ -405,6 +665,88 @@ void RenderTarget::initialize()
 }
 
 
+////////////////////////////////////////////////////////////
+template <typename VertexType>
+void RenderTarget::addToBatch(const VertexType* vertices, unsigned int vertexCount,
+                              const Uint16* indices, unsigned int indexCount, PrimitiveType type,
+                              const RenderStates& states, unsigned int batchCount)
+{
+    if (batchCount == 0)
+        return;
+
+    // Any change of state ends the pending batch, and so does a full buffer
+    Uint64 textureId = states.texture ? states.texture->m_cacheId : 0;
+    if (m_batch.indexCount > 0)
+    {
+        if ((textureId != m_batch.textureId) || (states.blendMode != m_batch.blendMode) ||
+            (states.scissor != m_batch.scissor) || (states.shader != m_batch.shader) ||
+            (m_batch.vertexCount + vertexCount > Batch::VertexCapacity) ||
+            (m_batch.indexCount + batchCount > Batch::IndexCapacity))
+            flush();
+        else
+            ++m_statistics.mergedDraws;
+    }
+
+    if (!m_batch.vertices)
+    {
+        m_batch.vertices = new Vertex[Batch::VertexCapacity];
+        m_batch.indices  = new Uint16[Batch::IndexCapacity];
+    }
+
+    // Start a new batch
+    if (m_batch.indexCount == 0)
+    {
+        m_batch.texture   = states.texture;
+        m_batch.textureId = textureId;
+        m_batch.blendMode = states.blendMode;
+        m_batch.scissor   = states.scissor;
+        m_batch.shader    = states.shader;
+    }
+
+    // Pre-transform the vertices, compact ones are expanded to floats
+    Vertex* out = m_batch.vertices + m_batch.vertexCount;
+    const Transform& transform = states.transform;
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+        out[i].position  = transform * Vector2f(vertices[i].position);
+        out[i].color     = vertices[i].color;
+        out[i].texCoords = Vector2f(vertices[i].texCoords);
+    }
+
+    // Store the primitives as independent triangles
+    writeTriangleIndices(m_batch.indices + m_batch.indexCount,
+                         indices, indices ? indexCount : vertexCount, type, m_batch.vertexCount);
+
+    m_batch.vertexCount += vertexCount;
+    m_batch.indexCount += batchCount;
+}
+
+
+////////////////////////////////////////////////////////////
+bool RenderTarget::clearPixels(const Color& color)
+{
+    return false;
+}
+
+
+////////////////////////////////////////////////////////////
+bool RenderTarget::rasterize(const Vertex* vertices, unsigned int vertexCount,
+                             const Uint16* indices, unsigned int indexCount,
+                             PrimitiveType type, const RenderStates& states)
+{
+    return false;
+}
+
+
+////////////////////////////////////////////////////////////
+bool RenderTarget::rasterize(const CompactVertex* vertices, unsigned int vertexCount,
+                             const Uint16* indices, unsigned int indexCount,
+                             PrimitiveType type, const RenderStates& states)
+{
+    return false;
+}
+
+
 ////////////////////////////////////////////////////////////
 void RenderTarget::applyCurrentView()
 {
@@ -437,6 +779,7 @@ void RenderTarget::applyBlendMode(const BlendMode& mode)
 		equationToGlConstant(mode.alphaEquation)));
 
     m_cache.lastBlendMode = mode;
+    ++m_statistics.blendChanges;
 }
 
 
@@ -452,6 +795,7 @@ void RenderTarget::applyScissor(const UintRect& rect)
 		glScissor(rect.left, y, rect.width, rect.height);
 	}
 	m_cache.lastScissor = rect;
+	++m_statistics.scissorChanges;
 }
 
 
@@ -470,6 +814,7 @@ void RenderTarget::applyTexture(const Texture* texture)
     Texture::bind(texture, Texture::Pixels);
 
     m_cache.lastTextureId = texture ? texture->m_cacheId : 0;
+    ++m_statistics.textureBinds;
 }
 
 
@@ -498,6 +843,16 @@ void RenderTarget::applyShader(const Shader* shader)
 //   pre-transform them and therefore use an identity transform
 //   to render them.
 //
+// * Batching
+//   Pre-transformed vertices are appended to a pending batch
+//   as long as texture, blend mode, scissor and shader don't
+//   change, so that consecutive sprites or shapes sharing the
+//   same states cost a single GPU draw call. All primitives
+//   are stored as indexed triangles, so that quads only need
+//   4 vertices. The batch is submitted when a state or the
+//   view changes, when the buffers are full, or when the
+//   target is cleared/displayed.
+//
 // * Blending mode
 //   Since it overloads the == operator, we can easily check
 //   whether any of the 6 blending components changed and,
@@ -132,6 +132,13 @@ bool Shader::loadFromFile(const std::string& vertexShaderFilename, const std::st
 ////////////////////////////////////////////////////////////
 bool Shader::loadFromMemory(const std::string& shader, Type type)
 {
+    // Compile the shader program
+    if (type == Vertex)
+        return compile(shader.c_str(), NULL);
+    else if (type == Fragment)
+        return compile(NULL, shader.c_str());
+
+    err() << "Failed to load shader from memory: geometry shaders are not supported" << std::endl;
     return false;
 }
 
@@ -139,7 +146,8 @@ bool Shader::loadFromMemory(const std::string& shader, Type type)
 ////////////////////////////////////////////////////////////
 bool Shader::loadFromMemory(const std::string& vertexShader, const std::string& fragmentShader)
 {
-    return false;
+    // Compile the shader program
+    return compile(vertexShader.c_str(), fragmentShader.c_str());
 }
 
 
@@ -449,6 +457,34 @@ bool Shader::compile(const char* vertexShaderCode, const char* fragmentShaderCod
 		glCheck(glDeleteObjectARB(vertexShader));
 	}
 
+	// Create the fragment shader if needed
+	if (fragmentShaderCode)
+	{
+		// Create and compile the shader
+		GLhandleARB fragmentShader;
+		glCheck(fragmentShader = glCreateShaderObjectARB(GL_FRAGMENT_SHADER));
+		glCheck(glShaderSource(fragmentShader, 1, &fragmentShaderCode, NULL));
+		glCheck(glCompileShader(fragmentShader));
+
+		// Check the compile log
+		GLint success;
+		glCheck(glGetObjectParameterivARB(fragmentShader, GL_OBJECT_COMPILE_STATUS_ARB, &success));
+		if (success == GL_FALSE)
+		{
+			char log[1024];
+			glCheck(glGetInfoLogARB(fragmentShader, sizeof(log), 0, log));
+			err() << "Failed to compile fragment shader:" << std::endl
+			<< log << std::endl;
+			glCheck(glDeleteObjectARB(fragmentShader));
+			glCheck(glDeleteObjectARB(shaderProgram));
+			return false;
+		}
+
+		// Attach the shader to the program, and delete it (not needed anymore)
+		glCheck(glAttachObjectARB(shaderProgram, fragmentShader));
+		glCheck(glDeleteObjectARB(fragmentShader));
+	}
+
 	// Link the program
 	glCheck(glLinkProgram(shaderProgram));
 
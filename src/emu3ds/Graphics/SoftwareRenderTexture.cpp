@@ -0,0 +1,375 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cpp3ds/Graphics/SoftwareRenderTexture.hpp>
+#include <cpp3ds/Graphics/Texture.hpp>
+#include <cpp3ds/System/Err.hpp>
+#include <algorithm>
+#include <cmath>
+
+
+namespace
+{
+// Positions are snapped to 1/256 of a pixel before rasterizing
+const int subpixelBits = 8;
+const cpp3ds::Int64 subpixelScale = 1 << subpixelBits;
+
+// Compute a blending factor for one channel, components ranging from 0 to 1
+float getFactor(cpp3ds::BlendMode::Factor factor, const float* src, const float* dst, int channel)
+{
+    switch (factor)
+    {
+        default:
+        case cpp3ds::BlendMode::Zero:             return 0.f;
+        case cpp3ds::BlendMode::One:              return 1.f;
+        case cpp3ds::BlendMode::SrcColor:         return src[channel];
+        case cpp3ds::BlendMode::OneMinusSrcColor: return 1.f - src[channel];
+        case cpp3ds::BlendMode::DstColor:         return dst[channel];
+        case cpp3ds::BlendMode::OneMinusDstColor: return 1.f - dst[channel];
+        case cpp3ds::BlendMode::SrcAlpha:         return src[3];
+        case cpp3ds::BlendMode::OneMinusSrcAlpha: return 1.f - src[3];
+        case cpp3ds::BlendMode::DstAlpha:         return dst[3];
+        case cpp3ds::BlendMode::OneMinusDstAlpha: return 1.f - dst[3];
+    }
+}
+
+// Blend a color into a pixel, like glBlendFuncSeparate and glBlendEquationSeparate
+void blend(cpp3ds::Uint8* pixel, const float* src, const cpp3ds::BlendMode& mode)
+{
+    float dst[4];
+    for (int i = 0; i < 4; ++i)
+        dst[i] = pixel[i] / 255.f;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        bool alpha = (i == 3);
+        float s = src[i] * getFactor(alpha ? mode.alphaSrcFactor : mode.colorSrcFactor, src, dst, i);
+        float d = dst[i] * getFactor(alpha ? mode.alphaDstFactor : mode.colorDstFactor, src, dst, i);
+        float result = ((alpha ? mode.alphaEquation : mode.colorEquation) == cpp3ds::BlendMode::Add) ? s + d : s - d;
+        pixel[i] = static_cast<cpp3ds::Uint8>(std::min(std::max(result, 0.f), 1.f) * 255.f + 0.5f);
+    }
+}
+
+// Wrap or clamp a texel coordinate
+int wrap(int coordinate, int size, bool repeated)
+{
+    if (repeated)
+        return ((coordinate % size) + size) % size;
+    else
+        return std::min(std::max(coordinate, 0), size - 1);
+}
+
+// Signed area of the parallelogram (a, b, p), positive when p is right of a->b with y going down
+cpp3ds::Int64 edge(cpp3ds::Int64 ax, cpp3ds::Int64 ay, cpp3ds::Int64 bx, cpp3ds::Int64 by, cpp3ds::Int64 px, cpp3ds::Int64 py)
+{
+    return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+}
+
+// Pixels exactly on an edge belong to the triangle if the edge is a top or left one
+bool isTopLeft(cpp3ds::Int64 ax, cpp3ds::Int64 ay, cpp3ds::Int64 bx, cpp3ds::Int64 by)
+{
+    return (by < ay) || ((by == ay) && (bx > ax));
+}
+}
+
+
+namespace cpp3ds
+{
+////////////////////////////////////////////////////////////
+SoftwareRenderTexture::SoftwareRenderTexture() :
+m_size           (0, 0),
+m_pixels         (),
+m_positions      (),
+m_expanded       (),
+m_image          (),
+m_imageNeedUpdate(false)
+{
+}
+
+
+////////////////////////////////////////////////////////////
+bool SoftwareRenderTexture::create(unsigned int width, unsigned int height)
+{
+    if ((width == 0) || (height == 0))
+    {
+        err() << "Failed to create software render texture, invalid size (" << width << "x" << height << ")" << std::endl;
+        return false;
+    }
+
+    m_size = Vector2u(width, height);
+    m_pixels.assign(width * height * 4, 0);
+    m_imageNeedUpdate = true;
+
+    // Setup the default view
+    RenderTarget::initialize();
+
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////
+Vector2u SoftwareRenderTexture::getSize() const
+{
+    return m_size;
+}
+
+
+////////////////////////////////////////////////////////////
+const Image& SoftwareRenderTexture::getImage() const
+{
+    if (m_imageNeedUpdate)
+    {
+        if (m_pixels.empty())
+            m_image = Image();
+        else
+            m_image.create(m_size.x, m_size.y, &m_pixels[0]);
+        m_imageNeedUpdate = false;
+    }
+
+    return m_image;
+}
+
+
+////////////////////////////////////////////////////////////
+bool SoftwareRenderTexture::activate(bool)
+{
+    return false;
+}
+
+
+////////////////////////////////////////////////////////////
+bool SoftwareRenderTexture::clearPixels(const Color& color)
+{
+    for (std::size_t i = 0; i < m_pixels.size(); i += 4)
+    {
+        m_pixels[i + 0] = color.r;
+        m_pixels[i + 1] = color.g;
+        m_pixels[i + 2] = color.b;
+        m_pixels[i + 3] = color.a;
+    }
+    m_imageNeedUpdate = true;
+
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////
+bool SoftwareRenderTexture::rasterize(const Vertex* vertices, unsigned int vertexCount,
+                                      const Uint16* indices, unsigned int indexCount,
+                                      PrimitiveType type, const RenderStates& states)
+{
+    // Pixels that can be written: the viewport, within the target and the scissor rect
+    IntRect clip;
+    if (!getViewport(getView()).intersects(IntRect(0, 0, m_size.x, m_size.y), clip))
+        return true;
+    if ((states.scissor != UintRect()) && !clip.intersects(IntRect(states.scissor), clip))
+        return true;
+
+    // Transform the vertices to pixels, like the view and viewport do on the GPU
+    Transform transform = getView().getTransform() * states.transform;
+    IntRect viewport = getViewport(getView());
+    m_positions.resize(vertexCount);
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+        Vector2f point = transform.transformPoint(vertices[i].position);
+        m_positions[i].x = viewport.left + (point.x + 1.f) / 2.f * viewport.width;
+        m_positions[i].y = viewport.top  + (1.f - point.y) / 2.f * viewport.height;
+    }
+
+    // Split the primitives into triangles
+    unsigned int count = indices ? indexCount : vertexCount;
+    for (unsigned int i = 0; i + 2 < count; )
+    {
+        unsigned int corners[4];
+        unsigned int cornerCount = (type == Quads) ? 4 : 3;
+        if ((type == Quads) && (i + 3 >= count))
+            break;
+
+        switch (type)
+        {
+            case TrianglesFan:
+                corners[0] = 0;
+                corners[1] = i + 1;
+                corners[2] = i + 2;
+                break;
+            default:
+                for (unsigned int j = 0; j < cornerCount; ++j)
+                    corners[j] = i + j;
+                break;
+        }
+
+        if (indices)
+        {
+            for (unsigned int j = 0; j < cornerCount; ++j)
+                corners[j] = indices[corners[j]];
+        }
+
+        fillTriangle(vertices, corners[0], corners[1], corners[2], states, clip);
+        if (type == Quads)
+            fillTriangle(vertices, corners[0], corners[2], corners[3], states, clip);
+
+        i += ((type == Triangles) || (type == Quads)) ? cornerCount : 1;
+    }
+
+    m_imageNeedUpdate = true;
+
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////
+bool SoftwareRenderTexture::rasterize(const CompactVertex* vertices, unsigned int vertexCount,
+                                      const Uint16* indices, unsigned int indexCount,
+                                      PrimitiveType type, const RenderStates& states)
+{
+    m_expanded.resize(vertexCount);
+    for (unsigned int i = 0; i < vertexCount; ++i)
+        m_expanded[i] = Vertex(Vector2f(vertices[i].position), vertices[i].color, Vector2f(vertices[i].texCoords));
+
+    return rasterize(&m_expanded[0], vertexCount, indices, indexCount, type, states);
+}
+
+
+////////////////////////////////////////////////////////////
+void SoftwareRenderTexture::fillTriangle(const Vertex* vertices, unsigned int a, unsigned int b, unsigned int c,
+                                         const RenderStates& states, const IntRect& clip)
+{
+    // Snap the corners to the subpixel grid
+    Int64 x0 = static_cast<Int64>(std::floor(m_positions[a].x * subpixelScale + 0.5f));
+    Int64 y0 = static_cast<Int64>(std::floor(m_positions[a].y * subpixelScale + 0.5f));
+    Int64 x1 = static_cast<Int64>(std::floor(m_positions[b].x * subpixelScale + 0.5f));
+    Int64 y1 = static_cast<Int64>(std::floor(m_positions[b].y * subpixelScale + 0.5f));
+    Int64 x2 = static_cast<Int64>(std::floor(m_positions[c].x * subpixelScale + 0.5f));
+    Int64 y2 = static_cast<Int64>(std::floor(m_positions[c].y * subpixelScale + 0.5f));
+
+    // Both windings are drawn, as culling is disabled: orient the triangle clockwise on screen
+    Int64 area = edge(x0, y0, x1, y1, x2, y2);
+    if (area == 0)
+        return;
+    if (area < 0)
+    {
+        std::swap(b, c);
+        std::swap(x1, x2);
+        std::swap(y1, y2);
+        area = -area;
+    }
+
+    // Bounding box of the triangle, in pixels
+    int left   = std::max(clip.left, static_cast<int>(std::floor(std::min(x0, std::min(x1, x2)) / static_cast<float>(subpixelScale))));
+    int top    = std::max(clip.top,  static_cast<int>(std::floor(std::min(y0, std::min(y1, y2)) / static_cast<float>(subpixelScale))));
+    int right  = std::min(clip.left + clip.width,  static_cast<int>(std::ceil(std::max(x0, std::max(x1, x2)) / static_cast<float>(subpixelScale))));
+    int bottom = std::min(clip.top  + clip.height, static_cast<int>(std::ceil(std::max(y0, std::max(y1, y2)) / static_cast<float>(subpixelScale))));
+    if ((left >= right) || (top >= bottom))
+        return;
+
+    // Edges on the right or bottom don't own the pixels they cross exactly
+    Int64 bias0 = isTopLeft(x1, y1, x2, y2) ? 0 : -1;
+    Int64 bias1 = isTopLeft(x2, y2, x0, y0) ? 0 : -1;
+    Int64 bias2 = isTopLeft(x0, y0, x1, y1) ? 0 : -1;
+
+    // Steps of the edge functions from a pixel to the next
+    Int64 step0 = -(y2 - y1) * subpixelScale;
+    Int64 step1 = -(y0 - y2) * subpixelScale;
+    Int64 step2 = -(y1 - y0) * subpixelScale;
+
+    const Vertex& v0 = vertices[a];
+    const Vertex& v1 = vertices[b];
+    const Vertex& v2 = vertices[c];
+    const Texture* texture = (states.texture && states.texture->loadShadow()) ? states.texture : NULL;
+    bool opaque = (states.blendMode == BlendNone);
+    float invArea = 1.f / area;
+
+    for (int y = top; y < bottom; ++y)
+    {
+        // Sample at the centers of the pixels
+        Int64 px = left * subpixelScale + subpixelScale / 2;
+        Int64 py = y * subpixelScale + subpixelScale / 2;
+        Int64 w0 = edge(x1, y1, x2, y2, px, py);
+        Int64 w1 = edge(x2, y2, x0, y0, px, py);
+        Int64 w2 = edge(x0, y0, x1, y1, px, py);
+
+        Uint8* pixel = &m_pixels[(left + y * m_size.x) * 4];
+        for (int x = left; x < right; ++x, pixel += 4, w0 += step0, w1 += step1, w2 += step2)
+        {
+            if ((w0 + bias0 < 0) || (w1 + bias1 < 0) || (w2 + bias2 < 0))
+                continue;
+
+            // Interpolate the vertex attributes
+            float l0 = w0 * invArea;
+            float l1 = w1 * invArea;
+            float l2 = 1.f - l0 - l1;
+
+            float color[4];
+            color[0] = (v0.color.r * l0 + v1.color.r * l1 + v2.color.r * l2) / 255.f;
+            color[1] = (v0.color.g * l0 + v1.color.g * l1 + v2.color.g * l2) / 255.f;
+            color[2] = (v0.color.b * l0 + v1.color.b * l1 + v2.color.b * l2) / 255.f;
+            color[3] = (v0.color.a * l0 + v1.color.a * l1 + v2.color.a * l2) / 255.f;
+
+            // Modulate by the texture, like GL_MODULATE
+            if (texture)
+            {
+                float texel[4];
+                sample(*texture,
+                       v0.texCoords.x * l0 + v1.texCoords.x * l1 + v2.texCoords.x * l2,
+                       v0.texCoords.y * l0 + v1.texCoords.y * l1 + v2.texCoords.y * l2,
+                       texel);
+                for (int i = 0; i < 4; ++i)
+                    color[i] *= texel[i];
+            }
+
+            if (opaque)
+            {
+                for (int i = 0; i < 4; ++i)
+                    pixel[i] = static_cast<Uint8>(std::min(std::max(color[i], 0.f), 1.f) * 255.f + 0.5f);
+            }
+            else
+            {
+                blend(pixel, color, states.blendMode);
+            }
+        }
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+void SoftwareRenderTexture::sample(const Texture& texture, float u, float v, float* texel)
+{
+    int width  = static_cast<int>(texture.m_actualSize.x);
+    int height = static_cast<int>(texture.m_actualSize.y);
+    const Uint8* pixels = &texture.m_shadow[0];
+
+    if (!texture.m_isSmooth)
+    {
+        // Nearest texel
+        int x = wrap(static_cast<int>(std::floor(u)), width, texture.m_isRepeated);
+        int y = wrap(static_cast<int>(std::floor(v)), height, texture.m_isRepeated);
+        const Uint8* p = pixels + (x + y * width) * 4;
+        for (int i = 0; i < 4; ++i)
+            texel[i] = p[i] / 255.f;
+        return;
+    }
+
+    // Weighted average of the four texels around the point, their centers being at half pixels
+    u -= 0.5f;
+    v -= 0.5f;
+    float fu = std::floor(u);
+    float fv = std::floor(v);
+    float ax = u - fu;
+    float ay = v - fv;
+    int xa = wrap(static_cast<int>(fu), width, texture.m_isRepeated);
+    int xb = wrap(static_cast<int>(fu) + 1, width, texture.m_isRepeated);
+    int ya = wrap(static_cast<int>(fv), height, texture.m_isRepeated);
+    int yb = wrap(static_cast<int>(fv) + 1, height, texture.m_isRepeated);
+    const Uint8* p00 = pixels + (xa + ya * width) * 4;
+    const Uint8* p10 = pixels + (xb + ya * width) * 4;
+    const Uint8* p01 = pixels + (xa + yb * width) * 4;
+    const Uint8* p11 = pixels + (xb + yb * width) * 4;
+    for (int i = 0; i < 4; ++i)
+    {
+        float upper = p00[i] + (p10[i] - p00[i]) * ax;
+        float lower = p01[i] + (p11[i] - p01[i]) * ax;
+        texel[i] = (upper + (lower - upper) * ay) / 255.f;
+    }
+}
+
+} // namespace cpp3ds
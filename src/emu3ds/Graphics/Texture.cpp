@@ -33,9 +33,11 @@
 #include <cpp3ds/System/Mutex.hpp>
 #include <cpp3ds/System/Lock.hpp>
 #include <cpp3ds/System/Err.hpp>
+#include <cpp3ds/System/Trace.hpp>
 #include <cpp3ds/OpenGL.hpp>
 #include <cassert>
 #include <cstring>
+#include <vector>
 #ifndef EMULATION
 #include <3ds.h>
 #endif
@@ -55,6 +57,16 @@ namespace
 		return id++;
 	}
 
+    // Bytes of pixels sent to the GPU by all the textures
+    cpp3ds::Uint64 uploadedBytes = 0;
+
+    void countUpload(std::size_t bytes)
+    {
+        cpp3ds::Lock lock(mutex);
+
+        uploadedBytes += bytes;
+    }
+
 	unsigned int checkMaximumTextureSize()
 	{
 		// TODO: fix this
@@ -68,6 +80,72 @@ namespace
 
 		return static_cast<unsigned int>(size);
 	}
+
+    // Get the OpenGL internal format matching a texture format,
+    // so that the emulator has the same precision as the GPU
+    GLint getInternalFormat(cpp3ds::Texture::Format format)
+    {
+        switch (format)
+        {
+            case cpp3ds::Texture::RGB565:   return GL_RGB5;
+            case cpp3ds::Texture::RGBA5551: return GL_RGB5_A1;
+            case cpp3ds::Texture::RGBA4:    return GL_RGBA4;
+            case cpp3ds::Texture::LA8:      return GL_LUMINANCE8_ALPHA8;
+            case cpp3ds::Texture::L8:       return GL_LUMINANCE8;
+            case cpp3ds::Texture::A8:       return GL_ALPHA8;
+            default:                        return GL_RGBA8;
+        }
+    }
+
+    // Luminance of a RGBA pixel, weighted like the hardware converter does
+    inline cpp3ds::Uint8 luminance(const cpp3ds::Uint8* pixel)
+    {
+        return static_cast<cpp3ds::Uint8>((pixel[0] * 77 + pixel[1] * 150 + pixel[2] * 29) >> 8);
+    }
+
+    // Upload RGBA pixels to a rectangle of the bound texture, pitch being the width of a source row
+    void uploadPixels(cpp3ds::Texture::Format format, const cpp3ds::Uint8* pixels, unsigned int width, unsigned int height,
+                      unsigned int pitch, unsigned int x, unsigned int y)
+    {
+        // OpenGL only keeps the red channel of luminance textures,
+        // so compute the luminance first
+        std::vector<cpp3ds::Uint8> converted;
+        if ((format == cpp3ds::Texture::L8) || (format == cpp3ds::Texture::LA8))
+        {
+            converted.resize(width * height * 4);
+            cpp3ds::Uint8* dst = &converted[0];
+            for (unsigned int row = 0; row < height; ++row)
+            {
+                const cpp3ds::Uint8* src = pixels + row * pitch * 4;
+                for (unsigned int i = 0; i < width; ++i, src += 4, dst += 4)
+                {
+                    dst[0] = dst[1] = dst[2] = luminance(src);
+                    dst[3] = src[3];
+                }
+            }
+            pixels = &converted[0];
+            pitch = width;
+        }
+
+        glCheck(glPixelStorei(GL_UNPACK_ROW_LENGTH, pitch));
+        glCheck(glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+        glCheck(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+    }
+
+    // Get the size of a texel, as stored by the GPU
+    std::size_t getTexelSize(cpp3ds::Texture::Format format)
+    {
+        switch (format)
+        {
+            case cpp3ds::Texture::RGB565:
+            case cpp3ds::Texture::RGBA5551:
+            case cpp3ds::Texture::RGBA4:
+            case cpp3ds::Texture::LA8:      return 2;
+            case cpp3ds::Texture::L8:
+            case cpp3ds::Texture::A8:       return 1;
+            default:                        return 4;
+        }
+    }
 }
 
 
@@ -77,9 +155,12 @@ namespace cpp3ds
 Texture::Texture() :
 m_size         (0, 0),
 m_actualSize   (0, 0),
+m_format       (RGBA8),
 m_texture      (0),
 m_isSmooth     (false),
 m_isRepeated   (false),
+m_hasMipmap    (false),
+m_mipmapSmooth (true),
 m_pixelsFlipped(false),
 m_cacheId      (getUniqueId())
 {
@@ -91,14 +172,17 @@ m_cacheId      (getUniqueId())
 Texture::Texture(const Texture& copy) :
 m_size         (0, 0),
 m_actualSize   (0, 0),
+m_format       (copy.m_format),
 m_texture      (0),
 m_isSmooth     (copy.m_isSmooth),
 m_isRepeated   (copy.m_isRepeated),
+m_hasMipmap    (false),
+m_mipmapSmooth (copy.m_mipmapSmooth),
 m_pixelsFlipped(false),
 m_cacheId      (getUniqueId())
 {
-    if (copy.m_texture)
-        loadFromImage(copy.copyToImage());
+    if (copy.m_texture || !copy.m_shadow.empty())
+        loadFromImage(copy.copyToImage(), IntRect(), copy.m_format);
 }
 
 
@@ -117,7 +201,7 @@ Texture::~Texture()
 
 
 ////////////////////////////////////////////////////////////
-bool Texture::create(unsigned int width, unsigned int height)
+bool Texture::create(unsigned int width, unsigned int height, Format format)
 {
     // Check if texture parameters are valid before creating it
     if ((width == 0) || (height == 0))
@@ -144,6 +228,8 @@ bool Texture::create(unsigned int width, unsigned int height)
     m_size.x        = width;
     m_size.y        = height;
     m_actualSize    = actualSize;
+    m_format        = format;
+    m_hasMipmap     = false;
     m_pixelsFlipped = false;
 
 	ensureGlContext();
@@ -151,17 +237,24 @@ bool Texture::create(unsigned int width, unsigned int height)
     // Create the OpenGL texture if it doesn't exist yet
     if (!m_texture)
     {
-        GLuint texture;
+        GLuint texture = 0;
         glCheck(glGenTextures(1, &texture));
         m_texture = static_cast<unsigned int>(texture);
     }
 
+    // Without OpenGL, the pixels are only kept on the CPU. Otherwise
+    // the copy is only made if a SoftwareRenderTexture samples them.
+    if (m_texture)
+        m_shadow.clear();
+    else
+        m_shadow.assign(m_actualSize.x * m_actualSize.y * 4, 0);
+
     // Make sure that the current texture binding will be preserved
     priv::TextureSaver save;
 
     // Initialize the texture
 	glCheck(glBindTexture(GL_TEXTURE_2D, m_texture));
-	glCheck(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_actualSize.x, m_actualSize.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL));
+	glCheck(glTexImage2D(GL_TEXTURE_2D, 0, getInternalFormat(m_format), m_actualSize.x, m_actualSize.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL));
 	glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, m_isRepeated ? GL_REPEAT : GL_CLAMP_TO_EDGE));
 	glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, m_isRepeated ? GL_REPEAT : GL_CLAMP_TO_EDGE));
 	glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, m_isSmooth ? GL_LINEAR : GL_NEAREST));
@@ -174,30 +267,30 @@ bool Texture::create(unsigned int width, unsigned int height)
 
 
 ////////////////////////////////////////////////////////////
-bool Texture::loadFromFile(const std::string& filename, const IntRect& area)
+bool Texture::loadFromFile(const std::string& filename, const IntRect& area, Format format)
 {
     Image image;
-    return image.loadFromFile(filename) && loadFromImage(image, area);
+    return image.loadFromFile(filename) && loadFromImage(image, area, format);
 }
 
 
 ////////////////////////////////////////////////////////////
-bool Texture::loadFromMemory(const void* data, std::size_t size, const IntRect& area)
+bool Texture::loadFromMemory(const void* data, std::size_t size, const IntRect& area, Format format)
 {
     Image image;
-    return image.loadFromMemory(data, size) && loadFromImage(image, area);
+    return image.loadFromMemory(data, size) && loadFromImage(image, area, format);
 }
 
 
 ////////////////////////////////////////////////////////////
-bool Texture::loadFromStream(InputStream& stream, const IntRect& area)
+bool Texture::loadFromStream(InputStream& stream, const IntRect& area, Format format)
 {
     Image image;
-    return image.loadFromStream(stream) && loadFromImage(image, area);
+    return image.loadFromStream(stream) && loadFromImage(image, area, format);
 }
 
 ////////////////////////////////////////////////////////////
-bool Texture::loadFromImage(const Image& image, const IntRect& area)
+bool Texture::loadFromImage(const Image& image, const IntRect& area, Format format)
 {
     // Retrieve the image size
     int width = static_cast<int>(image.getSize().x);
@@ -208,7 +301,7 @@ bool Texture::loadFromImage(const Image& image, const IntRect& area)
        ((area.left <= 0) && (area.top <= 0) && (area.width >= width) && (area.height >= height)))
     {
         // Load the entire image
-        if (create(image.getSize().x, image.getSize().y))
+        if (create(image.getSize().x, image.getSize().y, format))
         {
             update(image);
             // Force an OpenGL flush, so that the texture will appear updated
@@ -233,19 +326,17 @@ bool Texture::loadFromImage(const Image& image, const IntRect& area)
         if (rectangle.top + rectangle.height > height) rectangle.height = height - rectangle.top;
 
         // Create the texture and upload the pixels
-        if (create(rectangle.width, rectangle.height))
+        if (create(rectangle.width, rectangle.height, format))
         {
             // Make sure that the current texture binding will be preserved
             priv::TextureSaver save;
 
-            // Copy the pixels to the texture, row by row
+            // Copy the pixels to the texture, reading the rows from the whole image
             const Uint8* pixels = image.getPixelsPtr() + 4 * (rectangle.left + (width * rectangle.top));
+            updateShadow(pixels, rectangle.width, rectangle.height, width, 0, 0);
             glCheck(glBindTexture(GL_TEXTURE_2D, m_texture));
-            for (int i = 0; i < rectangle.height; ++i)
-            {
-                glCheck(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, i, rectangle.width, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
-                pixels += 4 * width;
-            }
+            uploadPixels(m_format, pixels, rectangle.width, rectangle.height, width, 0, 0);
+            countUpload(rectangle.width * rectangle.height * getTexelSize(m_format));
 
             // Force an OpenGL flush, so that the texture will appear updated
             // in all contexts immediately (solves problems in multi-threaded apps)
@@ -268,12 +359,48 @@ Vector2u Texture::getSize() const
 }
 
 
+////////////////////////////////////////////////////////////
+std::size_t Texture::getMemoryUsage() const
+{
+    if (!m_texture)
+        return 0;
+
+    // Same accounting as the 3DS, which only allocates the levels past
+    // the first one when the mipmap is generated
+    std::size_t size = m_actualSize.x * m_actualSize.y * getTexelSize(m_format);
+    if (m_hasMipmap)
+        for (unsigned int width = m_actualSize.x / 2, height = m_actualSize.y / 2; (width >= 8) && (height >= 8); width /= 2, height /= 2)
+            size += width * height * getTexelSize(m_format);
+    return size;
+}
+
+
+////////////////////////////////////////////////////////////
+Texture::Format Texture::getFormat() const
+{
+    return m_format;
+}
+
+
 ////////////////////////////////////////////////////////////
 Image Texture::copyToImage() const
 {
-    // Easy case: empty texture
+    // Without OpenGL, the copy kept on the CPU is all there is
     if (!m_texture)
-        return Image();
+    {
+        Image image;
+        if (!m_shadow.empty())
+        {
+            image.create(m_size.x, m_size.y);
+            for (unsigned int y = 0; y < m_size.y; ++y)
+                for (unsigned int x = 0; x < m_size.x; ++x)
+                {
+                    const Uint8* texel = &m_shadow[(x + y * m_actualSize.x) * 4];
+                    image.setPixel(x, y, Color(texel[0], texel[1], texel[2], texel[3]));
+                }
+        }
+        return image;
+    }
 
     ensureGlContext();
 
@@ -336,6 +463,11 @@ Image Texture::copyToImage() const
 		}
 	}
 #endif
+    // OpenGL reads alpha textures back as black, the GPU as white
+    if (m_format == A8)
+        for (std::size_t i = 0; i < pixels.size(); i += 4)
+            pixels[i] = pixels[i + 1] = pixels[i + 2] = 255;
+
     // Create the image
     Image image;
     image.create(m_size.x, m_size.y, &pixels[0]);
@@ -355,9 +487,14 @@ void Texture::update(const Uint8* pixels)
 ////////////////////////////////////////////////////////////
 void Texture::update(const Uint8* pixels, unsigned int width, unsigned int height, unsigned int x, unsigned int y)
 {
+    CPP3DS_TRACE_ZONE("Graphics", "Texture::update");
+
     assert(x + width <= m_size.x);
     assert(y + height <= m_size.y);
 
+    if (pixels)
+        updateShadow(pixels, width, height, width, x, y);
+
     if (pixels && m_texture)
     {
 		ensureGlContext();
@@ -367,7 +504,9 @@ void Texture::update(const Uint8* pixels, unsigned int width, unsigned int heigh
 
         // Copy pixels from the given array to the texture
         glCheck(glBindTexture(GL_TEXTURE_2D, m_texture));
-        glCheck(glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+        uploadPixels(m_format, pixels, width, height, width, x, y);
+        countUpload(width * height * getTexelSize(m_format));
+        invalidateMipmap();
         m_pixelsFlipped = false;
         m_cacheId = getUniqueId();
     }
@@ -389,6 +528,62 @@ void Texture::update(const Image& image, unsigned int x, unsigned int y)
 }
 
 
+////////////////////////////////////////////////////////////
+void Texture::updateRegions(const Uint8* pixels, const std::vector<IntRect>& regions)
+{
+    CPP3DS_TRACE_ZONE("Graphics", "Texture::updateRegions");
+
+    if (!pixels || regions.empty())
+        return;
+
+    for (std::vector<IntRect>::const_iterator it = regions.begin(); it != regions.end(); ++it)
+    {
+        int left   = std::max(it->left, 0);
+        int top    = std::max(it->top, 0);
+        int right  = std::min(it->left + it->width, static_cast<int>(m_size.x));
+        int bottom = std::min(it->top + it->height, static_cast<int>(m_size.y));
+        if ((left < right) && (top < bottom))
+            updateShadow(pixels + 4 * (left + top * m_size.x), right - left, bottom - top, m_size.x, left, top);
+    }
+
+    if (!m_texture)
+        return;
+
+    ensureGlContext();
+
+    // Make sure that the current texture binding will be preserved
+    priv::TextureSaver save;
+
+    // Each region is read from the full-size pixel array
+    glCheck(glBindTexture(GL_TEXTURE_2D, m_texture));
+    for (std::vector<IntRect>::const_iterator it = regions.begin(); it != regions.end(); ++it)
+    {
+        int left   = std::max(it->left, 0);
+        int top    = std::max(it->top, 0);
+        int right  = std::min(it->left + it->width, static_cast<int>(m_size.x));
+        int bottom = std::min(it->top + it->height, static_cast<int>(m_size.y));
+        if ((left >= right) || (top >= bottom))
+            continue;
+
+        uploadPixels(m_format, pixels + 4 * (left + top * m_size.x), right - left, bottom - top, m_size.x, left, top);
+        countUpload((right - left) * (bottom - top) * getTexelSize(m_format));
+    }
+
+    invalidateMipmap();
+    m_pixelsFlipped = false;
+    m_cacheId = getUniqueId();
+}
+
+
+////////////////////////////////////////////////////////////
+void Texture::updateRegions(const Image& image, const std::vector<IntRect>& regions)
+{
+    assert(image.getSize() == m_size);
+
+    updateRegions(image.getPixelsPtr(), regions);
+}
+
+
 ////////////////////////////////////////////////////////////
 void Texture::update(const Window& window)
 {
@@ -432,7 +627,7 @@ void Texture::setSmooth(bool smooth)
 
             glCheck(glBindTexture(GL_TEXTURE_2D, m_texture));
             glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, m_isSmooth ? GL_LINEAR : GL_NEAREST));
-            glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, m_isSmooth ? GL_LINEAR : GL_NEAREST));
+            glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, getMinFilter()));
         }
     }
 }
@@ -474,6 +669,92 @@ bool Texture::isRepeated() const
 }
 
 
+////////////////////////////////////////////////////////////
+bool Texture::generateMipmap()
+{
+    if (!m_texture)
+        return false;
+
+    ensureGlContext();
+
+    // Make sure that extensions are initialized
+    priv::ensureExtensionsInit();
+
+    if (!GLEXT_framebuffer_object)
+        return false;
+
+    // Make sure that the current texture binding will be preserved
+    priv::TextureSaver save;
+
+    m_hasMipmap = true;
+
+    glCheck(glBindTexture(GL_TEXTURE_2D, m_texture));
+    glCheck(GLEXT_glGenerateMipmap(GL_TEXTURE_2D));
+    glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, getMinFilter()));
+
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////
+void Texture::setMipmapFilter(bool smooth)
+{
+    if (smooth != m_mipmapSmooth)
+    {
+        m_mipmapSmooth = smooth;
+
+        if (m_texture && m_hasMipmap)
+        {
+            ensureGlContext();
+
+            // Make sure that the current texture binding will be preserved
+            priv::TextureSaver save;
+
+            glCheck(glBindTexture(GL_TEXTURE_2D, m_texture));
+            glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, getMinFilter()));
+        }
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+bool Texture::isMipmapFilterSmooth() const
+{
+    return m_mipmapSmooth;
+}
+
+
+////////////////////////////////////////////////////////////
+void Texture::invalidateMipmap()
+{
+    if (!m_hasMipmap)
+        return;
+
+    ensureGlContext();
+
+    // Make sure that the current texture binding will be preserved
+    priv::TextureSaver save;
+
+    m_hasMipmap = false;
+
+    glCheck(glBindTexture(GL_TEXTURE_2D, m_texture));
+    glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, getMinFilter()));
+}
+
+
+////////////////////////////////////////////////////////////
+int Texture::getMinFilter() const
+{
+    if (!m_hasMipmap)
+        return m_isSmooth ? GL_LINEAR : GL_NEAREST;
+
+    if (m_isSmooth)
+        return m_mipmapSmooth ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR_MIPMAP_NEAREST;
+    else
+        return m_mipmapSmooth ? GL_NEAREST_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST;
+}
+
+
 ////////////////////////////////////////////////////////////
 void Texture::bind(const Texture* texture, CoordinateType coordinateType)
 {
@@ -542,6 +823,15 @@ unsigned int Texture::getMaximumSize()
 }
 
 
+////////////////////////////////////////////////////////////
+Uint64 Texture::getUploadedBytes()
+{
+    Lock lock(mutex);
+
+    return uploadedBytes;
+}
+
+
 ////////////////////////////////////////////////////////////
 Texture& Texture::operator =(const Texture& right)
 {
@@ -549,9 +839,13 @@ Texture& Texture::operator =(const Texture& right)
 
     std::swap(m_size,          temp.m_size);
     std::swap(m_actualSize,    temp.m_actualSize);
+    std::swap(m_format,        temp.m_format);
     std::swap(m_texture,       temp.m_texture);
+    std::swap(m_shadow,        temp.m_shadow);
     std::swap(m_isSmooth,      temp.m_isSmooth);
     std::swap(m_isRepeated,    temp.m_isRepeated);
+    std::swap(m_hasMipmap,     temp.m_hasMipmap);
+    std::swap(m_mipmapSmooth,  temp.m_mipmapSmooth);
     std::swap(m_pixelsFlipped, temp.m_pixelsFlipped);
     m_cacheId = getUniqueId();
 
@@ -559,6 +853,87 @@ Texture& Texture::operator =(const Texture& right)
 }
 
 
+////////////////////////////////////////////////////////////
+void Texture::updateShadow(const Uint8* pixels, unsigned int width, unsigned int height, unsigned int pitch, unsigned int x, unsigned int y) const
+{
+    if (m_shadow.empty())
+        return;
+
+    for (unsigned int row = 0; row < height; ++row)
+    {
+        const Uint8* src = pixels + row * pitch * 4;
+        Uint8* dst = &m_shadow[(x + (y + row) * m_actualSize.x) * 4];
+        for (unsigned int i = 0; i < width; ++i, src += 4, dst += 4)
+        {
+            // Drop the bits the format can't store, and fill the
+            // channels it doesn't have like the GPU does
+            switch (m_format)
+            {
+                case RGB565:
+                    dst[0] = (src[0] & 0xF8) | (src[0] >> 5);
+                    dst[1] = (src[1] & 0xFC) | (src[1] >> 6);
+                    dst[2] = (src[2] & 0xF8) | (src[2] >> 5);
+                    dst[3] = 255;
+                    break;
+                case RGBA5551:
+                    dst[0] = (src[0] & 0xF8) | (src[0] >> 5);
+                    dst[1] = (src[1] & 0xF8) | (src[1] >> 5);
+                    dst[2] = (src[2] & 0xF8) | (src[2] >> 5);
+                    dst[3] = (src[3] & 0x80) ? 255 : 0;
+                    break;
+                case RGBA4:
+                    dst[0] = (src[0] & 0xF0) | (src[0] >> 4);
+                    dst[1] = (src[1] & 0xF0) | (src[1] >> 4);
+                    dst[2] = (src[2] & 0xF0) | (src[2] >> 4);
+                    dst[3] = (src[3] & 0xF0) | (src[3] >> 4);
+                    break;
+                case LA8:
+                    dst[0] = dst[1] = dst[2] = luminance(src);
+                    dst[3] = src[3];
+                    break;
+                case L8:
+                    dst[0] = dst[1] = dst[2] = luminance(src);
+                    dst[3] = 255;
+                    break;
+                case A8:
+                    dst[0] = dst[1] = dst[2] = 255;
+                    dst[3] = src[3];
+                    break;
+                default:
+                    dst[0] = src[0];
+                    dst[1] = src[1];
+                    dst[2] = src[2];
+                    dst[3] = src[3];
+                    break;
+            }
+        }
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+bool Texture::loadShadow() const
+{
+    if (!m_shadow.empty())
+        return true;
+    if (!m_texture || (m_size.x == 0) || (m_size.y == 0))
+        return false;
+
+    // The pixels read back are already at the precision of the format,
+    // but OpenGL returns the luminance in the red channel only
+    Image image = copyToImage();
+    std::vector<Uint8> pixels(image.getPixelsPtr(), image.getPixelsPtr() + m_size.x * m_size.y * 4);
+    if ((m_format == L8) || (m_format == LA8))
+        for (std::size_t i = 0; i < pixels.size(); i += 4)
+            pixels[i + 1] = pixels[i + 2] = pixels[i];
+
+    m_shadow.assign(m_actualSize.x * m_actualSize.y * 4, 0);
+    updateShadow(&pixels[0], m_size.x, m_size.y, m_size.x, 0, 0);
+
+    return true;
+}
+
+
 ////////////////////////////////////////////////////////////
 unsigned int Texture::getValidSize(unsigned int size)
 {
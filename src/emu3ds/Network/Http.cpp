@@ -27,6 +27,7 @@
 ////////////////////////////////////////////////////////////
 #include <cpp3ds/Network/Http.hpp>
 #include <cpp3ds/System/Err.hpp>
+#include <cpp3ds/System/Trace.hpp>
 #include <cctype>
 #include <algorithm>
 #include <iterator>
@@ -363,6 +364,8 @@ void Http::setHost(const std::string& host, unsigned short port)
 ////////////////////////////////////////////////////////////
 Http::Response Http::sendRequest(const Http::Request& request, Time timeout, RequestCallback callback, size_t bufferSize)
 {
+    CPP3DS_TRACE_ZONE("Network", "Http::sendRequest");
+
     // First make sure that the request is valid -- add missing mandatory fields
     Request toSend(request);
     if (!toSend.hasField("From"))
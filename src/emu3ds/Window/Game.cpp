@@ -1,8 +1,11 @@
 #include <cpp3ds/OpenGL.hpp>
 #include <cpp3ds/Emulator.hpp>
 #include <cpp3ds/Window/Game.hpp>
+#include <cpp3ds/Graphics/FrameProfiler.hpp>
 #include <cpp3ds/Window/EventManager.hpp>
 #include <cpp3ds/System/Clock.hpp>
+#include <cpp3ds/System/FrameArena.hpp>
+#include <cpp3ds/System/Trace.hpp>
 #include <cpp3ds/Window/Keyboard.hpp>
 #include <cpp3ds/Graphics/Sprite.hpp>
 #include "../Audio/AudioDevice.hpp"
@@ -39,23 +42,62 @@ void Game::exit()
 
 void Game::render()
 {
+	CPP3DS_TRACE_ZONE("Window", "Game::render");
+
+	FrameProfiler& profiler = FrameProfiler::getInstance();
+
 #ifndef TEST
 	_emulator->screen->clear();
 
 	// Top Screen
+	profiler.beginPhase(FrameProfiler::RenderTop);
 	m_frameTextureTop.setActive(true);
 	renderTopScreen(windowTop);
+	if (profiler.isOverlayVisible() && profiler.getOverlayScreen() == TopScreen) {
+		windowTop.setView(windowTop.getDefaultView());
+		windowTop.draw(profiler);
+	}
+	profiler.endPhase(FrameProfiler::RenderTop);
+
+	profiler.beginPhase(FrameProfiler::Flush);
+	windowTop.flush();
+	profiler.endPhase(FrameProfiler::Flush);
+
+	profiler.beginPhase(FrameProfiler::Transfer);
 	m_frameTextureTop.display();
 	m_frameSpriteTop.setTexture(m_frameTextureTop.getTexture());
 	_emulator->screen->draw(m_frameSpriteTop);
+	profiler.endPhase(FrameProfiler::Transfer);
 
 	// Bottom Screen
+	profiler.beginPhase(FrameProfiler::RenderBottom);
 	m_frameTextureBottom.setActive(true);
 	renderBottomScreen(windowBottom);
+	if (profiler.isOverlayVisible() && profiler.getOverlayScreen() == BottomScreen) {
+		windowBottom.setView(windowBottom.getDefaultView());
+		windowBottom.draw(profiler);
+	}
+	profiler.endPhase(FrameProfiler::RenderBottom);
+
+	profiler.beginPhase(FrameProfiler::Flush);
+	windowBottom.flush();
+	profiler.endPhase(FrameProfiler::Flush);
+
+	profiler.beginPhase(FrameProfiler::Transfer);
 	m_frameTextureBottom.display();
 	m_frameSpriteBottom.setTexture(m_frameTextureBottom.getTexture());
 	_emulator->screen->draw(m_frameSpriteBottom);
+	profiler.endPhase(FrameProfiler::Transfer);
 #endif
+
+	FrameArena::reset();
+
+	if (profiler.isEnabled()) {
+		profiler.addStatistics(windowTop.getStatistics());
+		profiler.addStatistics(windowBottom.getStatistics());
+		windowTop.resetStatistics();
+		windowBottom.resetStatistics();
+	}
 }
 
 
@@ -70,23 +112,39 @@ void Game::run()
 	_emulator->screen->setFramerateLimit(60);
 #endif
 
+	FrameProfiler& profiler = FrameProfiler::getInstance();
+	CPP3DS_TRACE_THREAD("Main");
+
 	while (windowTop.isOpen())
 	{
+		profiler.beginFrame();
+
+		profiler.beginPhase(FrameProfiler::Events);
 		while (eventmanager.pollEvent(event)) {
 			processEvent(event);
 		}
+		profiler.endPhase(FrameProfiler::Events);
 		deltaTime = clock.restart();
 
 		if (m_triggerExit)
 			break;
 
+		profiler.beginPhase(FrameProfiler::Update);
 		Keyboard::update();
 		update(deltaTime.asSeconds());
+		profiler.endPhase(FrameProfiler::Update);
 
 		render();
 
 #ifndef TEST
+		// The frame rate limit waits here, like the console waits for the vertical blank
+		profiler.beginPhase(FrameProfiler::VBlank);
 		_emulator->screen->display();
+		profiler.endPhase(FrameProfiler::VBlank);
+#endif
+		profiler.endFrame();
+
+#ifndef TEST
 		// TODO: pause non-drawing services (sound, networking, etc.)
 		if (_emulator->getState() == EMU_PAUSED){
 			priv::AudioDevice::suspend();
@@ -132,7 +132,8 @@ bool Window::setActive(bool active) const
 ////////////////////////////////////////////////////////////
 void Window::display()
 {
-
+	// Submit the primitives still waiting in the batch
+	flush();
 }
 
 
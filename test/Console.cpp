@@ -0,0 +1,160 @@
+#include "gtest/gtest.h"
+#include "TestHelpers.hpp"
+#include <cpp3ds/Graphics/Console.hpp>
+#include <cpp3ds/Graphics/SoftwareRenderTexture.hpp>
+#include <cpp3ds/Graphics/Text.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using cpp3ds::Console;
+
+namespace
+{
+	// Size of the console's characters and of its screen
+	const unsigned int characterSize = 10;
+	const unsigned int screenWidth   = 400;
+	const unsigned int screenHeight  = 240;
+
+	// Get the console, with a screen of empty lines
+	Console& getEmptyConsole()
+	{
+		Console::enable(cpp3ds::TopScreen);
+		Console& console = Console::getInstance();
+		console.write(std::string(100, '\n'));
+		console.update(0.f);
+		return console;
+	}
+
+	// Draw what the console shows
+	cpp3ds::Image renderConsole(Console& console)
+	{
+		cpp3ds::SoftwareRenderTexture target;
+		target.create(screenWidth, screenHeight);
+		target.clear(cpp3ds::Color::Black);
+		target.draw(console);
+		return target.getImage();
+	}
+
+	// Draw lines as the console should show them, the last one at the bottom of the screen
+	cpp3ds::Image renderLines(const std::vector<cpp3ds::String>& lines)
+	{
+		cpp3ds::Font font;
+		test::loadFont(font);
+		float lineSpacing = font.getLineSpacing(characterSize);
+
+		cpp3ds::SoftwareRenderTexture target;
+		target.create(screenWidth, screenHeight);
+		target.clear(cpp3ds::Color::Black);
+		for (std::size_t i = 0; i < lines.size(); ++i)
+		{
+			float y = screenHeight - (lines.size() - i) * lineSpacing;
+			if (y + lineSpacing < 0)
+				continue;
+
+			cpp3ds::Text text(lines[i], font, characterSize);
+			text.setPosition(0.f, y);
+			target.draw(text);
+		}
+		return target.getImage();
+	}
+
+	// Compare the console with the lines it should show
+	void expectShows(Console& console, const std::vector<cpp3ds::String>& lines)
+	{
+		cpp3ds::Image expected = renderLines(lines);
+		EXPECT_EQ(0u, test::countDifferences(expected, renderConsole(console)));
+
+		// The lines must be visible for the comparison to mean anything
+		EXPECT_GT(test::countDifferences(expected, renderLines(std::vector<cpp3ds::String>())), 0u);
+	}
+
+	std::string numberedLine(unsigned int number)
+	{
+		std::ostringstream line;
+		line << "Line " << number << " of the console";
+		return line.str();
+	}
+}
+
+TEST(Console, ContinuedLineIsLaidOutAgain){
+	Console& console = getEmptyConsole();
+	std::vector<cpp3ds::String> lines;
+
+	console.write("First");
+	console.update(0.f);
+	lines.push_back("First");
+	expectShows(console, lines);
+
+	// Both the laid out line and the next one are continued
+	console.write(" line\nSecond");
+	console.update(0.f);
+	console.write(" line");
+	console.write(" ends\n");
+	console.update(0.f);
+	lines.back() = "First line";
+	lines.push_back("Second line ends");
+	expectShows(console, lines);
+
+	console.write("Third\n");
+	console.update(0.f);
+	lines.push_back("Third");
+	expectShows(console, lines);
+}
+
+TEST(Console, ScreenfulInOneFrame){
+	Console& console = getEmptyConsole();
+	std::vector<cpp3ds::String> lines;
+
+	console.write("Kept on screen\n");
+	console.update(0.f);
+	lines.push_back("Kept on screen");
+
+	std::string text;
+	for (unsigned int i = 0; i < 60; ++i)
+	{
+		text += numberedLine(i) + "\n";
+		lines.push_back(numberedLine(i));
+	}
+	console.write(text);
+	console.update(0.f);
+	expectShows(console, lines);
+}
+
+TEST(Console, ScrollingCompactsTheVertices){
+	Console& console = getEmptyConsole();
+	std::vector<cpp3ds::String> lines;
+
+	// One line per frame, scrolling several screens
+	for (unsigned int i = 0; i < 80; ++i)
+	{
+		console.write(numberedLine(i) + "\n");
+		console.update(0.f);
+		lines.push_back(numberedLine(i));
+		if (i % 7 == 0)
+			expectShows(console, lines);
+	}
+	expectShows(console, lines);
+}
+
+TEST(Console, RingBufferKeepsTheLastLines){
+	Console& console = getEmptyConsole();
+	std::vector<cpp3ds::String> lines;
+
+	// Wrap around the 1000 lines kept, then write past the oldest ones
+	std::string text;
+	for (unsigned int i = 0; i < 990; ++i)
+		text += numberedLine(i) + "\n";
+	console.write(text);
+	console.update(0.f);
+
+	for (unsigned int i = 990; i < 1030; ++i)
+	{
+		console.write(numberedLine(i));
+		console.update(0.f);
+		console.write("\n");
+		lines.push_back(numberedLine(i));
+	}
+	console.update(0.f);
+	expectShows(console, lines);
+}
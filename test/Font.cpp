@@ -0,0 +1,262 @@
+#include "gtest/gtest.h"
+#include <cpp3ds/Graphics/Font.hpp>
+#include <cpp3ds/System/Clock.hpp>
+#include <cpp3ds/System/Sleep.hpp>
+#include <cpp3ds/Resources.hpp>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	cpp3ds::priv::ResourceInfo getFontData()
+	{
+		return cpp3ds::priv::core_resources["opensans.ttf"];
+	}
+
+	void write16(std::vector<cpp3ds::Uint8>& data, cpp3ds::Uint32 value)
+	{
+		data.push_back(value & 0xFF);
+		data.push_back((value >> 8) & 0xFF);
+	}
+
+	void writeFloat(std::vector<cpp3ds::Uint8>& data, float value)
+	{
+		cpp3ds::Uint32 bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		write16(data, bits & 0xFFFF);
+		write16(data, bits >> 16);
+	}
+
+	// Baked atlas with a single character size and no glyphs
+	std::vector<cpp3ds::Uint8> bakeMetrics(unsigned int characterSize, float lineSpacing)
+	{
+		std::vector<cpp3ds::Uint8> data;
+		data.insert(data.end(), "C3FB", "C3FB" + 4);
+		write16(data, 1); // Version
+		write16(data, 1); // Sizes
+		write16(data, 0); // Family length
+		write16(data, characterSize);
+		write16(data, 0); // Flags
+		writeFloat(data, lineSpacing);
+		writeFloat(data, 2.f); // Underline position
+		writeFloat(data, 1.f); // Underline thickness
+		write16(data, 0); // Pages
+		write16(data, 0); write16(data, 0); // Glyphs
+		write16(data, 0); write16(data, 0); // Kerning pairs
+		return data;
+	}
+}
+
+TEST(Font, SameBufferSharesGlyphs){
+	cpp3ds::priv::ResourceInfo info = getFontData();
+	cpp3ds::Font first, second;
+	ASSERT_TRUE(first.loadFromMemory(info.data, info.size));
+	ASSERT_TRUE(second.loadFromMemory(info.data, info.size));
+
+	const cpp3ds::Glyph& glyph = first.getGlyph('A', 20, false);
+	EXPECT_EQ(1u, second.getPageCount(20));
+	EXPECT_EQ(first.getMemoryUsage(), second.getMemoryUsage());
+	EXPECT_EQ(&glyph, &second.getGlyph('A', 20, false));
+	EXPECT_EQ(first.getInfo().family, second.getInfo().family);
+}
+
+TEST(Font, SharedFaceOutlivesFirstFont){
+	cpp3ds::priv::ResourceInfo info = getFontData();
+	cpp3ds::Font second;
+	float advance;
+	{
+		cpp3ds::Font first;
+		ASSERT_TRUE(first.loadFromMemory(info.data, info.size));
+		ASSERT_TRUE(second.loadFromMemory(info.data, info.size));
+		advance = first.getGlyph('W', 16, false).advance;
+	}
+
+	EXPECT_EQ(advance, second.getGlyph('W', 16, false).advance);
+	EXPECT_GT(second.getGlyph('x', 16, false).advance, 0.f);
+	EXPECT_GT(second.getLineSpacing(16), 0.f);
+}
+
+TEST(Font, BakedGlyphsAreNotSharedWithTheFace){
+	cpp3ds::priv::ResourceInfo info = getFontData();
+	cpp3ds::Font first, second;
+	ASSERT_TRUE(first.loadFromMemory(info.data, info.size));
+	ASSERT_TRUE(second.loadFromMemory(info.data, info.size));
+	float lineSpacing = second.getLineSpacing(16);
+
+	std::vector<cpp3ds::Uint8> baked = bakeMetrics(16, 100.f);
+	ASSERT_TRUE(first.loadFromBakedAtlas(&baked[0], baked.size()));
+	EXPECT_EQ(100.f, first.getLineSpacing(16));
+	EXPECT_EQ(lineSpacing, second.getLineSpacing(16));
+
+	// Copies get the baked glyphs, fonts loaded afterwards don't
+	cpp3ds::Font copy(first), third;
+	ASSERT_TRUE(third.loadFromMemory(info.data, info.size));
+	EXPECT_EQ(100.f, copy.getLineSpacing(16));
+	EXPECT_EQ(lineSpacing, third.getLineSpacing(16));
+}
+
+TEST(Font, OtherBufferHasItsOwnGlyphs){
+	cpp3ds::priv::ResourceInfo info = getFontData();
+	std::vector<cpp3ds::Uint8> copy(info.data, info.data + info.size);
+
+	cpp3ds::Font first, second;
+	ASSERT_TRUE(first.loadFromMemory(info.data, info.size));
+	ASSERT_TRUE(second.loadFromMemory(&copy[0], copy.size()));
+
+	first.getGlyph('A', 20, false);
+	EXPECT_EQ(0u, second.getPageCount(20));
+	EXPECT_EQ(first.getGlyph('A', 20, false).advance, second.getGlyph('A', 20, false).advance);
+}
+
+TEST(Font, DistanceFieldGlyphsHaveTheirOwnAtlas){
+	cpp3ds::priv::ResourceInfo info = getFontData();
+	cpp3ds::Font font;
+	ASSERT_TRUE(font.loadFromMemory(info.data, info.size));
+
+	const cpp3ds::Glyph& glyph = font.getDistanceFieldGlyph('A', false);
+	EXPECT_EQ(0u, font.getPageCount(cpp3ds::Font::DistanceFieldSize));
+	EXPECT_EQ(&glyph, &font.getDistanceFieldGlyph('A', false));
+
+	// Same metrics as the regular glyph, with the margin of the field around it
+	const cpp3ds::Glyph& regular = font.getGlyph('A', cpp3ds::Font::DistanceFieldSize, false);
+	float margin = 2.f * cpp3ds::Font::DistanceFieldSpread;
+	EXPECT_NEAR(regular.advance, glyph.advance, 1.f);
+	EXPECT_NEAR(regular.bounds.width + margin, glyph.bounds.width, 2.f);
+	EXPECT_NEAR(regular.bounds.height + margin, glyph.bounds.height, 2.f);
+}
+
+TEST(Font, FullPageSpillsToANewOne){
+	cpp3ds::priv::ResourceInfo info = getFontData();
+	cpp3ds::Font font;
+	ASSERT_TRUE(font.loadFromMemory(info.data, info.size));
+
+	// Glyphs big enough to fill a page several times
+	const unsigned int characterSize = 100;
+	std::vector<cpp3ds::Glyph> glyphs;
+	for (cpp3ds::Uint32 c = 'A'; c <= 'Z'; ++c)
+		glyphs.push_back(font.getGlyph(c, characterSize, false));
+	for (cpp3ds::Uint32 c = 'a'; c <= 'z'; ++c)
+		glyphs.push_back(font.getGlyph(c, characterSize, false));
+	ASSERT_GT(font.getPageCount(characterSize), 1u);
+
+	for (std::size_t i = 0; i < glyphs.size(); ++i)
+	{
+		const cpp3ds::IntRect& rect = glyphs[i].textureRect;
+		ASSERT_LT(glyphs[i].page, font.getPageCount(characterSize));
+		cpp3ds::Vector2u pageSize = font.getTexture(characterSize, glyphs[i].page).getSize();
+		EXPECT_GE(rect.left, 0);
+		EXPECT_GE(rect.top, 0);
+		EXPECT_LE(static_cast<unsigned int>(rect.left + rect.width), pageSize.x);
+		EXPECT_LE(static_cast<unsigned int>(rect.top + rect.height), pageSize.y);
+
+		for (std::size_t j = 0; j < i; ++j)
+			if (glyphs[j].page == glyphs[i].page)
+				EXPECT_FALSE(rect.intersects(glyphs[j].textureRect)) << "Glyphs " << i << " and " << j << " overlap";
+	}
+}
+
+TEST(Font, PreloadedGlyphsArePublished){
+	cpp3ds::priv::ResourceInfo info = getFontData();
+	cpp3ds::Font font;
+	ASSERT_TRUE(font.loadFromMemory(info.data, info.size));
+
+	const unsigned int characterSize = 24;
+	cpp3ds::String characters = "The quick brown fox jumps over the lazy dog 0123456789";
+	font.preloadGlyphsAsync(characters, characterSize);
+
+	unsigned int published = 0;
+	cpp3ds::Clock clock;
+	while (font.isPreloading() && (clock.getElapsedTime() < cpp3ds::seconds(10)))
+	{
+		published += font.publishPreloadedGlyphs();
+		cpp3ds::sleep(cpp3ds::milliseconds(1));
+	}
+	ASSERT_FALSE(font.isPreloading());
+	EXPECT_GT(published, 0u);
+
+	// Getting the glyphs now must not rasterize them again
+	unsigned int pageCount = font.getPageCount(characterSize);
+	std::size_t memoryUsage = font.getMemoryUsage();
+	std::vector<cpp3ds::Image> pages;
+	for (unsigned int i = 0; i < pageCount; ++i)
+		pages.push_back(font.getTexture(characterSize, i).copyToImage());
+
+	std::vector<cpp3ds::Glyph> glyphs;
+	for (std::size_t i = 0; i < characters.getSize(); ++i)
+		glyphs.push_back(font.getGlyph(characters[i], characterSize, false));
+
+	EXPECT_EQ(pageCount, font.getPageCount(characterSize));
+	EXPECT_EQ(memoryUsage, font.getMemoryUsage());
+	for (unsigned int i = 0; i < pageCount; ++i)
+	{
+		cpp3ds::Image page = font.getTexture(characterSize, i).copyToImage();
+		ASSERT_EQ(pages[i].getSize(), page.getSize());
+		EXPECT_TRUE(std::equal(page.getPixelsPtr(), page.getPixelsPtr() + page.getSize().x * page.getSize().y * 4, pages[i].getPixelsPtr()));
+	}
+
+	// The published glyphs stay where they are, with the metrics
+	// of glyphs loaded one by one by another font
+	std::vector<cpp3ds::Uint8> copy(info.data, info.data + info.size);
+	cpp3ds::Font other;
+	ASSERT_TRUE(other.loadFromMemory(&copy[0], copy.size()));
+	for (std::size_t i = 0; i < characters.getSize(); ++i)
+	{
+		const cpp3ds::Glyph& glyph = font.getGlyph(characters[i], characterSize, false);
+		EXPECT_EQ(glyphs[i].textureRect, glyph.textureRect);
+		EXPECT_EQ(glyphs[i].page, glyph.page);
+		EXPECT_EQ(other.getGlyph(characters[i], characterSize, false).bounds, glyph.bounds);
+		EXPECT_EQ(other.getGlyph(characters[i], characterSize, false).advance, glyph.advance);
+	}
+}
+
+TEST(Font, AlternatingSizesKeepTheirMetrics){
+	cpp3ds::priv::ResourceInfo info = getFontData();
+	std::vector<cpp3ds::Uint8> copy(info.data, info.data + info.size);
+	cpp3ds::Font alternating, oneByOne;
+	ASSERT_TRUE(alternating.loadFromMemory(info.data, info.size));
+	ASSERT_TRUE(oneByOne.loadFromMemory(&copy[0], copy.size()));
+
+	const unsigned int small = 12, large = 30;
+	cpp3ds::String characters = "AVWaegjx";
+
+	// Each size at once with one font, switching at every glyph with the other
+	std::vector<cpp3ds::Glyph> smallGlyphs, largeGlyphs;
+	for (std::size_t i = 0; i < characters.getSize(); ++i)
+		smallGlyphs.push_back(oneByOne.getGlyph(characters[i], small, false));
+	float smallSpacing = oneByOne.getLineSpacing(small);
+	for (std::size_t i = 0; i < characters.getSize(); ++i)
+		largeGlyphs.push_back(oneByOne.getGlyph(characters[i], large, false));
+	float largeSpacing = oneByOne.getLineSpacing(large);
+
+	for (std::size_t i = 0; i < characters.getSize(); ++i)
+	{
+		const cpp3ds::Glyph& smallGlyph = alternating.getGlyph(characters[i], small, false);
+		EXPECT_EQ(smallGlyphs[i].advance, smallGlyph.advance);
+		EXPECT_EQ(smallGlyphs[i].bounds, smallGlyph.bounds);
+		EXPECT_EQ(smallSpacing, alternating.getLineSpacing(small));
+
+		const cpp3ds::Glyph& largeGlyph = alternating.getGlyph(characters[i], large, false);
+		EXPECT_EQ(largeGlyphs[i].advance, largeGlyph.advance);
+		EXPECT_EQ(largeGlyphs[i].bounds, largeGlyph.bounds);
+		EXPECT_EQ(largeSpacing, alternating.getLineSpacing(large));
+	}
+	EXPECT_LT(smallGlyphs[0].advance, largeGlyphs[0].advance);
+}
+
+TEST(Font, CachedKerningMatchesTheFace){
+	cpp3ds::priv::ResourceInfo info = getFontData();
+	std::vector<cpp3ds::Uint8> copy(info.data, info.data + info.size);
+	cpp3ds::Font font, other;
+	ASSERT_TRUE(font.loadFromMemory(info.data, info.size));
+	ASSERT_TRUE(other.loadFromMemory(&copy[0], copy.size()));
+
+	float kerning = font.getKerning('A', 'V', 20);
+	EXPECT_NE(0.f, kerning);
+
+	// Cached after the first call, at this size only
+	EXPECT_EQ(kerning, font.getKerning('A', 'V', 20));
+	EXPECT_EQ(kerning, other.getKerning('A', 'V', 20));
+	EXPECT_EQ(other.getKerning('A', 'V', 40), font.getKerning('A', 'V', 40));
+	EXPECT_NE(kerning, font.getKerning('A', 'V', 40));
+}
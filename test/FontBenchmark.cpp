@@ -0,0 +1,73 @@
+#include "gtest/gtest.h"
+#include "TestHelpers.hpp"
+#include <cpp3ds/Graphics/Font.hpp>
+#include <cpp3ds/System/Clock.hpp>
+#include <iostream>
+
+namespace
+{
+	const unsigned int characterSize = 20;
+
+	// Advance the pen over a paragraph like Text does, returning its width
+	float layout(const cpp3ds::Font& font, const cpp3ds::String& string)
+	{
+		float x = 0.f;
+		cpp3ds::Uint32 previous = 0;
+		for (std::size_t i = 0; i < string.getSize(); ++i)
+		{
+			cpp3ds::Uint32 current = string[i];
+			x += font.getKerning(previous, current, characterSize);
+			x += font.getGlyph(current, characterSize, false).advance;
+			previous = current;
+		}
+		return x;
+	}
+
+	// Lay the paragraph out until enough time has passed, and report glyphs/s
+	double measure(const cpp3ds::Font& font, const cpp3ds::String& string, const char* name)
+	{
+		// Warm-up, so that only lookups are measured, not rasterization
+		float width = layout(font, string);
+
+		std::size_t glyphs = 0;
+		cpp3ds::Clock clock;
+		while (clock.getElapsedTime() < cpp3ds::milliseconds(200))
+		{
+			EXPECT_EQ(width, layout(font, string));
+			glyphs += string.getSize();
+		}
+
+		double rate = glyphs / clock.getElapsedTime().asSeconds();
+		std::cout << "[ BENCHMARK] " << name << ": " << static_cast<cpp3ds::Uint64>(rate) << " glyphs/s" << std::endl;
+		return rate;
+	}
+}
+
+TEST(FontBenchmark, Latin1Paragraph){
+	cpp3ds::Font font;
+	ASSERT_TRUE(test::loadFont(font));
+
+	cpp3ds::String sentence = L"Voix ambiguë d'un cœur qui, au zéphyr, préfère les jattes de kiwis. ";
+	cpp3ds::String paragraph;
+	for (int i = 0; i < 64; ++i)
+		paragraph += sentence;
+
+	EXPECT_GT(measure(font, paragraph, "Latin-1"), 0.0);
+}
+
+TEST(FontBenchmark, CJKParagraph){
+	cpp3ds::Font font;
+	ASSERT_TRUE(test::loadFont(font));
+
+	// Walk the CJK block with a stride, so that ~1000 distinct
+	// code points are spread over the paragraph like in real text
+	cpp3ds::String paragraph;
+	cpp3ds::Uint32 index = 0;
+	for (int i = 0; i < 4096; ++i)
+	{
+		index = (index * 97 + 13) % 1024;
+		paragraph += static_cast<cpp3ds::Uint32>(0x4E00 + index);
+	}
+
+	EXPECT_GT(measure(font, paragraph, "CJK"), 0.0);
+}
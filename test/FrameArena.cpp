@@ -0,0 +1,68 @@
+#include "gtest/gtest.h"
+#include <cpp3ds/System/FrameArena.hpp>
+#include <cstdint>
+
+namespace
+{
+	bool isAligned(const void* block)
+	{
+		return reinterpret_cast<std::uintptr_t>(block) % 16 == 0;
+	}
+}
+
+TEST(FrameArena, AlignsBlocks){
+	cpp3ds::FrameArena::reset();
+	void* first = cpp3ds::FrameArena::allocate(1);
+	void* second = cpp3ds::FrameArena::allocate(3);
+	ASSERT_NE(nullptr, first);
+	ASSERT_NE(nullptr, second);
+	EXPECT_TRUE(isAligned(first));
+	EXPECT_TRUE(isAligned(second));
+	EXPECT_EQ(16, static_cast<char*>(second) - static_cast<char*>(first));
+	EXPECT_EQ(32u, cpp3ds::FrameArena::getSize());
+
+	cpp3ds::FrameArena::setCapacity(100);
+	EXPECT_EQ(112u, cpp3ds::FrameArena::getCapacity());
+	cpp3ds::FrameArena::setCapacity(256 * 1024);
+	cpp3ds::FrameArena::reset();
+}
+
+TEST(FrameArena, OverflowsWhenFull){
+	std::size_t capacity = cpp3ds::FrameArena::getCapacity();
+	cpp3ds::FrameArena::reset();
+	cpp3ds::FrameArena::setCapacity(64);
+	cpp3ds::FrameArena::resetHighWaterMark();
+
+	// Blocks that don't fit are allocated separately
+	char* inside = static_cast<char*>(cpp3ds::FrameArena::allocate(48));
+	char* outside = static_cast<char*>(cpp3ds::FrameArena::allocate(32));
+	ASSERT_NE(nullptr, inside);
+	ASSERT_NE(nullptr, outside);
+	EXPECT_TRUE(isAligned(outside));
+	EXPECT_TRUE((outside < inside) || (outside >= inside + 64));
+	EXPECT_EQ(80u, cpp3ds::FrameArena::getSize());
+	EXPECT_EQ(80u, cpp3ds::FrameArena::getHighWaterMark());
+
+	// Sizes that can't be allocated at all fail without changing the arena
+	EXPECT_EQ(nullptr, cpp3ds::FrameArena::allocate(static_cast<std::size_t>(-1)));
+	EXPECT_EQ(80u, cpp3ds::FrameArena::getSize());
+
+	cpp3ds::FrameArena::reset();
+	cpp3ds::FrameArena::setCapacity(capacity);
+}
+
+TEST(FrameArena, ResetReusesTheArena){
+	cpp3ds::FrameArena::reset();
+	void* first = cpp3ds::FrameArena::allocate(100);
+	cpp3ds::FrameArena::allocate(200);
+	EXPECT_EQ(320u, cpp3ds::FrameArena::getSize());
+
+	cpp3ds::FrameArena::reset();
+	EXPECT_EQ(0u, cpp3ds::FrameArena::getSize());
+	EXPECT_GE(cpp3ds::FrameArena::getHighWaterMark(), 320u);
+	EXPECT_EQ(first, cpp3ds::FrameArena::allocate(16));
+
+	cpp3ds::FrameArena::resetHighWaterMark();
+	EXPECT_EQ(16u, cpp3ds::FrameArena::getHighWaterMark());
+	cpp3ds::FrameArena::reset();
+}
@@ -0,0 +1,51 @@
+#include "gtest/gtest.h"
+#include <cpp3ds/Graphics/FrameProfiler.hpp>
+#include <cpp3ds/System/Sleep.hpp>
+
+TEST(FrameProfiler, SummarizesTheLastFrames){
+	cpp3ds::FrameProfiler& profiler = cpp3ds::FrameProfiler::getInstance();
+	profiler.setEnabled(true);
+	profiler.setHistorySize(4);
+
+	for (cpp3ds::Uint32 i = 0; i < 6; ++i)
+	{
+		profiler.beginFrame();
+		profiler.beginPhase(cpp3ds::FrameProfiler::Update);
+		cpp3ds::sleep(cpp3ds::milliseconds(2));
+		profiler.endPhase(cpp3ds::FrameProfiler::Update);
+
+		// Both screens add their statistics
+		cpp3ds::RenderTarget::Statistics statistics;
+		statistics.drawCalls = i;
+		profiler.addStatistics(statistics);
+		profiler.addStatistics(statistics);
+		profiler.endFrame();
+	}
+	profiler.setEnabled(false);
+
+	// Only the last 4 frames are kept
+	EXPECT_EQ(4u, profiler.getFrameCount());
+	cpp3ds::FrameProfiler::Summary draws = profiler.getCounterSummary(cpp3ds::FrameProfiler::DrawCalls);
+	EXPECT_EQ(4.f, draws.min);
+	EXPECT_EQ(7.f, draws.average);
+	EXPECT_EQ(10.f, draws.max);
+
+	cpp3ds::FrameProfiler::Summary update = profiler.getPhaseSummary(cpp3ds::FrameProfiler::Update);
+	EXPECT_GE(update.min, 1.9f);
+	EXPECT_LE(update.max, profiler.getFrameSummary().max);
+	EXPECT_EQ(0.f, profiler.getPhaseSummary(cpp3ds::FrameProfiler::VBlank).max);
+}
+
+TEST(FrameProfiler, DisabledRecordsNothing){
+	cpp3ds::FrameProfiler& profiler = cpp3ds::FrameProfiler::getInstance();
+	profiler.setHistorySize(4);
+	ASSERT_FALSE(profiler.isEnabled());
+
+	profiler.beginFrame();
+	profiler.beginPhase(cpp3ds::FrameProfiler::Events);
+	profiler.endPhase(cpp3ds::FrameProfiler::Events);
+	profiler.endFrame();
+
+	EXPECT_EQ(0u, profiler.getFrameCount());
+	EXPECT_EQ(0.f, profiler.getFrameSummary().max);
+}
@@ -0,0 +1,55 @@
+#include "gtest/gtest.h"
+#include <cpp3ds/System/HashTable.hpp>
+
+typedef cpp3ds::HashTable<cpp3ds::Uint64, int> Table;
+
+TEST(HashTable, FindsInsertedKeys){
+	Table table;
+	EXPECT_EQ(nullptr, table.find(42));
+	EXPECT_EQ(0u, table.getCapacity());
+
+	// Keys differing only in their high bits, like packed code point pairs
+	for (cpp3ds::Uint64 i = 0; i < 1000; ++i)
+		table.insert(i << 32, static_cast<int>(i));
+
+	EXPECT_EQ(1000u, table.getSize());
+	for (cpp3ds::Uint64 i = 0; i < 1000; ++i)
+	{
+		const int* value = table.find(i << 32);
+		ASSERT_NE(nullptr, value);
+		EXPECT_EQ(static_cast<int>(i), *value);
+	}
+	EXPECT_EQ(nullptr, table.find(1));
+	EXPECT_EQ(nullptr, table.find(1000ULL << 32));
+}
+
+TEST(HashTable, ReplacesValues){
+	Table table;
+	table.insert(7, 1);
+	table.insert(7, 2);
+	EXPECT_EQ(1u, table.getSize());
+	EXPECT_EQ(2, *table.find(7));
+
+	*table.find(7) = 3;
+	EXPECT_EQ(3, *table.find(7));
+}
+
+TEST(HashTable, StaysHalfEmpty){
+	Table table;
+	table.reserve(100);
+	std::size_t capacity = table.getCapacity();
+	EXPECT_GE(capacity, 200u);
+
+	for (int i = 0; i < 100; ++i)
+		table.insert(i, i);
+	EXPECT_EQ(capacity, table.getCapacity());
+
+	table.insert(100, 100);
+	for (int i = 0; i <= 100; ++i)
+		EXPECT_EQ(i, *table.find(i));
+	EXPECT_LE(table.getSize() * 2, table.getCapacity());
+
+	table.clear();
+	EXPECT_EQ(0u, table.getSize());
+	EXPECT_EQ(nullptr, table.find(5));
+}
@@ -0,0 +1,89 @@
+#include "gtest/gtest.h"
+#include <cpp3ds/System/ResourceCache.hpp>
+
+namespace
+{
+	// Resource whose size is given by its filename
+	struct FakeResource
+	{
+		bool loadFromFile(const std::string& filename)
+		{
+			++loads;
+			size = std::atoi(filename.c_str());
+			return size > 0;
+		}
+
+		std::size_t getMemoryUsage() const
+		{
+			return size;
+		}
+
+		std::size_t size;
+		static int loads;
+	};
+
+	int FakeResource::loads = 0;
+
+	typedef cpp3ds::ResourceCache<FakeResource> Cache;
+}
+
+TEST(ResourceCache, SharesResources){
+	Cache cache;
+	FakeResource::loads = 0;
+
+	Cache::Handle first = cache.get("100");
+	Cache::Handle second = cache.get("100");
+	ASSERT_TRUE(first != nullptr);
+	EXPECT_EQ(first, second);
+	EXPECT_EQ(1, FakeResource::loads);
+	EXPECT_EQ(100u, cache.getMemoryUsage());
+
+	EXPECT_TRUE(cache.get("0") == nullptr);
+	EXPECT_FALSE(cache.contains("0"));
+	EXPECT_EQ(1u, cache.getResourceCount());
+}
+
+TEST(ResourceCache, EvictsLeastRecentlyUsed){
+	Cache cache(350);
+
+	cache.get("100");
+	cache.get("110");
+	cache.get("120");
+	cache.get("100"); // Now the most recently used
+
+	// Only unreferenced resources are evicted, oldest first
+	Cache::Handle big = cache.get("90");
+	EXPECT_TRUE(cache.contains("100"));
+	EXPECT_FALSE(cache.contains("110"));
+	EXPECT_TRUE(cache.contains("120"));
+	EXPECT_TRUE(cache.contains("90"));
+	EXPECT_EQ(310u, cache.getMemoryUsage());
+}
+
+TEST(ResourceCache, KeepsPinnedAndReferenced){
+	Cache cache(100);
+
+	cache.get("80");
+	EXPECT_TRUE(cache.pin("80"));
+	Cache::Handle used = cache.get("70");
+	cache.get("60");
+
+	// A new resource is kept by the call that loads it
+	EXPECT_EQ(3u, cache.getResourceCount());
+
+	// Then only the unused and unpinned resource can be evicted
+	EXPECT_EQ(60u, cache.trim());
+	EXPECT_TRUE(cache.contains("80"));
+	EXPECT_TRUE(cache.contains("70"));
+
+	used.reset();
+	cache.unpin("80");
+	EXPECT_EQ(80u, cache.trim());
+	EXPECT_EQ(1u, cache.getResourceCount());
+	EXPECT_TRUE(cache.contains("70"));
+
+	// Handles outlive their removal from the cache
+	Cache::Handle kept = cache.get("50");
+	cache.clear();
+	EXPECT_EQ(50u, kept->getMemoryUsage());
+}
@@ -0,0 +1,241 @@
+#include "gtest/gtest.h"
+#include <cpp3ds/Graphics/SoftwareRenderTexture.hpp>
+#include <cpp3ds/Graphics/CompactVertexArray.hpp>
+#include <cpp3ds/Graphics/RectangleShape.hpp>
+#include <cpp3ds/Graphics/Sprite.hpp>
+#include <cpp3ds/Graphics/Texture.hpp>
+#include <cpp3ds/Graphics/VertexArray.hpp>
+#include <cpp3ds/System/Clock.hpp>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+	// Count the pixels of an image having a color
+	unsigned int countPixels(const cpp3ds::Image& image, const cpp3ds::Color& color)
+	{
+		unsigned int count = 0;
+		for (unsigned int y = 0; y < image.getSize().y; ++y)
+			for (unsigned int x = 0; x < image.getSize().x; ++x)
+				if (image.getPixel(x, y) == color)
+					++count;
+		return count;
+	}
+}
+
+TEST(SoftwareRenderTexture, FillsPixelCenters){
+	cpp3ds::SoftwareRenderTexture target;
+	ASSERT_TRUE(target.create(8, 8));
+	target.clear(cpp3ds::Color::Black);
+
+	cpp3ds::RectangleShape rectangle(cpp3ds::Vector2f(4.f, 2.f));
+	rectangle.setPosition(2.f, 3.f);
+	rectangle.setFillColor(cpp3ds::Color::Red);
+	target.draw(rectangle);
+
+	const cpp3ds::Image& image = target.getImage();
+	EXPECT_EQ(8u, countPixels(image, cpp3ds::Color::Red));
+	EXPECT_EQ(cpp3ds::Color::Red, image.getPixel(2, 3));
+	EXPECT_EQ(cpp3ds::Color::Red, image.getPixel(5, 4));
+	EXPECT_EQ(cpp3ds::Color::Black, image.getPixel(6, 4));
+	EXPECT_EQ(cpp3ds::Color::Black, image.getPixel(2, 5));
+
+	// Centers on the left edge are covered, centers on the right edge aren't
+	rectangle.setPosition(2.5f, 3.f);
+	rectangle.setFillColor(cpp3ds::Color::Green);
+	target.draw(rectangle);
+	EXPECT_EQ(cpp3ds::Color::Green, target.getImage().getPixel(2, 3));
+	EXPECT_EQ(cpp3ds::Color::Green, target.getImage().getPixel(5, 3));
+	EXPECT_EQ(cpp3ds::Color::Black, target.getImage().getPixel(6, 3));
+}
+
+TEST(SoftwareRenderTexture, SharedEdgesAreDrawnOnce){
+	cpp3ds::SoftwareRenderTexture target;
+	ASSERT_TRUE(target.create(32, 32));
+	target.clear(cpp3ds::Color::Black);
+
+	// A fan of thin triangles around an off-grid center, added on top of each other
+	cpp3ds::VertexArray fan(cpp3ds::TrianglesFan);
+	cpp3ds::Color color(100, 100, 100);
+	fan.append(cpp3ds::Vertex(cpp3ds::Vector2f(16.3f, 15.7f), color));
+	for (int i = 0; i <= 37; ++i)
+	{
+		float angle = i * 2 * 3.14159265f / 37;
+		fan.append(cpp3ds::Vertex(cpp3ds::Vector2f(16.3f + 13.1f * std::cos(angle), 15.7f + 12.9f * std::sin(angle)), color));
+	}
+	target.draw(fan, cpp3ds::BlendAdd);
+
+	const cpp3ds::Image& image = target.getImage();
+	unsigned int covered = countPixels(image, cpp3ds::Color(100, 100, 100));
+	EXPECT_EQ(32u * 32u, covered + countPixels(image, cpp3ds::Color::Black));
+	EXPECT_NEAR(3.14159265f * 13.f * 13.f, covered, 30.f);
+}
+
+TEST(SoftwareRenderTexture, BlendsLikeOpenGL){
+	cpp3ds::SoftwareRenderTexture target;
+	ASSERT_TRUE(target.create(4, 4));
+	cpp3ds::RectangleShape rectangle(cpp3ds::Vector2f(4.f, 4.f));
+	rectangle.setFillColor(cpp3ds::Color(200, 0, 40, 128));
+
+	target.clear(cpp3ds::Color(100, 100, 100));
+	target.draw(rectangle, cpp3ds::BlendAlpha);
+	cpp3ds::Color pixel = target.getImage().getPixel(1, 1);
+	EXPECT_NEAR(200 * 128 / 255.f + 100 * 127 / 255.f, pixel.r, 1.f);
+	EXPECT_NEAR(100 * 127 / 255.f, pixel.g, 1.f);
+	EXPECT_NEAR(40 * 128 / 255.f + 100 * 127 / 255.f, pixel.b, 1.f);
+	EXPECT_EQ(255, pixel.a);
+
+	target.clear(cpp3ds::Color(100, 100, 100));
+	target.draw(rectangle, cpp3ds::BlendMultiply);
+	pixel = target.getImage().getPixel(1, 1);
+	EXPECT_NEAR(200 * 100 / 255.f, pixel.r, 1.f);
+	EXPECT_EQ(0, pixel.g);
+
+	target.clear(cpp3ds::Color(100, 100, 100));
+	target.draw(rectangle, cpp3ds::BlendNone);
+	EXPECT_EQ(rectangle.getFillColor(), target.getImage().getPixel(1, 1));
+}
+
+TEST(SoftwareRenderTexture, FollowsViewAndScissor){
+	cpp3ds::SoftwareRenderTexture target;
+	ASSERT_TRUE(target.create(8, 8));
+	target.clear(cpp3ds::Color::Black);
+
+	// One unit of the view is two pixels
+	target.setView(cpp3ds::View(cpp3ds::FloatRect(0.f, 0.f, 4.f, 4.f)));
+	cpp3ds::RectangleShape rectangle(cpp3ds::Vector2f(1.f, 1.f));
+	rectangle.setPosition(1.f, 1.f);
+	rectangle.setFillColor(cpp3ds::Color::White);
+	target.draw(rectangle);
+	EXPECT_EQ(4u, countPixels(target.getImage(), cpp3ds::Color::White));
+	EXPECT_EQ(cpp3ds::Color::White, target.getImage().getPixel(3, 3));
+
+	// The scissor rect is in pixels
+	target.clear(cpp3ds::Color::Black);
+	target.draw(rectangle, cpp3ds::RenderStates(cpp3ds::UintRect(0, 0, 3, 8)));
+	EXPECT_EQ(2u, countPixels(target.getImage(), cpp3ds::Color::White));
+	EXPECT_EQ(cpp3ds::Color::Black, target.getImage().getPixel(3, 2));
+}
+
+TEST(SoftwareRenderTexture, SamplesTextures){
+	cpp3ds::Image image;
+	image.create(2, 2, cpp3ds::Color::Red);
+	image.setPixel(1, 0, cpp3ds::Color::Green);
+	image.setPixel(0, 1, cpp3ds::Color::Blue);
+	cpp3ds::Texture texture;
+	ASSERT_TRUE(texture.loadFromImage(image));
+
+	cpp3ds::SoftwareRenderTexture target;
+	ASSERT_TRUE(target.create(4, 4));
+	target.clear(cpp3ds::Color::Black);
+
+	cpp3ds::Sprite sprite(texture);
+	sprite.setScale(2.f, 2.f);
+	target.draw(sprite);
+	EXPECT_EQ(cpp3ds::Color::Red, target.getImage().getPixel(1, 1));
+	EXPECT_EQ(cpp3ds::Color::Green, target.getImage().getPixel(2, 1));
+	EXPECT_EQ(cpp3ds::Color::Blue, target.getImage().getPixel(1, 2));
+
+	// The vertex color modulates the texels
+	sprite.setColor(cpp3ds::Color(255, 255, 255, 0));
+	target.draw(sprite, cpp3ds::BlendNone);
+	EXPECT_EQ(cpp3ds::Color(255, 0, 0, 0), target.getImage().getPixel(0, 0));
+
+	// Repeated textures wrap around
+	texture.setRepeated(true);
+	sprite.setColor(cpp3ds::Color::White);
+	sprite.setScale(1.f, 1.f);
+	sprite.setTextureRect(cpp3ds::IntRect(1, 0, 4, 4));
+	target.draw(sprite);
+	EXPECT_EQ(cpp3ds::Color::Green, target.getImage().getPixel(0, 0));
+	EXPECT_EQ(cpp3ds::Color::Red, target.getImage().getPixel(1, 0));
+	EXPECT_EQ(cpp3ds::Color::Green, target.getImage().getPixel(2, 0));
+}
+
+TEST(SoftwareRenderTexture, LuminanceFormatsWeighChannels){
+	cpp3ds::Image image;
+	image.create(1, 1, cpp3ds::Color(255, 0, 0, 128));
+	cpp3ds::Texture texture;
+	ASSERT_TRUE(texture.loadFromImage(image, cpp3ds::IntRect(), cpp3ds::Texture::LA8));
+
+	cpp3ds::SoftwareRenderTexture target;
+	ASSERT_TRUE(target.create(1, 1));
+	target.clear(cpp3ds::Color::Black);
+	target.draw(cpp3ds::Sprite(texture), cpp3ds::BlendNone);
+
+	// Same weights as the hardware converter: (77 * 255) >> 8
+	EXPECT_EQ(cpp3ds::Color(76, 76, 76, 128), target.getImage().getPixel(0, 0));
+}
+
+TEST(SoftwareRenderTexture, CompactVerticesMatchFloatVertices){
+	cpp3ds::Image image;
+	image.create(4, 2, cpp3ds::Color::Red);
+	for (unsigned int y = 0; y < 2; ++y)
+		for (unsigned int x = 2; x < 4; ++x)
+			image.setPixel(x, y, cpp3ds::Color::Green);
+	cpp3ds::Texture texture;
+	ASSERT_TRUE(texture.loadFromImage(image));
+
+	// A row of 2x2 tiles alternating between the two halves of the texture
+	cpp3ds::VertexArray tiles(cpp3ds::Quads);
+	cpp3ds::CompactVertexArray compactTiles(cpp3ds::Quads);
+	for (int i = 0; i < 4; ++i)
+	{
+		const int corners[4][2] = {{0, 0}, {0, 2}, {2, 2}, {2, 0}};
+		for (int j = 0; j < 4; ++j)
+		{
+			cpp3ds::Vector2<cpp3ds::Int16> position(i * 2 + corners[j][0], corners[j][1]);
+			cpp3ds::Vector2<cpp3ds::Int16> texCoords((i % 2) * 2 + corners[j][0], corners[j][1]);
+			compactTiles.append(cpp3ds::CompactVertex(position, cpp3ds::Color(255, 255, 255, 200), texCoords));
+			tiles.append(cpp3ds::Vertex(cpp3ds::Vector2f(position), cpp3ds::Color(255, 255, 255, 200), cpp3ds::Vector2f(texCoords)));
+		}
+	}
+	EXPECT_EQ(cpp3ds::FloatRect(0.f, 0.f, 8.f, 2.f), compactTiles.getBounds());
+
+	cpp3ds::RenderStates states(&texture);
+	states.transform.translate(1.f, 3.f).scale(2.f, 2.f);
+
+	cpp3ds::SoftwareRenderTexture target, compactTarget;
+	ASSERT_TRUE(target.create(20, 8));
+	ASSERT_TRUE(compactTarget.create(20, 8));
+	target.clear(cpp3ds::Color::Black);
+	compactTarget.clear(cpp3ds::Color::Black);
+	target.draw(tiles, states);
+	compactTarget.draw(compactTiles, states);
+
+	const cpp3ds::Image& expected = target.getImage();
+	const cpp3ds::Image& actual = compactTarget.getImage();
+	for (unsigned int y = 0; y < 8; ++y)
+		for (unsigned int x = 0; x < 20; ++x)
+			ASSERT_EQ(expected.getPixel(x, y), actual.getPixel(x, y)) << "at " << x << ", " << y;
+	EXPECT_EQ(cpp3ds::Color(200, 0, 0), actual.getPixel(1, 3));
+	EXPECT_EQ(cpp3ds::Color(0, 200, 0), actual.getPixel(5, 6));
+}
+
+TEST(SoftwareRenderTexture, DrawThroughput){
+	cpp3ds::Image image;
+	image.create(16, 16, cpp3ds::Color(255, 255, 255, 128));
+	cpp3ds::Texture texture;
+	ASSERT_TRUE(texture.loadFromImage(image));
+
+	cpp3ds::SoftwareRenderTexture target;
+	ASSERT_TRUE(target.create(400, 240));
+	cpp3ds::Sprite sprite(texture);
+
+	std::size_t sprites = 0;
+	cpp3ds::Clock clock;
+	while (clock.getElapsedTime() < cpp3ds::milliseconds(200))
+	{
+		target.clear();
+		for (int i = 0; i < 100; ++i)
+		{
+			sprite.setPosition(static_cast<float>(i * 37 % 384), static_cast<float>(i * 23 % 224));
+			target.draw(sprite);
+		}
+		sprites += 100;
+	}
+
+	double rate = sprites / clock.getElapsedTime().asSeconds();
+	std::cout << "[ BENCHMARK] 16x16 alpha-blended sprites: " << static_cast<cpp3ds::Uint64>(rate) << " sprites/s" << std::endl;
+	EXPECT_GT(target.getStatistics().drawCalls, 0u);
+}
@@ -0,0 +1,21 @@
+#include "TestHelpers.hpp"
+#include <cpp3ds/Resources.hpp>
+
+namespace test
+{
+	bool loadFont(cpp3ds::Font& font)
+	{
+		cpp3ds::priv::ResourceInfo info = cpp3ds::priv::core_resources["opensans.ttf"];
+		return font.loadFromMemory(info.data, info.size);
+	}
+
+	unsigned int countDifferences(const cpp3ds::Image& first, const cpp3ds::Image& second)
+	{
+		unsigned int count = 0;
+		for (unsigned int y = 0; y < first.getSize().y; ++y)
+			for (unsigned int x = 0; x < first.getSize().x; ++x)
+				if (first.getPixel(x, y) != second.getPixel(x, y))
+					++count;
+		return count;
+	}
+}
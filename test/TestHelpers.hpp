@@ -0,0 +1,16 @@
+#ifndef CPP3DS_TEST_TESTHELPERS_HPP
+#define CPP3DS_TEST_TESTHELPERS_HPP
+
+#include <cpp3ds/Graphics/Font.hpp>
+#include <cpp3ds/Graphics/Image.hpp>
+
+namespace test
+{
+	// Load the font embedded in the core resources
+	bool loadFont(cpp3ds::Font& font);
+
+	// Count the pixels that differ between two images of the same size
+	unsigned int countDifferences(const cpp3ds::Image& first, const cpp3ds::Image& second);
+}
+
+#endif
@@ -0,0 +1,104 @@
+#include "gtest/gtest.h"
+#include "TestHelpers.hpp"
+#include <cpp3ds/Graphics/SoftwareRenderTexture.hpp>
+#include <cpp3ds/Graphics/Text.hpp>
+
+namespace
+{
+	// Draw a text on a black target covering its bounds
+	cpp3ds::Image render(const cpp3ds::Text& text)
+	{
+		cpp3ds::FloatRect bounds = text.getLocalBounds();
+		cpp3ds::SoftwareRenderTexture target;
+		target.create(static_cast<unsigned int>(bounds.left + bounds.width) + 2,
+		              static_cast<unsigned int>(bounds.top + bounds.height) + 2);
+		target.clear(cpp3ds::Color::Black);
+		target.draw(text);
+		return target.getImage();
+	}
+
+	// Compare with a text laid out from scratch, including the drawn vertices
+	void expectSameLayout(const cpp3ds::Text& text, const cpp3ds::Font& font)
+	{
+		cpp3ds::Text fresh(text.getString(), font, text.getCharacterSize());
+		fresh.setStyle(text.getStyle());
+		fresh.setFillColor(text.getFillColor());
+		fresh.setOutlineColor(text.getOutlineColor());
+		fresh.setOutlineThickness(text.getOutlineThickness());
+
+		EXPECT_EQ(fresh.getLocalBounds(), text.getLocalBounds());
+		for (std::size_t i = 0; i <= text.getString().getSize(); ++i)
+			EXPECT_EQ(fresh.findCharacterPos(i), text.findCharacterPos(i));
+
+		cpp3ds::Image expected = render(fresh);
+		cpp3ds::Image actual = render(text);
+		ASSERT_EQ(expected.getSize(), actual.getSize());
+		EXPECT_EQ(0u, test::countDifferences(expected, actual));
+
+		// The text must be visible for the comparison to mean anything
+		cpp3ds::Image blank;
+		blank.create(expected.getSize().x, expected.getSize().y, cpp3ds::Color::Black);
+		EXPECT_GT(test::countDifferences(expected, blank), 0u);
+	}
+}
+
+TEST(Text, AppendKeepsTheLayout){
+	cpp3ds::Font font;
+	ASSERT_TRUE(test::loadFont(font));
+
+	cpp3ds::Text text(L"Voix ambiguë", font, 20);
+	text.setStyle(cpp3ds::Text::Underlined);
+	text.getLocalBounds();
+
+	text.append(L" d'un cœur\nqui, au zéphyr,");
+	expectSameLayout(text, font);
+
+	text.append(L" préfère les jattes de kiwis");
+	text.append(L".");
+	expectSameLayout(text, font);
+}
+
+TEST(Text, SetStringRelaysTheChangedTail){
+	cpp3ds::Font font;
+	ASSERT_TRUE(test::loadFont(font));
+
+	cpp3ds::Text text(L"AVAVAV\nWTWT", font, 24);
+	text.getLocalBounds();
+
+	// Kerning with the kept prefix must be applied to the new tail
+	text.setString(L"AVAVAV\nWTAV");
+	expectSameLayout(text, font);
+
+	text.setString(L"AVA");
+	expectSameLayout(text, font);
+
+	text.setStyle(cpp3ds::Text::Bold);
+	text.setString(L"AVAW");
+	expectSameLayout(text, font);
+}
+
+TEST(Text, OutlineAndDecorationsFollowTheLayout){
+	cpp3ds::Font font;
+	ASSERT_TRUE(test::loadFont(font));
+
+	cpp3ds::Text text(L"Jackdaws love", font, 22);
+	text.setStyle(cpp3ds::Text::Underlined | cpp3ds::Text::StrikeThrough);
+	text.setFillColor(cpp3ds::Color::Yellow);
+	text.setOutlineColor(cpp3ds::Color::Blue);
+	text.setOutlineThickness(2.f);
+	text.getLocalBounds();
+
+	// The decorations of the last line are extended, not duplicated
+	text.append(L" my big");
+	expectSameLayout(text, font);
+
+	text.append(L"\nsphinx of quartz");
+	expectSameLayout(text, font);
+
+	text.setString(L"Jackdaws love\nsphinxes");
+	expectSameLayout(text, font);
+
+	text.setOutlineThickness(1.f);
+	text.append(L".");
+	expectSameLayout(text, font);
+}
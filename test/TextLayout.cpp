@@ -0,0 +1,109 @@
+#include "gtest/gtest.h"
+#include "TestHelpers.hpp"
+#include <cpp3ds/Graphics/Text.hpp>
+#include <cpp3ds/Graphics/TextLayout.hpp>
+
+namespace
+{
+	const wchar_t* paragraph = L"Voix ambiguë d'un cœur qui, au zéphyr, préfère les jattes de kiwis.\n"
+	                           L"Anticonstitutionnellement";
+}
+
+TEST(TextLayout, UnwrappedMatchesText){
+	cpp3ds::Font font;
+	ASSERT_TRUE(test::loadFont(font));
+
+	cpp3ds::Text text(L"hello world\nsecond line", font, 20);
+	cpp3ds::TextLayout layout(text.getString(), font, 20);
+
+	EXPECT_EQ(2u, layout.getLineCount());
+	for (std::size_t i = 0; i <= text.getString().getSize(); ++i)
+	{
+		// The layout includes the kerning before the character, Text doesn't
+		EXPECT_NEAR(text.findCharacterPos(i).x, layout.findCharacterPos(i).x, 1.f);
+		EXPECT_EQ(text.findCharacterPos(i).y, layout.findCharacterPos(i).y);
+	}
+}
+
+TEST(TextLayout, WrapsAtSpaces){
+	cpp3ds::Font font;
+	ASSERT_TRUE(test::loadFont(font));
+
+	cpp3ds::TextLayout layout(paragraph, font, 16);
+	layout.setWrapWidth(120.f);
+	const cpp3ds::String& string = layout.getString();
+
+	ASSERT_GT(layout.getLineCount(), 4u);
+	for (std::size_t i = 0; i < layout.getLineCount(); ++i)
+	{
+		const cpp3ds::TextLayout::Line& line = layout.getLine(i);
+		EXPECT_LE(line.width, 120.f);
+		EXPECT_EQ(i * font.getLineSpacing(16), line.top);
+
+		// Lines start after a space or a line break, except inside the long word
+		if (i > 0 && line.start < 68)
+			EXPECT_TRUE(string[line.start - 1] == L' ' || string[line.start - 1] == L'\n');
+		EXPECT_EQ(i, layout.findLine(line.start));
+	}
+}
+
+TEST(TextLayout, AlignsLines){
+	cpp3ds::Font font;
+	ASSERT_TRUE(test::loadFont(font));
+
+	cpp3ds::TextLayout layout(paragraph, font, 16);
+	layout.setWrapWidth(150.f);
+	layout.setAlignment(cpp3ds::TextLayout::Right);
+
+	for (std::size_t i = 0; i < layout.getLineCount(); ++i)
+	{
+		const cpp3ds::TextLayout::Line& line = layout.getLine(i);
+		EXPECT_FLOAT_EQ(150.f, line.left + line.width);
+		EXPECT_EQ(line.left, layout.findCharacterPos(line.start).x);
+	}
+	EXPECT_FLOAT_EQ(150.f, layout.getBounds().left + layout.getBounds().width);
+}
+
+TEST(TextLayout, FindsCharacterUnderPoint){
+	cpp3ds::Font font;
+	ASSERT_TRUE(test::loadFont(font));
+
+	cpp3ds::TextLayout layout(paragraph, font, 16);
+	layout.setWrapWidth(130.f);
+	layout.setAlignment(cpp3ds::TextLayout::Center);
+	float height = font.getLineSpacing(16);
+
+	for (std::size_t i = 0; i < layout.getString().getSize(); ++i)
+	{
+		cpp3ds::FloatRect box = layout.getCharacterBounds(i);
+		if (layout.getString()[i] == L'\n' || box.width <= 0.f)
+			continue;
+		EXPECT_EQ(i, layout.findCharacterAt(cpp3ds::Vector2f(box.left + box.width / 4, box.top + height / 2)));
+	}
+
+	// Points outside of the text hit the nearest end of a line
+	EXPECT_EQ(0u, layout.findCharacterAt(cpp3ds::Vector2f(-100.f, -100.f)));
+	EXPECT_EQ(layout.getString().getSize(), layout.findCharacterAt(cpp3ds::Vector2f(1000.f, 1000.f)));
+}
+
+TEST(TextLayout, TextFollowsTheLayout){
+	cpp3ds::Font font;
+	ASSERT_TRUE(test::loadFont(font));
+
+	cpp3ds::TextLayout layout(L"hello world", font, 20);
+	cpp3ds::Text text;
+	text.setLayout(&layout);
+
+	cpp3ds::Text reference(L"hello world", font, 20);
+	EXPECT_EQ(reference.getLocalBounds(), text.getLocalBounds());
+
+	// Wrapping the layout moves the second word under the first
+	layout.setWrapWidth(60.f);
+	EXPECT_EQ(2u, layout.getLineCount());
+	EXPECT_GT(text.getLocalBounds().height, reference.getLocalBounds().height);
+	EXPECT_LT(text.getLocalBounds().width, reference.getLocalBounds().width);
+	EXPECT_EQ(layout.findCharacterPos(6), text.findCharacterPos(6));
+
+	text.setLayout(NULL);
+	EXPECT_EQ(cpp3ds::FloatRect(), text.getLocalBounds());
+}
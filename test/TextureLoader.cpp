@@ -0,0 +1,102 @@
+#include "gtest/gtest.h"
+#include <cpp3ds/Graphics/TextureLoader.hpp>
+#include <cpp3ds/System/Clock.hpp>
+#include <cpp3ds/System/FileSystem.hpp>
+#include <cpp3ds/System/Sleep.hpp>
+#include <cstdio>
+#include <string>
+#include <sys/stat.h>
+
+using cpp3ds::TextureLoader;
+
+namespace
+{
+	// Let the worker thread process the queue, with a timeout
+	void waitForPending(TextureLoader& loader)
+	{
+		cpp3ds::Clock clock;
+		while (loader.getPendingCount() > 0 && clock.getElapsedTime() < cpp3ds::seconds(5))
+		{
+			loader.update();
+			cpp3ds::sleep(cpp3ds::milliseconds(1));
+		}
+	}
+
+	// Save an image on the emulated SD card, creating its folders
+	bool saveImage(const std::string& filename, unsigned int width, unsigned int height)
+	{
+		std::string path = cpp3ds::FileSystem::getFilePath(filename);
+		for (std::size_t i = path.find('/'); i != std::string::npos; i = path.find('/', i + 1))
+			mkdir(path.substr(0, i).c_str(), 0755);
+
+		cpp3ds::Image image;
+		image.create(width, height, cpp3ds::Color::Red);
+		return image.saveToFile(path);
+	}
+}
+
+TEST(TextureLoader, LoadsFile){
+	ASSERT_TRUE(saveImage("sdmc:/TextureLoader.png", 20, 10));
+	TextureLoader loader;
+	cpp3ds::Texture texture;
+
+	TextureLoader::Status result = TextureLoader::Unknown;
+	TextureLoader::Handle handle = loader.loadAsync(texture, "sdmc:/TextureLoader.png", cpp3ds::Texture::RGB565,
+		[&](TextureLoader::Handle, TextureLoader::Status status) { result = status; });
+	ASSERT_NE(0u, handle);
+
+	waitForPending(loader);
+	EXPECT_EQ(TextureLoader::Loaded, result);
+	EXPECT_EQ(TextureLoader::Loaded, loader.getStatus(handle));
+	EXPECT_EQ(20u, texture.getSize().x);
+	EXPECT_EQ(10u, texture.getSize().y);
+	EXPECT_EQ(cpp3ds::Texture::RGB565, texture.getFormat());
+
+	std::remove(cpp3ds::FileSystem::getFilePath("sdmc:/TextureLoader.png").c_str());
+}
+
+TEST(TextureLoader, MissingFileFails){
+	TextureLoader loader;
+	cpp3ds::Texture texture;
+
+	TextureLoader::Status result = TextureLoader::Unknown;
+	TextureLoader::Handle handle = loader.loadAsync(texture, "does/not/exist.png", cpp3ds::Texture::RGBA8,
+		[&](TextureLoader::Handle, TextureLoader::Status status) { result = status; });
+	ASSERT_NE(0u, handle);
+
+	waitForPending(loader);
+	EXPECT_EQ(TextureLoader::Failed, result);
+	EXPECT_EQ(TextureLoader::Failed, loader.getStatus(handle));
+	EXPECT_EQ(0u, texture.getSize().x);
+}
+
+TEST(TextureLoader, QueueIsBounded){
+	TextureLoader loader(2);
+	cpp3ds::Texture texture;
+
+	EXPECT_NE(0u, loader.loadAsync(texture, "does/not/exist.png"));
+	EXPECT_NE(0u, loader.loadAsync(texture, "does/not/exist.png"));
+	EXPECT_EQ(0u, loader.loadAsync(texture, "does/not/exist.png"));
+
+	// Finished requests free their slot
+	waitForPending(loader);
+	EXPECT_NE(0u, loader.loadAsync(texture, "does/not/exist.png"));
+}
+
+TEST(TextureLoader, Cancel){
+	TextureLoader loader;
+	cpp3ds::Texture texture;
+
+	bool called = false;
+	TextureLoader::Handle handle = loader.loadAsync(texture, "does/not/exist.png", cpp3ds::Texture::RGBA8,
+		[&](TextureLoader::Handle, TextureLoader::Status) { called = true; });
+
+	EXPECT_TRUE(loader.cancel(handle));
+	EXPECT_FALSE(loader.cancel(handle));
+	EXPECT_EQ(TextureLoader::Cancelled, loader.getStatus(handle));
+	EXPECT_EQ(0u, loader.getPendingCount());
+
+	waitForPending(loader);
+	EXPECT_FALSE(called);
+	EXPECT_EQ(TextureLoader::Unknown, loader.getStatus(handle + 1));
+}
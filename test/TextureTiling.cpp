@@ -0,0 +1,274 @@
+#include "gtest/gtest.h"
+#include "../src/cpp3ds/Graphics/TextureTiling.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using cpp3ds::Uint8;
+using cpp3ds::Uint32;
+
+namespace
+{
+	// Per-pixel reference implementation (from citra/src/video_core/utils.h)
+	Uint32 morton_interleave(Uint32 x, Uint32 y)
+	{
+		Uint32 i = (x & 7) | ((y & 7) << 8);
+		i = (i ^ (i << 2)) & 0x1313;
+		i = (i ^ (i << 1)) & 0x1515;
+		i = (i | (i >> 7)) & 0x3F;
+		return i;
+	}
+
+	Uint32 get_morton_offset(Uint32 x, Uint32 y, Uint32 bytes_per_pixel)
+	{
+		Uint32 i = morton_interleave(x, y);
+		unsigned int offset = (x & ~7) * 8;
+		return (i + offset) * bytes_per_pixel;
+	}
+
+	void referenceTile32(Uint8* dest, const Uint8* source, unsigned x, unsigned y, unsigned src_w, unsigned src_h, unsigned dest_w, unsigned dest_h)
+	{
+		for (unsigned j = 0; j < src_h; j++)
+			for (unsigned i = 0; i < src_w; i++) {
+				int pos_y = (dest_h - 1 - j - y);
+				Uint32 coarse_y = pos_y & ~7;
+				Uint32 dst_offset = get_morton_offset(i+x, pos_y, 4) + coarse_y * dest_w * 4;
+				Uint32 v = ((Uint32 *)source)[i + j*src_w];
+				*(Uint32 *)(dest + dst_offset) = __builtin_bswap32(v);
+			}
+	}
+
+	void referenceUntile32(Uint8* dest, const Uint8* source, unsigned x, unsigned y, unsigned src_w, unsigned src_h, unsigned dest_w, unsigned dest_h)
+	{
+		for (unsigned j = 0; j < src_h; j++)
+			for (unsigned i = 0; i < src_w; i++) {
+				int pos_y = (dest_h - 1 - j - y);
+				Uint32 coarse_y = pos_y & ~7;
+				Uint32 src_offset = get_morton_offset(i+x, pos_y, 4) + coarse_y * dest_w * 4;
+				Uint32 v = *(Uint32 *)(source + src_offset);
+				((Uint32 *)dest)[i + j*src_w] = __builtin_bswap32(v);
+			}
+	}
+
+	std::vector<Uint32> randomPixels(unsigned int count)
+	{
+		std::vector<Uint32> pixels(count);
+		for (unsigned int i = 0; i < count; ++i)
+			pixels[i] = (static_cast<Uint32>(std::rand()) << 16) ^ static_cast<Uint32>(std::rand());
+		return pixels;
+	}
+
+	Uint8* bytes(std::vector<Uint32>& pixels)
+	{
+		return reinterpret_cast<Uint8*>(&pixels[0]);
+	}
+
+	// Linear 2x2 box filter of RGBA pixels
+	std::vector<Uint32> referenceDownsample(const std::vector<Uint32>& pixels, unsigned int width, unsigned int height)
+	{
+		std::vector<Uint32> result(width * height / 4);
+		for (unsigned int y = 0; y < height / 2; ++y)
+			for (unsigned int x = 0; x < width / 2; ++x)
+			{
+				Uint32 pixel = 0;
+				for (unsigned int c = 0; c < 32; c += 8)
+				{
+					Uint32 sum = 2;
+					for (unsigned int j = 0; j < 2; ++j)
+						for (unsigned int i = 0; i < 2; ++i)
+							sum += (pixels[(y * 2 + j) * width + x * 2 + i] >> c) & 0xFF;
+					pixel |= (sum >> 2) << c;
+				}
+				result[y * width / 2 + x] = pixel;
+			}
+		return result;
+	}
+
+	// Alpha channel as stored by a format, quantized to its precision
+	Uint32 alphaOf(Uint32 pixel, cpp3ds::Texture::Format format)
+	{
+		Uint32 alpha = pixel >> 24;
+		switch (format)
+		{
+			case cpp3ds::Texture::RGB565:
+			case cpp3ds::Texture::L8:       return 0xFF;
+			case cpp3ds::Texture::RGBA5551: return (alpha >> 7) * 0xFF;
+			case cpp3ds::Texture::RGBA4:    return (alpha >> 4) * 0x11;
+			default:                        return alpha;
+		}
+	}
+}
+
+TEST(TextureTiling, MatchesReference){
+	const unsigned int width = 64, height = 32;
+
+	// Aligned and unaligned sub-rectangles, including a full texture
+	const unsigned int rects[][4] = {{0, 0, 64, 32}, {8, 8, 16, 16}, {3, 5, 21, 9}, {57, 0, 7, 1}, {0, 31, 13, 1}};
+	for (const auto& r : rects)
+	{
+		std::vector<Uint32> source = randomPixels(r[2] * r[3]);
+		std::vector<Uint32> expected = randomPixels(width * height);
+		std::vector<Uint32> actual = expected;
+
+		referenceTile32(bytes(expected), bytes(source), r[0], r[1], r[2], r[3], width, height);
+		cpp3ds::priv::tileImage32(bytes(actual), bytes(source), r[0], r[1], r[2], r[3], width, height);
+		EXPECT_EQ(expected, actual);
+
+		std::vector<Uint32> expectedPixels(r[2] * r[3]), actualPixels(r[2] * r[3]);
+		referenceUntile32(bytes(expectedPixels), bytes(actual), r[0], r[1], r[2], r[3], width, height);
+		cpp3ds::priv::untileImage32(bytes(actualPixels), bytes(actual), r[0], r[1], r[2], r[3], width, height);
+		EXPECT_EQ(expectedPixels, actualPixels);
+	}
+}
+
+TEST(TextureTiling, RoundTrip){
+	const unsigned int width = 256, height = 128;
+	std::vector<Uint32> source = randomPixels(width * height);
+	std::vector<Uint32> tiled(width * height), result(width * height);
+
+	cpp3ds::priv::tileImage32(bytes(tiled), bytes(source), 0, 0, width, height, width, height);
+	cpp3ds::priv::untileImage32(bytes(result), bytes(tiled), 0, 0, width, height, width, height);
+	EXPECT_EQ(source, result);
+}
+
+TEST(TextureTiling, FormatConversion){
+	// Red, green, blue, alpha channels in memory order
+	std::vector<Uint32> source(64);
+	for (unsigned int i = 0; i < source.size(); ++i)
+		source[i] = 0x80FF4411;
+	std::vector<Uint32> tiled(64), result(64);
+
+	const struct { cpp3ds::Texture::Format format; Uint32 expected; } cases[] = {
+		{cpp3ds::Texture::RGBA8,    0x80FF4411},
+		{cpp3ds::Texture::RGB565,   0xFFFF4510},
+		{cpp3ds::Texture::RGBA5551, 0xFFFF4210},
+		{cpp3ds::Texture::RGBA4,    0x88FF4411},
+		{cpp3ds::Texture::LA8,      0x80494949},
+		{cpp3ds::Texture::L8,       0xFF494949},
+		{cpp3ds::Texture::A8,       0x80FFFFFF},
+	};
+	for (const auto& c : cases)
+	{
+		cpp3ds::priv::tileImage(bytes(tiled), bytes(source), 0, 0, 8, 8, 8, 8, c.format);
+		cpp3ds::priv::untileImage(bytes(result), bytes(tiled), 0, 0, 8, 8, 8, 8, c.format);
+		EXPECT_EQ(c.expected, result[0]) << "format " << c.format;
+		EXPECT_EQ(result[0], result[63]) << "format " << c.format;
+	}
+}
+
+TEST(TextureTiling, FormatRoundTrip){
+	const unsigned int width = 64, height = 32;
+	const cpp3ds::Texture::Format formats[] = {cpp3ds::Texture::RGB565, cpp3ds::Texture::RGBA5551, cpp3ds::Texture::RGBA4,
+	                                           cpp3ds::Texture::LA8, cpp3ds::Texture::L8, cpp3ds::Texture::A8};
+	for (auto format : formats)
+	{
+		// Once quantized, pixels must survive another conversion unchanged
+		std::vector<Uint32> source = randomPixels(width * height);
+		std::vector<Uint32> tiled(width * height), once(width * height), twice(width * height);
+
+		cpp3ds::priv::tileImage(bytes(tiled), bytes(source), 0, 0, width, height, width, height, format);
+		cpp3ds::priv::untileImage(bytes(once), bytes(tiled), 0, 0, width, height, width, height, format);
+		cpp3ds::priv::tileImage(bytes(tiled), bytes(once), 0, 0, width, height, width, height, format);
+		cpp3ds::priv::untileImage(bytes(twice), bytes(tiled), 0, 0, width, height, width, height, format);
+		EXPECT_EQ(once, twice) << "format " << format;
+
+		// Sub-rectangles land at the same place as with 32-bit pixels
+		std::vector<Uint32> block = randomPixels(21 * 9), blockResult(21 * 9);
+		cpp3ds::priv::tileImage(bytes(tiled), bytes(block), 3, 5, 21, 9, width, height, format);
+		cpp3ds::priv::untileImage(bytes(blockResult), bytes(tiled), 3, 5, 21, 9, width, height, format);
+		for (unsigned int i = 0; i < block.size(); ++i)
+			ASSERT_EQ(alphaOf(block[i], format), alphaOf(blockResult[i], format)) << "format " << format << ", pixel " << i;
+	}
+}
+
+TEST(TextureTiling, SourceStride){
+	const unsigned int width = 64, height = 32;
+	const unsigned int left = 11, top = 6, blockWidth = 37, blockHeight = 19;
+	std::vector<Uint32> source = randomPixels(width * height);
+
+	// Tiling straight from a larger image must match tiling a packed copy of the block
+	std::vector<Uint32> packed(blockWidth * blockHeight);
+	for (unsigned int j = 0; j < blockHeight; ++j)
+		for (unsigned int i = 0; i < blockWidth; ++i)
+			packed[i + j * blockWidth] = source[left + i + (top + j) * width];
+
+	std::vector<Uint32> expected(width * height), result(width * height);
+	cpp3ds::priv::tileImage(bytes(expected), bytes(packed), left, top, blockWidth, blockHeight, width, height, cpp3ds::Texture::RGBA8);
+	cpp3ds::priv::tileImage(bytes(result), bytes(source) + 4 * (left + top * width), left, top, blockWidth, blockHeight,
+	                        width, height, cpp3ds::Texture::RGBA8, width);
+	EXPECT_EQ(expected, result);
+}
+
+TEST(TextureTiling, MipmapMatchesReference){
+	const unsigned int width = 128, height = 64;
+	const cpp3ds::Texture::Format formats[] = {cpp3ds::Texture::RGBA8, cpp3ds::Texture::A8};
+	for (auto format : formats)
+	{
+		std::vector<Uint32> source = randomPixels(width * height);
+		std::vector<Uint32> tiled(width * height), level(width * height / 4), expected(width * height / 4);
+
+		// Box filter in linear layout, then tile the result
+		cpp3ds::priv::tileImage(bytes(tiled), bytes(source), 0, 0, width, height, width, height, format);
+		cpp3ds::priv::untileImage(bytes(source), bytes(tiled), 0, 0, width, height, width, height, format);
+		std::vector<Uint32> filtered = referenceDownsample(source, width, height);
+		cpp3ds::priv::tileImage(bytes(expected), bytes(filtered), 0, 0, width / 2, height / 2, width / 2, height / 2, format);
+
+		cpp3ds::priv::downsampleImage(bytes(level), bytes(tiled), width, height, format);
+		EXPECT_EQ(expected, level) << "format " << format;
+	}
+}
+
+TEST(TextureTiling, MipmapThroughput){
+	typedef std::chrono::high_resolution_clock Clock;
+	const unsigned int width = 1024, height = 1024, iterations = 20;
+	std::vector<Uint32> source = randomPixels(width * height);
+	std::vector<Uint32> tiled(width * height), level(width * height / 4);
+	cpp3ds::priv::tileImage32(bytes(tiled), bytes(source), 0, 0, width, height, width, height);
+
+	// Reference: untile, filter and tile again
+	Clock::time_point start = Clock::now();
+	for (unsigned int i = 0; i < iterations; ++i)
+	{
+		cpp3ds::priv::untileImage32(bytes(source), bytes(tiled), 0, 0, width, height, width, height);
+		std::vector<Uint32> filtered = referenceDownsample(source, width, height);
+		cpp3ds::priv::tileImage32(bytes(level), bytes(filtered), 0, 0, width / 2, height / 2, width / 2, height / 2);
+	}
+	double referenceTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+	start = Clock::now();
+	for (unsigned int i = 0; i < iterations; ++i)
+		cpp3ds::priv::downsampleImage(bytes(level), bytes(tiled), width, height, cpp3ds::Texture::RGBA8);
+	double downsampleTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+	double megaPixels = width * height * iterations / 1000000.0;
+	std::cout << "[ BENCHMARK] reference mipmap: " << megaPixels / referenceTime << " MPixels/s" << std::endl;
+	std::cout << "[ BENCHMARK] tiled mipmap:     " << megaPixels / downsampleTime << " MPixels/s" << std::endl;
+}
+
+TEST(TextureTiling, Throughput){
+	typedef std::chrono::high_resolution_clock Clock;
+	const unsigned int width = 1024, height = 1024, iterations = 20;
+	std::vector<Uint32> source = randomPixels(width * height);
+	std::vector<Uint32> tiled(width * height);
+
+	Clock::time_point start = Clock::now();
+	for (unsigned int i = 0; i < iterations; ++i)
+		referenceTile32(bytes(tiled), bytes(source), 0, 0, width, height, width, height);
+	double referenceTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+	start = Clock::now();
+	for (unsigned int i = 0; i < iterations; ++i)
+		cpp3ds::priv::tileImage32(bytes(tiled), bytes(source), 0, 0, width, height, width, height);
+	double tileTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+	start = Clock::now();
+	for (unsigned int i = 0; i < iterations; ++i)
+		cpp3ds::priv::untileImage32(bytes(source), bytes(tiled), 0, 0, width, height, width, height);
+	double untileTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+	double megaPixels = width * height * iterations / 1000000.0;
+	std::cout << "[ BENCHMARK] reference tile: " << megaPixels / referenceTime << " MPixels/s" << std::endl;
+	std::cout << "[ BENCHMARK] tile:           " << megaPixels / tileTime << " MPixels/s" << std::endl;
+	std::cout << "[ BENCHMARK] untile:         " << megaPixels / untileTime << " MPixels/s" << std::endl;
+}
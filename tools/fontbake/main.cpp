@@ -0,0 +1,514 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cpp3ds/Config.hpp>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_GLYPH_H
+#include FT_OUTLINE_H
+#include FT_BITMAP_H
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using cpp3ds::Uint8;
+using cpp3ds::Uint16;
+using cpp3ds::Uint32;
+
+
+namespace
+{
+    // Padding around glyphs, same as cpp3ds::Font::loadGlyph
+    const unsigned int padding = 1;
+
+    // Kerning is only baked for this many code points, as every pair is queried
+    const std::size_t maximumKerningGlyphs = 1024;
+
+    struct Range
+    {
+        Uint32 first;
+        Uint32 last;
+    };
+
+    struct BakedGlyph
+    {
+        Uint32             codePoint;
+        bool               bold;
+        float              advance;
+        float              bounds[4]; ///< Left, top, width, height
+        unsigned int       width;     ///< Size of the bitmap, without padding
+        unsigned int       height;
+        std::vector<Uint8> alpha;     ///< Pixels of the bitmap, row by row
+        unsigned int       page;
+        unsigned int       x;         ///< Position of the bitmap in its page
+        unsigned int       y;
+    };
+
+    struct KerningPair
+    {
+        Uint32 first;
+        Uint32 second;
+        float  offset;
+    };
+
+    struct Page
+    {
+        unsigned int       size;
+        std::vector<Uint8> alpha; ///< Pixels of the page, row by row
+    };
+
+    // Binary output, little-endian
+    class Writer
+    {
+    public:
+
+        void put16(unsigned int value)
+        {
+            data.push_back(static_cast<Uint8>(value & 0xFF));
+            data.push_back(static_cast<Uint8>((value >> 8) & 0xFF));
+        }
+
+        void put32(Uint32 value)
+        {
+            put16(value & 0xFFFF);
+            put16(value >> 16);
+        }
+
+        void putFloat(float value)
+        {
+            Uint32 bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            put32(bits);
+        }
+
+        void putBytes(const Uint8* bytes, std::size_t count)
+        {
+            data.insert(data.end(), bytes, bytes + count);
+        }
+
+        std::vector<Uint8> data;
+    };
+
+    bool parseNumber(const std::string& text, Uint32& value)
+    {
+        char* end = NULL;
+        unsigned long number = std::strtoul(text.c_str(), &end, 0);
+        if (text.empty() || (*end != '\0'))
+            return false;
+        value = static_cast<Uint32>(number);
+        return true;
+    }
+
+    // Parse "first-last" or a single code point
+    bool parseRange(const std::string& text, Range& range)
+    {
+        std::string::size_type dash = text.find('-', 1);
+        if (dash == std::string::npos)
+        {
+            if (!parseNumber(text, range.first))
+                return false;
+            range.last = range.first;
+            return true;
+        }
+
+        return parseNumber(text.substr(0, dash), range.first) &&
+               parseNumber(text.substr(dash + 1), range.last) &&
+               (range.first <= range.last);
+    }
+
+    // Rasterize a glyph exactly like cpp3ds::Font::loadGlyph
+    bool rasterize(FT_Library library, FT_Face face, Uint32 codePoint, bool bold, BakedGlyph& glyph)
+    {
+        if (FT_Load_Char(face, codePoint, FT_LOAD_TARGET_NORMAL | FT_LOAD_FORCE_AUTOHINT) != 0)
+            return false;
+
+        FT_Glyph glyphDesc;
+        if (FT_Get_Glyph(face->glyph, &glyphDesc) != 0)
+            return false;
+
+        FT_Pos weight = 1 << 6;
+        bool outline = (glyphDesc->format == FT_GLYPH_FORMAT_OUTLINE);
+        if (outline && bold)
+            FT_Outline_Embolden(&reinterpret_cast<FT_OutlineGlyph>(glyphDesc)->outline, weight);
+
+        FT_Glyph_To_Bitmap(&glyphDesc, FT_RENDER_MODE_NORMAL, 0, 1);
+        FT_Bitmap& bitmap = reinterpret_cast<FT_BitmapGlyph>(glyphDesc)->bitmap;
+
+        if (!outline && bold)
+            FT_Bitmap_Embolden(library, &bitmap, weight, weight);
+
+        glyph.codePoint = codePoint;
+        glyph.bold = bold;
+        glyph.advance = static_cast<float>(face->glyph->metrics.horiAdvance) / static_cast<float>(1 << 6);
+        if (bold)
+            glyph.advance += static_cast<float>(weight) / static_cast<float>(1 << 6);
+        std::fill(glyph.bounds, glyph.bounds + 4, 0.f);
+        glyph.width = 0;
+        glyph.height = 0;
+        glyph.page = 0;
+        glyph.x = 0;
+        glyph.y = 0;
+
+        if ((bitmap.width > 0) && (bitmap.rows > 0))
+        {
+            glyph.bounds[0] =  static_cast<float>(face->glyph->metrics.horiBearingX) / static_cast<float>(1 << 6);
+            glyph.bounds[1] = -static_cast<float>(face->glyph->metrics.horiBearingY) / static_cast<float>(1 << 6);
+            glyph.bounds[2] =  static_cast<float>(face->glyph->metrics.width)        / static_cast<float>(1 << 6);
+            glyph.bounds[3] =  static_cast<float>(face->glyph->metrics.height)       / static_cast<float>(1 << 6);
+
+            glyph.width = bitmap.width;
+            glyph.height = bitmap.rows;
+            glyph.alpha.resize(glyph.width * glyph.height);
+
+            const Uint8* pixels = bitmap.buffer;
+            for (unsigned int y = 0; y < glyph.height; ++y)
+            {
+                for (unsigned int x = 0; x < glyph.width; ++x)
+                {
+                    if (bitmap.pixel_mode == FT_PIXEL_MODE_MONO)
+                        glyph.alpha[x + y * glyph.width] = ((pixels[x / 8]) & (1 << (7 - (x % 8)))) ? 255 : 0;
+                    else
+                        glyph.alpha[x + y * glyph.width] = pixels[x];
+                }
+                pixels += bitmap.pitch;
+            }
+        }
+
+        FT_Done_Glyph(glyphDesc);
+        return true;
+    }
+
+    // Pack the glyphs in shelves, tallest first. Unlike the skyline packer
+    // of cpp3ds::Font, all the glyphs are known in advance here.
+    bool packGlyphs(std::vector<BakedGlyph>& glyphs, unsigned int pageSize, std::vector<Page>& pages)
+    {
+        std::vector<BakedGlyph*> order;
+        for (std::size_t i = 0; i < glyphs.size(); ++i)
+            if (glyphs[i].width > 0)
+                order.push_back(&glyphs[i]);
+        std::stable_sort(order.begin(), order.end(), [](const BakedGlyph* a, const BakedGlyph* b) { return a->height > b->height; });
+
+        unsigned int shelfX = pageSize;
+        unsigned int shelfY = 0;
+        unsigned int shelfHeight = 0;
+        for (std::size_t i = 0; i < order.size(); ++i)
+        {
+            BakedGlyph& glyph = *order[i];
+            unsigned int width = glyph.width + 2 * padding;
+            unsigned int height = glyph.height + 2 * padding;
+            if ((width > pageSize) || (height > pageSize))
+            {
+                std::cerr << "Glyph " << glyph.codePoint << " doesn't fit in a " << pageSize << "x" << pageSize
+                          << " page, use a larger page size" << std::endl;
+                return false;
+            }
+
+            // Start a new shelf, then a new page, when the current one is full
+            if (shelfX + width > pageSize)
+            {
+                shelfX = 0;
+                shelfY += shelfHeight;
+                shelfHeight = 0;
+            }
+            if (pages.empty() || (shelfY + height > pageSize))
+            {
+                Page page;
+                page.size = pageSize;
+                page.alpha.resize(pageSize * pageSize, 0);
+
+                // Reserve a 2x2 white square for texturing underlines, like cpp3ds::Font
+                for (unsigned int y = 0; y < 2; ++y)
+                    for (unsigned int x = 0; x < 2; ++x)
+                        page.alpha[x + y * pageSize] = 255;
+
+                pages.push_back(page);
+                shelfX = 3;
+                shelfY = 0;
+                shelfHeight = 3;
+            }
+
+            glyph.page = static_cast<unsigned int>(pages.size() - 1);
+            glyph.x = shelfX + padding;
+            glyph.y = shelfY + padding;
+            shelfX += width;
+            shelfHeight = std::max(shelfHeight, height);
+
+            Page& page = pages.back();
+            for (unsigned int y = 0; y < glyph.height; ++y)
+                std::memcpy(&page.alpha[glyph.x + (glyph.y + y) * pageSize], &glyph.alpha[y * glyph.width], glyph.width);
+        }
+
+        // Sizes without any visible glyph still get the white square
+        if (pages.empty())
+        {
+            Page page;
+            page.size = 8;
+            page.alpha.resize(8 * 8, 0);
+            page.alpha[0] = page.alpha[1] = page.alpha[8] = page.alpha[9] = 255;
+            pages.push_back(page);
+        }
+
+        return true;
+    }
+
+    void showUsage()
+    {
+        std::cerr << "Usage: cpp3ds-fontbake -s sizes -r ranges [-b] [-p size] -o output input" << std::endl
+                  << std::endl
+                  << "Rasterizes glyphs of a font to atlas pages with their metrics and kerning," << std::endl
+                  << "that can be loaded with cpp3ds::Font::loadFromBakedAtlas." << std::endl
+                  << std::endl
+                  << "  -s sizes   character sizes, separated by commas (e.g. 12,16,24)" << std::endl
+                  << "  -r ranges  code points, separated by commas (e.g. 32-126,0x3040-0x30ff)" << std::endl
+                  << "  -b         bake the bold glyphs too" << std::endl
+                  << "  -p size    size of the atlas pages (default 256)" << std::endl
+                  << "  -o output  output file" << std::endl;
+    }
+
+    std::vector<std::string> split(const std::string& text)
+    {
+        std::vector<std::string> items;
+        std::string::size_type start = 0;
+        while (start <= text.size())
+        {
+            std::string::size_type comma = text.find(',', start);
+            if (comma == std::string::npos)
+                comma = text.size();
+            if (comma > start)
+                items.push_back(text.substr(start, comma - start));
+            start = comma + 1;
+        }
+        return items;
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+int main(int argc, char** argv)
+{
+    std::vector<unsigned int> sizes;
+    std::vector<Range> ranges;
+    bool bold = false;
+    unsigned int pageSize = 256;
+    std::string inputFile;
+    std::string outputFile;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if ((arg == "-s") && (i + 1 < argc))
+        {
+            std::vector<std::string> items = split(argv[++i]);
+            for (std::size_t s = 0; s < items.size(); ++s)
+            {
+                Uint32 size;
+                if (!parseNumber(items[s], size) || (size == 0) || (size > 0xFFFF))
+                {
+                    std::cerr << "Invalid character size: " << items[s] << std::endl;
+                    return 1;
+                }
+                sizes.push_back(size);
+            }
+        }
+        else if ((arg == "-r") && (i + 1 < argc))
+        {
+            std::vector<std::string> items = split(argv[++i]);
+            for (std::size_t r = 0; r < items.size(); ++r)
+            {
+                Range range;
+                if (!parseRange(items[r], range))
+                {
+                    std::cerr << "Invalid code point range: " << items[r] << std::endl;
+                    return 1;
+                }
+                ranges.push_back(range);
+            }
+        }
+        else if (arg == "-b")
+            bold = true;
+        else if ((arg == "-p") && (i + 1 < argc))
+        {
+            pageSize = static_cast<unsigned int>(std::atoi(argv[++i]));
+            if ((pageSize < 8) || (pageSize > 1024) || (pageSize & (pageSize - 1)))
+            {
+                std::cerr << "The page size must be a power of two between 8 and 1024" << std::endl;
+                return 1;
+            }
+        }
+        else if ((arg == "-o") && (i + 1 < argc))
+            outputFile = argv[++i];
+        else if ((arg[0] != '-') && inputFile.empty())
+            inputFile = arg;
+        else
+        {
+            showUsage();
+            return 1;
+        }
+    }
+
+    if (inputFile.empty() || outputFile.empty() || sizes.empty() || ranges.empty())
+    {
+        showUsage();
+        return 1;
+    }
+
+    FT_Library library;
+    if (FT_Init_FreeType(&library) != 0)
+    {
+        std::cerr << "Failed to initialize FreeType" << std::endl;
+        return 1;
+    }
+
+    FT_Face face;
+    if ((FT_New_Face(library, inputFile.c_str(), 0, &face) != 0) || (FT_Select_Charmap(face, FT_ENCODING_UNICODE) != 0))
+    {
+        std::cerr << "Failed to load font \"" << inputFile << "\"" << std::endl;
+        FT_Done_FreeType(library);
+        return 1;
+    }
+
+    // Code points missing from the font are left to the fallback face
+    std::vector<Uint32> codePoints;
+    for (std::size_t r = 0; r < ranges.size(); ++r)
+        for (cpp3ds::Uint64 codePoint = ranges[r].first; codePoint <= ranges[r].last; ++codePoint)
+            if (FT_Get_Char_Index(face, static_cast<FT_ULong>(codePoint)) != 0)
+                codePoints.push_back(static_cast<Uint32>(codePoint));
+    std::sort(codePoints.begin(), codePoints.end());
+    codePoints.erase(std::unique(codePoints.begin(), codePoints.end()), codePoints.end());
+
+    bool bakeKerning = FT_HAS_KERNING(face) && (codePoints.size() <= maximumKerningGlyphs);
+    if (FT_HAS_KERNING(face) && !bakeKerning)
+        std::cerr << "Too many code points to bake the kerning of \"" << inputFile << "\", "
+                  << "it will be read from the fallback face" << std::endl;
+
+    // Header matching cpp3ds::Font::loadFromBakedAtlas
+    Writer writer;
+    writer.putBytes(reinterpret_cast<const Uint8*>("C3FB"), 4);
+    writer.put16(1);
+    writer.put16(static_cast<unsigned int>(sizes.size()));
+    std::string family = face->family_name ? face->family_name : std::string();
+    writer.put16(static_cast<unsigned int>(family.size()));
+    writer.putBytes(reinterpret_cast<const Uint8*>(family.c_str()), family.size());
+
+    for (std::size_t s = 0; s < sizes.size(); ++s)
+    {
+        unsigned int characterSize = sizes[s];
+        if (FT_Set_Pixel_Sizes(face, 0, characterSize) != 0)
+        {
+            std::cerr << "Failed to set the character size of \"" << inputFile << "\" to " << characterSize << std::endl;
+            FT_Done_Face(face);
+            FT_Done_FreeType(library);
+            return 1;
+        }
+
+        std::vector<BakedGlyph> glyphs;
+        for (std::size_t c = 0; c < codePoints.size(); ++c)
+        {
+            for (int style = 0; style < (bold ? 2 : 1); ++style)
+            {
+                BakedGlyph glyph;
+                if (rasterize(library, face, codePoints[c], style != 0, glyph))
+                    glyphs.push_back(glyph);
+            }
+        }
+
+        std::vector<Page> pages;
+        if (!packGlyphs(glyphs, pageSize, pages))
+        {
+            FT_Done_Face(face);
+            FT_Done_FreeType(library);
+            return 1;
+        }
+
+        // Kerning pairs, only the ones that are not zero
+        std::vector<KerningPair> kerning;
+        if (bakeKerning)
+        {
+            for (std::size_t first = 0; first < codePoints.size(); ++first)
+            {
+                FT_UInt index1 = FT_Get_Char_Index(face, codePoints[first]);
+                for (std::size_t second = 0; second < codePoints.size(); ++second)
+                {
+                    FT_Vector vector;
+                    FT_Get_Kerning(face, index1, FT_Get_Char_Index(face, codePoints[second]), FT_KERNING_DEFAULT, &vector);
+                    if (vector.x == 0)
+                        continue;
+
+                    KerningPair pair;
+                    pair.first = codePoints[first];
+                    pair.second = codePoints[second];
+                    pair.offset = FT_IS_SCALABLE(face) ? static_cast<float>(vector.x) / static_cast<float>(1 << 6)
+                                                       : static_cast<float>(vector.x);
+                    kerning.push_back(pair);
+                }
+            }
+        }
+
+        // Global metrics, same as cpp3ds::Font
+        float lineSpacing = static_cast<float>(face->size->metrics.height) / static_cast<float>(1 << 6);
+        float underlinePosition = characterSize / 10.f;
+        float underlineThickness = characterSize / 14.f;
+        if (FT_IS_SCALABLE(face))
+        {
+            underlinePosition = -static_cast<float>(FT_MulFix(face->underline_position, face->size->metrics.y_scale)) / static_cast<float>(1 << 6);
+            underlineThickness = static_cast<float>(FT_MulFix(face->underline_thickness, face->size->metrics.y_scale)) / static_cast<float>(1 << 6);
+        }
+
+        writer.put16(characterSize);
+        writer.put16(bakeKerning || !FT_HAS_KERNING(face) ? 1 : 0);
+        writer.putFloat(lineSpacing);
+        writer.putFloat(underlinePosition);
+        writer.putFloat(underlineThickness);
+        writer.put16(static_cast<unsigned int>(pages.size()));
+        writer.put32(static_cast<Uint32>(glyphs.size()));
+        writer.put32(static_cast<Uint32>(kerning.size()));
+
+        for (std::size_t p = 0; p < pages.size(); ++p)
+        {
+            writer.put16(pages[p].size);
+            writer.putBytes(&pages[p].alpha[0], pages[p].alpha.size());
+        }
+
+        for (std::size_t g = 0; g < glyphs.size(); ++g)
+        {
+            const BakedGlyph& glyph = glyphs[g];
+            writer.put32(glyph.codePoint);
+            writer.put16(glyph.bold ? 1 : 0);
+            writer.put16(glyph.page);
+            writer.putFloat(glyph.advance);
+            for (int i = 0; i < 4; ++i)
+                writer.putFloat(glyph.bounds[i]);
+            writer.put16(glyph.x);
+            writer.put16(glyph.y);
+            writer.put16(glyph.width);
+            writer.put16(glyph.height);
+        }
+
+        for (std::size_t k = 0; k < kerning.size(); ++k)
+        {
+            writer.put32(kerning[k].first);
+            writer.put32(kerning[k].second);
+            writer.putFloat(kerning[k].offset);
+        }
+
+        std::cout << "Size " << characterSize << ": " << glyphs.size() << " glyphs in " << pages.size()
+                  << " page(s), " << kerning.size() << " kerning pairs" << std::endl;
+    }
+
+    FT_Done_Face(face);
+    FT_Done_FreeType(library);
+
+    std::ofstream file(outputFile.c_str(), std::ios::binary);
+    file.write(reinterpret_cast<const char*>(&writer.data[0]), writer.data.size());
+    if (!file)
+    {
+        std::cerr << "Failed to write baked font \"" << outputFile << "\"" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,208 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include "Etc1.hpp"
+#include <climits>
+
+
+namespace
+{
+    // ETC1 intensity modifiers, indexed by table and pixel index
+    const int modifiers[8][4] = {
+        { 2,   8,  -2,   -8},
+        { 5,  17,  -5,  -17},
+        { 9,  29,  -9,  -29},
+        {13,  42, -13,  -42},
+        {18,  60, -18,  -60},
+        {24,  80, -24,  -80},
+        {33, 106, -33, -106},
+        {47, 183, -47, -183}
+    };
+
+    struct SubBlock
+    {
+        int            table;   ///< Modifier table
+        cpp3ds::Uint32 indices; ///< 2-bit pixel indices, by position in the block
+        int            error;   ///< Sum of squared errors
+    };
+
+    inline int clamp(int value)
+    {
+        return value < 0 ? 0 : (value > 255 ? 255 : value);
+    }
+
+    // Tell whether a pixel belongs to the second sub-block
+    inline bool inSecondHalf(int x, int y, bool flip)
+    {
+        return flip ? (y >= 2) : (x >= 2);
+    }
+
+    // Find the best modifier table and pixel indices for a sub-block with a given base color
+    SubBlock fitSubBlock(const cpp3ds::Uint8* pixels, bool flip, bool second, const int* base)
+    {
+        SubBlock best = {0, 0, INT_MAX};
+
+        for (int table = 0; table < 8; ++table)
+        {
+            SubBlock candidate = {table, 0, 0};
+
+            for (int y = 0; y < 4; ++y)
+            for (int x = 0; x < 4; ++x)
+            {
+                if (inSecondHalf(x, y, flip) != second)
+                    continue;
+
+                const cpp3ds::Uint8* pixel = pixels + (y * 4 + x) * 4;
+                int bestIndex = 0;
+                int bestError = INT_MAX;
+                for (int index = 0; index < 4; ++index)
+                {
+                    int modifier = modifiers[table][index];
+                    int r = clamp(base[0] + modifier) - pixel[0];
+                    int g = clamp(base[1] + modifier) - pixel[1];
+                    int b = clamp(base[2] + modifier) - pixel[2];
+                    int error = r * r + g * g + b * b;
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        bestIndex = index;
+                    }
+                }
+
+                // Pixels are numbered column by column
+                candidate.indices |= static_cast<cpp3ds::Uint32>(bestIndex) << ((x * 4 + y) * 2);
+                candidate.error += bestError;
+            }
+
+            if (candidate.error < best.error)
+                best = candidate;
+        }
+
+        return best;
+    }
+
+    // Average color of a sub-block
+    void averageSubBlock(const cpp3ds::Uint8* pixels, bool flip, bool second, int* average)
+    {
+        int sum[3] = {0, 0, 0};
+        for (int y = 0; y < 4; ++y)
+        for (int x = 0; x < 4; ++x)
+        {
+            if (inSecondHalf(x, y, flip) != second)
+                continue;
+            for (int c = 0; c < 3; ++c)
+                sum[c] += pixels[(y * 4 + x) * 4 + c];
+        }
+
+        // Each sub-block has 8 pixels
+        for (int c = 0; c < 3; ++c)
+            average[c] = (sum[c] + 4) / 8;
+    }
+
+    // Assemble the block from its base colors and sub-blocks
+    cpp3ds::Uint64 packBlock(const int* color1, const int* color2, bool differential, bool flip,
+                             const SubBlock& first, const SubBlock& second)
+    {
+        cpp3ds::Uint64 block = 0;
+
+        for (int c = 0; c < 3; ++c)
+        {
+            cpp3ds::Uint64 channel;
+            if (differential)
+                channel = (color1[c] << 3) | ((color2[c] - color1[c]) & 7);
+            else
+                channel = (color1[c] << 4) | color2[c];
+            block |= channel << (56 - c * 8);
+        }
+
+        block |= static_cast<cpp3ds::Uint64>(first.table) << 37;
+        block |= static_cast<cpp3ds::Uint64>(second.table) << 34;
+        block |= static_cast<cpp3ds::Uint64>(differential) << 33;
+        block |= static_cast<cpp3ds::Uint64>(flip) << 32;
+
+        // Split the 2-bit indices in most and least significant bit planes
+        cpp3ds::Uint32 indices = first.indices | second.indices;
+        for (int i = 0; i < 16; ++i)
+        {
+            cpp3ds::Uint64 index = (indices >> (i * 2)) & 3;
+            block |= (index >> 1) << (16 + i);
+            block |= (index & 1) << i;
+        }
+
+        return block;
+    }
+}
+
+
+namespace texconv
+{
+////////////////////////////////////////////////////////////
+cpp3ds::Uint64 encodeEtc1Block(const cpp3ds::Uint8* pixels)
+{
+    cpp3ds::Uint64 bestBlock = 0;
+    int bestError = INT_MAX;
+
+    for (int flip = 0; flip < 2; ++flip)
+    {
+        int average1[3], average2[3];
+        averageSubBlock(pixels, flip != 0, false, average1);
+        averageSubBlock(pixels, flip != 0, true,  average2);
+
+        // Individual mode: two 4-bit base colors
+        int quantized1[3], quantized2[3], base1[3], base2[3];
+        for (int c = 0; c < 3; ++c)
+        {
+            quantized1[c] = (average1[c] * 15 + 127) / 255;
+            quantized2[c] = (average2[c] * 15 + 127) / 255;
+            base1[c] = quantized1[c] * 0x11;
+            base2[c] = quantized2[c] * 0x11;
+        }
+
+        SubBlock first = fitSubBlock(pixels, flip != 0, false, base1);
+        SubBlock second = fitSubBlock(pixels, flip != 0, true, base2);
+        if (first.error + second.error < bestError)
+        {
+            bestError = first.error + second.error;
+            bestBlock = packBlock(quantized1, quantized2, false, flip != 0, first, second);
+        }
+
+        // Differential mode: a 5-bit base color and a 3-bit signed offset
+        bool representable = true;
+        for (int c = 0; c < 3; ++c)
+        {
+            quantized1[c] = (average1[c] * 31 + 127) / 255;
+            quantized2[c] = (average2[c] * 31 + 127) / 255;
+            int delta = quantized2[c] - quantized1[c];
+            if ((delta < -4) || (delta > 3))
+                representable = false;
+            base1[c] = (quantized1[c] << 3) | (quantized1[c] >> 2);
+            base2[c] = (quantized2[c] << 3) | (quantized2[c] >> 2);
+        }
+
+        if (representable)
+        {
+            first = fitSubBlock(pixels, flip != 0, false, base1);
+            second = fitSubBlock(pixels, flip != 0, true, base2);
+            if (first.error + second.error < bestError)
+            {
+                bestError = first.error + second.error;
+                bestBlock = packBlock(quantized1, quantized2, true, flip != 0, first, second);
+            }
+        }
+    }
+
+    return bestBlock;
+}
+
+
+////////////////////////////////////////////////////////////
+cpp3ds::Uint64 encodeAlpha4Block(const cpp3ds::Uint8* pixels)
+{
+    cpp3ds::Uint64 block = 0;
+    for (int y = 0; y < 4; ++y)
+        for (int x = 0; x < 4; ++x)
+            block |= static_cast<cpp3ds::Uint64>(pixels[(y * 4 + x) * 4 + 3] >> 4) << ((x * 4 + y) * 4);
+    return block;
+}
+
+} // namespace texconv
@@ -0,0 +1,42 @@
+#ifndef CPP3DS_TEXCONV_ETC1_HPP
+#define CPP3DS_TEXCONV_ETC1_HPP
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cpp3ds/Config.hpp>
+
+
+namespace texconv
+{
+////////////////////////////////////////////////////////////
+/// \brief Compress a 4x4 block of RGBA pixels to ETC1
+///
+/// Both sub-block orientations and both individual and
+/// differential base colors are tried, the block with the
+/// smallest error is kept.
+///
+/// \param pixels 16 RGBA pixels, row by row
+///
+/// \return ETC1 block, as a 64-bit value (big-endian layout)
+///
+////////////////////////////////////////////////////////////
+cpp3ds::Uint64 encodeEtc1Block(const cpp3ds::Uint8* pixels);
+
+////////////////////////////////////////////////////////////
+/// \brief Pack the alpha of a 4x4 block of RGBA pixels to 4 bits
+///
+/// Alpha values are stored column by column, as the 3DS
+/// expects in front of each ETC1A4 block.
+///
+/// \param pixels 16 RGBA pixels, row by row
+///
+/// \return 16 4-bit alpha values
+///
+////////////////////////////////////////////////////////////
+cpp3ds::Uint64 encodeAlpha4Block(const cpp3ds::Uint8* pixels);
+
+} // namespace texconv
+
+
+#endif // CPP3DS_TEXCONV_ETC1_HPP
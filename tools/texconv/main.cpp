@@ -0,0 +1,257 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include "Etc1.hpp"
+#include "../../src/cpp3ds/Graphics/TextureTiling.hpp"
+#define STB_IMAGE_IMPLEMENTATION
+#include <cpp3ds/Graphics/stb_image/stb_image.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using cpp3ds::Uint8;
+using cpp3ds::Uint16;
+using cpp3ds::Uint32;
+using cpp3ds::Uint64;
+
+
+namespace
+{
+    // Values of the ctrulib GPU_TEXCOLOR enum
+    enum GpuFormat
+    {
+        GpuRGBA8    = 0x0,
+        GpuRGBA5551 = 0x2,
+        GpuRGB565   = 0x3,
+        GpuRGBA4    = 0x4,
+        GpuLA8      = 0x5,
+        GpuL8       = 0x7,
+        GpuA8       = 0x8,
+        GpuETC1     = 0xC,
+        GpuETC1A4   = 0xD
+    };
+
+    struct FormatInfo
+    {
+        const char*             name;
+        GpuFormat               gpuFormat;
+        cpp3ds::Texture::Format format;       ///< Converter used for uncompressed formats
+        unsigned int            bitsPerPixel;
+    };
+
+    const FormatInfo formats[] = {
+        {"rgba8",    GpuRGBA8,    cpp3ds::Texture::RGBA8,    32},
+        {"rgb565",   GpuRGB565,   cpp3ds::Texture::RGB565,   16},
+        {"rgba5551", GpuRGBA5551, cpp3ds::Texture::RGBA5551, 16},
+        {"rgba4",    GpuRGBA4,    cpp3ds::Texture::RGBA4,    16},
+        {"la8",      GpuLA8,      cpp3ds::Texture::LA8,      16},
+        {"l8",       GpuL8,       cpp3ds::Texture::L8,       8},
+        {"a8",       GpuA8,       cpp3ds::Texture::A8,       8},
+        {"etc1",     GpuETC1,     cpp3ds::Texture::RGBA8,    4},
+        {"etc1a4",   GpuETC1A4,   cpp3ds::Texture::RGBA8,    8}
+    };
+
+    const unsigned int maximumSize = 1024;
+
+    struct Image
+    {
+        unsigned int       width;
+        unsigned int       height;
+        std::vector<Uint8> pixels; ///< RGBA pixels, row by row
+    };
+
+    unsigned int getValidSize(unsigned int size)
+    {
+        // Textures are powers of two, at least one tile large
+        unsigned int powerOfTwo = 8;
+        while (powerOfTwo < size)
+            powerOfTwo *= 2;
+        return powerOfTwo;
+    }
+
+    // Halve the size of an image, weighting colors by their alpha
+    Image downsample(const Image& image)
+    {
+        Image result;
+        result.width = image.width / 2;
+        result.height = image.height / 2;
+        result.pixels.resize(result.width * result.height * 4);
+
+        for (unsigned int y = 0; y < result.height; ++y)
+        for (unsigned int x = 0; x < result.width; ++x)
+        {
+            unsigned int sum[4] = {0, 0, 0, 0};
+            for (unsigned int j = 0; j < 2; ++j)
+            for (unsigned int i = 0; i < 2; ++i)
+            {
+                const Uint8* pixel = &image.pixels[((y * 2 + j) * image.width + x * 2 + i) * 4];
+                for (int c = 0; c < 3; ++c)
+                    sum[c] += pixel[c] * (pixel[3] + 1);
+                sum[3] += pixel[3] + 1;
+            }
+
+            Uint8* pixel = &result.pixels[(y * result.width + x) * 4];
+            for (int c = 0; c < 3; ++c)
+                pixel[c] = static_cast<Uint8>((sum[c] + sum[3] / 2) / sum[3]);
+            pixel[3] = static_cast<Uint8>((sum[3] - 4 + 2) / 4);
+        }
+
+        return result;
+    }
+
+    // Compress an image to ETC1, with or without 4-bit alpha. Blocks are stored
+    // by 8x8 tiles, each tile having its 4 blocks in Z order.
+    void encodeEtc1(const Image& image, bool alpha, std::vector<Uint8>& output)
+    {
+        for (unsigned int tileY = 0; tileY < image.height; tileY += 8)
+        for (unsigned int tileX = 0; tileX < image.width; tileX += 8)
+        for (unsigned int block = 0; block < 4; ++block)
+        {
+            unsigned int blockX = tileX + (block & 1) * 4;
+            unsigned int blockY = tileY + (block >> 1) * 4;
+
+            // Rows are stored bottom to top
+            Uint8 pixels[16 * 4];
+            for (unsigned int y = 0; y < 4; ++y)
+                std::memcpy(pixels + y * 16, &image.pixels[((image.height - 1 - blockY - y) * image.width + blockX) * 4], 16);
+
+            Uint64 words[2] = {texconv::encodeAlpha4Block(pixels), texconv::encodeEtc1Block(pixels)};
+            for (unsigned int w = alpha ? 0 : 1; w < 2; ++w)
+                for (unsigned int i = 0; i < 8; ++i)
+                    output.push_back(static_cast<Uint8>(words[w] >> (i * 8)));
+        }
+    }
+
+    void showUsage()
+    {
+        std::cerr << "Usage: cpp3ds-texconv [-f format] [-m levels] -o output input" << std::endl
+                  << std::endl
+                  << "Converts a PNG/JPG/BMP/TGA image to a tiled texture that can be loaded" << std::endl
+                  << "with cpp3ds::Texture::loadFromPreprocessedFile." << std::endl
+                  << std::endl
+                  << "  -f format  rgba8 (default), rgb565, rgba5551, rgba4, la8, l8, a8, etc1, etc1a4" << std::endl
+                  << "  -m levels  number of mipmap levels, 0 for a full chain (default 1)" << std::endl
+                  << "  -o output  output file" << std::endl;
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+int main(int argc, char** argv)
+{
+    const FormatInfo* format = &formats[0];
+    unsigned int levels = 1;
+    std::string inputFile;
+    std::string outputFile;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if ((arg == "-f") && (i + 1 < argc))
+        {
+            std::string name = argv[++i];
+            format = NULL;
+            for (std::size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f)
+                if (name == formats[f].name)
+                    format = &formats[f];
+            if (!format)
+            {
+                std::cerr << "Unknown texture format: " << name << std::endl;
+                return 1;
+            }
+        }
+        else if ((arg == "-m") && (i + 1 < argc))
+            levels = static_cast<unsigned int>(std::atoi(argv[++i]));
+        else if ((arg == "-o") && (i + 1 < argc))
+            outputFile = argv[++i];
+        else if ((arg[0] != '-') && inputFile.empty())
+            inputFile = arg;
+        else
+        {
+            showUsage();
+            return 1;
+        }
+    }
+
+    if (inputFile.empty() || outputFile.empty())
+    {
+        showUsage();
+        return 1;
+    }
+
+    // Load the source image
+    int width, height, channels;
+    Uint8* data = stbi_load(inputFile.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    if (!data)
+    {
+        std::cerr << "Failed to load image \"" << inputFile << "\". Reason: " << stbi_failure_reason() << std::endl;
+        return 1;
+    }
+
+    // Pad it to the texture size, the image staying at the top left
+    Image image;
+    image.width = getValidSize(width);
+    image.height = getValidSize(height);
+    if ((image.width > maximumSize) || (image.height > maximumSize))
+    {
+        std::cerr << "Image \"" << inputFile << "\" is too large (" << width << "x" << height << ", "
+                  << "maximum is " << maximumSize << "x" << maximumSize << ")" << std::endl;
+        stbi_image_free(data);
+        return 1;
+    }
+    image.pixels.resize(image.width * image.height * 4);
+    for (int y = 0; y < height; ++y)
+        std::memcpy(&image.pixels[y * image.width * 4], data + y * width * 4, width * 4);
+    stbi_image_free(data);
+
+    // Levels stop when a side gets smaller than a tile
+    unsigned int maxLevels = 1;
+    while (((image.width >> maxLevels) >= 8) && ((image.height >> maxLevels) >= 8))
+        ++maxLevels;
+    if ((levels == 0) || (levels > maxLevels))
+        levels = maxLevels;
+
+    // Convert each mipmap level, one after the other
+    std::vector<Uint8> output;
+    for (unsigned int level = 0; level < levels; ++level)
+    {
+        if (level > 0)
+            image = downsample(image);
+
+        if (format->gpuFormat == GpuETC1 || format->gpuFormat == GpuETC1A4)
+        {
+            encodeEtc1(image, format->gpuFormat == GpuETC1A4, output);
+        }
+        else
+        {
+            std::size_t offset = output.size();
+            output.resize(offset + image.width * image.height * format->bitsPerPixel / 8);
+            cpp3ds::priv::tileImage(&output[offset], &image.pixels[0], 0, 0, image.width, image.height,
+                                    image.width, image.height, format->format);
+        }
+    }
+
+    // Header matching cpp3ds::Texture::loadFromPreprocessedFile, little-endian
+    Uint16 header[5] = {static_cast<Uint16>(format->gpuFormat),
+                        static_cast<Uint16>(getValidSize(width)), static_cast<Uint16>(getValidSize(height)),
+                        static_cast<Uint16>(width), static_cast<Uint16>(height)};
+
+    std::ofstream file(outputFile.c_str(), std::ios::binary);
+    for (int i = 0; i < 5; ++i)
+    {
+        file.put(static_cast<char>(header[i] & 0xFF));
+        file.put(static_cast<char>(header[i] >> 8));
+    }
+    file.write(reinterpret_cast<const char*>(&output[0]), output.size());
+    if (!file)
+    {
+        std::cerr << "Failed to write texture \"" << outputFile << "\"" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}